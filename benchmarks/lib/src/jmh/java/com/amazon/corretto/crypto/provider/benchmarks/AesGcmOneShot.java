@@ -3,9 +3,11 @@
 package com.amazon.corretto.crypto.provider.benchmarks;
 
 import java.security.spec.AlgorithmParameterSpec;
+import javax.crypto.Cipher;
 import javax.crypto.spec.GCMParameterSpec;
 
 import com.amazon.corretto.crypto.provider.AmazonCorrettoCryptoProvider;
+import com.amazon.corretto.crypto.utils.AesGcmBatchUtils;
 import org.openjdk.jmh.annotations.Benchmark;
 import org.openjdk.jmh.annotations.Param;
 import org.openjdk.jmh.annotations.Scope;
@@ -14,6 +16,10 @@ import org.openjdk.jmh.annotations.State;
 
 @State(Scope.Benchmark)
 public class AesGcmOneShot extends AesBase {
+  // Shape of the batched benchmarks: many small records, as seen by services sealing messages
+  private static final int BATCH_RECORDS = 1024;
+  private static final int BATCH_RECORD_SIZE = 256;
+
   @Param({"128", "256"})
   public int keyBits;
 
@@ -23,9 +29,44 @@ public class AesGcmOneShot extends AesBase {
   @Param({"NoPadding"})
   public String padding;
 
+  private byte[][] batchIvs;
+  private int[] batchOffsets;
+  private int[] batchLengths;
+  private byte[] batchInput;
+  private byte[] batchSealed;
+  private int[] batchSealedOffsets;
+  private int[] batchSealedLengths;
+  private byte[] batchOutput;
+
   @Setup
   public void setup() throws Exception {
     super.setup(keyBits, provider, padding);
+
+    batchIvs = new byte[BATCH_RECORDS][];
+    batchOffsets = new int[BATCH_RECORDS];
+    batchLengths = new int[BATCH_RECORDS];
+    batchSealedOffsets = new int[BATCH_RECORDS];
+    batchSealedLengths = new int[BATCH_RECORDS];
+    for (int i = 0; i < BATCH_RECORDS; i++) {
+      batchIvs[i] = BenchmarkUtils.getRandBytes(getIvSize());
+      batchOffsets[i] = i * BATCH_RECORD_SIZE;
+      batchLengths[i] = BATCH_RECORD_SIZE;
+      batchSealedOffsets[i] = i * (BATCH_RECORD_SIZE + 16);
+      batchSealedLengths[i] = BATCH_RECORD_SIZE + 16;
+    }
+    batchInput = BenchmarkUtils.getRandBytes(BATCH_RECORDS * BATCH_RECORD_SIZE);
+    batchSealed = new byte[BATCH_RECORDS * (BATCH_RECORD_SIZE + 16)];
+    for (int i = 0; i < BATCH_RECORDS; i++) {
+      encryptor.init(Cipher.ENCRYPT_MODE, key, createParameterSpec(batchIvs[i]));
+      encryptor.doFinal(
+          batchInput, batchOffsets[i], batchLengths[i], batchSealed, batchSealedOffsets[i]);
+    }
+    batchOutput = new byte[batchInput.length];
+    encryptor.init(Cipher.ENCRYPT_MODE, key, params2);
+  }
+
+  private boolean isAccp() {
+    return AmazonCorrettoCryptoProvider.PROVIDER_NAME.equals(provider);
   }
 
   @Override
@@ -52,4 +93,55 @@ public class AesGcmOneShot extends AesBase {
   public byte[] decrypt() throws Exception {
     return super.oneShot1MiBDecrypt();
   }
+
+  // The per-record benchmarks below process the same 1024 records of 256 bytes each; the batched
+  // variants use AesGcmBatchUtils when running against ACCP and fall back to the per-record loop
+  // for other providers, so the two can be compared directly.
+
+  @Benchmark
+  public byte[] encryptRecords() throws Exception {
+    final byte[] out = new byte[batchSealed.length];
+    for (int i = 0; i < BATCH_RECORDS; i++) {
+      encryptor.init(Cipher.ENCRYPT_MODE, key, createParameterSpec(batchIvs[i]));
+      encryptor.doFinal(batchInput, batchOffsets[i], batchLengths[i], out, batchSealedOffsets[i]);
+    }
+    encryptor.init(Cipher.ENCRYPT_MODE, key, params2);
+    return out;
+  }
+
+  @Benchmark
+  public byte[] encryptRecordsBatched() throws Exception {
+    if (!isAccp()) {
+      return encryptRecords();
+    }
+    return AesGcmBatchUtils.seal(
+        key, 128, batchIvs, null, batchInput, batchOffsets, batchLengths);
+  }
+
+  @Benchmark
+  public byte[] decryptRecords() throws Exception {
+    for (int i = 0; i < BATCH_RECORDS; i++) {
+      decryptor.init(Cipher.DECRYPT_MODE, key, createParameterSpec(batchIvs[i]));
+      decryptor.doFinal(
+          batchSealed, batchSealedOffsets[i], batchSealedLengths[i], batchOutput, batchOffsets[i]);
+    }
+    return batchOutput;
+  }
+
+  @Benchmark
+  public byte[] decryptRecordsBatched() throws Exception {
+    if (!isAccp()) {
+      return decryptRecords();
+    }
+    AesGcmBatchUtils.open(
+        key,
+        128,
+        batchIvs,
+        null,
+        batchSealed,
+        batchSealedOffsets,
+        batchSealedLengths,
+        batchOutput);
+    return batchOutput;
+  }
 }
@@ -0,0 +1,74 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider.benchmarks;
+
+import java.security.Key;
+import javax.crypto.Cipher;
+import javax.crypto.spec.GCMParameterSpec;
+import javax.crypto.spec.SecretKeySpec;
+
+import com.amazon.corretto.crypto.provider.AmazonCorrettoCryptoProvider;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+
+/**
+ * One-shot AES-GCM on small messages. With ACCP, a 128-bit tag takes the EVP_AEAD fast path while a
+ * 120-bit tag takes the general EVP_CIPHER path, so comparing the two shows the cost of the latter.
+ */
+@State(Scope.Benchmark)
+public class AesGcmSmallMessage {
+  @Param({"128", "256"})
+  public int keyBits;
+
+  @Param({"128", "120"})
+  public int tagBits;
+
+  @Param({"64", "256", "512"})
+  public int messageSize;
+
+  @Param({AmazonCorrettoCryptoProvider.PROVIDER_NAME, "SunJCE"})
+  public String provider;
+
+  private Key key;
+  private GCMParameterSpec params1;
+  private GCMParameterSpec params2;
+  private Cipher encryptor;
+  private Cipher decryptor;
+  private byte[] plaintext;
+  private byte[] ciphertext;
+  private byte[] output;
+  private boolean useFirstIv;
+
+  @Setup
+  public void setup() throws Exception {
+    BenchmarkUtils.setupProvider(provider);
+    key = new SecretKeySpec(BenchmarkUtils.getRandBytes(keyBits / 8), "AES");
+    params1 = new GCMParameterSpec(tagBits, BenchmarkUtils.getRandBytes(12));
+    params2 = new GCMParameterSpec(tagBits, BenchmarkUtils.getRandBytes(12));
+    encryptor = Cipher.getInstance("AES/GCM/NoPadding", provider);
+    decryptor = Cipher.getInstance("AES/GCM/NoPadding", provider);
+    plaintext = BenchmarkUtils.getRandBytes(messageSize);
+    encryptor.init(Cipher.ENCRYPT_MODE, key, params1);
+    ciphertext = encryptor.doFinal(plaintext);
+    output = new byte[ciphertext.length];
+  }
+
+  @Benchmark
+  public byte[] encrypt() throws Exception {
+    // Alternate IVs, since GCM does not allow encrypting twice with the same key and IV.
+    useFirstIv = !useFirstIv;
+    encryptor.init(Cipher.ENCRYPT_MODE, key, useFirstIv ? params1 : params2);
+    encryptor.doFinal(plaintext, 0, plaintext.length, output, 0);
+    return output;
+  }
+
+  @Benchmark
+  public byte[] decrypt() throws Exception {
+    decryptor.init(Cipher.DECRYPT_MODE, key, params1);
+    decryptor.doFinal(ciphertext, 0, ciphertext.length, output, 0);
+    return output;
+  }
+}
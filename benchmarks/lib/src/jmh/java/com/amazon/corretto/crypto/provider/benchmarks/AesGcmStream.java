@@ -0,0 +1,67 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider.benchmarks;
+
+import java.security.spec.AlgorithmParameterSpec;
+import javax.crypto.spec.IvParameterSpec;
+
+import com.amazon.corretto.crypto.provider.AmazonCorrettoCryptoProvider;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+
+/** Segmented streaming AES-GCM; compare with {@link AesGcmOneShot} for the cost of segmenting. */
+@State(Scope.Benchmark)
+public class AesGcmStream extends AesBase {
+  @Param({"128", "256"})
+  public int keyBits;
+
+  // Each parameter combination runs in its own forked JVM, so the property is read afresh by every
+  // trial.
+  @Param({"1", "2", "4", "8"})
+  public int threads;
+
+  @Setup
+  public void setup() throws Exception {
+    System.setProperty(
+        "com.amazon.corretto.crypto.provider.aesGcmStreamThreads", Integer.toString(threads));
+    super.setup(keyBits, AmazonCorrettoCryptoProvider.PROVIDER_NAME, "NoPadding");
+  }
+
+  @Override
+  protected String getMode() {
+    return "GCM-STREAM";
+  }
+
+  @Override
+  protected AlgorithmParameterSpec createParameterSpec(byte[] iv) {
+    return new IvParameterSpec(iv);
+  }
+
+  @Override
+  protected int getIvSize() {
+    return 16;
+  }
+
+  @Benchmark
+  public byte[] encrypt() throws Exception {
+    return super.oneShot1MiBEncrypt();
+  }
+
+  @Benchmark
+  public byte[] decrypt() throws Exception {
+    return super.oneShot1MiBDecrypt();
+  }
+
+  @Benchmark
+  public byte[] encryptStreaming() throws Exception {
+    return super.updateEncrypt(16 * 1024);
+  }
+
+  @Benchmark
+  public byte[] decryptStreaming() throws Exception {
+    return super.updateDecrypt(16 * 1024);
+  }
+}
@@ -0,0 +1,64 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider.benchmarks;
+
+import javax.crypto.Mac;
+import javax.crypto.spec.IvParameterSpec;
+import javax.crypto.spec.SecretKeySpec;
+
+import com.amazon.corretto.crypto.provider.AmazonCorrettoCryptoProvider;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+
+@State(Scope.Benchmark)
+public class AesMac {
+  @Param({"AESCMAC", "AES-GMAC"})
+  public String algorithm;
+
+  @Param({AmazonCorrettoCryptoProvider.PROVIDER_NAME, "BC"})
+  public String provider;
+
+  private byte[] data_16B;
+  private byte[] data_1KiB;
+  private byte[] data_64KiB;
+  private SecretKeySpec key;
+  private IvParameterSpec iv;
+  private Mac mac;
+
+  @Setup
+  public void setup() throws Exception {
+    BenchmarkUtils.setupProvider(provider);
+    data_16B = BenchmarkUtils.getRandBytes(16);
+    data_1KiB = BenchmarkUtils.getRandBytes(1024);
+    data_64KiB = BenchmarkUtils.getRandBytes(64 * 1024);
+    key = new SecretKeySpec(BenchmarkUtils.getRandBytes(16), "AES");
+    iv = algorithm.equals("AES-GMAC") ? new IvParameterSpec(BenchmarkUtils.getRandBytes(12)) : null;
+    mac = Mac.getInstance(algorithm, provider);
+    mac.init(key, iv);
+  }
+
+  @Benchmark
+  public byte[] oneShotSmall_16B() {
+    return mac.doFinal(data_16B);
+  }
+
+  @Benchmark
+  public byte[] oneShotMedium_1KiB() {
+    return mac.doFinal(data_1KiB);
+  }
+
+  @Benchmark
+  public byte[] oneShotLarge_64KiB() {
+    return mac.doFinal(data_64KiB);
+  }
+
+  /** A key check value: a new MAC over a single block, including initialization. */
+  @Benchmark
+  public byte[] initAndMac_16B() throws Exception {
+    mac.init(key, iv);
+    return mac.doFinal(data_16B);
+  }
+}
@@ -0,0 +1,61 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider.benchmarks;
+
+import java.security.Key;
+import javax.crypto.Cipher;
+import javax.crypto.spec.IvParameterSpec;
+import javax.crypto.spec.SecretKeySpec;
+
+import com.amazon.corretto.crypto.provider.AmazonCorrettoCryptoProvider;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+
+/** Mirrors {@link AesGcmOneShot}'s 1 MiB one-shot benchmarks so the two AEADs can be compared. */
+@State(Scope.Benchmark)
+public class ChaCha20Poly1305OneShot {
+  private static final String ALGORITHM = "ChaCha20-Poly1305";
+
+  @Param({AmazonCorrettoCryptoProvider.PROVIDER_NAME, "BC", "SunJCE"})
+  public String provider;
+
+  private Key key;
+  private IvParameterSpec params1;
+  private IvParameterSpec params2;
+  private Cipher encryptor;
+  private Cipher decryptor;
+  private byte[] plaintext;
+  private byte[] ciphertext;
+
+  @Setup
+  public void setup() throws Exception {
+    BenchmarkUtils.setupProvider(provider);
+    key = new SecretKeySpec(BenchmarkUtils.getRandBytes(32), "ChaCha20");
+    params1 = new IvParameterSpec(BenchmarkUtils.getRandBytes(12));
+    params2 = new IvParameterSpec(BenchmarkUtils.getRandBytes(12));
+    encryptor = Cipher.getInstance(ALGORITHM, provider);
+    decryptor = Cipher.getInstance(ALGORITHM, provider);
+    encryptor.init(Cipher.ENCRYPT_MODE, key, params1);
+    plaintext = BenchmarkUtils.getRandBytes(AesBase.PLAINTEXT_SIZE);
+    ciphertext = encryptor.doFinal(plaintext);
+    encryptor.init(Cipher.ENCRYPT_MODE, key, params2);
+  }
+
+  @Benchmark
+  public byte[] encrypt() throws Exception {
+    // Re-initializing with params2 afterwards avoids a key/nonce reuse rejection on the next call
+    encryptor.init(Cipher.ENCRYPT_MODE, key, params1);
+    final byte[] out = encryptor.doFinal(plaintext);
+    encryptor.init(Cipher.ENCRYPT_MODE, key, params2);
+    return out;
+  }
+
+  @Benchmark
+  public byte[] decrypt() throws Exception {
+    decryptor.init(Cipher.DECRYPT_MODE, key, params1);
+    return decryptor.doFinal(ciphertext);
+  }
+}
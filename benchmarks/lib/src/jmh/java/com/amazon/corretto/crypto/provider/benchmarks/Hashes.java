@@ -13,7 +13,17 @@ import org.openjdk.jmh.annotations.State;
 
 @State(Scope.Benchmark)
 public class Hashes {
-  @Param({"SHA-256", "SHA-384", "SHA-512", "SHA-1", "MD5"})
+  @Param({
+    "SHA-256",
+    "SHA-384",
+    "SHA-512",
+    "SHA-1",
+    "MD5",
+    "SHA3-256",
+    "SHA3-512",
+    "SHAKE128-256",
+    "SHAKE256-512"
+  })
   public String algorithm;
 
   @Param({AmazonCorrettoCryptoProvider.PROVIDER_NAME, "BC", "SUN"})
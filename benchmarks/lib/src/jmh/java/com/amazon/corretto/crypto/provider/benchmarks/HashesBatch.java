@@ -0,0 +1,66 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider.benchmarks;
+
+import java.security.MessageDigest;
+
+import com.amazon.corretto.crypto.provider.AmazonCorrettoCryptoProvider;
+import com.amazon.corretto.crypto.utils.DigestBatchUtils;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.OperationsPerInvocation;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.infra.Blackhole;
+
+/**
+ * Digests of many small records, one {@link MessageDigest#digest} call per record versus a single
+ * batch call. Scores are per record, so they are comparable with {@link Hashes#oneShotSmall_8B}.
+ */
+@State(Scope.Benchmark)
+public class HashesBatch {
+  private static final int RECORDS = 1024;
+
+  @Param({"SHA-256", "SHA-512"})
+  public String algorithm;
+
+  @Param({"8", "32", "256"})
+  public int recordSize;
+
+  private byte[] data;
+  private int[] offsets;
+  private int[] lengths;
+  private byte[] digests;
+  private MessageDigest digest;
+
+  @Setup
+  public void setup() throws Exception {
+    BenchmarkUtils.setupProvider(AmazonCorrettoCryptoProvider.PROVIDER_NAME);
+    data = BenchmarkUtils.getRandBytes(RECORDS * recordSize);
+    offsets = new int[RECORDS];
+    lengths = new int[RECORDS];
+    for (int i = 0; i < RECORDS; i++) {
+      offsets[i] = i * recordSize;
+      lengths[i] = recordSize;
+    }
+    digest = MessageDigest.getInstance(algorithm, AmazonCorrettoCryptoProvider.PROVIDER_NAME);
+    digests = new byte[RECORDS * digest.getDigestLength()];
+  }
+
+  @Benchmark
+  @OperationsPerInvocation(RECORDS)
+  public void oneShotEach(final Blackhole bh) {
+    for (int i = 0; i < RECORDS; i++) {
+      digest.update(data, offsets[i], lengths[i]);
+      bh.consume(digest.digest());
+    }
+  }
+
+  @Benchmark
+  @OperationsPerInvocation(RECORDS)
+  public byte[] batch() {
+    DigestBatchUtils.digestBatch(algorithm, data, offsets, lengths, digests, 0);
+    return digests;
+  }
+}
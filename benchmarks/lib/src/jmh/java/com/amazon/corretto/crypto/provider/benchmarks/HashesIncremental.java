@@ -0,0 +1,53 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider.benchmarks;
+
+import java.security.MessageDigest;
+
+import com.amazon.corretto.crypto.provider.AmazonCorrettoCryptoProvider;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.OperationsPerInvocation;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+
+/**
+ * Streams a message through many small {@link MessageDigest#update} calls. Scores are per update.
+ * Updates of up to 1 KiB are coalesced by the Java side input buffer; larger ones each reach the
+ * native context. The nested {@link NativeContexts} benchmark repeats this with {@code
+ * nativeDigestContexts} enabled, to compare against the default byte[] contexts.
+ */
+@State(Scope.Benchmark)
+public class HashesIncremental {
+  private static final int UPDATES = 1024;
+
+  @Param({"SHA-256", "SHA-512"})
+  public String algorithm;
+
+  @Param({"64", "1100", "4096"})
+  public int updateSize;
+
+  private byte[] data;
+  private MessageDigest digest;
+
+  @Setup
+  public void setup() throws Exception {
+    BenchmarkUtils.setupProvider(AmazonCorrettoCryptoProvider.PROVIDER_NAME);
+    data = BenchmarkUtils.getRandBytes(updateSize);
+    digest = MessageDigest.getInstance(algorithm, AmazonCorrettoCryptoProvider.PROVIDER_NAME);
+  }
+
+  @Benchmark
+  @OperationsPerInvocation(UPDATES)
+  public byte[] incremental() {
+    for (int i = 0; i < UPDATES; i++) {
+      digest.update(data);
+    }
+    return digest.digest();
+  }
+
+  @Fork(jvmArgsAppend = "-Dcom.amazon.corretto.crypto.provider.nativeDigestContexts=true")
+  public static class NativeContexts extends HashesIncremental {}
+}
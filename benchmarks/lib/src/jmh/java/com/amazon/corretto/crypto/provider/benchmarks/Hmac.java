@@ -2,16 +2,22 @@
 // SPDX-License-Identifier: Apache-2.0
 package com.amazon.corretto.crypto.provider.benchmarks;
 
+import java.nio.ByteBuffer;
 import javax.crypto.Mac;
 import javax.crypto.spec.SecretKeySpec;
 
 import com.amazon.corretto.crypto.provider.AmazonCorrettoCryptoProvider;
 import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.Fork;
 import org.openjdk.jmh.annotations.Param;
 import org.openjdk.jmh.annotations.Scope;
 import org.openjdk.jmh.annotations.Setup;
 import org.openjdk.jmh.annotations.State;
 
+/**
+ * The nested {@link Specialized} benchmark repeats this with {@code specializedHmac} enabled, to
+ * compare the per-digest HMAC implementations against the generic {@code HMAC_CTX} path.
+ */
 @State(Scope.Benchmark)
 public class Hmac {
   @Param({"SHA256", "SHA384", "SHA512"})
@@ -23,6 +29,7 @@ public class Hmac {
   private byte[] data_8B;
   private byte[] data_1KiB;
   private byte[] data_64KiB;
+  private ByteBuffer direct_64KiB;
   private Mac mac;
 
   @Setup
@@ -32,6 +39,8 @@ public class Hmac {
     data_8B = BenchmarkUtils.getRandBytes(8);
     data_1KiB = BenchmarkUtils.getRandBytes(1024);
     data_64KiB = BenchmarkUtils.getRandBytes(64 * 1024);
+    direct_64KiB = ByteBuffer.allocateDirect(data_64KiB.length);
+    direct_64KiB.put(data_64KiB).flip();
     mac = Mac.getInstance(algorithm, provider);
     mac.init(new SecretKeySpec(BenchmarkUtils.getRandBytes(mac.getMacLength()), algorithm));
   }
@@ -50,4 +59,13 @@ public class Hmac {
   public byte[] oneShotLarge_64KiB() {
     return mac.doFinal(data_64KiB);
   }
+
+  @Benchmark
+  public byte[] directBufferLarge_64KiB() {
+    mac.update(direct_64KiB.duplicate());
+    return mac.doFinal();
+  }
+
+  @Fork(jvmArgsAppend = "-Dcom.amazon.corretto.crypto.provider.specializedHmac=true")
+  public static class Specialized extends Hmac {}
 }
@@ -0,0 +1,85 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider.benchmarks;
+
+import java.security.Key;
+import java.security.MessageDigest;
+import java.util.BitSet;
+import javax.crypto.Mac;
+import javax.crypto.spec.SecretKeySpec;
+
+import com.amazon.corretto.crypto.provider.AmazonCorrettoCryptoProvider;
+import com.amazon.corretto.crypto.utils.HmacBatchUtils;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.OperationsPerInvocation;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+
+/**
+ * Verifies a batch of (key, message, tag) tuples, either one {@link Mac#doFinal} and Java
+ * comparison at a time or with a single {@link HmacBatchUtils#verify} call. Scores are per message.
+ */
+@State(Scope.Benchmark)
+public class HmacBatch {
+  private static final int MESSAGES = 1024;
+  private static final int KEYS = 16;
+
+  @Param({"HmacSHA256", "HmacSHA512"})
+  public String algorithm;
+
+  @Param({"64", "1024"})
+  public int messageSize;
+
+  private Key[] keys;
+  private byte[] input;
+  private int[] offsets;
+  private int[] lengths;
+  private byte[] tags;
+  private int macLength;
+  private Mac mac;
+
+  @Setup
+  public void setup() throws Exception {
+    BenchmarkUtils.setupProvider(AmazonCorrettoCryptoProvider.PROVIDER_NAME);
+    final Key[] distinct = new Key[KEYS];
+    for (int i = 0; i < KEYS; i++) {
+      distinct[i] = new SecretKeySpec(BenchmarkUtils.getRandBytes(32), algorithm);
+    }
+    keys = new Key[MESSAGES];
+    offsets = new int[MESSAGES];
+    lengths = new int[MESSAGES];
+    for (int i = 0; i < MESSAGES; i++) {
+      keys[i] = distinct[i % KEYS];
+      offsets[i] = i * messageSize;
+      lengths[i] = messageSize;
+    }
+    input = BenchmarkUtils.getRandBytes(MESSAGES * messageSize);
+    mac = Mac.getInstance(algorithm, AmazonCorrettoCryptoProvider.PROVIDER_NAME);
+    macLength = mac.getMacLength();
+    tags = HmacBatchUtils.compute(algorithm, keys, input, offsets, lengths);
+  }
+
+  @Benchmark
+  @OperationsPerInvocation(MESSAGES)
+  public int verifyIndividually() throws Exception {
+    int valid = 0;
+    final byte[] expected = new byte[macLength];
+    for (int i = 0; i < MESSAGES; i++) {
+      mac.init(keys[i]);
+      mac.update(input, offsets[i], lengths[i]);
+      System.arraycopy(tags, i * macLength, expected, 0, macLength);
+      if (MessageDigest.isEqual(mac.doFinal(), expected)) {
+        valid++;
+      }
+    }
+    return valid;
+  }
+
+  @Benchmark
+  @OperationsPerInvocation(MESSAGES)
+  public BitSet verifyBatch() {
+    return HmacBatchUtils.verify(algorithm, keys, input, offsets, lengths, tags);
+  }
+}
@@ -2,11 +2,17 @@
 // SPDX-License-Identifier: Apache-2.0
 package com.amazon.corretto.crypto.provider.benchmarks;
 
+import java.io.ByteArrayOutputStream;
 import java.security.KeyPair;
 import java.security.KeyPairGenerator;
 import java.security.SecureRandom;
+import java.security.PublicKey;
 import java.security.Signature;
 import java.security.spec.AlgorithmParameterSpec;
+import java.util.BitSet;
+
+import com.amazon.corretto.crypto.provider.AsyncSignatures;
+import com.amazon.corretto.crypto.utils.SignatureBatchUtils;
 
 public class SignatureBase {
   protected KeyPair keyPair;
@@ -14,6 +20,16 @@ public class SignatureBase {
   protected Signature verifier;
   protected byte[] message = new byte[1024];
   protected byte[] signature;
+  protected byte[] output = new byte[8192];
+
+  // Batch verification state, see setupBatch
+  private String sigAlg;
+  private PublicKey[] batchKeys;
+  private int[] batchOffsets;
+  private int[] batchLengths;
+  private byte[] batchSignatures;
+  private int[] batchSigOffsets;
+  private int[] batchSigLengths;
 
   protected void setup(
           String provider,
@@ -29,6 +45,7 @@ public class SignatureBase {
       kpg.initialize(keyParams);
     }
     keyPair = kpg.generateKeyPair();
+    this.sigAlg = sigAlg;
     signer = Signature.getInstance(sigAlg, provider);
     verifier = Signature.getInstance(sigAlg, provider);
     if (sigParams != null) {
@@ -51,8 +68,69 @@ public class SignatureBase {
     return signer.sign();
   }
 
+  /** Signs {@link #message} into a reused array rather than allocating one per signature. */
+  protected int signInto() throws Exception {
+    signer.update(message);
+    return signer.sign(output, 0, output.length);
+  }
+
   protected boolean verify() throws Exception {
     verifier.update(message);
     return verifier.verify(signature);
   }
-}
\ No newline at end of file
+
+  /** Signs {@link #message} on the {@link AsyncSignatures} worker pool and waits for the result. */
+  protected byte[] signAsync() {
+    return AsyncSignatures.sign(sigAlg, keyPair.getPrivate(), message).join();
+  }
+
+  protected boolean verifyAsync() {
+    return AsyncSignatures.verify(sigAlg, keyPair.getPublic(), message, signature).join();
+  }
+
+  /**
+   * Prepares {@code batchSize} signatures of {@link #message} under the key pair, laid out for
+   * {@link SignatureBatchUtils}. Must be called after {@link #setup}.
+   */
+  protected void setupBatch(final int batchSize) throws Exception {
+    final ByteArrayOutputStream sigs = new ByteArrayOutputStream();
+    batchKeys = new PublicKey[batchSize];
+    batchOffsets = new int[batchSize];
+    batchLengths = new int[batchSize];
+    batchSigOffsets = new int[batchSize];
+    batchSigLengths = new int[batchSize];
+    for (int i = 0; i < batchSize; i++) {
+      batchKeys[i] = keyPair.getPublic();
+      batchLengths[i] = message.length;
+      signer.update(message);
+      final byte[] sig = signer.sign();
+      batchSigOffsets[i] = sigs.size();
+      batchSigLengths[i] = sig.length;
+      sigs.write(sig, 0, sig.length);
+    }
+    batchSignatures = sigs.toByteArray();
+  }
+
+  protected int verifyBatchIndividually() throws Exception {
+    int valid = 0;
+    for (int i = 0; i < batchKeys.length; i++) {
+      verifier.update(message);
+      if (verifier.verify(batchSignatures, batchSigOffsets[i], batchSigLengths[i])) {
+        valid++;
+      }
+    }
+    return valid;
+  }
+
+  protected BitSet verifyBatch() {
+    return SignatureBatchUtils.verify(
+        sigAlg,
+        batchKeys,
+        message,
+        batchOffsets,
+        batchLengths,
+        batchSignatures,
+        batchSigOffsets,
+        batchSigLengths);
+  }
+}
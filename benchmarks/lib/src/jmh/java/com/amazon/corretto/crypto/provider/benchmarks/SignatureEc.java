@@ -3,14 +3,20 @@
 package com.amazon.corretto.crypto.provider.benchmarks;
 
 import java.security.spec.ECGenParameterSpec;
+import java.util.BitSet;
 
 import com.amazon.corretto.crypto.provider.AmazonCorrettoCryptoProvider;
 import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.Fork;
 import org.openjdk.jmh.annotations.Param;
 import org.openjdk.jmh.annotations.Scope;
 import org.openjdk.jmh.annotations.Setup;
 import org.openjdk.jmh.annotations.State;
 
+/**
+ * The nested {@link ContextTemplates} benchmark repeats this with {@code
+ * signatureContextTemplates} enabled, to measure the cost of per-operation context setup.
+ */
 @State(Scope.Benchmark)
 public class SignatureEc extends SignatureBase {
   @Param({"SHA1"})
@@ -33,8 +39,81 @@ public class SignatureEc extends SignatureBase {
     return super.sign();
   }
 
+  @Benchmark
+  public int signInto() throws Exception {
+    return super.signInto();
+  }
+
   @Benchmark
   public boolean verify() throws Exception {
     return super.verify();
   }
+
+  /**
+   * Verifies a batch of signatures, either one {@code Signature.verify} call at a time or with a
+   * single {@link com.amazon.corretto.crypto.utils.SignatureBatchUtils#verify} call. Scores are
+   * per batch.
+   */
+  @State(Scope.Benchmark)
+  public static class Batch extends SignatureBase {
+    @Param({"secp256r1", "secp384r1"})
+    public String curve;
+
+    @Param({"1", "16", "256", "1024"})
+    public int batchSize;
+
+    @Setup
+    public void setup() throws Exception {
+      super.setup(
+          AmazonCorrettoCryptoProvider.PROVIDER_NAME,
+          "EC",
+          new ECGenParameterSpec(curve),
+          "SHA256withECDSA",
+          null);
+      setupBatch(batchSize);
+    }
+
+    @Benchmark
+    public int verifyIndividually() throws Exception {
+      return verifyBatchIndividually();
+    }
+
+    @Benchmark
+    public BitSet verifyBatch() {
+      return super.verifyBatch();
+    }
+  }
+
+  /** Signatures in the IEEE P1363 (r||s) format used by JOSE and WebAuthn. */
+  @State(Scope.Benchmark)
+  public static class P1363 extends SignatureBase {
+    @Param({"secp256r1", "secp384r1", "secp521r1"})
+    public String curve;
+
+    @Param({AmazonCorrettoCryptoProvider.PROVIDER_NAME, "SunEC"})
+    public String provider;
+
+    @Setup
+    public void setup() throws Exception {
+      super.setup(
+          provider,
+          "EC",
+          new ECGenParameterSpec(curve),
+          "SHA256withECDSAinP1363Format",
+          null);
+    }
+
+    @Benchmark
+    public byte[] sign() throws Exception {
+      return super.sign();
+    }
+
+    @Benchmark
+    public boolean verify() throws Exception {
+      return super.verify();
+    }
+  }
+
+  @Fork(jvmArgsAppend = "-Dcom.amazon.corretto.crypto.provider.signatureContextTemplates=true")
+  public static class ContextTemplates extends SignatureEc {}
 }
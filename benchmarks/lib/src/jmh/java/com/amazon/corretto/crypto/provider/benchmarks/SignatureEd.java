@@ -2,6 +2,8 @@
 // SPDX-License-Identifier: Apache-2.0
 package com.amazon.corretto.crypto.provider.benchmarks;
 
+import java.util.BitSet;
+
 import com.amazon.corretto.crypto.provider.AmazonCorrettoCryptoProvider;
 import org.openjdk.jmh.annotations.Benchmark;
 import org.openjdk.jmh.annotations.Param;
@@ -26,8 +28,40 @@ public class SignatureEd extends SignatureBase {
         return super.sign();
     }
 
+    @Benchmark
+    public int signInto() throws Exception {
+        return super.signInto();
+    }
+
     @Benchmark
     public boolean verify() throws Exception {
         return super.verify();
     }
-}
\ No newline at end of file
+
+    /**
+     * Verifies a batch of signatures, either one {@code Signature.verify} call at a time or with a
+     * single {@link com.amazon.corretto.crypto.utils.SignatureBatchUtils#verify} call. Scores are
+     * per batch.
+     */
+    @State(Scope.Benchmark)
+    public static class Batch extends SignatureBase {
+        @Param({"1", "16", "256", "1024"})
+        public int batchSize;
+
+        @Setup
+        public void setup() throws Exception {
+            super.setup(AmazonCorrettoCryptoProvider.PROVIDER_NAME, "Ed25519", null, "Ed25519", null);
+            setupBatch(batchSize);
+        }
+
+        @Benchmark
+        public int verifyIndividually() throws Exception {
+            return verifyBatchIndividually();
+        }
+
+        @Benchmark
+        public BitSet verifyBatch() {
+            return super.verifyBatch();
+        }
+    }
+}
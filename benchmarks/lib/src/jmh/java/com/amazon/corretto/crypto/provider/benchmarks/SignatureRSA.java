@@ -35,8 +35,44 @@ public class SignatureRSA extends SignatureBase {
     return super.sign();
   }
 
+  @Benchmark
+  public int signInto() throws Exception {
+    return super.signInto();
+  }
+
   @Benchmark
   public boolean verify() throws Exception {
     return super.verify();
   }
+
+  /**
+   * Signatures computed on the {@link com.amazon.corretto.crypto.provider.AsyncSignatures} worker
+   * pool. Each benchmark thread waits for its own result, so run with several threads ({@code -t})
+   * to compare against {@link SignatureRSA#sign} at the same concurrency.
+   */
+  @State(Scope.Thread)
+  public static class Async extends SignatureBase {
+    @Param({"2048", "3072", "4096"})
+    public int bits;
+
+    @Setup
+    public void setup() throws Exception {
+      super.setup(
+          AmazonCorrettoCryptoProvider.PROVIDER_NAME,
+          "RSA",
+          new RSAKeyGenParameterSpec(bits, RSAKeyGenParameterSpec.F4),
+          "SHA256withRSA",
+          null);
+    }
+
+    @Benchmark
+    public byte[] sign() {
+      return signAsync();
+    }
+
+    @Benchmark
+    public boolean verify() {
+      return verifyAsync();
+    }
+  }
 }
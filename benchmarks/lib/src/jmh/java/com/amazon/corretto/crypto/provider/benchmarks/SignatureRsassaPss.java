@@ -7,11 +7,16 @@ import java.security.spec.RSAKeyGenParameterSpec;
 
 import com.amazon.corretto.crypto.provider.AmazonCorrettoCryptoProvider;
 import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.Fork;
 import org.openjdk.jmh.annotations.Param;
 import org.openjdk.jmh.annotations.Scope;
 import org.openjdk.jmh.annotations.Setup;
 import org.openjdk.jmh.annotations.State;
 
+/**
+ * The nested {@link ContextTemplates} benchmark repeats this with {@code
+ * signatureContextTemplates} enabled, to measure the cost of per-operation context setup.
+ */
 @State(Scope.Benchmark)
 public class SignatureRsassaPss extends SignatureBase {
   @Param({"SHA-1"})
@@ -46,4 +51,7 @@ public class SignatureRsassaPss extends SignatureBase {
   public boolean verify() throws Exception {
     return super.verify();
   }
+
+  @Fork(jvmArgsAppend = "-Dcom.amazon.corretto.crypto.provider.signatureContextTemplates=true")
+  public static class ContextTemplates extends SignatureRsassaPss {}
 }
@@ -0,0 +1,49 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider.benchmarks;
+
+import java.security.MessageDigest;
+
+import com.amazon.corretto.crypto.provider.AmazonCorrettoCryptoProvider;
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+
+/** Throughput of the parallel tree hashes on a large input, compared to the plain hashes. */
+@State(Scope.Benchmark)
+public class TreeHashes {
+  @Param({"SHA-256", "SHA-256-TREE", "SHA-512", "SHA-512-TREE"})
+  public String algorithm;
+
+  // Each parameter combination runs in its own forked JVM, so the property is read afresh by every
+  // trial.
+  @Param({"1", "4", "16"})
+  public int threads;
+
+  private byte[] data_64MiB;
+  private MessageDigest digest;
+
+  @Setup
+  public void setup() throws Exception {
+    System.setProperty(
+        "com.amazon.corretto.crypto.provider.treeHashThreads", Integer.toString(threads));
+    BenchmarkUtils.setupProvider(AmazonCorrettoCryptoProvider.PROVIDER_NAME);
+    data_64MiB = BenchmarkUtils.getRandBytes(64 * 1024 * 1024);
+    digest = MessageDigest.getInstance(algorithm, AmazonCorrettoCryptoProvider.PROVIDER_NAME);
+  }
+
+  @Benchmark
+  public byte[] oneShot_64MiB() {
+    return digest.digest(data_64MiB);
+  }
+
+  @Benchmark
+  public byte[] streaming_64MiB() {
+    for (int offset = 0; offset < data_64MiB.length; offset += 64 * 1024) {
+      digest.update(data_64MiB, offset, 64 * 1024);
+    }
+    return digest.digest();
+  }
+}
@@ -0,0 +1,220 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+#include "buffer.h"
+#include "env.h"
+#include "generated-headers.h"
+#include "util.h"
+#include <openssl/cipher.h>
+#include <openssl/cmac.h>
+
+#define AES_CMAC_LEN 16
+
+using namespace AmazonCorrettoCryptoProvider;
+
+/*
+ * AES-CMAC (NIST SP 800-38B, RFC 4493) on top of AWS-LC's CMAC_* API. A context is keyed once, which derives the
+ * K1/K2 subkeys, and CMAC_Reset then returns it to that keyed state at the start of every message, so reusing a Mac
+ * with the same key never repeats the subkey derivation.
+ */
+namespace {
+CMAC_CTX* cmac_from_ptr(jlong ctxPtr)
+{
+    if (unlikely(!ctxPtr)) {
+        throw java_ex(EX_NPE, "Null CMAC context");
+    }
+    return reinterpret_cast<CMAC_CTX*>(ctxPtr);
+}
+
+void reset(CMAC_CTX* ctx)
+{
+    if (unlikely(CMAC_Reset(ctx) != 1)) {
+        throw_openssl("Unable to reset CMAC_CTX");
+    }
+}
+
+void update(CMAC_CTX* ctx, jni_borrow& input)
+{
+    if (unlikely(CMAC_Update(ctx, input.data(), input.len()) != 1)) {
+        throw_openssl("Unable to update CMAC_CTX");
+    }
+}
+
+void calculate_mac(raii_env& env, CMAC_CTX* ctx, jbyteArray resultArray)
+{
+    uint8_t scratch[AES_CMAC_LEN];
+    size_t macSize = sizeof(scratch);
+    if (unlikely(CMAC_Final(ctx, scratch, &macSize) != 1 || macSize != AES_CMAC_LEN)) {
+        throw_openssl("Unable to finish CMAC_CTX");
+    }
+    java_buffer::from_array(env, resultArray).put_bytes(env, scratch, 0, macSize);
+}
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesCmacSpi
+ * Method:    newContext
+ * Signature: ([B)J
+ */
+JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_AesCmacSpi_newContext(
+    JNIEnv* pEnv, jclass, jbyteArray keyArray)
+{
+    try {
+        raii_env env(pEnv);
+
+        java_buffer keyBuf = java_buffer::from_array(env, keyArray);
+        const EVP_CIPHER* cipher;
+        switch (keyBuf.len()) {
+        case 16:
+            cipher = EVP_aes_128_cbc();
+            break;
+        case 24:
+            cipher = EVP_aes_192_cbc();
+            break;
+        case 32:
+            cipher = EVP_aes_256_cbc();
+            break;
+        default:
+            throw java_ex(EX_RUNTIME_CRYPTO, "Unsupported key length");
+        }
+
+        CMAC_CTX* ctx = CMAC_CTX_new();
+        if (unlikely(!ctx)) {
+            throw java_ex(EX_OOM, "Unable to allocate CMAC context");
+        }
+        int keyed;
+        {
+            jni_borrow key(env, keyBuf, "key");
+            keyed = CMAC_Init(ctx, key.data(), key.len(), cipher, nullptr /* ENGINE */);
+        }
+        if (unlikely(keyed != 1)) {
+            CMAC_CTX_free(ctx);
+            throw_openssl("Unable to initialize CMAC_CTX");
+        }
+        return reinterpret_cast<jlong>(ctx);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return 0;
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesCmacSpi
+ * Method:    freeContext
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_AesCmacSpi_freeContext(JNIEnv*, jclass, jlong ctxPtr)
+{
+    CMAC_CTX_free(reinterpret_cast<CMAC_CTX*>(ctxPtr));
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesCmacSpi
+ * Method:    cloneContext
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_AesCmacSpi_cloneContext(
+    JNIEnv* pEnv, jclass, jlong ctxPtr)
+{
+    try {
+        CMAC_CTX* original = cmac_from_ptr(ctxPtr);
+        CMAC_CTX* ctx = CMAC_CTX_new();
+        if (unlikely(!ctx)) {
+            throw java_ex(EX_OOM, "Unable to allocate CMAC context");
+        }
+        if (unlikely(CMAC_CTX_copy(ctx, original) != 1)) {
+            CMAC_CTX_free(ctx);
+            throw_openssl("Unable to copy CMAC_CTX");
+        }
+        return reinterpret_cast<jlong>(ctx);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return 0;
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesCmacSpi
+ * Method:    update
+ * Signature: (J[BIIZ)V
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_AesCmacSpi_update(
+    JNIEnv* pEnv, jclass, jlong ctxPtr, jbyteArray inputArray, jint offset, jint len, jboolean startMessage)
+{
+    try {
+        raii_env env(pEnv);
+
+        CMAC_CTX* ctx = cmac_from_ptr(ctxPtr);
+        if (startMessage) {
+            reset(ctx);
+        }
+        java_buffer inputBuf = java_buffer::from_array(env, inputArray, offset, len);
+        jni_borrow input(env, inputBuf, "input");
+        update(ctx, input);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesCmacSpi
+ * Method:    updateDirect
+ * Signature: (JLjava/nio/ByteBuffer;Z)V
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_AesCmacSpi_updateDirect(
+    JNIEnv* pEnv, jclass, jlong ctxPtr, jobject inputDirectBuf, jboolean startMessage)
+{
+    try {
+        raii_env env(pEnv);
+
+        CMAC_CTX* ctx = cmac_from_ptr(ctxPtr);
+        if (startMessage) {
+            reset(ctx);
+        }
+        java_buffer inputBuf = java_buffer::from_direct(env, inputDirectBuf);
+        jni_borrow input(env, inputBuf, "input");
+        update(ctx, input);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesCmacSpi
+ * Method:    doFinal
+ * Signature: (J[B)V
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_AesCmacSpi_doFinal(
+    JNIEnv* pEnv, jclass, jlong ctxPtr, jbyteArray resultArray)
+{
+    try {
+        raii_env env(pEnv);
+
+        calculate_mac(env, cmac_from_ptr(ctxPtr), resultArray);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesCmacSpi
+ * Method:    fastMac
+ * Signature: (J[BII[B)V
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_AesCmacSpi_fastMac(
+    JNIEnv* pEnv, jclass, jlong ctxPtr, jbyteArray inputArray, jint offset, jint len, jbyteArray resultArray)
+{
+    try {
+        raii_env env(pEnv);
+
+        CMAC_CTX* ctx = cmac_from_ptr(ctxPtr);
+        reset(ctx);
+        {
+            java_buffer inputBuf = java_buffer::from_array(env, inputArray, offset, len);
+            jni_borrow input(env, inputBuf, "input");
+            update(ctx, input);
+        }
+        calculate_mac(env, ctx, resultArray);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
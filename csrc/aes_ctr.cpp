@@ -0,0 +1,436 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+#include "buffer.h"
+#include "env.h"
+#include "generated-headers.h"
+#include "util.h"
+#include <openssl/crypto.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <pthread.h>
+#include <vector>
+
+#define AES_CTR_BLOCK_SIZE_IN_BYTES 16
+#define KEY_LEN_AES128              16
+#define KEY_LEN_AES192              24
+#define KEY_LEN_AES256              32
+// Java memory is borrowed for at most this many bytes per thread at a time, see AesCtrCipher::process.
+#define AES_CTR_WINDOW_PER_THREAD (4 * 1024 * 1024)
+
+namespace AmazonCorrettoCryptoProvider {
+
+// Processes one contiguous, block aligned slice of a parallel CTR operation. Workers never touch the JNIEnv.
+struct ctr_slice {
+    EVP_CIPHER_CTX* ctx;
+    uint8_t const* input;
+    uint8_t* output;
+    int len;
+    bool ok;
+};
+
+static void* ctr_slice_worker(void* arg)
+{
+    ctr_slice* slice = reinterpret_cast<ctr_slice*>(arg);
+    int outLen = 0;
+    slice->ok = EVP_CipherUpdate(slice->ctx, slice->output, &outLen, slice->input, slice->len) == 1
+        && outLen == slice->len;
+    if (!slice->ok) {
+        // The error queue is thread-local, so the calling thread reports a generic failure instead.
+        ERR_clear_error();
+    }
+    return nullptr;
+}
+
+class AesCtrCipher {
+    JNIEnv* jenv_;
+    EVP_CIPHER_CTX* ctx_;
+    bool own_ctx_;
+    uint8_t iv_[AES_CTR_BLOCK_SIZE_IN_BYTES];
+
+    static bool output_overlaps_input(uint8_t const* input, int input_len, uint8_t const* output)
+    {
+        // Exactly in-place operation is safe for CTR, even when split across threads.
+        if (input == output) {
+            return false;
+        }
+        return (output < input + input_len) && (input < output + input_len);
+    }
+
+    // Sets |counter| to the initial counter block plus |blocks|, as a 128-bit big-endian integer.
+    void counter_at(uint64_t blocks, uint8_t* counter) const
+    {
+        std::memcpy(counter, iv_, AES_CTR_BLOCK_SIZE_IN_BYTES);
+        for (int i = AES_CTR_BLOCK_SIZE_IN_BYTES - 1; i >= 0 && blocks != 0; i--) {
+            uint64_t sum = (uint64_t)counter[i] + (blocks & 0xff);
+            counter[i] = (uint8_t)sum;
+            blocks = (blocks >> 8) + (sum >> 8);
+        }
+    }
+
+    // Positions |ctx| so that its next output byte is the keystream byte at |position|.
+    void seek(EVP_CIPHER_CTX* ctx, uint64_t position) const
+    {
+        uint8_t counter[AES_CTR_BLOCK_SIZE_IN_BYTES];
+        counter_at(position / AES_CTR_BLOCK_SIZE_IN_BYTES, counter);
+        if (EVP_CipherInit_ex(ctx, nullptr, nullptr, nullptr, counter, -1) != 1) {
+            throw_openssl(EX_RUNTIME_CRYPTO, "EVP_CipherInit_ex failed.");
+        }
+        const int partial = (int)(position % AES_CTR_BLOCK_SIZE_IN_BYTES);
+        if (partial != 0) {
+            uint8_t scratch[AES_CTR_BLOCK_SIZE_IN_BYTES] = { 0 };
+            int ignored = 0;
+            if (EVP_CipherUpdate(ctx, scratch, &ignored, scratch, partial) != 1) {
+                throw_openssl(EX_RUNTIME_CRYPTO, "EVP_CipherUpdate failed.");
+            }
+            OPENSSL_cleanse(scratch, sizeof(scratch));
+        }
+    }
+
+    int serial_update(uint8_t const* input, int input_len, uint8_t* output)
+    {
+        int result = 0;
+        if (EVP_CipherUpdate(ctx_, output, &result, input, input_len) != 1) {
+            throw_openssl(EX_RUNTIME_CRYPTO, "EVP_CipherUpdate failed.");
+        }
+        return result;
+    }
+
+    // Splits the keystream for [position, position + input_len) into |threads| block aligned slices. The first slice
+    // is processed on the calling thread with the main context, the others by worker threads on copies of it. Since
+    // every slice seeks to its own counter value, the main context is finally positioned at the end of the input.
+    void parallel_update(uint64_t position, uint8_t const* input, int input_len, uint8_t* output, int threads)
+    {
+        // Bring the main context to a block boundary first so that every slice starts on a fresh counter block.
+        const int head = (int)((AES_CTR_BLOCK_SIZE_IN_BYTES - position % AES_CTR_BLOCK_SIZE_IN_BYTES)
+            % AES_CTR_BLOCK_SIZE_IN_BYTES);
+        serial_update(input, head, output);
+        position += head;
+        input += head;
+        output += head;
+        input_len -= head;
+
+        // Any trailing partial block goes to the last slice.
+        const int blocks = input_len / AES_CTR_BLOCK_SIZE_IN_BYTES;
+        const int slice_len = ((blocks + threads - 1) / threads) * AES_CTR_BLOCK_SIZE_IN_BYTES;
+        const int slice_count = (input_len - 1) / slice_len + 1;
+        std::vector<ctr_slice> slices(slice_count);
+        for (int i = 0; i < slice_count; i++) {
+            const int offset = i * slice_len;
+            slices[i].ctx = nullptr;
+            slices[i].input = input + offset;
+            slices[i].output = output + offset;
+            slices[i].len = (i == slice_count - 1) ? input_len - offset : slice_len;
+            slices[i].ok = false;
+        }
+
+        std::vector<pthread_t> workers(slices.size());
+        std::vector<bool> started(slices.size(), false);
+        struct slice_cleanup {
+            std::vector<ctr_slice>& slices;
+            std::vector<pthread_t>& workers;
+            std::vector<bool>& started;
+            ~slice_cleanup()
+            {
+                for (size_t i = 1; i < slices.size(); i++) {
+                    if (started[i]) {
+                        pthread_join(workers[i], nullptr);
+                    }
+                    EVP_CIPHER_CTX_free(slices[i].ctx);
+                }
+            }
+        } cleanup { slices, workers, started };
+
+        uint64_t slice_position = position;
+        for (size_t i = 0; i < slices.size(); i++) {
+            if (i != 0) {
+                slices[i].ctx = EVP_CIPHER_CTX_new();
+                if (slices[i].ctx == nullptr || EVP_CIPHER_CTX_copy(slices[i].ctx, ctx_) != 1) {
+                    throw_openssl(EX_RUNTIME_CRYPTO, "EVP_CIPHER_CTX_copy failed.");
+                }
+                seek(slices[i].ctx, slice_position);
+                // If we cannot get another thread, the slice is simply processed on this one below.
+                started[i] = pthread_create(&workers[i], nullptr, ctr_slice_worker, &slices[i]) == 0;
+            }
+            slice_position += slices[i].len;
+        }
+
+        slices[0].ctx = ctx_;
+        ctr_slice_worker(&slices[0]);
+        for (size_t i = 1; i < slices.size(); i++) {
+            if (started[i]) {
+                pthread_join(workers[i], nullptr);
+                started[i] = false;
+            } else {
+                ctr_slice_worker(&slices[i]);
+            }
+        }
+        for (size_t i = 0; i < slices.size(); i++) {
+            if (!slices[i].ok) {
+                throw java_ex(EX_RUNTIME_CRYPTO, "EVP_CipherUpdate failed.");
+            }
+        }
+
+        seek(ctx_, slice_position);
+    }
+
+public:
+    AesCtrCipher(JNIEnv* jenv, jlongArray ctx_container, jlong ctx_ptr, bool save_ctx)
+        : jenv_(jenv)
+        , ctx_(reinterpret_cast<EVP_CIPHER_CTX*>(ctx_ptr))
+        , own_ctx_(!save_ctx)
+    {
+        if (ctx_ != nullptr) {
+            // if there is a context, we don't need to do anything.
+            return;
+        }
+
+        // There is no context, so we need to create one.
+        ctx_ = EVP_CIPHER_CTX_new();
+        if (ctx_ == nullptr) {
+            throw_openssl(EX_RUNTIME_CRYPTO, "EVP_CIPHER_CTX_new failed.");
+        }
+
+        if (own_ctx_) {
+            // Since we should own the context, there is no need to return the context to the caller.
+            return;
+        }
+
+        // We need to return the context.
+        if (ctx_container == nullptr) {
+            // This should not happen, as init should always be called with a ctx container
+            EVP_CIPHER_CTX_free(ctx_);
+            throw java_ex(EX_ERROR, "THIS SHOULD NOT BE REACHABLE. No container is provided to return the context.");
+        }
+
+        jlong tmpPtr = reinterpret_cast<jlong>(ctx_);
+        jenv_->SetLongArrayRegion(ctx_container, 0, 1, &tmpPtr);
+    }
+
+    ~AesCtrCipher()
+    {
+        if (own_ctx_) {
+            EVP_CIPHER_CTX_free(ctx_);
+            ctx_ = nullptr;
+        }
+        OPENSSL_cleanse(iv_, sizeof(iv_));
+    }
+
+    // Records the initial counter block, which is needed to seek within the keystream.
+    void set_iv(jbyteArray iv)
+    {
+        JBinaryBlob j_iv(jenv_, nullptr, iv);
+        std::memcpy(iv_, j_iv.get(), AES_CTR_BLOCK_SIZE_IN_BYTES);
+    }
+
+    void init(jbyteArray key, int key_len)
+    {
+        EVP_CIPHER const* cipher;
+        switch (key_len) {
+        case KEY_LEN_AES128:
+            cipher = EVP_aes_128_ctr();
+            break;
+        case KEY_LEN_AES192:
+            cipher = EVP_aes_192_ctr();
+            break;
+        case KEY_LEN_AES256:
+            cipher = EVP_aes_256_ctr();
+            break;
+        default:
+            // This should not happen since we enforce this in the Java layer.
+            throw java_ex(EX_ERROR, "THIS SHOULD NOT BE REACHABLE. Invalid AES key size.");
+        }
+
+        JBinaryBlob j_key(jenv_, nullptr, key);
+        // Encryption and decryption are the same operation in CTR mode.
+        if (EVP_CipherInit_ex(ctx_, cipher, nullptr, j_key.get(), iv_, 1) != 1) {
+            throw_openssl(EX_RUNTIME_CRYPTO, "EVP_CipherInit_ex failed.");
+        }
+    }
+
+    // |position| is the number of bytes processed since init and must match the state of the context.
+    int update(uint64_t position, uint8_t const* input, int input_len, uint8_t* output, int threads)
+    {
+        if (threads > 1 && input_len / AES_CTR_BLOCK_SIZE_IN_BYTES > threads) {
+            if (output_overlaps_input(input, input_len, output)) {
+                SimpleBuffer temp(input_len);
+                parallel_update(position, input, input_len, temp.get_buffer(), threads);
+                std::memcpy(output, temp.get_buffer(), input_len);
+            } else {
+                parallel_update(position, input, input_len, output, threads);
+            }
+            return input_len;
+        }
+
+        if (output_overlaps_input(input, input_len, output)) {
+            SimpleBuffer temp(input_len);
+            int result = serial_update(input, input_len, temp.get_buffer());
+            std::memcpy(output, temp.get_buffer(), result);
+            return result;
+        }
+        return serial_update(input, input_len, output);
+    }
+
+    int do_final(uint8_t* output)
+    {
+        int result = 0;
+        if (EVP_CipherFinal_ex(ctx_, output, &result) != 1) {
+            throw_openssl(EX_RUNTIME_CRYPTO, "EVP_CipherFinal_ex failed.");
+        }
+        return result;
+    }
+
+    // Runs update, and do_final if |finish| is set, over the Java input and output. Arrays are pinned with critical
+    // sections which hold off the garbage collector, so rather than pinning a multi-gigabyte input for the whole
+    // parallel operation they are borrowed for one window of AES_CTR_WINDOW_PER_THREAD bytes per thread at a time.
+    // The caller must ensure that the output does not start after an overlapping input, as earlier windows would
+    // otherwise overwrite the input of later ones.
+    int process(uint64_t position,
+        jobject inputDirect,
+        jbyteArray inputArray,
+        int inputOffset,
+        int inputLen,
+        jobject outputDirect,
+        jbyteArray outputArray,
+        int outputOffset,
+        int threads,
+        bool finish)
+    {
+        const int window = (int)std::min<int64_t>(INT_MAX, (int64_t)threads * AES_CTR_WINDOW_PER_THREAD);
+        int result = 0;
+        int done = 0;
+        do {
+            const int len = std::min(inputLen - done, window);
+            JIOBlobs io_blobs(jenv_, inputDirect, inputArray, outputDirect, outputArray);
+            uint8_t* output = io_blobs.get_output() + outputOffset;
+            result += update(position + done, io_blobs.get_input() + inputOffset + done, len, output + result, threads);
+            done += len;
+            if (finish && done == inputLen) {
+                result += do_final(output + result);
+            }
+        } while (done < inputLen);
+        return result;
+    }
+};
+
+}
+
+using namespace AmazonCorrettoCryptoProvider;
+
+extern "C" JNIEXPORT jint JNICALL Java_com_amazon_corretto_crypto_provider_AesCtrSpi_nInitUpdateFinal(JNIEnv* env,
+    jclass,
+    jbyteArray key,
+    jint keyLen,
+    jbyteArray iv,
+    jint threads,
+    jobject inputDirect,
+    jbyteArray inputArray,
+    jint inputOffset,
+    jint inputLen,
+    jobject outputDirect,
+    jbyteArray outputArray,
+    jint outputOffset)
+{
+    try {
+        AesCtrCipher aes_ctr_cipher(env, nullptr, 0, false);
+        aes_ctr_cipher.set_iv(iv);
+        aes_ctr_cipher.init(key, keyLen);
+
+        // update and final
+        return aes_ctr_cipher.process(0, inputDirect, inputArray, inputOffset, inputLen, outputDirect, outputArray,
+            outputOffset, threads, true);
+
+    } catch (java_ex& ex) {
+        ex.throw_to_java(env);
+        return -1;
+    }
+}
+
+extern "C" JNIEXPORT jint JNICALL Java_com_amazon_corretto_crypto_provider_AesCtrSpi_nInitUpdate(JNIEnv* env,
+    jclass,
+    jbyteArray key,
+    jint keyLen,
+    jbyteArray iv,
+    jlongArray ctxContainer,
+    jint threads,
+    jobject inputDirect,
+    jbyteArray inputArray,
+    jint inputOffset,
+    jint inputLen,
+    jobject outputDirect,
+    jbyteArray outputArray,
+    jint outputOffset)
+{
+    try {
+        AesCtrCipher aes_ctr_cipher(env, ctxContainer, 0, true);
+        aes_ctr_cipher.set_iv(iv);
+        aes_ctr_cipher.init(key, keyLen);
+
+        // update
+        return aes_ctr_cipher.process(0, inputDirect, inputArray, inputOffset, inputLen, outputDirect, outputArray,
+            outputOffset, threads, false);
+
+    } catch (java_ex& ex) {
+        ex.throw_to_java(env);
+        return -1;
+    }
+}
+
+extern "C" JNIEXPORT jint JNICALL Java_com_amazon_corretto_crypto_provider_AesCtrSpi_nUpdate(JNIEnv* env,
+    jclass,
+    jlong ctxPtr,
+    jbyteArray iv,
+    jlong position,
+    jint threads,
+    jobject inputDirect,
+    jbyteArray inputArray,
+    jint inputOffset,
+    jint inputLen,
+    jobject outputDirect,
+    jbyteArray outputArray,
+    jint outputOffset)
+{
+    try {
+        AesCtrCipher aes_ctr_cipher(env, nullptr, ctxPtr, true);
+        aes_ctr_cipher.set_iv(iv);
+
+        // update
+        return aes_ctr_cipher.process(position, inputDirect, inputArray, inputOffset, inputLen, outputDirect,
+            outputArray, outputOffset, threads, false);
+
+    } catch (java_ex& ex) {
+        ex.throw_to_java(env);
+        return -1;
+    }
+}
+
+extern "C" JNIEXPORT jint JNICALL Java_com_amazon_corretto_crypto_provider_AesCtrSpi_nUpdateFinal(JNIEnv* env,
+    jclass,
+    jlong ctxPtr,
+    jbyteArray iv,
+    jlong position,
+    jint threads,
+    jobject inputDirect,
+    jbyteArray inputArray,
+    jint inputOffset,
+    jint inputLen,
+    jobject outputDirect,
+    jbyteArray outputArray,
+    jint outputOffset)
+{
+    try {
+        // The caller hands over ownership of the context, which is freed at the end of the operation.
+        AesCtrCipher aes_ctr_cipher(env, nullptr, ctxPtr, false);
+        aes_ctr_cipher.set_iv(iv);
+
+        // update and final
+        return aes_ctr_cipher.process(position, inputDirect, inputArray, inputOffset, inputLen, outputDirect,
+            outputArray, outputOffset, threads, true);
+
+    } catch (java_ex& ex) {
+        ex.throw_to_java(env);
+        return -1;
+    }
+}
@@ -1,15 +1,22 @@
 // Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
 // SPDX-License-Identifier: Apache-2.0
+#include "aes_gcm_key_cache.h"
 #include "buffer.h"
 #include "env.h"
 #include "generated-headers.h"
 #include "keyutils.h"
 #include "util.h"
+#include <openssl/aead.h>
+#include <openssl/cipher.h>
 #include <openssl/err.h>
 #include <openssl/evp.h>
+#include <openssl/rand.h>
 #include <algorithm> // for std::min
+#include <atomic>
 #include <cassert>
 #include <cstdio>
+#include <cstring>
+#include <memory>
 
 #define NATIVE_MODE_ENCRYPT 1
 #define NATIVE_MODE_DECRYPT 0
@@ -179,6 +186,36 @@ static int cryptFinish(raii_env& env, int opMode, java_buffer resultBuf, unsigne
     return outl;
 }
 
+static int oneShotEncryptImpl(raii_env& env,
+    jlong ctxPtr,
+    jboolean sameKey,
+    jlongArray ctxOut,
+    java_buffer input,
+    java_buffer result,
+    jint tagLen,
+    jbyteArray keyArray,
+    jbyteArray ivArray)
+{
+    raii_cipher_ctx ctx;
+
+    initializeContext(env, ctxPtr, ctx, sameKey, keyArray, ivArray, NATIVE_MODE_ENCRYPT);
+
+    int outoffset = updateLoop(env, result, input, ctx);
+    if (outoffset < 0)
+        return 0;
+
+    result = result.subrange(outoffset);
+    int finalOffset = cryptFinish(env, NATIVE_MODE_ENCRYPT, result, tagLen, ctx);
+
+    if (!ctxPtr && ctxOut) {
+        // Context is new, but caller does want it back
+        jlong tmpPtr = reinterpret_cast<jlong>(ctx.take());
+        env->SetLongArrayRegion(ctxOut, 0 /* start position */, 1 /* number of elements */, &tmpPtr);
+    }
+
+    return finalOffset + outoffset;
+}
+
 JNIEXPORT int JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmSpi_oneShotEncrypt(JNIEnv* pEnv,
     jclass,
     jlong ctxPtr,
@@ -195,27 +232,38 @@ JNIEXPORT int JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmSpi_oneShot
 {
     try {
         raii_env env(pEnv);
-        raii_cipher_ctx ctx;
-
-        initializeContext(env, ctxPtr, ctx, sameKey, keyArray, ivArray, NATIVE_MODE_ENCRYPT);
 
         java_buffer input = java_buffer::from_array(env, inputArray, inoffset, inlen);
         java_buffer result = java_buffer::from_array(env, resultArray, resultOffset);
 
-        int outoffset = updateLoop(env, result, input, ctx);
-        if (outoffset < 0)
-            return 0;
+        return oneShotEncryptImpl(env, ctxPtr, sameKey, ctxOut, input, result, tagLen, keyArray, ivArray);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return -1;
+    }
+}
 
-        result = result.subrange(outoffset);
-        int finalOffset = cryptFinish(env, NATIVE_MODE_ENCRYPT, result, tagLen, ctx);
+JNIEXPORT int JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmSpi_oneShotEncryptDirect(JNIEnv* pEnv,
+    jclass,
+    jlong ctxPtr,
+    jboolean sameKey,
+    jlongArray ctxOut,
+    jobject inputBuffer,
+    jint inoffset,
+    jint inlen,
+    jobject resultBuffer,
+    jint resultOffset,
+    jint tagLen,
+    jbyteArray keyArray,
+    jbyteArray ivArray)
+{
+    try {
+        raii_env env(pEnv);
 
-        if (!ctxPtr && ctxOut) {
-            // Context is new, but caller does want it back
-            jlong tmpPtr = reinterpret_cast<jlong>(ctx.take());
-            env->SetLongArrayRegion(ctxOut, 0 /* start position */, 1 /* number of elements */, &tmpPtr);
-        }
+        java_buffer input = java_buffer::from_direct(env, inputBuffer).subrange(inoffset, inlen);
+        java_buffer result = java_buffer::from_direct(env, resultBuffer).subrange(resultOffset);
 
-        return finalOffset + outoffset;
+        return oneShotEncryptImpl(env, ctxPtr, sameKey, ctxOut, input, result, tagLen, keyArray, ivArray);
     } catch (java_ex& ex) {
         ex.throw_to_java(pEnv);
         return -1;
@@ -264,6 +312,29 @@ JNIEXPORT jint JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmSpi_encryp
     }
 }
 
+JNIEXPORT jint JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmSpi_encryptUpdateDirect(JNIEnv* pEnv,
+    jclass,
+    jlong ctxPtr,
+    jobject inputBuffer,
+    jint inoffset,
+    jint inlen,
+    jobject resultBuffer,
+    jint resultOffset)
+{
+    try {
+        raii_env env(pEnv);
+
+        java_buffer input = java_buffer::from_direct(env, inputBuffer).subrange(inoffset, inlen);
+        java_buffer result = java_buffer::from_direct(env, resultBuffer).subrange(resultOffset);
+
+        EVP_CIPHER_CTX* ctx = (EVP_CIPHER_CTX*)ctxPtr;
+        return updateLoop(env, result, input, ctx);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return -1;
+    }
+}
+
 namespace {
 void updateAAD_loop(raii_env& env, EVP_CIPHER_CTX* ctx, java_buffer aadData)
 {
@@ -294,6 +365,32 @@ JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmSpi_encryp
     }
 }
 
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmSpi_encryptUpdateAADDirect(
+    JNIEnv* pEnv, jclass, jlong ctxPtr, jobject input, jint offset, jint length)
+{
+    try {
+        raii_env env(pEnv);
+        if (!ctxPtr)
+            throw java_ex(EX_NPE, "Null context");
+
+        EVP_CIPHER_CTX* ctx = (EVP_CIPHER_CTX*)ctxPtr;
+        java_buffer aadBuf = java_buffer::from_direct(env, input).subrange(offset, length);
+
+        updateAAD_loop(env, ctx, aadBuf);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
+
+static int encryptDoFinalImpl(raii_env& env, raii_cipher_ctx& ctx, java_buffer input, java_buffer result, jint tagLen)
+{
+    int outoffset = updateLoop(env, result, input, ctx);
+    result = result.subrange(outoffset);
+    int finalOffset = cryptFinish(env, NATIVE_MODE_ENCRYPT, result, tagLen, ctx);
+
+    return outoffset + finalOffset;
+}
+
 JNIEXPORT jint JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmSpi_encryptDoFinal(JNIEnv* pEnv,
     jclass,
     jlong ctxPtr,
@@ -323,11 +420,47 @@ JNIEXPORT jint JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmSpi_encryp
         java_buffer input = java_buffer::from_array(env, inputArray, inoffset, inlength);
         java_buffer result = java_buffer::from_array(env, resultArray, resultOffset);
 
-        int outoffset = updateLoop(env, result, input, ctx);
-        result = result.subrange(outoffset);
-        int finalOffset = cryptFinish(env, NATIVE_MODE_ENCRYPT, result, tagLen, ctx);
+        rv = encryptDoFinalImpl(env, ctx, input, result, tagLen);
+    } catch (java_ex& ex) {
+        EVP_CIPHER_CTX_free(ctx.take());
+
+        ex.throw_to_java(pEnv);
+        return -1;
+    }
+
+    return rv;
+}
+
+JNIEXPORT jint JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmSpi_encryptDoFinalDirect(JNIEnv* pEnv,
+    jclass,
+    jlong ctxPtr,
+    jboolean releaseContext,
+    jobject inputBuffer,
+    jint inoffset,
+    jint inlength,
+    jobject resultBuffer,
+    jint resultOffset,
+    jint tagLen)
+{
+    raii_cipher_ctx ctx;
+    if (releaseContext) {
+        ctx.move((EVP_CIPHER_CTX*)ctxPtr);
+    } else {
+        ctx.borrow((EVP_CIPHER_CTX*)ctxPtr);
+    }
+
+    int rv = -1;
+    try {
+        if (!ctx) {
+            throw java_ex(EX_NPE, "Null context passed");
+        }
+
+        raii_env env(pEnv);
 
-        rv = outoffset + finalOffset;
+        java_buffer input = java_buffer::from_direct(env, inputBuffer).subrange(inoffset, inlength);
+        java_buffer result = java_buffer::from_direct(env, resultBuffer).subrange(resultOffset);
+
+        rv = encryptDoFinalImpl(env, ctx, input, result, tagLen);
     } catch (java_ex& ex) {
         EVP_CIPHER_CTX_free(ctx.take());
 
@@ -338,6 +471,55 @@ JNIEXPORT jint JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmSpi_encryp
     return rv;
 }
 
+static int oneShotDecryptImpl(raii_env& env,
+    jlong ctxPtr,
+    jboolean sameKey,
+    jlongArray ctxOut,
+    java_buffer input,
+    java_buffer result,
+    jint tagLen,
+    jbyteArray keyArray,
+    jbyteArray ivArray,
+    jbyteArray aadBuffer,
+    jint aadSize)
+{
+    raii_cipher_ctx ctx;
+
+    initializeContext(env, ctxPtr, ctx, sameKey, keyArray, ivArray, NATIVE_MODE_DECRYPT);
+
+    // Decrypt mode: Set the tag before we decrypt
+    if (unlikely(tagLen > 16 || tagLen < 0)) {
+        throw java_ex(EX_ILLEGAL_ARGUMENT, "Bad tag length");
+    }
+
+    if (unlikely(input.len() < (size_t)tagLen)) {
+        throw java_ex(EX_BADTAG, "Input too short - need tag");
+    }
+
+    SecureBuffer<uint8_t, 16> tag;
+    input.get_bytes(env, tag.buf, input.len() - tagLen, tagLen);
+
+    if (!EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, tagLen, tag.buf)) {
+        throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "Failed to set GCM tag");
+    }
+    input = input.subrange(0, input.len() - tagLen);
+
+    if (aadSize != 0) {
+        updateAAD_loop(env, ctx, java_buffer::from_array(env, aadBuffer, 0, aadSize));
+    }
+
+    int outoffset = updateLoop(env, result, input, ctx);
+    outoffset += cryptFinish(env, NATIVE_MODE_DECRYPT, result.subrange(outoffset), tagLen, ctx);
+
+    if (!ctxPtr && ctxOut) {
+        // Context is new, but caller does want it back
+        jlong tmpPtr = reinterpret_cast<jlong>(ctx.take());
+        env->SetLongArrayRegion(ctxOut, 0, 1, &tmpPtr);
+    }
+
+    return outoffset;
+}
+
 JNIEXPORT jint JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmSpi_oneShotDecrypt(JNIEnv* pEnv,
     jclass,
     jlong ctxPtr,
@@ -356,44 +538,926 @@ JNIEXPORT jint JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmSpi_oneSho
 {
     try {
         raii_env env(pEnv);
-        raii_cipher_ctx ctx;
 
-        initializeContext(env, ctxPtr, ctx, sameKey, keyArray, ivArray, NATIVE_MODE_DECRYPT);
+        java_buffer input = java_buffer::from_array(env, inputArray, inoffset, inlen);
+        java_buffer result = java_buffer::from_array(env, resultArray, resultOffset);
+
+        return oneShotDecryptImpl(
+            env, ctxPtr, sameKey, ctxOut, input, result, tagLen, keyArray, ivArray, aadBuffer, aadSize);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return -1;
+    }
+}
+
+JNIEXPORT jint JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmSpi_oneShotDecryptDirect(JNIEnv* pEnv,
+    jclass,
+    jlong ctxPtr,
+    jboolean sameKey,
+    jlongArray ctxOut,
+    jobject inputBuffer,
+    jint inoffset,
+    jint inlen,
+    jobject resultBuffer,
+    jint resultOffset,
+    jint tagLen,
+    jbyteArray keyArray,
+    jbyteArray ivArray,
+    jbyteArray aadBuffer,
+    jint aadSize)
+{
+    try {
+        raii_env env(pEnv);
+
+        java_buffer input = java_buffer::from_direct(env, inputBuffer).subrange(inoffset, inlen);
+        java_buffer result = java_buffer::from_direct(env, resultBuffer).subrange(resultOffset);
+        if (unlikely(result.len() + std::max(tagLen, 0) < input.len())) {
+            throw java_ex(EX_SHORTBUF, "Output buffer too small");
+        }
+
+        // The result buffer can be read by other threads while we decrypt, so the plaintext is only produced in
+        // native memory and copied out once the tag has been verified.
+        std::vector<uint8_t, SecureAlloc<uint8_t> > plaintext(input.len() + 1);
+        int outl = oneShotDecryptImpl(env,
+            ctxPtr,
+            sameKey,
+            ctxOut,
+            input,
+            java_buffer::from_native(&plaintext[0], plaintext.size()),
+            tagLen,
+            keyArray,
+            ivArray,
+            aadBuffer,
+            aadSize);
+        result.put_bytes(env, &plaintext[0], 0, outl);
+        return outl;
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return -1;
+    }
+}
+
+static const EVP_AEAD* gcmAeadForKeyLength(size_t keyLen)
+{
+    switch (keyLen) {
+    case KEY_LEN_AES128:
+        return EVP_aead_aes_128_gcm();
+    case KEY_LEN_AES192:
+        return EVP_aead_aes_192_gcm();
+    case KEY_LEN_AES256:
+        return EVP_aead_aes_256_gcm();
+    default:
+        throw java_ex(EX_RUNTIME_CRYPTO, "Unsupported key length");
+    }
+}
+
+static EVP_AEAD_CTX* aeadFromPtr(jlong ctxPtr)
+{
+    if (unlikely(!ctxPtr)) {
+        throw java_ex(EX_NPE, "Null AEAD context");
+    }
+    return reinterpret_cast<EVP_AEAD_CTX*>(ctxPtr);
+}
+
+/*
+ * The functions below implement the one-shot fast path for the common case of a 12-byte IV and a 16-byte tag. An
+ * EVP_AEAD_CTX holds the expanded key, so each message only costs a single seal or open call instead of the
+ * EVP_CIPHER sequence of init, IV length ctrl, update, final and tag ctrl.
+ */
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesGcmSpi
+ * Method:    aeadNewContext
+ * Signature: ([B)J
+ */
+JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmSpi_aeadNewContext(
+    JNIEnv* pEnv, jclass, jbyteArray keyArray)
+{
+    try {
+        raii_env env(pEnv);
+
+        java_buffer key = java_buffer::from_array(env, keyArray);
+        const EVP_AEAD* aead = gcmAeadForKeyLength(key.len());
+        SecureBuffer<uint8_t, KEY_LEN_AES256> keybuf;
+        key.get_bytes(env, keybuf.buf, 0, key.len());
+
+        EVP_AEAD_CTX* ctx = EVP_AEAD_CTX_new(aead, keybuf.buf, key.len(), EVP_AEAD_DEFAULT_TAG_LENGTH);
+        if (unlikely(!ctx)) {
+            throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "Failed to create AEAD context");
+        }
+        return reinterpret_cast<jlong>(ctx);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return 0;
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesGcmSpi
+ * Method:    aeadSeal
+ * Signature: (J[BII[BI[B)I
+ */
+JNIEXPORT jint JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmSpi_aeadSeal(JNIEnv* pEnv,
+    jclass,
+    jlong ctxPtr,
+    jbyteArray inputArray,
+    jint inoffset,
+    jint inlen,
+    jbyteArray resultArray,
+    jint resultOffset,
+    jbyteArray ivArray)
+{
+    try {
+        raii_env env(pEnv);
 
+        EVP_AEAD_CTX* ctx = aeadFromPtr(ctxPtr);
         java_buffer input = java_buffer::from_array(env, inputArray, inoffset, inlen);
         java_buffer result = java_buffer::from_array(env, resultArray, resultOffset);
+        java_buffer iv = java_buffer::from_array(env, ivArray);
+
+        if (unlikely(result.len() < input.len() + EVP_AEAD_DEFAULT_TAG_LENGTH)) {
+            throw java_ex(EX_SHORTBUF, "No space for GCM tag");
+        }
+        result = result.subrange(0, input.len() + EVP_AEAD_DEFAULT_TAG_LENGTH);
 
-        // Decrypt mode: Set the tag before we decrypt
-        if (unlikely(tagLen > 16 || tagLen < 0)) {
-            throw java_ex(EX_ILLEGAL_ARGUMENT, "Bad tag length");
+        jni_borrow ivBorrow(env, iv, "iv");
+        jni_borrow inBorrow(env, input, "input");
+        jni_borrow outBorrow(env, result, "result");
+
+        size_t outl = 0;
+        if (unlikely(!EVP_AEAD_CTX_seal(ctx,
+                outBorrow.data(),
+                &outl,
+                outBorrow.len(),
+                ivBorrow.data(),
+                ivBorrow.len(),
+                inBorrow.data(),
+                inBorrow.len(),
+                NULL,
+                0))) {
+            throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "AEAD seal failed");
         }
 
-        if (unlikely(inlen < tagLen)) {
+        return (jint)outl;
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return -1;
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesGcmSpi
+ * Method:    aeadOpen
+ * Signature: (J[BII[BI[B[BI)I
+ */
+JNIEXPORT jint JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmSpi_aeadOpen(JNIEnv* pEnv,
+    jclass,
+    jlong ctxPtr,
+    jbyteArray inputArray,
+    jint inoffset,
+    jint inlen,
+    jbyteArray resultArray,
+    jint resultOffset,
+    jbyteArray ivArray,
+    jbyteArray aadBuffer,
+    jint aadSize)
+{
+    try {
+        raii_env env(pEnv);
+
+        EVP_AEAD_CTX* ctx = aeadFromPtr(ctxPtr);
+        java_buffer input = java_buffer::from_array(env, inputArray, inoffset, inlen);
+        java_buffer result = java_buffer::from_array(env, resultArray, resultOffset);
+        java_buffer iv = java_buffer::from_array(env, ivArray);
+        java_buffer aad = java_buffer::from_array(env, aadBuffer, 0, aadSize);
+
+        if (unlikely(input.len() < EVP_AEAD_DEFAULT_TAG_LENGTH)) {
             throw java_ex(EX_BADTAG, "Input too short - need tag");
         }
+        const size_t plaintextLen = input.len() - EVP_AEAD_DEFAULT_TAG_LENGTH;
+        if (unlikely(result.len() < plaintextLen)) {
+            throw java_ex(EX_SHORTBUF, "Output buffer too small");
+        }
+        // Limit the output to the plaintext so that zeroizing on failure cannot touch anything else.
+        result = result.subrange(0, plaintextLen);
 
-        SecureBuffer<uint8_t, 16> tag;
-        input.get_bytes(env, tag.buf, input.len() - tagLen, tagLen);
+        jni_borrow ivBorrow(env, iv, "iv");
+        jni_borrow aadBorrow(env, aad, "aad");
+        jni_borrow inBorrow(env, input, "input");
+        jni_borrow outBorrow(env, result, "result");
+
+        size_t outl = 0;
+        if (unlikely(!EVP_AEAD_CTX_open(ctx,
+                outBorrow.data(),
+                &outl,
+                outBorrow.len(),
+                ivBorrow.data(),
+                ivBorrow.len(),
+                inBorrow.data(),
+                inBorrow.len(),
+                aadBorrow.data(),
+                aadBorrow.len()))) {
+            // The plaintext may already have been written before the tag was checked; never release it.
+            outBorrow.zeroize();
+            unsigned long errCode = drainOpensslErrors();
+            if (likely(errCode == 0
+                    || (ERR_GET_LIB(errCode) == ERR_LIB_CIPHER && ERR_GET_REASON(errCode) == CIPHER_R_BAD_DECRYPT))) {
+                throw java_ex(EX_BADTAG, "Tag mismatch!");
+            }
+            throw java_ex(EX_RUNTIME_CRYPTO, formatOpensslError(errCode, "AEAD open failed"));
+        }
+
+        return (jint)outl;
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return -1;
+    }
+}
+
+/*
+ * Deterministic IV construction of NIST SP 800-38D section 8.2.1, see gcm_iv_generator. Generators are shared by all
+ * Ciphers using the same key and live in the key cache.
+ */
+static gcm_iv_generator* ivGeneratorFromPtr(jlong genPtr)
+{
+    if (unlikely(!genPtr)) {
+        throw java_ex(EX_NPE, "Null IV generator");
+    }
+    return reinterpret_cast<gcm_iv_generator*>(genPtr);
+}
+
+/**
+ * Reserves the next counter value and writes the resulting IV. Once all 2^32 values have been used the generator
+ * refuses to produce further IVs; a wrapped counter would repeat IVs under the same key.
+ */
+static void nextDeterministicIv(gcm_iv_generator* gen, uint8_t iv[GCM_IV_LEN])
+{
+    uint64_t counter = gen->next.load(std::memory_order_relaxed);
+    do {
+        if (unlikely(counter > UINT32_MAX)) {
+            throw java_ex(EX_ILLEGAL_STATE, "GCM invocation counter exhausted; a new key is required");
+        }
+    } while (!gen->next.compare_exchange_weak(counter, counter + 1, std::memory_order_relaxed));
+
+    memcpy(iv, gen->prefix, sizeof(gen->prefix));
+    for (int i = 0; i < GCM_IV_COUNTER_LEN; i++) {
+        iv[sizeof(gen->prefix) + i] = (uint8_t)(counter >> (8 * (GCM_IV_COUNTER_LEN - 1 - i)));
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesGcmSpi
+ * Method:    ivGeneratorAcquire
+ * Signature: ([BI)J
+ */
+JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmSpi_ivGeneratorAcquire(
+    JNIEnv* pEnv, jclass, jbyteArray keyArray, jint fixedField)
+{
+    try {
+        raii_env env(pEnv);
+
+        java_buffer keyBuf = java_buffer::from_array(env, keyArray);
+        if (unlikely(keyBuf.len() > MAX_KEY_SIZE)) {
+            throw java_ex(EX_RUNTIME_CRYPTO, "Unsupported key length");
+        }
+        SecureBuffer<uint8_t, MAX_KEY_SIZE> key;
+        keyBuf.get_bytes(env, key.buf, 0, keyBuf.len());
+        return reinterpret_cast<jlong>(acquire_iv_generator(key.buf, keyBuf.len(), (uint32_t)fixedField));
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return 0;
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesGcmSpi
+ * Method:    ivGeneratorNew
+ * Signature: (II)J
+ */
+JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmSpi_ivGeneratorNew(
+    JNIEnv* pEnv, jclass, jint fixedField, jint firstInvocation)
+{
+    try {
+        return reinterpret_cast<jlong>(new_iv_generator((uint32_t)fixedField, (uint32_t)firstInvocation));
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return 0;
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesGcmSpi
+ * Method:    ivGeneratorRelease
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmSpi_ivGeneratorRelease(
+    JNIEnv*, jclass, jlong genPtr)
+{
+    release_iv_generator(reinterpret_cast<gcm_iv_generator*>(genPtr));
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesGcmSpi
+ * Method:    ivGeneratorNext
+ * Signature: (J[B)V
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmSpi_ivGeneratorNext(
+    JNIEnv* pEnv, jclass, jlong genPtr, jbyteArray ivArray)
+{
+    try {
+        raii_env env(pEnv);
+
+        java_buffer iv = java_buffer::from_array(env, ivArray);
+        if (unlikely(iv.len() != GCM_IV_LEN)) {
+            throw java_ex(EX_ILLEGAL_ARGUMENT, "Deterministic IVs are 12 bytes long");
+        }
+        uint8_t next[GCM_IV_LEN];
+        nextDeterministicIv(ivGeneratorFromPtr(genPtr), next);
+        iv.put_bytes(env, next, 0, sizeof(next));
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesGcmSpi
+ * Method:    aeadSealWithGeneratedIv
+ * Signature: (JJ[BII[BI[B)I
+ *
+ * Like aeadSeal, but first takes the next IV from the generator and writes it to ivArray, so that a deterministic-IV
+ * encryption costs a single native call.
+ */
+JNIEXPORT jint JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmSpi_aeadSealWithGeneratedIv(JNIEnv* pEnv,
+    jclass,
+    jlong ctxPtr,
+    jlong genPtr,
+    jbyteArray inputArray,
+    jint inoffset,
+    jint inlen,
+    jbyteArray resultArray,
+    jint resultOffset,
+    jbyteArray ivArray)
+{
+    try {
+        raii_env env(pEnv);
+
+        EVP_AEAD_CTX* ctx = aeadFromPtr(ctxPtr);
+        gcm_iv_generator* gen = ivGeneratorFromPtr(genPtr);
+        java_buffer input = java_buffer::from_array(env, inputArray, inoffset, inlen);
+        java_buffer result = java_buffer::from_array(env, resultArray, resultOffset);
+        java_buffer ivOut = java_buffer::from_array(env, ivArray);
+
+        if (unlikely(ivOut.len() != GCM_IV_LEN)) {
+            throw java_ex(EX_ILLEGAL_ARGUMENT, "Deterministic IVs are 12 bytes long");
+        }
+        if (unlikely(result.len() < input.len() + EVP_AEAD_DEFAULT_TAG_LENGTH)) {
+            throw java_ex(EX_SHORTBUF, "No space for GCM tag");
+        }
+        result = result.subrange(0, input.len() + EVP_AEAD_DEFAULT_TAG_LENGTH);
+
+        uint8_t iv[GCM_IV_LEN];
+        nextDeterministicIv(gen, iv);
+        // Publish the IV before sealing. Should sealing fail, the IV is simply skipped, never reused.
+        ivOut.put_bytes(env, iv, 0, sizeof(iv));
+
+        jni_borrow inBorrow(env, input, "input");
+        jni_borrow outBorrow(env, result, "result");
+
+        size_t outl = 0;
+        if (unlikely(!EVP_AEAD_CTX_seal(ctx,
+                outBorrow.data(),
+                &outl,
+                outBorrow.len(),
+                iv,
+                sizeof(iv),
+                inBorrow.data(),
+                inBorrow.len(),
+                NULL,
+                0))) {
+            throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "AEAD seal failed");
+        }
+
+        return (jint)outl;
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return -1;
+    }
+}
+
+/**
+ * Seals or opens a batch of independent records which all share a single key. The key schedule is computed once and
+ * only the IV is changed between records, so each record costs one EVP_CipherInit_ex for the IV rather than a full
+ * context setup and JNI transition.
+ *
+ * Record i is read from input[offsets[i], offsets[i] + lengths[i]) and its result is appended to output immediately
+ * after the result of record i - 1. When decrypting, records failing tag verification have their output zeroed and
+ * statusArray[i] set to non-zero; no exception is thrown for them.
+ *
+ * Returns the total number of bytes written to output.
+ */
+static int gcmBatch(raii_env& env,
+    int opMode,
+    jbyteArray keyArray,
+    jint tagLen,
+    jobjectArray ivs,
+    jobjectArray aads,
+    jbyteArray inputArray,
+    jintArray offsetsArray,
+    jintArray lengthsArray,
+    jbyteArray outputArray,
+    jbyteArray statusArray)
+{
+    if (unlikely(tagLen > 16 || tagLen < 0)) {
+        throw java_ex(EX_ILLEGAL_ARGUMENT, "Bad tag length");
+    }
+
+    const jsize count = env->GetArrayLength(ivs);
+    if (unlikely(env->GetArrayLength(offsetsArray) != count || env->GetArrayLength(lengthsArray) != count
+            || (aads && env->GetArrayLength(aads) != count)
+            || (statusArray && env->GetArrayLength(statusArray) != count))) {
+        throw java_ex(EX_ILLEGAL_ARGUMENT, "Mismatched batch lengths");
+    }
+
+    std::vector<jint> offsets(count);
+    std::vector<jint> lengths(count);
+    std::vector<jbyte> status(count);
+    env->GetIntArrayRegion(offsetsArray, 0, count, offsets.data());
+    env->GetIntArrayRegion(lengthsArray, 0, count, lengths.data());
+    env.rethrow_java_exception();
+
+    raii_cipher_ctx ctx;
+    ctx.init();
+    EVP_CIPHER_CTX_init(ctx);
+
+    java_buffer output = java_buffer::from_array(env, outputArray);
+    size_t outPos = 0;
+
+    for (jsize i = 0; i < count; i++) {
+        jbyteArray ivArray = (jbyteArray)env->GetObjectArrayElement(ivs, i);
+        {
+            java_buffer iv = java_buffer::from_array(env, ivArray);
+            if (i == 0) {
+                java_buffer key = java_buffer::from_array(env, keyArray);
+                initContext(env, ctx, opMode, key, iv);
+            } else {
+                if (unlikely(!EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, iv.len(), NULL))) {
+                    throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "Setting IV length failed");
+                }
+                jni_borrow ivBorrow(env, iv, "iv");
+                if (unlikely(!EVP_CipherInit_ex(ctx, NULL, NULL, NULL, ivBorrow.data(), opMode))) {
+                    throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "Failed to set IV");
+                }
+            }
+        }
+        // Batches may contain thousands of records; don't let local references pile up.
+        env->DeleteLocalRef(ivArray);
+
+        java_buffer input = java_buffer::from_array(env, inputArray, offsets[i], lengths[i]);
+        bool tagFailure = false;
+
+        if (opMode == NATIVE_MODE_DECRYPT) {
+            if (input.len() < (size_t)tagLen) {
+                // Too short to even hold a tag, so it cannot possibly verify.
+                tagFailure = true;
+                input = input.subrange(0, 0);
+            } else {
+                SecureBuffer<uint8_t, 16> tag;
+                input.get_bytes(env, tag.buf, input.len() - tagLen, tagLen);
+                if (!EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, tagLen, tag.buf)) {
+                    throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "Failed to set GCM tag");
+                }
+                input = input.subrange(0, input.len() - tagLen);
+            }
+        }
+
+        if (aads) {
+            jbyteArray aadArray = (jbyteArray)env->GetObjectArrayElement(aads, i);
+            if (aadArray) {
+                updateAAD_loop(env, ctx, java_buffer::from_array(env, aadArray));
+                env->DeleteLocalRef(aadArray);
+            }
+        }
+
+        const size_t recordOutLen = input.len() + (opMode == NATIVE_MODE_ENCRYPT ? tagLen : 0);
+        java_buffer result = output.subrange(outPos, recordOutLen);
+
+        if (tagFailure) {
+            status[i] = 1;
+        } else {
+            int outl = updateLoop(env, result, input, ctx);
+
+            if (opMode == NATIVE_MODE_ENCRYPT) {
+                outl += cryptFinish(env, NATIVE_MODE_ENCRYPT, result.subrange(outl), tagLen, ctx);
+            } else {
+                jni_borrow finalBorrow(env, result.subrange(outl), "result");
+                int finalOutl = 0;
+                if (unlikely(!EVP_CipherFinal_ex(ctx, finalBorrow, &finalOutl))) {
+                    unsigned long errCode = drainOpensslErrors();
+                    if (unlikely(errCode != 0)) {
+                        throw java_ex(EX_RUNTIME_CRYPTO, formatOpensslError(errCode, "CipherFinal failed"));
+                    }
+                    status[i] = 1;
+                }
+                outl += finalOutl;
+            }
+
+            if (unlikely((size_t)outl != recordOutLen)) {
+                throw java_ex(EX_RUNTIME_CRYPTO, "Unexpected GCM output length");
+            }
+        }
+
+        if (status[i]) {
+            // Never release unauthenticated plaintext.
+            jni_borrow resultBorrow(env, result, "result");
+            resultBorrow.zeroize();
+        }
+
+        outPos += recordOutLen;
+    }
+
+    if (statusArray) {
+        env->SetByteArrayRegion(statusArray, 0, count, status.data());
+    }
+
+    return (int)outPos;
+}
 
-        if (!EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, tagLen, tag.buf)) {
+JNIEXPORT jint JNICALL Java_com_amazon_corretto_crypto_utils_AesGcmBatchUtils_sealInternal(JNIEnv* pEnv,
+    jclass,
+    jbyteArray keyArray,
+    jint tagLen,
+    jobjectArray ivs,
+    jobjectArray aads,
+    jbyteArray inputArray,
+    jintArray offsets,
+    jintArray lengths,
+    jbyteArray outputArray)
+{
+    try {
+        raii_env env(pEnv);
+
+        return gcmBatch(
+            env, NATIVE_MODE_ENCRYPT, keyArray, tagLen, ivs, aads, inputArray, offsets, lengths, outputArray, nullptr);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return -1;
+    }
+}
+
+JNIEXPORT jint JNICALL Java_com_amazon_corretto_crypto_utils_AesGcmBatchUtils_openInternal(JNIEnv* pEnv,
+    jclass,
+    jbyteArray keyArray,
+    jint tagLen,
+    jobjectArray ivs,
+    jobjectArray aads,
+    jbyteArray inputArray,
+    jintArray offsets,
+    jintArray lengths,
+    jbyteArray outputArray,
+    jbyteArray statusArray)
+{
+    try {
+        raii_env env(pEnv);
+
+        return gcmBatch(env,
+            NATIVE_MODE_DECRYPT,
+            keyArray,
+            tagLen,
+            ivs,
+            aads,
+            inputArray,
+            offsets,
+            lengths,
+            outputArray,
+            statusArray);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return -1;
+    }
+}
+
+namespace {
+// Holds several simultaneous borrows and releases them in reverse order of acquisition, as jni_borrow requires.
+class borrow_batch {
+    std::vector<std::unique_ptr<jni_borrow> > borrows_;
+
+public:
+    ~borrow_batch()
+    {
+        while (!borrows_.empty()) {
+            borrows_.pop_back();
+        }
+    }
+
+    uint8_t* add(raii_env& env, const java_buffer& buffer, const char* trace)
+    {
+        if (buffer.len() == 0) {
+            return nullptr;
+        }
+        borrows_.emplace_back(new jni_borrow(env, buffer, trace));
+        return borrows_.back()->data();
+    }
+};
+
+struct gcm_slice {
+    uint8_t* data;
+    size_t len;
+};
+
+// Walks a list of slices as if they were one contiguous buffer.
+class slice_cursor {
+    std::vector<gcm_slice>& slices_;
+    size_t index_;
+    size_t pos_;
+
+public:
+    explicit slice_cursor(std::vector<gcm_slice>& slices)
+        : slices_(slices)
+        , index_(0)
+        , pos_(0)
+    {
+    }
+
+    // Returns the longest contiguous run of at most |max| bytes at the cursor and advances past it.
+    uint8_t* next(size_t max, size_t* len)
+    {
+        while (index_ < slices_.size() && pos_ == slices_[index_].len) {
+            index_++;
+            pos_ = 0;
+        }
+        if (unlikely(index_ == slices_.size())) {
+            throw java_ex(EX_ARRAYOOB, "Ran past the end of the slices");
+        }
+        uint8_t* result = slices_[index_].data + pos_;
+        *len = std::min(max, slices_[index_].len - pos_);
+        pos_ += *len;
+        return result;
+    }
+
+    void copy_out(uint8_t* dest, size_t len)
+    {
+        while (len > 0) {
+            size_t chunk;
+            const uint8_t* src = next(len, &chunk);
+            memcpy(dest, src, chunk);
+            dest += chunk;
+            len -= chunk;
+        }
+    }
+
+    void copy_in(const uint8_t* src, size_t len)
+    {
+        while (len > 0) {
+            size_t chunk;
+            uint8_t* dest = next(len, &chunk);
+            memcpy(dest, src, chunk);
+            src += chunk;
+            len -= chunk;
+        }
+    }
+
+    void zeroize(size_t len)
+    {
+        while (len > 0) {
+            size_t chunk;
+            uint8_t* dest = next(len, &chunk);
+            OPENSSL_cleanse(dest, chunk);
+            len -= chunk;
+        }
+    }
+};
+
+// Resolves the slices described by parallel arrays. Every element of |buffers| is either a direct ByteBuffer or a
+// byte[]; GetDirectBufferAddress tells them apart, as it returns NULL for anything but a direct buffer.
+std::vector<java_buffer> resolveSlices(
+    raii_env& env, jobjectArray buffers, jintArray offsetsArray, jintArray lengthsArray, size_t* total)
+{
+    const jsize count = env->GetArrayLength(buffers);
+    if (unlikely(env->GetArrayLength(offsetsArray) != count || env->GetArrayLength(lengthsArray) != count)) {
+        throw java_ex(EX_ILLEGAL_ARGUMENT, "Mismatched slice lengths");
+    }
+    std::vector<jint> offsets(count);
+    std::vector<jint> lengths(count);
+    env->GetIntArrayRegion(offsetsArray, 0, count, offsets.data());
+    env->GetIntArrayRegion(lengthsArray, 0, count, lengths.data());
+    env.rethrow_java_exception();
+
+    std::vector<java_buffer> slices;
+    slices.reserve(count);
+    *total = 0;
+    for (jsize i = 0; i < count; i++) {
+        // The local reference must outlive the java_buffer, so it is kept until we return to Java.
+        jobject buffer = env->GetObjectArrayElement(buffers, i);
+        if (unlikely(!buffer)) {
+            throw java_ex(EX_NPE, "Null slice");
+        }
+        if (unlikely(offsets[i] < 0 || lengths[i] < 0)) {
+            throw java_ex(EX_ARRAYOOB, "Negative slice bounds");
+        }
+        if (env->GetDirectBufferAddress(buffer)) {
+            slices.push_back(java_buffer::from_direct(env, buffer).subrange(offsets[i], lengths[i]));
+        } else {
+            slices.push_back(java_buffer::from_array(env, (jbyteArray)buffer, offsets[i], lengths[i]));
+        }
+        *total += lengths[i];
+    }
+    return slices;
+}
+}
+
+/**
+ * Seals or opens a single message whose input is gathered from, and whose output is scattered to, lists of slices.
+ * When opening, the tag is the last tagLen bytes of the gathered input.
+ *
+ * All slices are borrowed at once, after which the message is processed with one EVP_CipherUpdate per contiguous run
+ * of input and output, so nothing is copied apart from the tag. The critical section spans the whole message, which
+ * is intended for protocol frames rather than for bulk data.
+ *
+ * Returns the total number of bytes written to the output slices.
+ */
+static int gcmScatterGather(raii_env& env,
+    int opMode,
+    jbyteArray keyArray,
+    jint tagLen,
+    jbyteArray ivArray,
+    jbyteArray aadArray,
+    jobjectArray inputBuffers,
+    jintArray inputOffsets,
+    jintArray inputLengths,
+    jobjectArray outputBuffers,
+    jintArray outputOffsets,
+    jintArray outputLengths)
+{
+    if (unlikely(tagLen > 16 || tagLen < 0)) {
+        throw java_ex(EX_ILLEGAL_ARGUMENT, "Bad tag length");
+    }
+
+    size_t inputTotal;
+    size_t outputCapacity;
+    std::vector<java_buffer> inputs = resolveSlices(env, inputBuffers, inputOffsets, inputLengths, &inputTotal);
+    std::vector<java_buffer> outputs = resolveSlices(env, outputBuffers, outputOffsets, outputLengths, &outputCapacity);
+
+    if (opMode == NATIVE_MODE_DECRYPT && inputTotal < (size_t)tagLen) {
+        throw java_ex(EX_BADTAG, "Input too short - need tag");
+    }
+    const size_t dataLen = opMode == NATIVE_MODE_ENCRYPT ? inputTotal : inputTotal - tagLen;
+    const size_t outputLen = opMode == NATIVE_MODE_ENCRYPT ? inputTotal + tagLen : dataLen;
+    if (unlikely(outputCapacity < outputLen)) {
+        throw java_ex(EX_SHORTBUF, "Output buffers too small");
+    }
+
+    raii_cipher_ctx ctx;
+    ctx.init();
+    EVP_CIPHER_CTX_init(ctx);
+    {
+        java_buffer key = java_buffer::from_array(env, keyArray);
+        java_buffer iv = java_buffer::from_array(env, ivArray);
+        initContext(env, ctx, opMode, key, iv);
+    }
+    if (aadArray) {
+        updateAAD_loop(env, ctx, java_buffer::from_array(env, aadArray));
+    }
+
+    // From here on there are no JNI calls until the borrows are released.
+    borrow_batch borrows;
+    std::vector<gcm_slice> in(inputs.size());
+    std::vector<gcm_slice> out(outputs.size());
+    for (size_t i = 0; i < inputs.size(); i++) {
+        in[i].data = borrows.add(env, inputs[i], "input");
+        in[i].len = inputs[i].len();
+    }
+    for (size_t i = 0; i < outputs.size(); i++) {
+        out[i].data = borrows.add(env, outputs[i], "output");
+        out[i].len = outputs[i].len();
+    }
+
+    SecureBuffer<uint8_t, 16> tag;
+    slice_cursor inCursor(in);
+    if (opMode == NATIVE_MODE_DECRYPT) {
+        // Fetch the tag first, in case the output overwrites it.
+        slice_cursor tagCursor(in);
+        size_t skipped = 0;
+        while (skipped < dataLen) {
+            size_t chunk;
+            tagCursor.next(dataLen - skipped, &chunk);
+            skipped += chunk;
+        }
+        tagCursor.copy_out(tag.buf, tagLen);
+        if (unlikely(!EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, tagLen, tag.buf))) {
             throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "Failed to set GCM tag");
         }
-        input = input.subrange(0, input.len() - tagLen);
+    }
 
-        if (aadSize != 0) {
-            updateAAD_loop(env, ctx, java_buffer::from_array(env, aadBuffer, 0, aadSize));
+    slice_cursor outCursor(out);
+    size_t remaining = dataLen;
+    while (remaining > 0) {
+        size_t inChunk;
+        const uint8_t* inPtr = inCursor.next(remaining, &inChunk);
+        remaining -= inChunk;
+        while (inChunk > 0) {
+            size_t piece;
+            uint8_t* outPtr = outCursor.next(inChunk, &piece);
+            int outl;
+            if (unlikely(!EVP_CipherUpdate(ctx, outPtr, &outl, inPtr, piece))) {
+                throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "CipherUpdate failed");
+            }
+            // GCM never holds back output, so every run is written where it was read.
+            if (unlikely((size_t)outl != piece)) {
+                env.fatal_error("Unexpected GCM output length");
+            }
+            inPtr += piece;
+            inChunk -= piece;
         }
+    }
 
-        int outoffset = updateLoop(env, result, input, ctx);
-        outoffset += cryptFinish(env, NATIVE_MODE_DECRYPT, result.subrange(outoffset), tagLen, ctx);
+    uint8_t finalBlock[16];
+    int finalOutl = 0;
+    if (unlikely(!EVP_CipherFinal_ex(ctx, finalBlock, &finalOutl) || finalOutl != 0)) {
+        if (opMode == NATIVE_MODE_DECRYPT) {
+            // Never release unauthenticated plaintext.
+            slice_cursor zeroCursor(out);
+            zeroCursor.zeroize(dataLen);
+            unsigned long errCode = drainOpensslErrors();
+            if (likely(errCode == 0)) {
+                throw java_ex(EX_BADTAG, "Tag mismatch!");
+            }
+            throw java_ex(EX_RUNTIME_CRYPTO, formatOpensslError(errCode, "CipherFinal failed"));
+        }
+        throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "CipherFinal failed");
+    }
 
-        if (!ctxPtr && ctxOut) {
-            // Context is new, but caller does want it back
-            jlong tmpPtr = reinterpret_cast<jlong>(ctx.take());
-            env->SetLongArrayRegion(ctxOut, 0, 1, &tmpPtr);
+    if (opMode == NATIVE_MODE_ENCRYPT) {
+        if (unlikely(!EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, tagLen, tag.buf))) {
+            throw java_ex(EX_RUNTIME_CRYPTO, "Failed to get GCM tag");
         }
+        outCursor.copy_in(tag.buf, tagLen);
+    }
+
+    return (int)outputLen;
+}
+
+JNIEXPORT jint JNICALL Java_com_amazon_corretto_crypto_utils_AesGcmScatterGatherUtils_sealInternal(JNIEnv* pEnv,
+    jclass,
+    jbyteArray keyArray,
+    jint tagLen,
+    jbyteArray ivArray,
+    jbyteArray aadArray,
+    jobjectArray inputBuffers,
+    jintArray inputOffsets,
+    jintArray inputLengths,
+    jobjectArray outputBuffers,
+    jintArray outputOffsets,
+    jintArray outputLengths)
+{
+    try {
+        raii_env env(pEnv);
+
+        return gcmScatterGather(env,
+            NATIVE_MODE_ENCRYPT,
+            keyArray,
+            tagLen,
+            ivArray,
+            aadArray,
+            inputBuffers,
+            inputOffsets,
+            inputLengths,
+            outputBuffers,
+            outputOffsets,
+            outputLengths);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return -1;
+    }
+}
+
+JNIEXPORT jint JNICALL Java_com_amazon_corretto_crypto_utils_AesGcmScatterGatherUtils_openInternal(JNIEnv* pEnv,
+    jclass,
+    jbyteArray keyArray,
+    jint tagLen,
+    jbyteArray ivArray,
+    jbyteArray aadArray,
+    jobjectArray inputBuffers,
+    jintArray inputOffsets,
+    jintArray inputLengths,
+    jobjectArray outputBuffers,
+    jintArray outputOffsets,
+    jintArray outputLengths)
+{
+    try {
+        raii_env env(pEnv);
 
-        return outoffset;
+        return gcmScatterGather(env,
+            NATIVE_MODE_DECRYPT,
+            keyArray,
+            tagLen,
+            ivArray,
+            aadArray,
+            inputBuffers,
+            inputOffsets,
+            inputLengths,
+            outputBuffers,
+            outputOffsets,
+            outputLengths);
     } catch (java_ex& ex) {
         ex.throw_to_java(pEnv);
         return -1;
@@ -0,0 +1,355 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+#include "aes_gcm_key_cache.h"
+#include "buffer.h"
+#include "env.h"
+#include "generated-headers.h"
+#include "keyutils.h"
+#include "util.h"
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+#include <openssl/sha.h>
+#include <algorithm> // for std::max
+#include <cstring>
+#include <list>
+#include <pthread.h>
+
+#define MAX_KEY_SIZE 32
+
+using namespace AmazonCorrettoCryptoProvider;
+
+/*
+ * Process-wide cache of AES-GCM contexts which have been initialized with a key but not with an IV. Setting up a GCM
+ * key (AES key expansion plus the GHASH tables) is the dominant cost of initializing a context for small messages;
+ * cloning an already keyed context with EVP_CIPHER_CTX_copy avoids it.
+ *
+ * Entries are identified by an HMAC of the key under a random per-process secret, so key material is never stored
+ * outside of the keyed context itself. Entries are reference counted: the cache holds one reference while the entry
+ * is in the LRU list and each Java-side AesGcmKeyCache.Entry holds another. An evicted entry is freed once its last
+ * Java handle is released by the Janitor.
+ *
+ * The same tags also identify the deterministic IV generators of AesGcmSpi, which are kept in a separate list since
+ * they are needed whether or not the context cache is enabled.
+ */
+namespace {
+struct gcm_key_entry {
+    uint8_t tag[SHA256_DIGEST_LENGTH];
+    EVP_CIPHER_CTX* ctx;
+    size_t refs;
+};
+
+pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_once_t secret_once = PTHREAD_ONCE_INIT;
+uint8_t tag_secret[SHA256_DIGEST_LENGTH];
+bool tag_secret_ok = false;
+// Most recently used entries are at the front.
+std::list<gcm_key_entry*> cache_lru;
+
+// Generators of recently used keys, most recently used at the front. A generator which is still referenced from Java
+// survives eviction; it is merely no longer handed to new users of its key, which get a generator with a new
+// generator number instead.
+#define IV_GENERATOR_CAPACITY 1024
+std::list<gcm_iv_generator*> generator_lru;
+// Generator numbers are allocated sequentially, so they are unique within the process. Uniqueness across processes is
+// the job of the fixed field; the random starting point only makes a misconfigured fixed field less likely to repeat
+// IVs straight away.
+uint32_t generator_base;
+uint64_t generators_allocated = 0;
+
+class cache_guard {
+public:
+    cache_guard() { pthread_mutex_lock(&cache_lock); }
+    ~cache_guard() { pthread_mutex_unlock(&cache_lock); }
+};
+
+void init_tag_secret()
+{
+    tag_secret_ok = RAND_bytes(tag_secret, sizeof(tag_secret)) == 1
+        && RAND_bytes(reinterpret_cast<uint8_t*>(&generator_base), sizeof(generator_base)) == 1;
+}
+
+void key_tag(const uint8_t* key, size_t keyLen, uint8_t tag[SHA256_DIGEST_LENGTH])
+{
+    pthread_once(&secret_once, init_tag_secret);
+    if (unlikely(!tag_secret_ok)) {
+        throw java_ex(EX_RUNTIME_CRYPTO, "Unable to initialize key cache");
+    }
+    unsigned int tagLen = SHA256_DIGEST_LENGTH;
+    CHECK_OPENSSL(HMAC(EVP_sha256(), tag_secret, sizeof(tag_secret), key, keyLen, tag, &tagLen));
+}
+
+void put_be32(uint8_t* out, uint32_t value)
+{
+    for (int i = 0; i < 4; i++) {
+        out[i] = (uint8_t)(value >> (8 * (3 - i)));
+    }
+}
+
+// Must be called with cache_lock held. Writes |fixedField| and a new generator number to |prefix|. Throws once every
+// generator number has been handed out, since continuing would repeat IVs under keys which are still in use.
+void allocate_prefix_locked(uint8_t prefix[GCM_IV_FIXED_LEN + GCM_IV_GENERATOR_LEN], uint32_t fixedField)
+{
+    if (unlikely(generators_allocated > UINT32_MAX)) {
+        throw java_ex(EX_ILLEGAL_STATE, "GCM generator numbers exhausted; deterministic IVs are no longer available");
+    }
+    put_be32(prefix, fixedField);
+    put_be32(prefix + GCM_IV_FIXED_LEN, generator_base + (uint32_t)generators_allocated++);
+}
+
+// Must be called with cache_lock held.
+void unref_generator_locked(gcm_iv_generator* gen)
+{
+    if (--gen->refs == 0) {
+        OPENSSL_cleanse(gen->tag, sizeof(gen->tag));
+        delete gen;
+    }
+}
+
+// Must be called with cache_lock held.
+void unref_locked(gcm_key_entry* entry)
+{
+    if (--entry->refs == 0) {
+        EVP_CIPHER_CTX_free(entry->ctx);
+        OPENSSL_cleanse(entry->tag, sizeof(entry->tag));
+        delete entry;
+    }
+}
+
+// Must be called with cache_lock held. On a hit, the entry is moved to the front and a reference is taken.
+gcm_key_entry* find_locked(const uint8_t* tag)
+{
+    for (auto it = cache_lru.begin(); it != cache_lru.end(); ++it) {
+        if (!CRYPTO_memcmp((*it)->tag, tag, SHA256_DIGEST_LENGTH)) {
+            gcm_key_entry* entry = *it;
+            cache_lru.splice(cache_lru.begin(), cache_lru, it);
+            entry->refs++;
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+const EVP_CIPHER* gcm_cipher_for_key(size_t keyLen)
+{
+    switch (keyLen) {
+    case 16:
+        return EVP_aes_128_gcm();
+    case 24:
+        return EVP_aes_192_gcm();
+    case 32:
+        return EVP_aes_256_gcm();
+    default:
+        throw java_ex(EX_RUNTIME_CRYPTO, "Unsupported key length");
+    }
+}
+
+gcm_key_entry* entry_from_ptr(jlong ptr)
+{
+    if (unlikely(!ptr)) {
+        throw java_ex(EX_NPE, "Null key cache entry");
+    }
+    return reinterpret_cast<gcm_key_entry*>(ptr);
+}
+
+void set_iv_len(EVP_CIPHER_CTX* ctx, jint ivLen)
+{
+    if (unlikely(!EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, ivLen, NULL))) {
+        throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "Setting IV length failed");
+    }
+}
+}
+
+namespace AmazonCorrettoCryptoProvider {
+
+gcm_iv_generator* acquire_iv_generator(const uint8_t* key, size_t keyLen, uint32_t fixedField)
+{
+    uint8_t tag[SHA256_DIGEST_LENGTH];
+    key_tag(key, keyLen, tag);
+    uint8_t fixed[GCM_IV_FIXED_LEN];
+    put_be32(fixed, fixedField);
+
+    cache_guard guard;
+    for (auto it = generator_lru.begin(); it != generator_lru.end(); ++it) {
+        if (!CRYPTO_memcmp((*it)->tag, tag, SHA256_DIGEST_LENGTH) && !memcmp((*it)->prefix, fixed, sizeof(fixed))) {
+            gcm_iv_generator* gen = *it;
+            generator_lru.splice(generator_lru.begin(), generator_lru, it);
+            gen->refs++;
+            return gen;
+        }
+    }
+
+    uint8_t prefix[GCM_IV_FIXED_LEN + GCM_IV_GENERATOR_LEN];
+    allocate_prefix_locked(prefix, fixedField);
+    gcm_iv_generator* gen = new gcm_iv_generator();
+    memcpy(gen->tag, tag, sizeof(tag));
+    memcpy(gen->prefix, prefix, sizeof(prefix));
+    gen->next.store(0);
+    gen->refs = 2; // One for the list and one for the caller
+    generator_lru.push_front(gen);
+
+    while (generator_lru.size() > IV_GENERATOR_CAPACITY) {
+        gcm_iv_generator* evicted = generator_lru.back();
+        generator_lru.pop_back();
+        unref_generator_locked(evicted);
+    }
+    return gen;
+}
+
+gcm_iv_generator* new_iv_generator(uint32_t fixedField, uint32_t firstInvocation)
+{
+    pthread_once(&secret_once, init_tag_secret);
+    if (unlikely(!tag_secret_ok)) {
+        throw java_ex(EX_RUNTIME_CRYPTO, "Unable to initialize key cache");
+    }
+
+    cache_guard guard;
+    uint8_t prefix[GCM_IV_FIXED_LEN + GCM_IV_GENERATOR_LEN];
+    allocate_prefix_locked(prefix, fixedField);
+    gcm_iv_generator* gen = new gcm_iv_generator();
+    memset(gen->tag, 0, sizeof(gen->tag));
+    memcpy(gen->prefix, prefix, sizeof(prefix));
+    gen->next.store(firstInvocation);
+    gen->refs = 1;
+    return gen;
+}
+
+void release_iv_generator(gcm_iv_generator* gen)
+{
+    if (!gen) {
+        return;
+    }
+    cache_guard guard;
+    unref_generator_locked(gen);
+}
+
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesGcmKeyCache
+ * Method:    acquireEntry
+ * Signature: (I[B)J
+ */
+JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmKeyCache_acquireEntry(
+    JNIEnv* pEnv, jclass, jint capacity, jbyteArray keyArray)
+{
+    try {
+        raii_env env(pEnv);
+
+        java_buffer keyBuf = java_buffer::from_array(env, keyArray);
+        const EVP_CIPHER* cipher = gcm_cipher_for_key(keyBuf.len());
+        SecureBuffer<uint8_t, MAX_KEY_SIZE> key;
+        keyBuf.get_bytes(env, key.buf, 0, keyBuf.len());
+
+        uint8_t tag[SHA256_DIGEST_LENGTH];
+        key_tag(key.buf, keyBuf.len(), tag);
+
+        {
+            cache_guard guard;
+            gcm_key_entry* hit = find_locked(tag);
+            if (hit) {
+                return reinterpret_cast<jlong>(hit);
+            }
+        }
+
+        // Build the new entry outside of the lock; key setup is exactly the cost we want to keep off of
+        // the critical section.
+        raii_cipher_ctx ctx;
+        ctx.init();
+        if (unlikely(!ctx)) {
+            throw java_ex(EX_OOM, "Unable to allocate cipher context");
+        }
+        if (unlikely(!EVP_CipherInit_ex(ctx, cipher, NULL, key.buf, NULL, 1))) {
+            throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "Initializing cipher failed");
+        }
+
+        cache_guard guard;
+        // Another thread may have inserted the same key while we were unlocked.
+        gcm_key_entry* hit = find_locked(tag);
+        if (hit) {
+            return reinterpret_cast<jlong>(hit);
+        }
+
+        gcm_key_entry* entry = new gcm_key_entry;
+        memcpy(entry->tag, tag, sizeof(tag));
+        entry->ctx = ctx.take();
+        entry->refs = 2; // One for the cache and one for the caller
+        cache_lru.push_front(entry);
+
+        while (cache_lru.size() > (size_t)std::max(capacity, 1)) {
+            gcm_key_entry* evicted = cache_lru.back();
+            cache_lru.pop_back();
+            unref_locked(evicted);
+        }
+
+        return reinterpret_cast<jlong>(entry);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return 0;
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesGcmKeyCache
+ * Method:    releaseEntry
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmKeyCache_releaseEntry(
+    JNIEnv*, jclass, jlong entryPtr)
+{
+    if (!entryPtr) {
+        return;
+    }
+    cache_guard guard;
+    unref_locked(reinterpret_cast<gcm_key_entry*>(entryPtr));
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesGcmKeyCache
+ * Method:    newContext
+ * Signature: (JI)J
+ */
+JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmKeyCache_newContext(
+    JNIEnv* pEnv, jclass, jlong entryPtr, jint ivLen)
+{
+    try {
+        gcm_key_entry* entry = entry_from_ptr(entryPtr);
+
+        raii_cipher_ctx ctx;
+        ctx.init();
+        if (unlikely(!ctx)) {
+            throw java_ex(EX_OOM, "Unable to allocate cipher context");
+        }
+        // The cached context is never modified after creation, so it can be copied without holding the lock.
+        CHECK_OPENSSL(EVP_CIPHER_CTX_copy(ctx, entry->ctx));
+        set_iv_len(ctx, ivLen);
+
+        return reinterpret_cast<jlong>(ctx.take());
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return 0;
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesGcmKeyCache
+ * Method:    copyToContext
+ * Signature: (JJI)V
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmKeyCache_copyToContext(
+    JNIEnv* pEnv, jclass, jlong entryPtr, jlong ctxPtr, jint ivLen)
+{
+    try {
+        gcm_key_entry* entry = entry_from_ptr(entryPtr);
+        if (unlikely(!ctxPtr)) {
+            throw java_ex(EX_NPE, "Null context");
+        }
+        EVP_CIPHER_CTX* ctx = reinterpret_cast<EVP_CIPHER_CTX*>(ctxPtr);
+
+        CHECK_OPENSSL(EVP_CIPHER_CTX_copy(ctx, entry->ctx));
+        set_iv_len(ctx, ivLen);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
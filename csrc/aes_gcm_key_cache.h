@@ -0,0 +1,46 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+#ifndef AES_GCM_KEY_CACHE_H
+#define AES_GCM_KEY_CACHE_H 1
+
+#include <openssl/sha.h>
+#include <atomic>
+#include <cstddef>
+#include <stdint.h>
+
+#define GCM_IV_FIXED_LEN     4
+#define GCM_IV_GENERATOR_LEN 4
+#define GCM_IV_COUNTER_LEN   4
+#define GCM_IV_LEN           (GCM_IV_FIXED_LEN + GCM_IV_GENERATOR_LEN + GCM_IV_COUNTER_LEN)
+
+namespace AmazonCorrettoCryptoProvider {
+
+/*
+ * Deterministic IV generator of NIST SP 800-38D section 8.2.1 for one key. The 4-byte fixed field is supplied by the
+ * application and must identify this process among everything which may use the same key, since nothing in the
+ * process can coordinate with other processes. The 8-byte invocation field is a 32-bit generator number followed by a
+ * 32-bit big-endian counter. Generators are shared by every AesGcmSpi in the process using the same key, so the key
+ * has a single counter. Generator numbers are handed out by a process-wide allocator and are never reused within the
+ * process, so a generator which is evicted and later re-created for the same key cannot repeat the IVs of its
+ * predecessor.
+ */
+struct gcm_iv_generator {
+    uint8_t tag[SHA256_DIGEST_LENGTH];
+    uint8_t prefix[GCM_IV_FIXED_LEN + GCM_IV_GENERATOR_LEN];
+    std::atomic<uint64_t> next;
+    // Protected by the key cache lock
+    size_t refs;
+};
+
+// Returns a referenced generator shared by all users of |key| with |fixedField| in this process, creating it if needed.
+gcm_iv_generator* acquire_iv_generator(const uint8_t* key, size_t keyLen, uint32_t fixedField);
+
+// Returns a referenced generator tied to no key whose counter starts at |firstInvocation|. Only used by tests.
+gcm_iv_generator* new_iv_generator(uint32_t fixedField, uint32_t firstInvocation);
+
+// Drops a reference obtained from acquire_iv_generator or new_iv_generator.
+void release_iv_generator(gcm_iv_generator* gen);
+
+}
+
+#endif
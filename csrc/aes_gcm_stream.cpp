@@ -0,0 +1,369 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+#include "buffer.h"
+#include "env.h"
+#include "generated-headers.h"
+#include "util.h"
+#include <openssl/aead.h>
+#include <openssl/evp.h>
+#include <openssl/err.h>
+#include <openssl/hkdf.h>
+#include <algorithm>
+#include <cstring>
+#include <pthread.h>
+#include <vector>
+
+#define EX_BADTAG   "javax/crypto/AEADBadTagException"
+#define EX_SHORTBUF "javax/crypto/ShortBufferException"
+
+#define KEY_LEN_AES128 16
+#define KEY_LEN_AES192 24
+#define KEY_LEN_AES256 32
+
+#define STREAM_TAG_LEN           16
+#define STREAM_NONCE_LEN         12
+#define STREAM_NONCE_PREFIX_LEN  7
+#define STREAM_MAX_SEGMENTS      (((uint64_t)1) << 32)
+#define STREAM_LAST_SEGMENT_FLAG 1
+// Java memory is borrowed for at most this many bytes of input per thread at a time, see process_segments.
+#define STREAM_WINDOW_PER_THREAD (4 * 1024 * 1024)
+
+using namespace AmazonCorrettoCryptoProvider;
+
+/*
+ * Segmented streaming AES-GCM (the STREAM construction with a per-stream key derived by HKDF).
+ *
+ * A stream is keyed with HKDF-SHA256(ikm = key, salt = IV, info = AAD), which yields an AES-GCM key of the same length
+ * as the input key followed by a 7 byte nonce prefix. Segment i is sealed with its own AES-GCM tag under the nonce
+ *   prefix || uint32_be(i) || last
+ * where last is 1 only for the final segment, so segments can be neither reordered nor truncated. Every segment but
+ * the final one holds exactly segmentSize bytes of plaintext; the final one holds between 0 and segmentSize bytes.
+ *
+ * As segments are independent, a call covering several segments may split them across threads. The EVP_AEAD_CTX is
+ * only read while sealing or opening, so the workers share it. Java arrays are pinned with critical sections which
+ * hold off the garbage collector, so a large call is processed in windows of whole segments and only one window of
+ * the input and output is borrowed at a time.
+ */
+namespace {
+
+struct aes_gcm_stream {
+    EVP_AEAD_CTX* ctx;
+    uint8_t nonce_prefix[STREAM_NONCE_PREFIX_LEN];
+};
+
+const EVP_AEAD* gcm_aead_for_key_length(size_t keyLen)
+{
+    switch (keyLen) {
+    case KEY_LEN_AES128:
+        return EVP_aead_aes_128_gcm();
+    case KEY_LEN_AES192:
+        return EVP_aead_aes_192_gcm();
+    case KEY_LEN_AES256:
+        return EVP_aead_aes_256_gcm();
+    default:
+        throw java_ex(EX_RUNTIME_CRYPTO, "Unsupported key length");
+    }
+}
+
+aes_gcm_stream* stream_from_ptr(jlong ptr)
+{
+    if (unlikely(!ptr)) {
+        throw java_ex(EX_NPE, "Null stream context");
+    }
+    return reinterpret_cast<aes_gcm_stream*>(ptr);
+}
+
+// A run of consecutive segments processed by one thread. Workers never touch the JNIEnv.
+struct segment_batch {
+    const aes_gcm_stream* stream;
+    bool seal;
+    size_t segment_size;
+    uint64_t first_segment;
+    size_t segment_count;
+    bool ends_stream;
+    uint8_t const* input;
+    size_t input_len;
+    uint8_t* output;
+    bool ok;
+};
+
+void* segment_worker(void* arg)
+{
+    segment_batch* batch = reinterpret_cast<segment_batch*>(arg);
+    const size_t in_unit = batch->seal ? batch->segment_size : batch->segment_size + STREAM_TAG_LEN;
+    uint8_t nonce[STREAM_NONCE_LEN];
+    memcpy(nonce, batch->stream->nonce_prefix, STREAM_NONCE_PREFIX_LEN);
+
+    uint8_t const* in = batch->input;
+    uint8_t* out = batch->output;
+    size_t remaining = batch->input_len;
+    batch->ok = true;
+    for (size_t i = 0; i < batch->segment_count; i++) {
+        const uint64_t segment = batch->first_segment + i;
+        nonce[7] = (uint8_t)(segment >> 24);
+        nonce[8] = (uint8_t)(segment >> 16);
+        nonce[9] = (uint8_t)(segment >> 8);
+        nonce[10] = (uint8_t)segment;
+        nonce[11] = (batch->ends_stream && i == batch->segment_count - 1) ? STREAM_LAST_SEGMENT_FLAG : 0;
+
+        const size_t in_len = remaining < in_unit ? remaining : in_unit;
+        size_t out_len = 0;
+        int success;
+        if (batch->seal) {
+            success = EVP_AEAD_CTX_seal(batch->stream->ctx, out, &out_len, in_len + STREAM_TAG_LEN, nonce,
+                sizeof(nonce), in, in_len, nullptr, 0);
+        } else {
+            success = EVP_AEAD_CTX_open(batch->stream->ctx, out, &out_len, in_len - STREAM_TAG_LEN, nonce,
+                sizeof(nonce), in, in_len, nullptr, 0);
+        }
+        if (!success) {
+            // The error queue is thread-local, so the calling thread reports the failure instead.
+            ERR_clear_error();
+            batch->ok = false;
+            return nullptr;
+        }
+        in += in_len;
+        out += out_len;
+        remaining -= in_len;
+    }
+    return nullptr;
+}
+
+jint process_segments(raii_env& env,
+    bool seal,
+    jlong streamPtr,
+    jint segmentSize,
+    jlong firstSegment,
+    bool isFinal,
+    jint threads,
+    jbyteArray inputArray,
+    jint inputOffset,
+    jint inputLength,
+    jbyteArray outputArray,
+    jint outputOffset)
+{
+    const aes_gcm_stream* stream = stream_from_ptr(streamPtr);
+    if (unlikely(segmentSize <= 0 || firstSegment < 0 || threads <= 0)) {
+        throw java_ex(EX_ILLEGAL_ARGUMENT, "Invalid segment parameters");
+    }
+    java_buffer input = java_buffer::from_array(env, inputArray, inputOffset, inputLength);
+    java_buffer output = java_buffer::from_array(env, outputArray, outputOffset);
+
+    const size_t in_unit = seal ? (size_t)segmentSize : (size_t)segmentSize + STREAM_TAG_LEN;
+    const size_t in_len = input.len();
+    size_t segments = in_len / in_unit;
+    const size_t partial = in_len % in_unit;
+    if (isFinal) {
+        if (partial != 0 || segments == 0) {
+            // The final segment is shorter than the others, or this is an empty stream.
+            if (unlikely(!seal && partial < STREAM_TAG_LEN)) {
+                throw java_ex(EX_BADTAG, "Truncated segment");
+            }
+            segments++;
+        }
+    } else if (unlikely(partial != 0)) {
+        throw java_ex(EX_ILLEGAL_ARGUMENT, "Input must consist of whole segments");
+    }
+    if (segments == 0) {
+        return 0;
+    }
+    if (unlikely((uint64_t)firstSegment + segments > STREAM_MAX_SEGMENTS)) {
+        throw java_ex(EX_RUNTIME_CRYPTO, "Too many segments in stream");
+    }
+
+    const size_t out_len = seal ? in_len + segments * STREAM_TAG_LEN : in_len - segments * STREAM_TAG_LEN;
+    if (unlikely(output.len() < out_len)) {
+        throw java_ex(EX_SHORTBUF, "Output buffer too small");
+    }
+    output = output.subrange(0, out_len);
+
+    const size_t workers = (size_t)threads < segments ? (size_t)threads : segments;
+    const size_t out_unit = seal ? in_unit + STREAM_TAG_LEN : in_unit - STREAM_TAG_LEN;
+    // Every worker gets at least one segment per window, even if segments are larger than the window.
+    const size_t per_window = workers * std::max((size_t)1, (size_t)STREAM_WINDOW_PER_THREAD / in_unit);
+
+    bool ok = true;
+    size_t written = 0;
+    for (size_t window = 0; ok && window < segments; window += per_window) {
+        const size_t window_segments = std::min(per_window, segments - window);
+        const bool ends_call = window + window_segments == segments;
+        const size_t window_in = (ends_call ? in_len : (window + window_segments) * in_unit) - window * in_unit;
+        const size_t window_out
+            = (ends_call ? out_len : (window + window_segments) * out_unit) - window * out_unit;
+        const size_t window_workers = std::min(workers, window_segments);
+        const size_t per_worker = (window_segments + window_workers - 1) / window_workers;
+
+        jni_borrow inBorrow(env, input.subrange(window * in_unit, window_in), "input");
+        jni_borrow outBorrow(env, output.subrange(window * out_unit, window_out), "output");
+
+        std::vector<segment_batch> batches;
+        for (size_t first = 0; first < window_segments; first += per_worker) {
+            segment_batch batch;
+            batch.stream = stream;
+            batch.seal = seal;
+            batch.segment_size = segmentSize;
+            batch.first_segment = (uint64_t)firstSegment + window + first;
+            batch.segment_count = (window_segments - first) < per_worker ? window_segments - first : per_worker;
+            batch.ends_stream = isFinal && ends_call && first + batch.segment_count == window_segments;
+            batch.input = inBorrow.data() + first * in_unit;
+            const size_t batch_end
+                = first + batch.segment_count == window_segments ? window_in : (first + batch.segment_count) * in_unit;
+            batch.input_len = batch_end - first * in_unit;
+            batch.output = outBorrow.data() + first * out_unit;
+            batch.ok = false;
+            batches.push_back(batch);
+        }
+
+        std::vector<pthread_t> handles(batches.size());
+        std::vector<bool> started(batches.size(), false);
+        for (size_t i = 1; i < batches.size(); i++) {
+            // If we cannot get another thread, the batch is simply processed on this one below.
+            started[i] = pthread_create(&handles[i], nullptr, segment_worker, &batches[i]) == 0;
+        }
+        segment_worker(&batches[0]);
+        for (size_t i = 1; i < batches.size(); i++) {
+            if (started[i]) {
+                pthread_join(handles[i], nullptr);
+            } else {
+                segment_worker(&batches[i]);
+            }
+        }
+        for (size_t i = 0; i < batches.size(); i++) {
+            ok = ok && batches[i].ok;
+        }
+        written += window_out;
+    }
+
+    if (!ok && !seal) {
+        // Never release unauthenticated plaintext, not even from the segments which did verify. Earlier windows were
+        // already released to Java, so they are borrowed again, one at a time, to clear them.
+        const size_t window_out = per_window * out_unit;
+        for (size_t offset = 0; offset < written; offset += window_out) {
+            jni_borrow outBorrow(env, output.subrange(offset, std::min(window_out, written - offset)), "output");
+            outBorrow.zeroize();
+        }
+    }
+
+    if (!ok) {
+        if (seal) {
+            throw java_ex(EX_RUNTIME_CRYPTO, "AEAD seal failed");
+        }
+        throw java_ex(EX_BADTAG, "Tag mismatch!");
+    }
+    return (jint)out_len;
+}
+
+} // namespace
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesGcmStreamSpi
+ * Method:    newStream
+ * Signature: ([B[B[BI)J
+ */
+JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmStreamSpi_newStream(
+    JNIEnv* pEnv, jclass, jbyteArray keyArray, jbyteArray ivArray, jbyteArray aadArray, jint aadSize)
+{
+    try {
+        raii_env env(pEnv);
+
+        java_buffer key = java_buffer::from_array(env, keyArray);
+        java_buffer iv = java_buffer::from_array(env, ivArray);
+        java_buffer aad = java_buffer::from_array(env, aadArray, 0, aadSize);
+        const size_t keyLen = key.len();
+        const EVP_AEAD* aead = gcm_aead_for_key_length(keyLen);
+
+        SecureBuffer<uint8_t, KEY_LEN_AES256> keybuf;
+        key.get_bytes(env, keybuf.buf, 0, keyLen);
+        SecureBuffer<uint8_t, KEY_LEN_AES256 + STREAM_NONCE_PREFIX_LEN> derived;
+        {
+            jni_borrow ivBorrow(env, iv, "iv");
+            jni_borrow aadBorrow(env, aad, "aad");
+            if (unlikely(!HKDF(derived.buf, keyLen + STREAM_NONCE_PREFIX_LEN, EVP_sha256(), keybuf.buf, keyLen,
+                    ivBorrow.data(), ivBorrow.len(), aadBorrow.data(), aadBorrow.len()))) {
+                throw_openssl(EX_RUNTIME_CRYPTO, "HKDF failed.");
+            }
+        }
+
+        aes_gcm_stream* stream = new aes_gcm_stream;
+        stream->ctx = EVP_AEAD_CTX_new(aead, derived.buf, keyLen, STREAM_TAG_LEN);
+        if (unlikely(!stream->ctx)) {
+            delete stream;
+            throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "Failed to create AEAD context");
+        }
+        memcpy(stream->nonce_prefix, derived.buf + keyLen, STREAM_NONCE_PREFIX_LEN);
+        return reinterpret_cast<jlong>(stream);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return 0;
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesGcmStreamSpi
+ * Method:    freeStream
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmStreamSpi_freeStream(
+    JNIEnv*, jclass, jlong streamPtr)
+{
+    aes_gcm_stream* stream = reinterpret_cast<aes_gcm_stream*>(streamPtr);
+    EVP_AEAD_CTX_free(stream->ctx);
+    OPENSSL_cleanse(stream->nonce_prefix, sizeof(stream->nonce_prefix));
+    delete stream;
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesGcmStreamSpi
+ * Method:    sealSegments
+ * Signature: (JIJZI[BII[BI)I
+ */
+JNIEXPORT jint JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmStreamSpi_sealSegments(JNIEnv* pEnv,
+    jclass,
+    jlong streamPtr,
+    jint segmentSize,
+    jlong firstSegment,
+    jboolean isFinal,
+    jint threads,
+    jbyteArray inputArray,
+    jint inputOffset,
+    jint inputLength,
+    jbyteArray outputArray,
+    jint outputOffset)
+{
+    try {
+        raii_env env(pEnv);
+        return process_segments(env, true, streamPtr, segmentSize, firstSegment, isFinal, threads, inputArray,
+            inputOffset, inputLength, outputArray, outputOffset);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return -1;
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesGcmStreamSpi
+ * Method:    openSegments
+ * Signature: (JIJZI[BII[BI)I
+ */
+JNIEXPORT jint JNICALL Java_com_amazon_corretto_crypto_provider_AesGcmStreamSpi_openSegments(JNIEnv* pEnv,
+    jclass,
+    jlong streamPtr,
+    jint segmentSize,
+    jlong firstSegment,
+    jboolean isFinal,
+    jint threads,
+    jbyteArray inputArray,
+    jint inputOffset,
+    jint inputLength,
+    jbyteArray outputArray,
+    jint outputOffset)
+{
+    try {
+        raii_env env(pEnv);
+        return process_segments(env, false, streamPtr, segmentSize, firstSegment, isFinal, threads, inputArray,
+            inputOffset, inputLength, outputArray, outputOffset);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return -1;
+    }
+}
@@ -0,0 +1,225 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+#include "buffer.h"
+#include "env.h"
+#include "generated-headers.h"
+#include "keyutils.h"
+#include "util.h"
+#include <openssl/cipher.h>
+
+#define AES_GMAC_LEN 16
+
+using namespace AmazonCorrettoCryptoProvider;
+
+/*
+ * AES-GMAC (NIST SP 800-38D): AES-GCM over an empty plaintext, with the whole message authenticated as AAD. The
+ * context is keyed once, which expands the AES key and precomputes the GHASH tables, and every message then only
+ * sets a new IV on it.
+ */
+namespace {
+EVP_CIPHER_CTX* gmac_from_ptr(jlong ctxPtr)
+{
+    if (unlikely(!ctxPtr)) {
+        throw java_ex(EX_NPE, "Null GMAC context");
+    }
+    return reinterpret_cast<EVP_CIPHER_CTX*>(ctxPtr);
+}
+
+void start_message(raii_env& env, EVP_CIPHER_CTX* ctx, jbyteArray ivArray)
+{
+    java_buffer iv = java_buffer::from_array(env, ivArray);
+    if (unlikely(!EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, iv.len(), nullptr))) {
+        throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "Setting IV length failed");
+    }
+    jni_borrow ivBorrow(env, iv, "iv");
+    if (unlikely(!EVP_EncryptInit_ex(ctx, nullptr, nullptr, nullptr, ivBorrow.data()))) {
+        throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "Failed to set IV");
+    }
+}
+
+void update_aad(EVP_CIPHER_CTX* ctx, jni_borrow& input)
+{
+    int outl;
+    if (unlikely(!EVP_EncryptUpdate(ctx, nullptr, &outl, input.data(), input.len()))) {
+        throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "Failed to update GMAC");
+    }
+}
+
+void calculate_mac(raii_env& env, EVP_CIPHER_CTX* ctx, jbyteArray resultArray)
+{
+    uint8_t scratch[AES_GMAC_LEN];
+    int outl = 0;
+    if (unlikely(!EVP_EncryptFinal_ex(ctx, scratch, &outl) || outl != 0)) {
+        throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "Failed to finish GMAC");
+    }
+    if (unlikely(!EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, AES_GMAC_LEN, scratch))) {
+        throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "Failed to get GMAC tag");
+    }
+    java_buffer::from_array(env, resultArray).put_bytes(env, scratch, 0, AES_GMAC_LEN);
+}
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesGmacSpi
+ * Method:    newContext
+ * Signature: ([B)J
+ */
+JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_AesGmacSpi_newContext(
+    JNIEnv* pEnv, jclass, jbyteArray keyArray)
+{
+    try {
+        raii_env env(pEnv);
+
+        java_buffer keyBuf = java_buffer::from_array(env, keyArray);
+        const EVP_CIPHER* cipher;
+        switch (keyBuf.len()) {
+        case 16:
+            cipher = EVP_aes_128_gcm();
+            break;
+        case 24:
+            cipher = EVP_aes_192_gcm();
+            break;
+        case 32:
+            cipher = EVP_aes_256_gcm();
+            break;
+        default:
+            throw java_ex(EX_RUNTIME_CRYPTO, "Unsupported key length");
+        }
+
+        raii_cipher_ctx ctx;
+        ctx.init();
+        if (unlikely(!(EVP_CIPHER_CTX*)ctx)) {
+            throw java_ex(EX_OOM, "Unable to allocate GMAC context");
+        }
+        jni_borrow key(env, keyBuf, "key");
+        if (unlikely(!EVP_EncryptInit_ex(ctx, cipher, nullptr, key.data(), nullptr))) {
+            throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "Failed to initialize GMAC context");
+        }
+        return reinterpret_cast<jlong>(ctx.take());
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return 0;
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesGmacSpi
+ * Method:    cloneContext
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_AesGmacSpi_cloneContext(
+    JNIEnv* pEnv, jclass, jlong ctxPtr)
+{
+    try {
+        EVP_CIPHER_CTX* original = gmac_from_ptr(ctxPtr);
+        raii_cipher_ctx ctx;
+        ctx.init();
+        if (unlikely(!(EVP_CIPHER_CTX*)ctx)) {
+            throw java_ex(EX_OOM, "Unable to allocate GMAC context");
+        }
+        if (unlikely(!EVP_CIPHER_CTX_copy(ctx, original))) {
+            throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "Failed to copy GMAC context");
+        }
+        return reinterpret_cast<jlong>(ctx.take());
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return 0;
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesGmacSpi
+ * Method:    update
+ * Signature: (J[B[BII)V
+ *
+ * Starts a new message with the given IV first, unless ivArray is null.
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_AesGmacSpi_update(
+    JNIEnv* pEnv, jclass, jlong ctxPtr, jbyteArray ivArray, jbyteArray inputArray, jint offset, jint len)
+{
+    try {
+        raii_env env(pEnv);
+
+        EVP_CIPHER_CTX* ctx = gmac_from_ptr(ctxPtr);
+        if (ivArray) {
+            start_message(env, ctx, ivArray);
+        }
+        java_buffer inputBuf = java_buffer::from_array(env, inputArray, offset, len);
+        jni_borrow input(env, inputBuf, "input");
+        update_aad(ctx, input);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesGmacSpi
+ * Method:    updateDirect
+ * Signature: (J[BLjava/nio/ByteBuffer;)V
+ *
+ * Starts a new message with the given IV first, unless ivArray is null.
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_AesGmacSpi_updateDirect(
+    JNIEnv* pEnv, jclass, jlong ctxPtr, jbyteArray ivArray, jobject inputDirectBuf)
+{
+    try {
+        raii_env env(pEnv);
+
+        EVP_CIPHER_CTX* ctx = gmac_from_ptr(ctxPtr);
+        if (ivArray) {
+            start_message(env, ctx, ivArray);
+        }
+        java_buffer inputBuf = java_buffer::from_direct(env, inputDirectBuf);
+        jni_borrow input(env, inputBuf, "input");
+        update_aad(ctx, input);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesGmacSpi
+ * Method:    doFinal
+ * Signature: (J[B)V
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_AesGmacSpi_doFinal(
+    JNIEnv* pEnv, jclass, jlong ctxPtr, jbyteArray resultArray)
+{
+    try {
+        raii_env env(pEnv);
+
+        calculate_mac(env, gmac_from_ptr(ctxPtr), resultArray);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AesGmacSpi
+ * Method:    fastMac
+ * Signature: (J[B[BII[B)V
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_AesGmacSpi_fastMac(JNIEnv* pEnv,
+    jclass,
+    jlong ctxPtr,
+    jbyteArray ivArray,
+    jbyteArray inputArray,
+    jint offset,
+    jint len,
+    jbyteArray resultArray)
+{
+    try {
+        raii_env env(pEnv);
+
+        EVP_CIPHER_CTX* ctx = gmac_from_ptr(ctxPtr);
+        start_message(env, ctx, ivArray);
+        {
+            java_buffer inputBuf = java_buffer::from_array(env, inputArray, offset, len);
+            jni_borrow input(env, inputBuf, "input");
+            update_aad(ctx, input);
+        }
+        calculate_mac(env, ctx, resultArray);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
@@ -5,6 +5,7 @@
 
 #include "env.h"
 #include <openssl/ec.h>
+#include <openssl/ecdsa.h>
 #include <openssl/evp.h>
 #include <openssl/mem.h>
 #include <openssl/rsa.h>
@@ -83,6 +84,7 @@ OPENSSL_auto(PKCS8_PRIV_KEY_INFO);
 OPENSSL_auto(EC_GROUP);
 OPENSSL_auto(EC_POINT);
 OPENSSL_auto(EC_KEY);
+OPENSSL_auto(ECDSA_SIG);
 OPENSSL_auto(BN_CTX);
 OPENSSL_auto(EVP_MD_CTX);
 OPENSSL_auto(EVP_PKEY);
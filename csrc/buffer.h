@@ -132,6 +132,22 @@ public:
         return buf;
     }
 
+    /**
+     * Constructs a java buffer over native memory, so that code written against java_buffer can also
+     * write to scratch space which Java cannot observe.
+     *
+     * The caller must keep the memory alive for as long as the java_buffer is used.
+     */
+    static java_buffer from_native(void* data, size_t len)
+    {
+        java_buffer buf;
+        buf.m_direct_buffer = data;
+        buf.m_offset = 0;
+        buf.m_length = len;
+
+        return buf;
+    }
+
     /**
      * Constructs a java buffer representing a slice of an array.
      *
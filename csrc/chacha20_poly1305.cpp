@@ -0,0 +1,187 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+#include "buffer.h"
+#include "env.h"
+#include "generated-headers.h"
+#include "util.h"
+#include <openssl/aead.h>
+#include <openssl/cipher.h>
+#include <openssl/err.h>
+
+#define EX_BADTAG   "javax/crypto/AEADBadTagException"
+#define EX_SHORTBUF "javax/crypto/ShortBufferException"
+
+#define CHACHA20_POLY1305_KEY_LEN 32
+#define CHACHA20_POLY1305_TAG_LEN 16
+
+using namespace AmazonCorrettoCryptoProvider;
+
+/*
+ * ChaCha20-Poly1305 (RFC 8439) on top of EVP_aead_chacha20_poly1305. The EVP_AEAD interface only supports whole
+ * messages, so the Java layer buffers incremental input and every operation here is a single seal or open call.
+ */
+namespace {
+EVP_AEAD_CTX* aead_from_ptr(jlong ctxPtr)
+{
+    if (unlikely(!ctxPtr)) {
+        throw java_ex(EX_NPE, "Null AEAD context");
+    }
+    return reinterpret_cast<EVP_AEAD_CTX*>(ctxPtr);
+}
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_ChaCha20Poly1305Spi
+ * Method:    newContext
+ * Signature: ([B)J
+ */
+JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_ChaCha20Poly1305Spi_newContext(
+    JNIEnv* pEnv, jclass, jbyteArray keyArray)
+{
+    try {
+        raii_env env(pEnv);
+
+        java_buffer key = java_buffer::from_array(env, keyArray);
+        if (unlikely(key.len() != CHACHA20_POLY1305_KEY_LEN)) {
+            throw java_ex(EX_RUNTIME_CRYPTO, "Unsupported key length");
+        }
+        SecureBuffer<uint8_t, CHACHA20_POLY1305_KEY_LEN> keybuf;
+        key.get_bytes(env, keybuf.buf, 0, key.len());
+
+        EVP_AEAD_CTX* ctx = EVP_AEAD_CTX_new(
+            EVP_aead_chacha20_poly1305(), keybuf.buf, CHACHA20_POLY1305_KEY_LEN, CHACHA20_POLY1305_TAG_LEN);
+        if (unlikely(!ctx)) {
+            throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "Failed to create AEAD context");
+        }
+        return reinterpret_cast<jlong>(ctx);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return 0;
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_ChaCha20Poly1305Spi
+ * Method:    seal
+ * Signature: (J[BII[BI[B[BI)I
+ */
+JNIEXPORT jint JNICALL Java_com_amazon_corretto_crypto_provider_ChaCha20Poly1305Spi_seal(JNIEnv* pEnv,
+    jclass,
+    jlong ctxPtr,
+    jbyteArray inputArray,
+    jint inoffset,
+    jint inlen,
+    jbyteArray resultArray,
+    jint resultOffset,
+    jbyteArray nonceArray,
+    jbyteArray aadArray,
+    jint aadSize)
+{
+    try {
+        raii_env env(pEnv);
+
+        EVP_AEAD_CTX* ctx = aead_from_ptr(ctxPtr);
+        java_buffer input = java_buffer::from_array(env, inputArray, inoffset, inlen);
+        java_buffer result = java_buffer::from_array(env, resultArray, resultOffset);
+        java_buffer nonce = java_buffer::from_array(env, nonceArray);
+        java_buffer aad = java_buffer::from_array(env, aadArray, 0, aadSize);
+
+        if (unlikely(result.len() < input.len() + CHACHA20_POLY1305_TAG_LEN)) {
+            throw java_ex(EX_SHORTBUF, "No space for Poly1305 tag");
+        }
+        result = result.subrange(0, input.len() + CHACHA20_POLY1305_TAG_LEN);
+
+        jni_borrow nonceBorrow(env, nonce, "nonce");
+        jni_borrow aadBorrow(env, aad, "aad");
+        jni_borrow inBorrow(env, input, "input");
+        jni_borrow outBorrow(env, result, "result");
+
+        size_t outl = 0;
+        if (unlikely(!EVP_AEAD_CTX_seal(ctx,
+                outBorrow.data(),
+                &outl,
+                outBorrow.len(),
+                nonceBorrow.data(),
+                nonceBorrow.len(),
+                inBorrow.data(),
+                inBorrow.len(),
+                aadBorrow.data(),
+                aadBorrow.len()))) {
+            throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "AEAD seal failed");
+        }
+
+        return (jint)outl;
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return -1;
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_ChaCha20Poly1305Spi
+ * Method:    open
+ * Signature: (J[BII[BI[B[BI)I
+ */
+JNIEXPORT jint JNICALL Java_com_amazon_corretto_crypto_provider_ChaCha20Poly1305Spi_open(JNIEnv* pEnv,
+    jclass,
+    jlong ctxPtr,
+    jbyteArray inputArray,
+    jint inoffset,
+    jint inlen,
+    jbyteArray resultArray,
+    jint resultOffset,
+    jbyteArray nonceArray,
+    jbyteArray aadArray,
+    jint aadSize)
+{
+    try {
+        raii_env env(pEnv);
+
+        EVP_AEAD_CTX* ctx = aead_from_ptr(ctxPtr);
+        java_buffer input = java_buffer::from_array(env, inputArray, inoffset, inlen);
+        java_buffer result = java_buffer::from_array(env, resultArray, resultOffset);
+        java_buffer nonce = java_buffer::from_array(env, nonceArray);
+        java_buffer aad = java_buffer::from_array(env, aadArray, 0, aadSize);
+
+        if (unlikely(input.len() < CHACHA20_POLY1305_TAG_LEN)) {
+            throw java_ex(EX_BADTAG, "Input too short - need tag");
+        }
+        const size_t plaintextLen = input.len() - CHACHA20_POLY1305_TAG_LEN;
+        if (unlikely(result.len() < plaintextLen)) {
+            throw java_ex(EX_SHORTBUF, "Output buffer too small");
+        }
+        // Limit the output to the plaintext so that zeroizing on failure cannot touch anything else.
+        result = result.subrange(0, plaintextLen);
+
+        jni_borrow nonceBorrow(env, nonce, "nonce");
+        jni_borrow aadBorrow(env, aad, "aad");
+        jni_borrow inBorrow(env, input, "input");
+        jni_borrow outBorrow(env, result, "result");
+
+        size_t outl = 0;
+        if (unlikely(!EVP_AEAD_CTX_open(ctx,
+                outBorrow.data(),
+                &outl,
+                outBorrow.len(),
+                nonceBorrow.data(),
+                nonceBorrow.len(),
+                inBorrow.data(),
+                inBorrow.len(),
+                aadBorrow.data(),
+                aadBorrow.len()))) {
+            // Never release unauthenticated plaintext.
+            outBorrow.zeroize();
+            unsigned long errCode = drainOpensslErrors();
+            if (likely(errCode == 0
+                    || (ERR_GET_LIB(errCode) == ERR_LIB_CIPHER && ERR_GET_REASON(errCode) == CIPHER_R_BAD_DECRYPT))) {
+                throw java_ex(EX_BADTAG, "Tag mismatch!");
+            }
+            throw java_ex(EX_RUNTIME_CRYPTO, formatOpensslError(errCode, "AEAD open failed"));
+        }
+
+        return (jint)outl;
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return -1;
+    }
+}
@@ -0,0 +1,183 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+#include "buffer.h"
+#include "env.h"
+#include "file_mapping.h"
+#include "generated-headers.h"
+#include "keyutils.h"
+#include "util.h"
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <memory>
+#include <string>
+
+using namespace AmazonCorrettoCryptoProvider;
+
+namespace {
+
+// A digest or HMAC computation over memory mapped files. Exactly one of md_ctx and hmac_ctx is set.
+struct file_digest_ctx {
+    EVP_MD_CTX* md_ctx;
+    HMAC_CTX* hmac_ctx;
+
+    file_digest_ctx()
+        : md_ctx(nullptr)
+        , hmac_ctx(nullptr)
+    {
+    }
+
+    ~file_digest_ctx()
+    {
+        EVP_MD_CTX_free(md_ctx);
+        HMAC_CTX_free(hmac_ctx);
+    }
+
+    void update(const uint8_t* data, size_t len)
+    {
+        const int rv = md_ctx ? EVP_DigestUpdate(md_ctx, data, len) : HMAC_Update(hmac_ctx, data, len);
+        if (unlikely(rv != 1)) {
+            throw_openssl(EX_RUNTIME_CRYPTO, "Unable to update digest");
+        }
+    }
+};
+
+file_digest_ctx* ctxFromPtr(jlong ctxPtr)
+{
+    if (unlikely(!ctxPtr)) {
+        throw java_ex(EX_NPE, "Null digest context");
+    }
+    return reinterpret_cast<file_digest_ctx*>(ctxPtr);
+}
+
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_utils_FileDigestUtils
+ * Method:    newContext
+ * Signature: (Ljava/lang/String;[B)J
+ *
+ * Returns a new digest context for the named digest, or an HMAC context if hmacKey is not null.
+ */
+JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_utils_FileDigestUtils_newContext(
+    JNIEnv* pEnv, jclass, jstring digestName, jbyteArray hmacKey)
+{
+    try {
+        raii_env env(pEnv);
+
+        const EVP_MD* md = digestFromJstring(env, digestName);
+        std::unique_ptr<file_digest_ctx> ctx(new file_digest_ctx());
+        if (hmacKey == nullptr) {
+            ctx->md_ctx = EVP_MD_CTX_new();
+            if (unlikely(!ctx->md_ctx || EVP_DigestInit_ex(ctx->md_ctx, md, nullptr) != 1)) {
+                throw_openssl(EX_RUNTIME_CRYPTO, "Unable to initialize digest");
+            }
+        } else {
+            ctx->hmac_ctx = HMAC_CTX_new();
+            if (unlikely(!ctx->hmac_ctx)) {
+                throw_openssl(EX_RUNTIME_CRYPTO, "Unable to create HMAC_CTX");
+            }
+            java_buffer keyBuf = java_buffer::from_array(env, hmacKey);
+            jni_borrow key(env, keyBuf, "key");
+            if (unlikely(HMAC_Init_ex(ctx->hmac_ctx, key.data(), key.len(), md, nullptr /* ENGINE */) != 1)) {
+                throw_openssl(EX_RUNTIME_CRYPTO, "Unable to initialize HMAC_CTX");
+            }
+        }
+        return reinterpret_cast<jlong>(ctx.release());
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return 0;
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_utils_FileDigestUtils
+ * Method:    freeContext
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_utils_FileDigestUtils_freeContext(JNIEnv*, jclass, jlong ctxPtr)
+{
+    delete reinterpret_cast<file_digest_ctx*>(ctxPtr);
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_utils_FileDigestUtils
+ * Method:    updateFile
+ * Signature: (J[B)V
+ *
+ * Maps the complete file at the given (not NUL-terminated) path and digests it. Files larger than 2 GiB are mapped
+ * and digested in one go.
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_utils_FileDigestUtils_updateFile(
+    JNIEnv* pEnv, jclass, jlong ctxPtr, jbyteArray pathArray)
+{
+    try {
+        raii_env env(pEnv);
+
+        file_digest_ctx* ctx = ctxFromPtr(ctxPtr);
+        file_mapping mapping(pathFromArray(env, pathArray));
+        if (mapping.len() != 0) {
+            ctx->update(mapping.data(), mapping.len());
+        }
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_utils_FileDigestUtils
+ * Method:    updateMapped
+ * Signature: (JLjava/nio/ByteBuffer;I)V
+ *
+ * Digests the first length bytes of a direct (typically file mapped) buffer in place.
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_utils_FileDigestUtils_updateMapped(
+    JNIEnv* pEnv, jclass, jlong ctxPtr, jobject mapped, jint length)
+{
+    try {
+        raii_env env(pEnv);
+
+        file_digest_ctx* ctx = ctxFromPtr(ctxPtr);
+        const uint8_t* addr = reinterpret_cast<const uint8_t*>(env->GetDirectBufferAddress(mapped));
+        if (unlikely(!addr || length < 0 || env->GetDirectBufferCapacity(mapped) < length)) {
+            throw java_ex(EX_ILLEGAL_ARGUMENT, "Bad mapped buffer");
+        }
+        if (length != 0) {
+            adviseSequential(addr, length);
+            ctx->update(addr, length);
+        }
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_utils_FileDigestUtils
+ * Method:    finish
+ * Signature: (J)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_com_amazon_corretto_crypto_utils_FileDigestUtils_finish(
+    JNIEnv* pEnv, jclass, jlong ctxPtr)
+{
+    try {
+        raii_env env(pEnv);
+
+        file_digest_ctx* ctx = ctxFromPtr(ctxPtr);
+        uint8_t result[EVP_MAX_MD_SIZE];
+        unsigned int resultLen = 0;
+        const int rv = ctx->md_ctx ? EVP_DigestFinal_ex(ctx->md_ctx, result, &resultLen)
+                                   : HMAC_Final(ctx->hmac_ctx, result, &resultLen);
+        if (unlikely(rv != 1)) {
+            throw_openssl(EX_RUNTIME_CRYPTO, "Unable to finish digest");
+        }
+
+        jbyteArray out = env->NewByteArray(resultLen);
+        if (!out) {
+            throw_java_ex(EX_OOM, "Unable to allocate digest array");
+        }
+        env->SetByteArrayRegion(out, 0, resultLen, reinterpret_cast<const jbyte*>(result));
+        return out;
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return nullptr;
+    }
+}
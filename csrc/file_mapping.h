@@ -0,0 +1,117 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+#ifndef FILE_MAPPING_H
+#define FILE_MAPPING_H 1
+
+#include "buffer.h"
+#include "env.h"
+#include "util.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define EX_IO "java/io/IOException"
+
+// Read-only memory mappings of complete files, shared by the utilities which digest or absorb files in place.
+
+namespace AmazonCorrettoCryptoProvider {
+
+inline java_ex io_exception(const char* what, int err)
+{
+    std::string msg(what);
+    msg += ": ";
+    msg += strerror(err);
+    return java_ex(EX_IO, msg);
+}
+
+// Tells the kernel that [addr, addr + len) will be read once, front to back, so that it reads ahead aggressively and
+// may drop pages behind us. Purely advisory.
+inline void adviseSequential(const uint8_t* addr, size_t len)
+{
+    const uintptr_t pageSize = (uintptr_t)sysconf(_SC_PAGESIZE);
+    const uintptr_t start = (uintptr_t)addr & ~(pageSize - 1);
+    madvise((void*)start, (uintptr_t)addr + len - start, MADV_SEQUENTIAL);
+}
+
+// Returns the (not NUL-terminated) native path held by pathArray.
+inline std::string pathFromArray(raii_env& env, jbyteArray pathArray)
+{
+    java_buffer pathBuf = java_buffer::from_array(env, pathArray);
+    std::string path(pathBuf.len(), '\0');
+    pathBuf.get_bytes(env, reinterpret_cast<uint8_t*>(&path[0]), 0, pathBuf.len());
+    if (path.find('\0') != std::string::npos) {
+        throw java_ex(EX_IO, "Invalid file path");
+    }
+    return path;
+}
+
+// Owns a read-only file descriptor and mapping of a complete file. Both are released by the destructor, so the
+// mapping never outlives the call which created it.
+class file_mapping {
+    int fd_;
+    void* addr_;
+    size_t len_;
+
+public:
+    explicit file_mapping(const std::string& path)
+        : fd_(-1)
+        , addr_(MAP_FAILED)
+        , len_(0)
+    {
+        do {
+            fd_ = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        } while (fd_ < 0 && errno == EINTR);
+        if (fd_ < 0) {
+            throw io_exception("Unable to open file", errno);
+        }
+        // The destructor does not run when the constructor throws, so the descriptor is closed here.
+        try {
+            struct stat st;
+            if (fstat(fd_, &st) != 0) {
+                throw io_exception("Unable to stat file", errno);
+            }
+            if (!S_ISREG(st.st_mode)) {
+                throw java_ex(EX_IO, "Not a regular file");
+            }
+            len_ = (size_t)st.st_size;
+            // Empty files cannot be mapped, and need not be.
+            if (len_ != 0) {
+                addr_ = mmap(nullptr, len_, PROT_READ, MAP_PRIVATE, fd_, 0);
+                if (addr_ == MAP_FAILED) {
+                    throw io_exception("Unable to map file", errno);
+                }
+                adviseSequential(data(), len_);
+            }
+        } catch (...) {
+            close(fd_);
+            throw;
+        }
+    }
+
+    ~file_mapping()
+    {
+        if (addr_ != MAP_FAILED) {
+            munmap(addr_, len_);
+        }
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+
+    // deleting copy & move operations to satisfy rule of five
+    file_mapping(const file_mapping&) = delete;
+    file_mapping& operator=(const file_mapping&) = delete;
+    file_mapping(file_mapping&&) = delete;
+    file_mapping& operator=(file_mapping&&) = delete;
+
+    const uint8_t* data() const { return reinterpret_cast<const uint8_t*>(addr_); }
+    size_t len() const { return len_; }
+};
+
+}
+
+#endif
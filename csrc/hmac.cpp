@@ -2,8 +2,11 @@
 // SPDX-License-Identifier: Apache-2.0
 #include "buffer.h"
 #include "env.h"
+#include "keyutils.h"
 #include "util.h"
+#include <openssl/crypto.h>
 #include <openssl/hmac.h>
+#include <vector>
 
 #define DO_NOT_INIT  -1
 #define DO_NOT_REKEY -2
@@ -102,6 +105,137 @@ jint get_precomputed_key_size(raii_env& env, jstring digestName)
 #endif
     return 0; // just to please the static verifier, since throw_java_ex always throws an exception
 }
+
+// Owns one keyed HMAC_CTX per distinct key of a batch.
+class hmac_ctx_list {
+    std::vector<HMAC_CTX*> ctxs_;
+
+public:
+    ~hmac_ctx_list()
+    {
+        for (HMAC_CTX* ctx : ctxs_) {
+            HMAC_CTX_free(ctx);
+        }
+    }
+
+    HMAC_CTX* add()
+    {
+        HMAC_CTX* ctx = HMAC_CTX_new();
+        if (unlikely(!ctx)) {
+            throw java_ex(EX_OOM, "Unable to allocate HMAC context");
+        }
+        ctxs_.push_back(ctx);
+        return ctx;
+    }
+
+    HMAC_CTX* operator[](size_t idx) const { return ctxs_[idx]; }
+};
+
+/*
+ * Computes the HMAC of every message of a batch. Message i is inputArr[offsets[i], offsets[i] + lengths[i]) and is
+ * keyed with keys[keyIndices[i]]. Each distinct key is set up once and every message then starts from a copy of it.
+ *
+ * If verifiedArr is null, the MACs are written back to back to tagsArr. Otherwise tagsArr holds the expected MACs,
+ * laid out the same way, and bit i of verifiedArr is set iff MAC i matches. Comparisons are constant time and
+ * do not stop at the first mismatch.
+ */
+void hmac_batch(raii_env& env,
+    jstring digestName,
+    jobjectArray keysArr,
+    jintArray keyIndicesArr,
+    jbyteArray inputArr,
+    jintArray offsetsArr,
+    jintArray lengthsArr,
+    jbyteArray tagsArr,
+    jlongArray verifiedArr)
+{
+    const EVP_MD* md = digestFromJstring(env, digestName);
+    const size_t macLen = EVP_MD_size(md);
+
+    const jsize count = env->GetArrayLength(keyIndicesArr);
+    if (unlikely(env->GetArrayLength(offsetsArr) != count || env->GetArrayLength(lengthsArr) != count)) {
+        throw java_ex(EX_ILLEGAL_ARGUMENT, "Mismatched batch lengths");
+    }
+    std::vector<jint> keyIndices(count);
+    std::vector<jint> offsets(count);
+    std::vector<jint> lengths(count);
+    env->GetIntArrayRegion(keyIndicesArr, 0, count, keyIndices.data());
+    env->GetIntArrayRegion(offsetsArr, 0, count, offsets.data());
+    env->GetIntArrayRegion(lengthsArr, 0, count, lengths.data());
+    env.rethrow_java_exception();
+
+    // Key everything up front: once the input is borrowed below, no further JNI calls may be made.
+    const jsize keyCount = env->GetArrayLength(keysArr);
+    hmac_ctx_list keyed;
+    for (jsize k = 0; k < keyCount; k++) {
+        jbyteArray keyArr = (jbyteArray)env->GetObjectArrayElement(keysArr, k);
+        if (unlikely(!keyArr)) {
+            throw java_ex(EX_NPE, "Null key");
+        }
+        {
+            java_buffer keyBuf = java_buffer::from_array(env, keyArr);
+            jni_borrow key(env, keyBuf, "key");
+            if (unlikely(HMAC_Init_ex(keyed.add(), key.data(), key.len(), md, nullptr /* ENGINE */) != 1)) {
+                throw_openssl("Unable to initialize HMAC_CTX");
+            }
+        }
+        env->DeleteLocalRef(keyArr);
+    }
+
+    const java_buffer input = java_buffer::from_array(env, inputArr);
+    const java_buffer tags = java_buffer::from_array(env, tagsArr);
+    for (jsize i = 0; i < count; i++) {
+        if (unlikely(keyIndices[i] < 0 || keyIndices[i] >= keyCount)) {
+            throw java_ex(EX_ARRAYOOB, "Key index out of range");
+        }
+        // Throws if the message lies outside of the input.
+        input.subrange(offsets[i], lengths[i]);
+    }
+    tags.subrange(0, macLen * count);
+    if (count == 0) {
+        return;
+    }
+    std::vector<jlong> verified;
+    if (verifiedArr) {
+        if (unlikely((size_t)env->GetArrayLength(verifiedArr) < ((size_t)count + 63) / 64)) {
+            throw java_ex(EX_ARRAYOOB, "Result bitmap too small");
+        }
+        verified.resize(((size_t)count + 63) / 64);
+    }
+
+    HMAC_CTX ctx;
+    HMAC_CTX_init(&ctx);
+    bool failed = false;
+    {
+        jni_borrow inputBorrow(env, input, "input");
+        jni_borrow tagsBorrow(env, tags, "tags");
+        for (jsize i = 0; i < count; i++) {
+            uint8_t mac[EVP_MAX_MD_SIZE];
+            unsigned int outLen = sizeof(mac);
+            failed = HMAC_CTX_copy_ex(&ctx, keyed[keyIndices[i]]) != 1
+                || HMAC_Update(&ctx, inputBorrow.data() + offsets[i], lengths[i]) != 1
+                || HMAC_Final(&ctx, mac, &outLen) != 1;
+            if (unlikely(failed)) {
+                break;
+            }
+            uint8_t* tag = tagsBorrow.data() + macLen * i;
+            if (verifiedArr) {
+                const jlong match = CRYPTO_memcmp(mac, tag, macLen) == 0;
+                verified[i / 64] |= match << (i % 64);
+            } else {
+                memcpy(tag, mac, macLen);
+            }
+            OPENSSL_cleanse(mac, sizeof(mac));
+        }
+    }
+    HMAC_CTX_cleanup(&ctx);
+    if (unlikely(failed)) {
+        throw_openssl("Unable to compute HMAC");
+    }
+    if (verifiedArr) {
+        env->SetLongArrayRegion(verifiedArr, 0, verified.size(), verified.data());
+    }
+}
 } // anonymous namespace
 
 #ifdef __cplusplus
@@ -147,6 +281,34 @@ JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_EvpHmac_updateCt
     }
 }
 
+/*
+ * Class:     com_amazon_corretto_crypto_provider_EvpHmac
+ * Method:    updateCtxDirect
+ * Signature: ([B[BJLjava/nio/ByteBuffer;Z)V
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_EvpHmac_updateCtxDirect(JNIEnv* pEnv,
+    jclass,
+    jbyteArray ctxArr,
+    jbyteArray keyArr,
+    jlong evpMd,
+    jobject inputDirectBuf,
+    jboolean usePrecomputedKey)
+{
+    try {
+        raii_env env(pEnv);
+        bounce_buffer<HMAC_CTX> ctx = bounce_buffer<HMAC_CTX>::from_array(env, ctxArr);
+
+        java_buffer inputBuf = java_buffer::from_direct(env, inputDirectBuf);
+
+        maybe_init_ctx(env, ctx, keyArr, evpMd, usePrecomputedKey);
+
+        jni_borrow input(env, inputBuf, "input");
+        update_ctx(env, ctx, input);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
+
 /*
  * Class:     com_amazon_corretto_crypto_provider_EvpHmac
  * Method:    doFinal
@@ -275,6 +437,53 @@ JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_HmacWithPrecompu
     }
 }
 
+/*
+ * Class:     com_amazon_corretto_crypto_utils_HmacBatchUtils
+ * Method:    computeInternal
+ * Signature: (Ljava/lang/String;[[B[I[B[I[I[B)V
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_utils_HmacBatchUtils_computeInternal(JNIEnv* pEnv,
+    jclass,
+    jstring digestName,
+    jobjectArray keys,
+    jintArray keyIndices,
+    jbyteArray input,
+    jintArray offsets,
+    jintArray lengths,
+    jbyteArray tags)
+{
+    try {
+        raii_env env(pEnv);
+        hmac_batch(env, digestName, keys, keyIndices, input, offsets, lengths, tags, nullptr);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_utils_HmacBatchUtils
+ * Method:    verifyInternal
+ * Signature: (Ljava/lang/String;[[B[I[B[I[I[B[J)V
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_utils_HmacBatchUtils_verifyInternal(JNIEnv* pEnv,
+    jclass,
+    jstring digestName,
+    jobjectArray keys,
+    jintArray keyIndices,
+    jbyteArray input,
+    jintArray offsets,
+    jintArray lengths,
+    jbyteArray tags,
+    jlongArray verified)
+{
+    try {
+        raii_env env(pEnv);
+        hmac_batch(env, digestName, keys, keyIndices, input, offsets, lengths, tags, verified);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,421 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+#include "buffer.h"
+#include "env.h"
+#include "generated-headers.h"
+#include "util.h"
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
+#include <openssl/sha.h>
+#include <algorithm> // for std::max
+#include <cstring>
+#include <list>
+#include <pthread.h>
+#include <vector>
+
+// Detect the support of precomputed keys as hmac.cpp does
+#ifdef HMAC_SHA256_PRECOMPUTED_KEY_SIZE
+#define HMAC_PRECOMPUTED_KEY_SUPPORT 1
+#endif
+
+using namespace AmazonCorrettoCryptoProvider;
+
+/*
+ * Process-wide cache of keyed HMAC templates: HMAC_CTXs on which HMAC_Init_ex (or HMAC_Init_from_precomputed_key)
+ * has been run once and which are never modified afterwards. Each message then starts with a copy of the template
+ * state instead of hashing the padded key again, and the per-Mac context lives in native memory so that neither the
+ * template nor the context is ever bounced through a Java array.
+ *
+ * As in aes_gcm_key_cache.cpp, entries are identified by an HMAC of the digest, key type and key under a random
+ * per-process secret, and are reference counted: the cache holds one reference while the entry is in the LRU list
+ * and each Java-side HmacKeyCache.Entry holds another.
+ */
+namespace {
+struct hmac_key_entry {
+    uint8_t tag[SHA256_DIGEST_LENGTH];
+    HMAC_CTX* ctx;
+    size_t refs;
+};
+
+pthread_mutex_t cache_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_once_t secret_once = PTHREAD_ONCE_INIT;
+uint8_t tag_secret[SHA256_DIGEST_LENGTH];
+bool tag_secret_ok = false;
+// Most recently used entries are at the front.
+std::list<hmac_key_entry*> cache_lru;
+
+class cache_guard {
+public:
+    cache_guard() { pthread_mutex_lock(&cache_lock); }
+    ~cache_guard() { pthread_mutex_unlock(&cache_lock); }
+};
+
+void init_tag_secret() { tag_secret_ok = RAND_bytes(tag_secret, sizeof(tag_secret)) == 1; }
+
+// Must be called with cache_lock held.
+void unref_locked(hmac_key_entry* entry)
+{
+    if (--entry->refs == 0) {
+        HMAC_CTX_free(entry->ctx);
+        OPENSSL_cleanse(entry->tag, sizeof(entry->tag));
+        delete entry;
+    }
+}
+
+// Must be called with cache_lock held. On a hit, the entry is moved to the front and a reference is taken.
+hmac_key_entry* find_locked(const uint8_t* tag)
+{
+    for (auto it = cache_lru.begin(); it != cache_lru.end(); ++it) {
+        if (!CRYPTO_memcmp((*it)->tag, tag, SHA256_DIGEST_LENGTH)) {
+            hmac_key_entry* entry = *it;
+            cache_lru.splice(cache_lru.begin(), cache_lru, it);
+            entry->refs++;
+            return entry;
+        }
+    }
+    return nullptr;
+}
+
+hmac_key_entry* entry_from_ptr(jlong ptr)
+{
+    if (unlikely(!ptr)) {
+        throw java_ex(EX_NPE, "Null key cache entry");
+    }
+    return reinterpret_cast<hmac_key_entry*>(ptr);
+}
+
+HMAC_CTX* ctx_from_ptr(jlong ptr)
+{
+    if (unlikely(!ptr)) {
+        throw java_ex(EX_NPE, "Null context");
+    }
+    return reinterpret_cast<HMAC_CTX*>(ptr);
+}
+
+void init_from_entry(HMAC_CTX* ctx, const hmac_key_entry* entry)
+{
+    // The template is never modified after creation, so it can be copied without holding the lock.
+    if (unlikely(HMAC_CTX_copy_ex(ctx, entry->ctx) != 1)) {
+        throw_openssl("Unable to copy HMAC template");
+    }
+}
+
+void update_from_array(raii_env& env, HMAC_CTX* ctx, jbyteArray inputArr, jint offset, jint len)
+{
+    java_buffer inputBuf = java_buffer::from_array(env, inputArr, offset, len);
+    jni_borrow input(env, inputBuf, "input");
+    if (unlikely(HMAC_Update(ctx, input.data(), input.len()) != 1)) {
+        throw_openssl("Unable to update HMAC_CTX");
+    }
+}
+
+void update_from_direct(raii_env& env, HMAC_CTX* ctx, jobject inputDirectBuf)
+{
+    java_buffer inputBuf = java_buffer::from_direct(env, inputDirectBuf);
+    jni_borrow input(env, inputBuf, "input");
+    if (unlikely(HMAC_Update(ctx, input.data(), input.len()) != 1)) {
+        throw_openssl("Unable to update HMAC_CTX");
+    }
+}
+
+void final_to_array(raii_env& env, HMAC_CTX* ctx, jbyteArray resultArr)
+{
+    uint8_t scratch[EVP_MAX_MD_SIZE];
+    unsigned int macSize = EVP_MAX_MD_SIZE;
+    if (unlikely(HMAC_Final(ctx, scratch, &macSize) != 1)) {
+        throw_openssl("Unable to finish HMAC_CTX");
+    }
+    java_buffer resultBuf = java_buffer::from_array(env, resultArr);
+    resultBuf.put_bytes(env, scratch, 0, macSize);
+}
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_HmacKeyCache
+ * Method:    acquireEntry
+ * Signature: (IJ[BZ)J
+ */
+JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_HmacKeyCache_acquireEntry(
+    JNIEnv* pEnv, jclass, jint capacity, jlong evpMd, jbyteArray keyArray, jboolean usePrecomputedKey)
+{
+    try {
+        raii_env env(pEnv);
+
+        const EVP_MD* md = reinterpret_cast<const EVP_MD*>(evpMd);
+        if (unlikely(!md)) {
+            throw java_ex(EX_NPE, "Null digest");
+        }
+        java_buffer keyBuf = java_buffer::from_array(env, keyArray);
+        // HMAC keys have no maximum length, so this is the one place where key material is copied to the heap.
+        std::vector<uint8_t> key(keyBuf.len());
+        struct key_cleanse {
+            std::vector<uint8_t>& key;
+            ~key_cleanse() { OPENSSL_cleanse(key.data(), key.size()); }
+        } cleanse { key };
+        keyBuf.get_bytes(env, key.data(), 0, key.size());
+
+        pthread_once(&secret_once, init_tag_secret);
+        if (unlikely(!tag_secret_ok)) {
+            throw java_ex(EX_RUNTIME_CRYPTO, "Unable to initialize key cache");
+        }
+        // The tag covers the digest and the key type, so the same bytes used with another digest, or as a
+        // precomputed key, get a separate entry.
+        const uint8_t prefix[5] = { (uint8_t)(EVP_MD_type(md) >> 24), (uint8_t)(EVP_MD_type(md) >> 16),
+            (uint8_t)(EVP_MD_type(md) >> 8), (uint8_t)EVP_MD_type(md), (uint8_t)(usePrecomputedKey ? 1 : 0) };
+        uint8_t tag[SHA256_DIGEST_LENGTH];
+        unsigned int tagLen = sizeof(tag);
+        HMAC_CTX tagCtx;
+        HMAC_CTX_init(&tagCtx);
+        const bool tagged = HMAC_Init_ex(&tagCtx, tag_secret, sizeof(tag_secret), EVP_sha256(), nullptr) == 1
+            && HMAC_Update(&tagCtx, prefix, sizeof(prefix)) == 1 && HMAC_Update(&tagCtx, key.data(), key.size()) == 1
+            && HMAC_Final(&tagCtx, tag, &tagLen) == 1;
+        HMAC_CTX_cleanup(&tagCtx);
+        if (unlikely(!tagged)) {
+            throw_openssl("Unable to compute key cache tag");
+        }
+
+        {
+            cache_guard guard;
+            hmac_key_entry* hit = find_locked(tag);
+            if (hit) {
+                return reinterpret_cast<jlong>(hit);
+            }
+        }
+
+        // Build the new template outside of the lock; keying is exactly the cost we want to keep off of
+        // the critical section.
+        HMAC_CTX* ctx = HMAC_CTX_new();
+        if (unlikely(!ctx)) {
+            throw java_ex(EX_OOM, "Unable to allocate HMAC context");
+        }
+        int keyed;
+        if (usePrecomputedKey) {
+#ifdef HMAC_PRECOMPUTED_KEY_SUPPORT
+            keyed = HMAC_Init_from_precomputed_key(ctx, key.data(), key.size(), md);
+#else
+            HMAC_CTX_free(ctx);
+            throw java_ex(EX_ERROR, "Precomputed keys are not supported on this platform/build");
+#endif
+        } else {
+            keyed = HMAC_Init_ex(ctx, key.data(), key.size(), md, nullptr /* ENGINE */);
+        }
+        if (unlikely(keyed != 1)) {
+            HMAC_CTX_free(ctx);
+            throw_openssl("Unable to initialize HMAC_CTX");
+        }
+
+        cache_guard guard;
+        // Another thread may have inserted the same key while we were unlocked.
+        hmac_key_entry* hit = find_locked(tag);
+        if (hit) {
+            HMAC_CTX_free(ctx);
+            return reinterpret_cast<jlong>(hit);
+        }
+
+        hmac_key_entry* entry = new hmac_key_entry;
+        memcpy(entry->tag, tag, sizeof(tag));
+        entry->ctx = ctx;
+        entry->refs = 2; // One for the cache and one for the caller
+        cache_lru.push_front(entry);
+
+        while (cache_lru.size() > (size_t)std::max(capacity, 1)) {
+            hmac_key_entry* evicted = cache_lru.back();
+            cache_lru.pop_back();
+            unref_locked(evicted);
+        }
+
+        return reinterpret_cast<jlong>(entry);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return 0;
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_HmacKeyCache
+ * Method:    releaseEntry
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_HmacKeyCache_releaseEntry(
+    JNIEnv*, jclass, jlong entryPtr)
+{
+    if (!entryPtr) {
+        return;
+    }
+    cache_guard guard;
+    unref_locked(reinterpret_cast<hmac_key_entry*>(entryPtr));
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_HmacKeyCache
+ * Method:    newContext
+ * Signature: ()J
+ */
+JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_HmacKeyCache_newContext(JNIEnv* pEnv, jclass)
+{
+    HMAC_CTX* ctx = HMAC_CTX_new();
+    if (unlikely(!ctx)) {
+        java_ex(EX_OOM, "Unable to allocate HMAC context").throw_to_java(pEnv);
+        return 0;
+    }
+    return reinterpret_cast<jlong>(ctx);
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_HmacKeyCache
+ * Method:    copyContext
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_HmacKeyCache_copyContext(
+    JNIEnv* pEnv, jclass, jlong ctxPtr)
+{
+    try {
+        HMAC_CTX* original = ctx_from_ptr(ctxPtr);
+        HMAC_CTX* ctx = HMAC_CTX_new();
+        if (unlikely(!ctx)) {
+            throw java_ex(EX_OOM, "Unable to allocate HMAC context");
+        }
+        // A context which has not started a message yet has nothing worth copying.
+        if (HMAC_CTX_get_md(original) && unlikely(HMAC_CTX_copy_ex(ctx, original) != 1)) {
+            HMAC_CTX_free(ctx);
+            throw_openssl("Unable to copy HMAC_CTX");
+        }
+        return reinterpret_cast<jlong>(ctx);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return 0;
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_HmacKeyCache
+ * Method:    freeContext
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_HmacKeyCache_freeContext(JNIEnv*, jclass, jlong ctxPtr)
+{
+    HMAC_CTX_free(reinterpret_cast<HMAC_CTX*>(ctxPtr));
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_HmacKeyCache
+ * Method:    initUpdate
+ * Signature: (JJ[BII)V
+ *
+ * Starts a new message on the context from the keyed template and absorbs input[offset, offset + len).
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_HmacKeyCache_initUpdate(
+    JNIEnv* pEnv, jclass, jlong entryPtr, jlong ctxPtr, jbyteArray inputArr, jint offset, jint len)
+{
+    try {
+        raii_env env(pEnv);
+
+        HMAC_CTX* ctx = ctx_from_ptr(ctxPtr);
+        init_from_entry(ctx, entry_from_ptr(entryPtr));
+        update_from_array(env, ctx, inputArr, offset, len);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_HmacKeyCache
+ * Method:    update
+ * Signature: (J[BII)V
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_HmacKeyCache_update(
+    JNIEnv* pEnv, jclass, jlong ctxPtr, jbyteArray inputArr, jint offset, jint len)
+{
+    try {
+        raii_env env(pEnv);
+
+        update_from_array(env, ctx_from_ptr(ctxPtr), inputArr, offset, len);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_HmacKeyCache
+ * Method:    initUpdateDirect
+ * Signature: (JJLjava/nio/ByteBuffer;)V
+ *
+ * As initUpdate, but absorbs the remaining bytes of a direct ByteBuffer.
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_HmacKeyCache_initUpdateDirect(
+    JNIEnv* pEnv, jclass, jlong entryPtr, jlong ctxPtr, jobject inputDirectBuf)
+{
+    try {
+        raii_env env(pEnv);
+
+        HMAC_CTX* ctx = ctx_from_ptr(ctxPtr);
+        init_from_entry(ctx, entry_from_ptr(entryPtr));
+        update_from_direct(env, ctx, inputDirectBuf);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_HmacKeyCache
+ * Method:    updateDirect
+ * Signature: (JLjava/nio/ByteBuffer;)V
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_HmacKeyCache_updateDirect(
+    JNIEnv* pEnv, jclass, jlong ctxPtr, jobject inputDirectBuf)
+{
+    try {
+        raii_env env(pEnv);
+
+        update_from_direct(env, ctx_from_ptr(ctxPtr), inputDirectBuf);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_HmacKeyCache
+ * Method:    doFinal
+ * Signature: (J[B)V
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_HmacKeyCache_doFinal(
+    JNIEnv* pEnv, jclass, jlong ctxPtr, jbyteArray resultArr)
+{
+    try {
+        raii_env env(pEnv);
+
+        final_to_array(env, ctx_from_ptr(ctxPtr), resultArr);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_HmacKeyCache
+ * Method:    fastHmac
+ * Signature: (JJ[BII[B)V
+ *
+ * Computes the HMAC of a complete message with a single call: copy of the template, update and final.
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_HmacKeyCache_fastHmac(JNIEnv* pEnv,
+    jclass,
+    jlong entryPtr,
+    jlong ctxPtr,
+    jbyteArray inputArr,
+    jint offset,
+    jint len,
+    jbyteArray resultArr)
+{
+    try {
+        raii_env env(pEnv);
+
+        HMAC_CTX* ctx = ctx_from_ptr(ctxPtr);
+        init_from_entry(ctx, entry_from_ptr(entryPtr));
+        update_from_array(env, ctx, inputArr, offset, len);
+        final_to_array(env, ctx, resultArr);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
@@ -0,0 +1,237 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+#include "auto_free.h"
+#include "buffer.h"
+#include "env.h"
+#include "generated-headers.h"
+#include "util.h"
+#include <openssl/evp.h>
+
+/*
+ * Bindings for SHA-3 and SHAKE. Unlike the SHA-2 family (see hash_template.cpp.template), AWS-LC only exposes its
+ * Keccak implementation through EVP, whose state is not a flat structure and so cannot be kept in a Java byte[].
+ * Contexts therefore live on the native heap and are owned by a NativeResource. Messages small enough to be buffered
+ * by the Java side are digested in a single call which never hands a context to Java.
+ */
+
+// Keep in sync with the algorithm codes in SHA3Spi.java
+#define SHA3_224_CODE 0
+#define SHA3_256_CODE 1
+#define SHA3_384_CODE 2
+#define SHA3_512_CODE 3
+#define SHAKE128_CODE 4
+#define SHAKE256_CODE 5
+
+// Inputs up to this size are copied to the stack rather than pinned. This is the SHA3-224 rate.
+#define SHA3_SCRATCH_SIZE 144
+
+using namespace AmazonCorrettoCryptoProvider;
+
+namespace {
+
+const EVP_MD* sha3Digest(jint algorithm)
+{
+    switch (algorithm) {
+    case SHA3_224_CODE:
+        return EVP_sha3_224();
+    case SHA3_256_CODE:
+        return EVP_sha3_256();
+    case SHA3_384_CODE:
+        return EVP_sha3_384();
+    case SHA3_512_CODE:
+        return EVP_sha3_512();
+    case SHAKE128_CODE:
+        return EVP_shake128();
+    case SHAKE256_CODE:
+        return EVP_shake256();
+    default:
+        throw java_ex(EX_ILLEGAL_ARGUMENT, "Unsupported SHA-3 algorithm");
+    }
+}
+
+bool isXof(jint algorithm) { return algorithm == SHAKE128_CODE || algorithm == SHAKE256_CODE; }
+
+// Finishes ctx, writing outLen bytes to out. outLen must be the digest length for fixed length digests.
+void sha3Final(EVP_MD_CTX* ctx, bool xof, uint8_t* out, size_t outLen)
+{
+    const int rv = xof ? EVP_DigestFinalXOF(ctx, out, outLen) : EVP_DigestFinal_ex(ctx, out, nullptr);
+    if (unlikely(rv != 1)) {
+        throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "Unable to finish digest");
+    }
+}
+
+void checkOutputLength(const EVP_MD* md, bool xof, jint outLen)
+{
+    if (unlikely(outLen <= 0 || (!xof && (size_t)outLen != EVP_MD_size(md)))) {
+        throw java_ex(EX_ILLEGAL_ARGUMENT, "Bad digest output length");
+    }
+}
+
+void updateFromArray(raii_env& env, EVP_MD_CTX* ctx, jbyteArray dataArray, jint offset, jint length)
+{
+    java_buffer dataBuf = java_buffer::from_array(env, dataArray, offset, length);
+    jni_borrow data(env, dataBuf, "data");
+    if (unlikely(EVP_DigestUpdate(ctx, data.data(), data.len()) != 1)) {
+        throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "Unable to update context");
+    }
+}
+
+EVP_MD_CTX* ctxFromPtr(jlong ctxPtr)
+{
+    if (unlikely(!ctxPtr)) {
+        throw java_ex(EX_NPE, "Null context");
+    }
+    return reinterpret_cast<EVP_MD_CTX*>(ctxPtr);
+}
+
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_SHA3Spi
+ * Method:    fastDigest
+ * Signature: (I[BI[BII)V
+ *
+ * One-shot digest of data[offset, offset + length) into the first outLen bytes of digestArray.
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_SHA3Spi_fastDigest(JNIEnv* pEnv,
+    jclass,
+    jint algorithm,
+    jbyteArray digestArray,
+    jint outLen,
+    jbyteArray dataArray,
+    jint offset,
+    jint length)
+{
+    try {
+        raii_env env(pEnv);
+
+        const EVP_MD* md = sha3Digest(algorithm);
+        const bool xof = isXof(algorithm);
+        checkOutputLength(md, xof, outLen);
+
+        EVP_MD_CTX_auto ctx;
+        if (unlikely(!ctx.set(EVP_MD_CTX_new()) || EVP_DigestInit_ex(ctx, md, nullptr) != 1)) {
+            throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "Unable to initialize context");
+        }
+        if (length > SHA3_SCRATCH_SIZE) {
+            updateFromArray(env, ctx, dataArray, offset, length);
+        } else {
+            SecureBuffer<uint8_t, SHA3_SCRATCH_SIZE> scratch;
+            env->GetByteArrayRegion(dataArray, offset, length, reinterpret_cast<jbyte*>(scratch.buf));
+            env.rethrow_java_exception();
+            if (unlikely(EVP_DigestUpdate(ctx, scratch, length) != 1)) {
+                throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "Unable to update context");
+            }
+        }
+
+        java_buffer digestBuf = java_buffer::from_array(env, digestArray, 0, outLen);
+        jni_borrow digest(env, digestBuf, "digest");
+        sha3Final(ctx, xof, digest.data(), digest.len());
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_SHA3Spi
+ * Method:    initUpdate
+ * Signature: (I[BII)J
+ *
+ * Returns a new native context which has absorbed data[offset, offset + length).
+ */
+JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_SHA3Spi_initUpdate(
+    JNIEnv* pEnv, jclass, jint algorithm, jbyteArray dataArray, jint offset, jint length)
+{
+    try {
+        raii_env env(pEnv);
+
+        const EVP_MD* md = sha3Digest(algorithm);
+        EVP_MD_CTX_auto ctx;
+        if (unlikely(!ctx.set(EVP_MD_CTX_new()) || EVP_DigestInit_ex(ctx, md, nullptr) != 1)) {
+            throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "Unable to initialize context");
+        }
+        updateFromArray(env, ctx, dataArray, offset, length);
+        return reinterpret_cast<jlong>(ctx.take());
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return 0;
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_SHA3Spi
+ * Method:    update
+ * Signature: (J[BII)V
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_SHA3Spi_update(
+    JNIEnv* pEnv, jclass, jlong ctxPtr, jbyteArray dataArray, jint offset, jint length)
+{
+    try {
+        raii_env env(pEnv);
+
+        updateFromArray(env, ctxFromPtr(ctxPtr), dataArray, offset, length);
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_SHA3Spi
+ * Method:    finish
+ * Signature: (JI[BI)V
+ *
+ * Writes outLen bytes of output to digestArray[0, outLen) and frees the context, whether or not this succeeds.
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_SHA3Spi_finish(
+    JNIEnv* pEnv, jclass, jlong ctxPtr, jint algorithm, jbyteArray digestArray, jint outLen)
+{
+    EVP_MD_CTX_auto ctx = EVP_MD_CTX_auto::from(reinterpret_cast<EVP_MD_CTX*>(ctxPtr));
+    try {
+        raii_env env(pEnv);
+
+        if (unlikely(!ctx.isInitialized())) {
+            throw java_ex(EX_NPE, "Null context");
+        }
+        const bool xof = isXof(algorithm);
+        checkOutputLength(EVP_MD_CTX_md(ctx), xof, outLen);
+
+        java_buffer digestBuf = java_buffer::from_array(env, digestArray, 0, outLen);
+        jni_borrow digest(env, digestBuf, "digest");
+        sha3Final(ctx, xof, digest.data(), digest.len());
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_SHA3Spi
+ * Method:    cloneContext
+ * Signature: (J)J
+ */
+JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_SHA3Spi_cloneContext(
+    JNIEnv* pEnv, jclass, jlong ctxPtr)
+{
+    try {
+        raii_env env(pEnv);
+
+        EVP_MD_CTX* original = ctxFromPtr(ctxPtr);
+        EVP_MD_CTX_auto copy;
+        if (unlikely(!copy.set(EVP_MD_CTX_new()) || EVP_MD_CTX_copy_ex(copy, original) != 1)) {
+            throw java_ex::from_openssl(EX_RUNTIME_CRYPTO, "Unable to clone context");
+        }
+        return reinterpret_cast<jlong>(copy.take());
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return 0;
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_SHA3Spi
+ * Method:    freeContext
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_SHA3Spi_freeContext(JNIEnv*, jclass, jlong ctxPtr)
+{
+    EVP_MD_CTX_free(reinterpret_cast<EVP_MD_CTX*>(ctxPtr));
+}
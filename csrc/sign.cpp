@@ -5,10 +5,18 @@
 #include "generated-headers.h"
 #include "keyutils.h"
 #include "util.h"
+#include <openssl/bn.h>
+#include <openssl/ec_key.h>
+#include <openssl/ecdsa.h>
 #include <openssl/err.h>
 #include <openssl/evp.h>
 #include <openssl/rsa.h>
 #include <openssl/sha.h>
+#include <algorithm>
+#include <climits>
+#include <deque>
+#include <memory>
+#include <pthread.h>
 #include <vector>
 
 using namespace AmazonCorrettoCryptoProvider;
@@ -139,6 +147,40 @@ bool initializeContext(raii_env& env,
     return true;
 }
 
+// Initializes ctx as a copy of a template built by newContextTemplate. The template already holds a reference to the
+// key and a fully initialized digest context; EVP_MD_CTX_copy_ex also duplicates its EVP_PKEY_CTX, so the padding
+// configuration is carried over. Templates are never modified after creation, so they may be copied concurrently.
+void initializeFromTemplate(EvpKeyContext* ctx, EvpKeyContext* tmpl)
+{
+    ctx->setKey(tmpl->get1Key());
+    if (!ctx->setDigestCtx(EVP_MD_CTX_create())) {
+        throw_openssl("Unable to create MD_CTX");
+    }
+    if (EVP_MD_CTX_copy_ex(ctx->getDigestCtx(), tmpl->getDigestCtx()) != 1) {
+        throw_openssl("Unable to copy signature context template");
+    }
+}
+
+// Initializes ctx either from the template at templatePtr or, if there is none, from scratch.
+void startContext(raii_env& env,
+    EvpKeyContext* ctx,
+    bool signMode,
+    jlong templatePtr,
+    jlong pKey,
+    jlong mdPtr,
+    jint paddingType,
+    jlong mgfMdPtr,
+    jint pssSaltLen,
+    bool preHash)
+{
+    if (templatePtr) {
+        initializeFromTemplate(ctx, reinterpret_cast<EvpKeyContext*>(templatePtr));
+    } else {
+        initializeContext(env, ctx, signMode, reinterpret_cast<EVP_PKEY*>(pKey), reinterpret_cast<const EVP_MD*>(mdPtr),
+            paddingType, reinterpret_cast<const EVP_MD*>(mgfMdPtr), pssSaltLen, preHash);
+    }
+}
+
 void update(raii_env& env, EvpKeyContext* ctx, EVP_GENERIC_UPDATE_t func, java_buffer messageBuf)
 {
     if (!ctx) {
@@ -178,11 +220,491 @@ void bufferUpdate(JNIEnv* pEnv, EvpKeyContext* ctx, EVP_GENERIC_UPDATE_t func, j
     }
 }
 
+// A signing operation whose output goes to memory chosen by the caller. sign() follows the contract of
+// EVP_DigestSignFinal: |*sigLen| holds the space available at |sig| and receives the length of the signature.
+class signer {
+public:
+    virtual ~signer() { }
+    // Returns the largest signature this operation may produce
+    virtual size_t maxLength() = 0;
+    virtual void sign(uint8_t* sig, size_t* sigLen) = 0;
+};
+
+// Finishes a streaming signature held by an EvpKeyContext.
+class digest_final_signer : public signer {
+public:
+    explicit digest_final_signer(EvpKeyContext* ctx)
+        : ctx_(ctx)
+    {
+    }
+
+    size_t maxLength()
+    {
+        size_t sigLength = 0;
+        if (!EVP_DigestSignFinal(ctx_->getDigestCtx(), NULL, &sigLength)) {
+            throw_openssl("Unable to get signature length");
+        }
+        return sigLength;
+    }
+
+    void sign(uint8_t* sig, size_t* sigLen)
+    {
+        if (!EVP_DigestSignFinal(ctx_->getDigestCtx(), sig, sigLen)) {
+            // If signature fails due to sizing concerns, give an informative exception
+            const uint32_t lastErr = ERR_peek_last_error();
+            if ((lastErr & RSA_R_DATA_TOO_LARGE_FOR_KEY_SIZE) == RSA_R_DATA_TOO_LARGE_FOR_KEY_SIZE
+                || (lastErr & RSA_R_DIGEST_TOO_BIG_FOR_RSA_KEY) == RSA_R_DIGEST_TOO_BIG_FOR_RSA_KEY) {
+                drainOpensslErrors();
+                throw_java_ex(EX_SIGNATURE_EXCEPTION, formatOpensslError(lastErr, "UNUSED"));
+            } else {
+                throw_openssl("Unable to sign");
+            }
+        }
+    }
+
+private:
+    EvpKeyContext* ctx_;
+};
+
+// Signs a whole message without digesting it first, either with a one-shot EVP_DigestSign (EdDSA and ML-DSA) or
+// with EVP_PKEY_sign over a caller-supplied digest.
+class raw_signer : public signer {
+public:
+    raw_signer(raii_env& env, EvpKeyContext* ctx, java_buffer message, bool oneShot)
+        : env_(env)
+        , ctx_(ctx)
+        , message_(message)
+        , oneShot_(oneShot)
+    {
+    }
+
+    size_t maxLength()
+    {
+        size_t sigLength = 0;
+        sign(NULL, &sigLength);
+        return sigLength;
+    }
+
+    void sign(uint8_t* sig, size_t* sigLen)
+    {
+        const size_t available = *sigLen;
+        jni_borrow message(env_, message_, "message");
+
+        if (oneShot_) {
+            if (!EVP_DigestSign(ctx_->getDigestCtx(), sig, sigLen, message.data(), message.len())) {
+                throw_openssl("Signature failed");
+            }
+        } else if (EVP_PKEY_sign(ctx_->getKeyCtx(), sig, sigLen, message.data(), message.len()) <= 0) {
+            throw_openssl("Signature failed");
+        }
+
+        if (sig && *sigLen > available) {
+            env_.fatal_error("Unexpected buffer overflow");
+        }
+    }
+
+private:
+    raii_env& env_;
+    EvpKeyContext* ctx_;
+    java_buffer message_;
+    bool oneShot_;
+};
+
+// Signs a message held in native memory with a one-shot EVP_DigestSign (EdDSA and ML-DSA).
+class one_shot_signer : public signer {
+public:
+    one_shot_signer(EvpKeyContext* ctx, const uint8_t* message, size_t messageLen)
+        : ctx_(ctx)
+        , message_(message)
+        , messageLen_(messageLen)
+    {
+    }
+
+    size_t maxLength()
+    {
+        size_t sigLength = 0;
+        sign(NULL, &sigLength);
+        return sigLength;
+    }
+
+    void sign(uint8_t* sig, size_t* sigLen)
+    {
+        if (!EVP_DigestSign(ctx_->getDigestCtx(), sig, sigLen, message_, messageLen_)) {
+            throw_openssl("Signature failed");
+        }
+    }
+
+private:
+    EvpKeyContext* ctx_;
+    const uint8_t* message_;
+    size_t messageLen_;
+};
+
+// Returns the length of each of r and s in an IEEE P1363 signature under |key|, which is that of the group order.
+size_t p1363NumLength(EVP_PKEY* key)
+{
+    const EC_KEY* ecKey = EVP_PKEY_get0_EC_KEY(key);
+    if (!ecKey) {
+        throw_java_ex(EX_SIGNATURE_EXCEPTION, "P1363 format signatures require an EC key");
+    }
+    return BN_num_bytes(EC_GROUP_get0_order(EC_KEY_get0_group(ecKey)));
+}
+
+// Re-encodes the DER ECDSA signatures of |inner| as the fixed-length IEEE P1363 concatenation r||s.
+class p1363_signer : public signer {
+public:
+    p1363_signer(signer& inner, size_t numLen)
+        : inner_(inner)
+        , numLen_(numLen)
+    {
+    }
+
+    size_t maxLength() { return 2 * numLen_; }
+
+    void sign(uint8_t* sig, size_t* sigLen)
+    {
+        if (*sigLen < 2 * numLen_) {
+            throw_java_ex(EX_SIGNATURE_EXCEPTION, "Output buffer too small for signature");
+        }
+
+        size_t derLength = inner_.maxLength();
+        std::vector<uint8_t, SecureAlloc<uint8_t> > der(derLength);
+        inner_.sign(&der[0], &derLength);
+
+        ECDSA_SIG_auto parsed = ECDSA_SIG_auto::from(ECDSA_SIG_from_bytes(&der[0], derLength));
+        if (!parsed.isInitialized()) {
+            throw_openssl("Unable to parse signature");
+        }
+        const BIGNUM* r;
+        const BIGNUM* s;
+        ECDSA_SIG_get0(parsed, &r, &s);
+        if (!BN_bn2bin_padded(sig, numLen_, r) || !BN_bn2bin_padded(sig + numLen_, numLen_, s)) {
+            throw_openssl("Unable to encode signature");
+        }
+        *sigLen = 2 * numLen_;
+    }
+
+private:
+    signer& inner_;
+    size_t numLen_;
+};
+
+// Encodes the IEEE P1363 signature r||s as DER into |der|, which must be freed with OPENSSL_free.
+void p1363ToDer(EVP_PKEY* key, const uint8_t* sig, size_t sigLen, uint8_t** der, size_t* derLen)
+{
+    const size_t numLen = p1363NumLength(key);
+    if (sigLen != 2 * numLen) {
+        throw_java_ex(EX_SIGNATURE_EXCEPTION, "P1363 signature of invalid length");
+    }
+
+    ECDSA_SIG_auto parsed = ECDSA_SIG_auto::from(ECDSA_SIG_new());
+    if (!parsed.isInitialized()) {
+        throw_openssl(EX_OOM, "Unable to allocate signature");
+    }
+    BIGNUM* r = BN_bin2bn(sig, numLen, NULL);
+    BIGNUM* s = BN_bin2bn(sig + numLen, numLen, NULL);
+    if (!r || !s || !ECDSA_SIG_set0(parsed, r, s)) {
+        BN_free(r);
+        BN_free(s);
+        throw_openssl("Unable to decode signature");
+    }
+    if (!ECDSA_SIG_to_bytes(der, derLen, parsed)) {
+        throw_openssl("Unable to encode signature");
+    }
+}
+
+// Interprets the result of a signature verification. Mismatched signatures are not an error case, so they return false
+// instead of throwing per JCA convention.
+bool verificationResult(int result, int keyType)
+{
+    if (likely(result == 1)) {
+        return true;
+    }
+    unsigned long errorCode = drainOpensslErrors();
+
+    if (ECDSA_R_MISMATCHED_SIGNATURE == (errorCode & ECDSA_R_MISMATCHED_SIGNATURE)
+        || RSA_R_MISMATCHED_SIGNATURE == (errorCode & RSA_R_MISMATCHED_SIGNATURE)
+        || EVP_R_INVALID_SIGNATURE == (errorCode & EVP_R_INVALID_SIGNATURE)) {
+        return false;
+    }
+
+    // JCA/JCA requires us to try to throw an exception on corrupted signatures, but only if it isn't an RSA
+    // signature
+    if (errorCode != 0 && keyType != EVP_PKEY_RSA) {
+        throw_java_ex(EX_SIGNATURE_EXCEPTION, formatOpensslError(errorCode, "Unknown error verifying signature"));
+    }
+
+    return false;
+}
+
+// ECDSA signatures are DER encoded, so the size query only bounds their length. Every other supported key type
+// produces signatures of exactly the queried length.
+bool hasFixedSignatureLength(EVP_PKEY* key) { return EVP_PKEY_id(key) != EVP_PKEY_EC; }
+
+// Returns the signature as a new Java array. When its length is known up front, the signature is written straight
+// into the array instead of going through a temporary buffer.
+jbyteArray signToNewArray(raii_env& env, signer& op, bool fixedLength)
+{
+    size_t sigLength = op.maxLength();
+
+    if (fixedLength) {
+        jbyteArray signature = env->NewByteArray(sigLength);
+        if (!signature) {
+            throw_java_ex(EX_OOM, "Unable to allocate signature array");
+        }
+        const size_t expected = sigLength;
+        {
+            jni_borrow sig(env, java_buffer::from_array(env, signature), "signature");
+            op.sign(sig.data(), &sigLength);
+        }
+        if (unlikely(sigLength != expected)) {
+            throw_java_ex(EX_RUNTIME_CRYPTO, "Unexpected signature length");
+        }
+        return signature;
+    }
+
+    std::vector<uint8_t, SecureAlloc<uint8_t> > tmpSig(sigLength);
+    op.sign(&tmpSig[0], &sigLength);
+    tmpSig.resize(sigLength);
+    return vecToArray(env, tmpSig);
+}
+
+// Writes the signature to the start of |out| and returns its length. Only signatures which might not fit in |out|
+// but still could (short ECDSA signatures) go through a temporary buffer.
+size_t signToBuffer(raii_env& env, signer& op, bool fixedLength, java_buffer out)
+{
+    size_t sigLength = op.maxLength();
+
+    if (out.len() >= sigLength) {
+        jni_borrow sig(env, out, "signature");
+        sigLength = sig.len();
+        op.sign(sig.data(), &sigLength);
+        return sigLength;
+    }
+    if (fixedLength) {
+        // Fail before spending a private key operation on a signature which cannot be returned
+        throw_java_ex(EX_SIGNATURE_EXCEPTION, "Output buffer too small for signature");
+    }
+
+    std::vector<uint8_t, SecureAlloc<uint8_t> > tmpSig(sigLength);
+    op.sign(&tmpSig[0], &sigLength);
+    if (sigLength > out.len()) {
+        throw_java_ex(EX_SIGNATURE_EXCEPTION, "Output buffer too small for signature");
+    }
+    out.put_bytes(env, &tmpSig[0], 0, sigLength);
+    return sigLength;
+}
+
+// Whether raw signatures with this key are computed over the whole message rather than a supplied digest.
+bool isOneShotRawSignature(EVP_PKEY* key, bool preHash)
+{
+    int keyType = EVP_PKEY_id(key);
+#if defined(FIPS_BUILD) && !defined(EXPERIMENTAL_FIPS_BUILD)
+    (void)preHash;
+    return keyType == EVP_PKEY_ED25519;
+#else
+    return !preHash && (keyType == EVP_PKEY_ED25519 || keyType == EVP_PKEY_PQDSA);
+#endif
+}
+
+// Key types accepted by SignatureBatchUtils, which cannot see the native EVP_PKEY ids.
+enum batch_key_type { BATCH_KEY_RSA = 0, BATCH_KEY_EC = 1, BATCH_KEY_ED25519 = 2 };
+
+// Owns the distinct public keys of a verification batch.
+class pkey_list {
+public:
+    pkey_list() { }
+    ~pkey_list()
+    {
+        for (size_t i = 0; i < keys_.size(); i++) {
+            EVP_PKEY_free(keys_[i]);
+        }
+    }
+    void add(EVP_PKEY* key) { keys_.push_back(key); }
+    size_t size() const { return keys_.size(); }
+    EVP_PKEY* const* data() const { return keys_.data(); }
+
+private:
+    std::vector<EVP_PKEY*> keys_;
+
+    pkey_list(const pkey_list&) DELETE_IMPLICIT;
+    pkey_list& operator=(const pkey_list&) DELETE_IMPLICIT;
+};
+
+// Verifies a contiguous run of a signature batch. Workers never touch the JNIEnv, and only ever write to their own
+// slice of |valid|.
+struct verify_run {
+    const EVP_MD* md;
+    EVP_PKEY* const* keys;
+    const jint* keyIndices;
+    const uint8_t* input;
+    const jint* offsets;
+    const jint* lengths;
+    const uint8_t* signatures;
+    const jint* sigOffsets;
+    const jint* sigLengths;
+    uint8_t* valid;
+    size_t first;
+    size_t end;
+    bool ok;
+};
+
+void* verify_run_worker(void* arg)
+{
+    verify_run* run = reinterpret_cast<verify_run*>(arg);
+
+    run->ok = false;
+    EVP_MD_CTX* ctx = EVP_MD_CTX_new();
+    if (ctx != nullptr) {
+        run->ok = true;
+        for (size_t i = run->first; i < run->end; i++) {
+            EVP_PKEY* key = run->keys[run->keyIndices[i]];
+            EVP_PKEY_CTX* pctx;
+            // Failing to set up the context is an error, while a failed verification just marks the signature invalid.
+            if (EVP_MD_CTX_reset(ctx) != 1 || EVP_DigestVerifyInit(ctx, &pctx, run->md, nullptr, key) != 1
+                || (EVP_PKEY_base_id(key) == EVP_PKEY_RSA
+                    && EVP_PKEY_CTX_set_rsa_padding(pctx, RSA_PKCS1_PADDING) <= 0)) {
+                run->ok = false;
+                break;
+            }
+            run->valid[i] = EVP_DigestVerify(ctx, run->signatures + run->sigOffsets[i], run->sigLengths[i],
+                                run->input + run->offsets[i], run->lengths[i])
+                == 1;
+        }
+        EVP_MD_CTX_free(ctx);
+    }
+    // The error queue is thread-local and invalid signatures leave errors on it. Failures are reported generically by
+    // the calling thread.
+    ERR_clear_error();
+    return nullptr;
+}
+
+std::vector<jint> getIntArray(raii_env& env, jintArray array, jsize count)
+{
+    if (unlikely(!array)) {
+        throw java_ex(EX_NPE, "Null batch array");
+    }
+    if (unlikely(env->GetArrayLength(array) != count)) {
+        throw java_ex(EX_ILLEGAL_ARGUMENT, "Mismatched batch lengths");
+    }
+    std::vector<jint> result(count);
+    env->GetIntArrayRegion(array, 0, count, result.data());
+    env.rethrow_java_exception();
+    return result;
+}
+
+// A signature or verification queued by AsyncSignatures. Everything it needs is copied out of the Java heap when it
+// is submitted, so no Java array stays pinned while it waits or runs.
+struct async_job {
+    async_job(EVP_PKEY* key, const EVP_MD* md, int paddingType, bool p1363, bool verify)
+        : key(key)
+        , md(md)
+        , paddingType(paddingType)
+        , p1363(p1363)
+        , verify(verify)
+        , future(NULL)
+    {
+        EVP_PKEY_up_ref(key);
+    }
+    ~async_job() { EVP_PKEY_free(key); }
+
+    EVP_PKEY* key;
+    const EVP_MD* md;
+    int paddingType;
+    bool p1363;
+    bool verify;
+    std::vector<uint8_t> message;
+    std::vector<uint8_t> signature;
+    // Global reference to the CompletableFuture, deleted by whoever completes or drops the job
+    jobject future;
+
+private:
+    async_job(const async_job&) DELETE_IMPLICIT;
+    async_job& operator=(const async_job&) DELETE_IMPLICIT;
+};
+
+// Jobs waiting for a worker. The queue is bounded by the caller of async_submit so that a burst of requests fails
+// fast instead of buffering unbounded copies of their messages.
+pthread_mutex_t async_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t async_ready = PTHREAD_COND_INITIALIZER;
+std::deque<async_job*> async_queue;
+
+bool async_submit(async_job* job, size_t maxQueued)
+{
+    pthread_mutex_lock(&async_lock);
+    const bool accepted = async_queue.size() < maxQueued;
+    if (accepted) {
+        async_queue.push_back(job);
+        pthread_cond_signal(&async_ready);
+    }
+    pthread_mutex_unlock(&async_lock);
+    return accepted;
+}
+
+async_job* async_take()
+{
+    pthread_mutex_lock(&async_lock);
+    while (async_queue.empty()) {
+        pthread_cond_wait(&async_ready, &async_lock);
+    }
+    async_job* job = async_queue.front();
+    async_queue.pop_front();
+    pthread_mutex_unlock(&async_lock);
+    return job;
+}
+
+void copyFromArray(raii_env& env, std::vector<uint8_t>& dest, jbyteArray array, jint offset, jint length)
+{
+    java_buffer buf = java_buffer::from_array(env, array, offset, length);
+    dest.resize(buf.len());
+    if (!dest.empty()) {
+        buf.get_bytes(env, &dest[0], 0, dest.size());
+    }
+}
+
+jbyteArray asyncSign(raii_env& env, async_job& job)
+{
+    EvpKeyContext ctx;
+    initializeContext(env, &ctx, true, job.key, job.md, job.paddingType, nullptr, 0, false);
+
+    if (isOneShotRawSignature(ctx.getKey(), false)) {
+        one_shot_signer op(&ctx, job.message.data(), job.message.size());
+        return signToNewArray(env, op, true);
+    }
+
+    if (!EVP_DigestSignUpdate(ctx.getDigestCtx(), job.message.data(), job.message.size())) {
+        throw_openssl("Unable to update signature");
+    }
+    digest_final_signer op(&ctx);
+    if (job.p1363) {
+        p1363_signer p1363Op(op, p1363NumLength(ctx.getKey()));
+        return signToNewArray(env, p1363Op, true);
+    }
+    return signToNewArray(env, op, hasFixedSignatureLength(ctx.getKey()));
+}
+
+bool asyncVerify(raii_env& env, async_job& job)
+{
+    EvpKeyContext ctx;
+    initializeContext(env, &ctx, false, job.key, job.md, job.paddingType, nullptr, 0, false);
+
+    const uint8_t* sig = job.signature.data();
+    size_t sigLen = job.signature.size();
+    OPENSSL_buffer_auto der;
+    if (job.p1363) {
+        p1363ToDer(ctx.getKey(), sig, sigLen, &der, &sigLen);
+        sig = der;
+    }
+    const int result = EVP_DigestVerify(ctx.getDigestCtx(), sig, sigLen, job.message.data(), job.message.size());
+    return verificationResult(result, EVP_PKEY_base_id(ctx.getKey()));
+}
+
 } // Anonymous namespace
 
 JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignature_signStart(JNIEnv* pEnv,
     jclass,
     jlong pKey,
+    jlong templatePtr,
     jlong mdPtr,
     jint paddingType,
     jboolean preHash,
@@ -197,10 +719,9 @@ JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignature_si
 
         EvpKeyContext ctx;
 
-        initializeContext(env, &ctx,
+        startContext(env, &ctx,
             true, // true->sign
-            reinterpret_cast<EVP_PKEY*>(pKey), reinterpret_cast<const EVP_MD*>(mdPtr), paddingType,
-            reinterpret_cast<const EVP_MD*>(mgfMdPtr), pssSaltLen, preHash);
+            templatePtr, pKey, mdPtr, paddingType, mgfMdPtr, pssSaltLen, preHash);
 
         update(env, &ctx, digestSignUpdate, java_buffer::from_array(env, message, offset, length));
         return reinterpret_cast<jlong>(ctx.moveToHeap());
@@ -213,6 +734,7 @@ JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignature_si
 JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignature_signStartBuffer(JNIEnv* pEnv,
     jclass,
     jlong pKey,
+    jlong templatePtr,
     jlong mdPtr,
     jint paddingType,
     jboolean preHash,
@@ -225,10 +747,9 @@ JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignature_si
 
         EvpKeyContext ctx;
 
-        initializeContext(env, &ctx,
+        startContext(env, &ctx,
             true, // true->sign
-            reinterpret_cast<EVP_PKEY*>(pKey), reinterpret_cast<const EVP_MD*>(mdPtr), paddingType,
-            reinterpret_cast<const EVP_MD*>(mgfMdPtr), pssSaltLen, preHash);
+            templatePtr, pKey, mdPtr, paddingType, mgfMdPtr, pssSaltLen, preHash);
         update(env, &ctx, digestSignUpdate, java_buffer::from_direct(env, message));
 
         return reinterpret_cast<jlong>(ctx.moveToHeap());
@@ -241,6 +762,7 @@ JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignature_si
 JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignature_verifyStart(JNIEnv* pEnv,
     jclass,
     jlong pKey,
+    jlong templatePtr,
     jlong mdPtr,
     jint paddingType,
     jboolean preHash,
@@ -255,10 +777,9 @@ JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignature_ve
 
         EvpKeyContext ctx;
 
-        initializeContext(env, &ctx,
+        startContext(env, &ctx,
             false, // false->verify
-            reinterpret_cast<EVP_PKEY*>(pKey), reinterpret_cast<const EVP_MD*>(mdPtr), paddingType,
-            reinterpret_cast<const EVP_MD*>(mgfMdPtr), pssSaltLen, preHash);
+            templatePtr, pKey, mdPtr, paddingType, mgfMdPtr, pssSaltLen, preHash);
         update(env, &ctx, digestVerifyUpdate, java_buffer::from_array(env, message, offset, length));
 
         return reinterpret_cast<jlong>(ctx.moveToHeap());
@@ -271,6 +792,7 @@ JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignature_ve
 JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignature_verifyStartBuffer(JNIEnv* pEnv,
     jclass,
     jlong pKey,
+    jlong templatePtr,
     jlong mdPtr,
     jint paddingType,
     jboolean preHash,
@@ -283,10 +805,9 @@ JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignature_ve
 
         EvpKeyContext ctx;
 
-        initializeContext(env, &ctx,
+        startContext(env, &ctx,
             false, // false->verify
-            reinterpret_cast<EVP_PKEY*>(pKey), reinterpret_cast<const EVP_MD*>(mdPtr), paddingType,
-            reinterpret_cast<const EVP_MD*>(mgfMdPtr), pssSaltLen, preHash);
+            templatePtr, pKey, mdPtr, paddingType, mgfMdPtr, pssSaltLen, preHash);
         update(env, &ctx, digestVerifyUpdate, java_buffer::from_direct(env, message));
 
         return reinterpret_cast<jlong>(ctx.moveToHeap());
@@ -320,6 +841,40 @@ JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignature_ver
     bufferUpdate(pEnv, reinterpret_cast<EvpKeyContext*>(ctxPtr), digestVerifyUpdate, message);
 }
 
+/*
+ * Class:     com_amazon_corretto_crypto_provider_EvpSignature
+ * Method:    newContextTemplate
+ * Signature: (JZJIZJI)J
+ */
+JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignature_newContextTemplate(JNIEnv* pEnv,
+    jclass,
+    jlong pKey,
+    jboolean signMode,
+    jlong mdPtr,
+    jint paddingType,
+    jboolean preHash,
+    jlong mgfMdPtr,
+    jint pssSaltLen)
+{
+    try {
+        raii_env env(pEnv);
+
+        EvpKeyContext ctx;
+
+        initializeContext(env, &ctx, signMode, reinterpret_cast<EVP_PKEY*>(pKey),
+            reinterpret_cast<const EVP_MD*>(mdPtr), paddingType, reinterpret_cast<const EVP_MD*>(mgfMdPtr), pssSaltLen,
+            preHash);
+        if (!ctx.getDigestCtx()) {
+            throw_java_ex(EX_ILLEGAL_STATE, "Signature context templates require a digest context");
+        }
+
+        return reinterpret_cast<jlong>(ctx.moveToHeap());
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return 0;
+    }
+}
+
 /*
  * Class:     com_amazon_corretto_crypto_provider_EvpSignature
  * Method:    sign
@@ -328,27 +883,29 @@ JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignature_ver
 JNIEXPORT jbyteArray JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignature_sign(JNIEnv* pEnv,
     jclass clazz,
     jlong pKey,
+    jlong templatePtr,
     jlong mdPtr,
     jint paddingType,
     jboolean preHash,
     jlong mgfMdPtr,
     jint pssSaltLen,
+    jboolean p1363,
     jbyteArray message,
     jint offset,
     jint length)
 {
     jlong ctx = Java_com_amazon_corretto_crypto_provider_EvpSignature_signStart(
-        pEnv, clazz, pKey, mdPtr, paddingType, preHash, mgfMdPtr, pssSaltLen, message, offset, length);
+        pEnv, clazz, pKey, templatePtr, mdPtr, paddingType, preHash, mgfMdPtr, pssSaltLen, message, offset, length);
 
     if (unlikely(pEnv->ExceptionCheck())) {
         return NULL;
     }
 
-    return Java_com_amazon_corretto_crypto_provider_EvpSignature_signFinish(pEnv, clazz, ctx);
+    return Java_com_amazon_corretto_crypto_provider_EvpSignature_signFinish(pEnv, clazz, ctx, p1363);
 }
 
 JNIEXPORT jboolean JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignature_verifyFinish(
-    JNIEnv* pEnv, jclass, jlong ctxPtr, jbyteArray signature, jint sigOff, jint sigLen)
+    JNIEnv* pEnv, jclass, jlong ctxPtr, jboolean p1363, jbyteArray signature, jint sigOff, jint sigLen)
 {
     EvpKeyContext* ctx = reinterpret_cast<EvpKeyContext*>(ctxPtr);
 
@@ -358,38 +915,27 @@ JNIEXPORT jboolean JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignature
         if (!ctxPtr) {
             throw_java_ex(EX_NPE, "Null context");
         }
+        // Freed on every path, including malformed P1363 signatures
+        std::unique_ptr<EvpKeyContext> owner(ctx);
 
         int keyType = EVP_PKEY_base_id(ctx->getKey());
         // might throw
         java_buffer signatureBuf = java_buffer::from_array(env, signature, sigOff, sigLen);
         jni_borrow sigBorrow(env, signatureBuf, "signature");
 
-        int result = EVP_DigestVerifyFinal(ctx->getDigestCtx(), sigBorrow.data(), sigBorrow.len());
-
-        delete ctx;
-
-        if (likely(result == 1)) {
-            return true;
+        int result;
+        if (p1363) {
+            OPENSSL_buffer_auto der;
+            size_t derLen = 0;
+            p1363ToDer(ctx->getKey(), sigBorrow.data(), sigBorrow.len(), &der, &derLen);
+            result = EVP_DigestVerifyFinal(ctx->getDigestCtx(), der, derLen);
         } else {
-            unsigned long errorCode = drainOpensslErrors();
-
-            // Mismatched signatures are not an error case, so return false
-            // instead of throwing per JCA convention.
-            if (ECDSA_R_MISMATCHED_SIGNATURE == (errorCode & ECDSA_R_MISMATCHED_SIGNATURE)
-                || RSA_R_MISMATCHED_SIGNATURE == (errorCode & RSA_R_MISMATCHED_SIGNATURE)
-                || EVP_R_INVALID_SIGNATURE == (errorCode & EVP_R_INVALID_SIGNATURE)) {
-                return false;
-            }
+            result = EVP_DigestVerifyFinal(ctx->getDigestCtx(), sigBorrow.data(), sigBorrow.len());
+        }
 
-            // JCA/JCA requires us to try to throw an exception on corrupted signatures, but only if it isn't an RSA
-            // signature
-            if (errorCode != 0 && keyType != EVP_PKEY_RSA) {
-                throw_java_ex(
-                    EX_SIGNATURE_EXCEPTION, formatOpensslError(errorCode, "Unknown error verifying signature"));
-            }
+        owner.reset();
 
-            return false;
-        }
+        return verificationResult(result, keyType);
     } catch (java_ex& ex) {
         ex.throw_to_java(pEnv);
         return false;
@@ -397,7 +943,7 @@ JNIEXPORT jboolean JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignature
 }
 
 JNIEXPORT jbyteArray JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignature_signFinish(
-    JNIEnv* pEnv, jclass, jlong ctxPtr)
+    JNIEnv* pEnv, jclass, jlong ctxPtr, jboolean p1363)
 {
     EvpKeyContext* ctx = reinterpret_cast<EvpKeyContext*>(ctxPtr);
     jbyteArray signature = NULL;
@@ -408,40 +954,90 @@ JNIEXPORT jbyteArray JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignatu
         if (!ctx) {
             throw_java_ex(EX_NPE, "Null context");
         }
+        // The Java side has already released its handle, so this is the only owner even when signing or the P1363
+        // re-encoding fails
+        std::unique_ptr<EvpKeyContext> owner(ctx);
+
+        digest_final_signer op(ctx);
+        if (p1363) {
+            p1363_signer p1363Op(op, p1363NumLength(ctx->getKey()));
+            signature = signToNewArray(env, p1363Op, true);
+        } else {
+            signature = signToNewArray(env, op, hasFixedSignatureLength(ctx->getKey()));
+        }
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
 
-        size_t sigLength = 0;
-        std::vector<uint8_t, SecureAlloc<uint8_t> > tmpSig;
+    return signature;
+}
 
-        if (!EVP_DigestSignFinal(ctx->getDigestCtx(), NULL, &sigLength)) {
-            throw_openssl("Unable to get signature length");
-        }
+/*
+ * Class:     com_amazon_corretto_crypto_provider_EvpSignature
+ * Method:    signFinishInto
+ * Signature: (JZ[BII)I
+ */
+JNIEXPORT jint JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignature_signFinishInto(
+    JNIEnv* pEnv, jclass, jlong ctxPtr, jboolean p1363, jbyteArray outArr, jint outOff, jint outLen)
+{
+    EvpKeyContext* ctx = reinterpret_cast<EvpKeyContext*>(ctxPtr);
+    jint sigLength = 0;
 
-        tmpSig.resize(sigLength);
+    try {
+        raii_env env(pEnv);
 
-        if (!EVP_DigestSignFinal(ctx->getDigestCtx(), &tmpSig[0], &sigLength)) {
-            // If signature fails due to sizing concerns, give an informative exception
-            const uint32_t lastErr = ERR_peek_last_error();
-            if ((lastErr & RSA_R_DATA_TOO_LARGE_FOR_KEY_SIZE) == RSA_R_DATA_TOO_LARGE_FOR_KEY_SIZE
-                || (lastErr & RSA_R_DIGEST_TOO_BIG_FOR_RSA_KEY) == RSA_R_DIGEST_TOO_BIG_FOR_RSA_KEY) {
-                drainOpensslErrors();
-                throw_java_ex(EX_SIGNATURE_EXCEPTION, formatOpensslError(lastErr, "UNUSED"));
-            } else {
-                throw_openssl("Unable to sign");
-            }
+        if (!ctx) {
+            throw_java_ex(EX_NPE, "Null context");
         }
-
-        if (!(signature = env->NewByteArray(sigLength))) {
-            throw_java_ex(EX_OOM, "Unable to allocate signature array");
+        // Freed on every path, including output ranges too small for the signature and P1363 re-encoding failures
+        std::unique_ptr<EvpKeyContext> owner(ctx);
+
+        java_buffer outBuf = java_buffer::from_array(env, outArr, outOff, outLen);
+        digest_final_signer op(ctx);
+        if (p1363) {
+            p1363_signer p1363Op(op, p1363NumLength(ctx->getKey()));
+            sigLength = signToBuffer(env, p1363Op, true, outBuf);
+        } else {
+            sigLength = signToBuffer(env, op, hasFixedSignatureLength(ctx->getKey()), outBuf);
         }
-        // This may throw, if it does we'll just keep the exception state as we return.
-        env->SetByteArrayRegion(signature, 0, sigLength, (jbyte*)&tmpSig[0]);
-
-        delete ctx;
     } catch (java_ex& ex) {
         ex.throw_to_java(pEnv);
     }
 
-    return signature;
+    return sigLength;
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_EvpSignature
+ * Method:    signInto
+ * Signature: (JJJIZJIZ[BII[BII)I
+ */
+JNIEXPORT jint JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignature_signInto(JNIEnv* pEnv,
+    jclass clazz,
+    jlong pKey,
+    jlong templatePtr,
+    jlong mdPtr,
+    jint paddingType,
+    jboolean preHash,
+    jlong mgfMdPtr,
+    jint pssSaltLen,
+    jboolean p1363,
+    jbyteArray message,
+    jint offset,
+    jint length,
+    jbyteArray outArr,
+    jint outOff,
+    jint outLen)
+{
+    jlong ctx = Java_com_amazon_corretto_crypto_provider_EvpSignature_signStart(
+        pEnv, clazz, pKey, templatePtr, mdPtr, paddingType, preHash, mgfMdPtr, pssSaltLen, message, offset, length);
+
+    if (unlikely(pEnv->ExceptionCheck())) {
+        return 0;
+    }
+
+    return Java_com_amazon_corretto_crypto_provider_EvpSignature_signFinishInto(
+        pEnv, clazz, ctx, p1363, outArr, outOff, outLen);
 }
 
 /*
@@ -452,11 +1048,13 @@ JNIEXPORT jbyteArray JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignatu
 JNIEXPORT jboolean JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignature_verify(JNIEnv* pEnv,
     jclass clazz,
     jlong pKey,
+    jlong templatePtr,
     jlong mdPtr,
     jint paddingType,
     jboolean preHash,
     jlong mgfMdPtr,
     jint pssSaltLen,
+    jboolean p1363,
     jbyteArray message,
     jint offset,
     jint length,
@@ -465,14 +1063,14 @@ JNIEXPORT jboolean JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignature
     jint sigLen)
 {
     jlong ctx = Java_com_amazon_corretto_crypto_provider_EvpSignature_verifyStart(
-        pEnv, clazz, pKey, mdPtr, paddingType, preHash, mgfMdPtr, pssSaltLen, message, offset, length);
+        pEnv, clazz, pKey, templatePtr, mdPtr, paddingType, preHash, mgfMdPtr, pssSaltLen, message, offset, length);
 
     if (unlikely(pEnv->ExceptionCheck())) {
         return false;
     }
 
     return Java_com_amazon_corretto_crypto_provider_EvpSignature_verifyFinish(
-        pEnv, clazz, ctx, signature, sigOff, sigLen);
+        pEnv, clazz, ctx, p1363, signature, sigOff, sigLen);
 }
 
 JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignatureBase_destroyContext(
@@ -495,60 +1093,60 @@ JNIEXPORT jbyteArray JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignatu
     try {
         raii_env env(pEnv);
         java_buffer messageBuf = java_buffer::from_array(env, messageArr, offset, length);
+        EVP_PKEY* key = reinterpret_cast<EVP_PKEY*>(pKey);
 
         EvpKeyContext ctx;
         initializeContext(env, &ctx,
             true, // true->sign
-            reinterpret_cast<EVP_PKEY*>(pKey),
+            key,
             nullptr, // No message digest
             paddingType, reinterpret_cast<const EVP_MD*>(mgfMdPtr), pssSaltLen, preHash);
 
-        std::vector<uint8_t, SecureAlloc<uint8_t> > signature;
-        size_t sigLength;
-
-        int keyType = EVP_PKEY_id(reinterpret_cast<EVP_PKEY*>(pKey));
-
-#if defined(FIPS_BUILD) && !defined(EXPERIMENTAL_FIPS_BUILD)
-        if (keyType == EVP_PKEY_ED25519) {
-#else
-        if (!preHash && (keyType == EVP_PKEY_ED25519 || keyType == EVP_PKEY_PQDSA)) {
-#endif
-            jni_borrow message(env, messageBuf, "message");
-
-            if (!EVP_DigestSign(ctx.getDigestCtx(), NULL, &sigLength, message.data(), message.len())) {
-                throw_openssl("Signature failed");
-            }
-
-            signature.resize(sigLength);
-
-            if (!EVP_DigestSign(ctx.getDigestCtx(), &signature[0], &sigLength, message.data(), message.len())) {
-                throw_openssl("Signature failed");
-            }
-
-            signature.resize(sigLength);
-        } else {
-            jni_borrow message(env, messageBuf, "message");
-
-            if (EVP_PKEY_sign(ctx.getKeyCtx(), NULL, &sigLength, message.data(), message.len()) <= 0) {
-                throw_openssl("Signature failed");
-            }
-
-            signature.resize(sigLength);
+        raw_signer op(env, &ctx, messageBuf, isOneShotRawSignature(key, preHash));
+        return signToNewArray(env, op, hasFixedSignatureLength(key));
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return NULL;
+    }
+}
 
-            if (EVP_PKEY_sign(ctx.getKeyCtx(), &signature[0], &sigLength, message.data(), message.len()) <= 0) {
-                throw_openssl("Signature failed");
-            }
+/*
+ * Class:     com_amazon_corretto_crypto_provider_EvpSignatureRaw
+ * Method:    signRawInto
+ * Signature: (JIZJI[BII[BII)I
+ */
+JNIEXPORT jint JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignatureRaw_signRawInto(JNIEnv* pEnv,
+    jclass clazz,
+    jlong pKey,
+    jint paddingType,
+    jboolean preHash,
+    jlong mgfMdPtr,
+    jint pssSaltLen,
+    jbyteArray messageArr,
+    jint offset,
+    jint length,
+    jbyteArray outArr,
+    jint outOff,
+    jint outLen)
+{
+    try {
+        raii_env env(pEnv);
+        java_buffer messageBuf = java_buffer::from_array(env, messageArr, offset, length);
+        java_buffer outBuf = java_buffer::from_array(env, outArr, outOff, outLen);
+        EVP_PKEY* key = reinterpret_cast<EVP_PKEY*>(pKey);
 
-            if (signature.size() < sigLength) {
-                pEnv->FatalError("Unexpected buffer overflow");
-            }
+        EvpKeyContext ctx;
+        initializeContext(env, &ctx,
+            true, // true->sign
+            key,
+            nullptr, // No message digest
+            paddingType, reinterpret_cast<const EVP_MD*>(mgfMdPtr), pssSaltLen, preHash);
 
-            signature.resize(sigLength);
-        }
-        return vecToArray(env, signature);
+        raw_signer op(env, &ctx, messageBuf, isOneShotRawSignature(key, preHash));
+        return signToBuffer(env, op, hasFixedSignatureLength(key), outBuf);
     } catch (java_ex& ex) {
         ex.throw_to_java(pEnv);
-        return NULL;
+        return 0;
     }
 }
 
@@ -621,3 +1219,304 @@ JNIEXPORT jboolean JNICALL Java_com_amazon_corretto_crypto_provider_EvpSignature
         return false;
     }
 }
+
+/*
+ * Class:     com_amazon_corretto_crypto_utils_SignatureBatchUtils
+ * Method:    verifyInternal
+ * Signature: (ILjava/lang/String;[[B[I[B[I[I[B[I[I[JI)V
+ *
+ * Verifies signature i over input[offsets[i], offsets[i] + lengths[i]) with keys[keyIndices[i]], and sets bit i of
+ * verifiedArr if it is valid. The batch is divided into contiguous runs which are verified by up to |threads| threads,
+ * the calling thread included.
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_utils_SignatureBatchUtils_verifyInternal(JNIEnv* pEnv,
+    jclass,
+    jint keyType,
+    jstring digestName,
+    jobjectArray keysArr,
+    jintArray keyIndicesArr,
+    jbyteArray inputArr,
+    jintArray offsetsArr,
+    jintArray lengthsArr,
+    jbyteArray signaturesArr,
+    jintArray sigOffsetsArr,
+    jintArray sigLengthsArr,
+    jlongArray verifiedArr,
+    jint threads)
+{
+    // Runs should be long enough to be worth a thread.
+    const size_t MIN_VERIFICATIONS_PER_RUN = 4;
+    try {
+        raii_env env(pEnv);
+
+        int expectedKeyType;
+        switch (keyType) {
+        case BATCH_KEY_RSA:
+            expectedKeyType = EVP_PKEY_RSA;
+            break;
+        case BATCH_KEY_EC:
+            expectedKeyType = EVP_PKEY_EC;
+            break;
+        case BATCH_KEY_ED25519:
+            expectedKeyType = EVP_PKEY_ED25519;
+            break;
+        default:
+            throw java_ex(EX_ILLEGAL_ARGUMENT, "Unsupported key type");
+        }
+        // Ed25519 signs the message itself
+        const EVP_MD* md = expectedKeyType == EVP_PKEY_ED25519 ? nullptr : digestFromJstring(env, digestName);
+        if (unlikely(threads <= 0)) {
+            throw java_ex(EX_ILLEGAL_ARGUMENT, "Bad thread count");
+        }
+
+        const jsize count = env->GetArrayLength(keyIndicesArr);
+        const std::vector<jint> keyIndices = getIntArray(env, keyIndicesArr, count);
+        const std::vector<jint> offsets = getIntArray(env, offsetsArr, count);
+        const std::vector<jint> lengths = getIntArray(env, lengthsArr, count);
+        const std::vector<jint> sigOffsets = getIntArray(env, sigOffsetsArr, count);
+        const std::vector<jint> sigLengths = getIntArray(env, sigLengthsArr, count);
+        if (unlikely((size_t)env->GetArrayLength(verifiedArr) < ((size_t)count + 63) / 64)) {
+            throw java_ex(EX_ARRAYOOB, "Result bitmap too small");
+        }
+
+        // Parse every key up front, as the worker threads cannot make JNI calls.
+        const jsize keyCount = env->GetArrayLength(keysArr);
+        pkey_list keys;
+        for (jsize k = 0; k < keyCount; k++) {
+            jbyteArray keyArr = (jbyteArray)env->GetObjectArrayElement(keysArr, k);
+            if (unlikely(!keyArr)) {
+                throw java_ex(EX_NPE, "Null key");
+            }
+            {
+                java_buffer keyBuf = java_buffer::from_array(env, keyArr);
+                jni_borrow key(env, keyBuf, "key");
+                keys.add(der2EvpPublicKey(key.data(), key.len(), EX_ILLEGAL_ARGUMENT));
+            }
+            env->DeleteLocalRef(keyArr);
+            if (unlikely(EVP_PKEY_id(keys.data()[k]) != expectedKeyType)) {
+                throw java_ex(EX_ILLEGAL_ARGUMENT, "Key does not match the signature algorithm");
+            }
+        }
+
+        const java_buffer input = java_buffer::from_array(env, inputArr);
+        const java_buffer signatures = java_buffer::from_array(env, signaturesArr);
+        for (jsize i = 0; i < count; i++) {
+            if (unlikely(keyIndices[i] < 0 || keyIndices[i] >= keyCount)) {
+                throw java_ex(EX_ARRAYOOB, "Key index out of range");
+            }
+            // These throw if the message or signature lies outside of its array.
+            input.subrange(offsets[i], lengths[i]);
+            signatures.subrange(sigOffsets[i], sigLengths[i]);
+        }
+        if (count == 0) {
+            return;
+        }
+
+        // Copy the messages and signatures out of the Java heap rather than borrowing the arrays, which would pin
+        // them and hold off the garbage collector for the whole verification. Only the referenced slices are copied,
+        // packed back to back.
+        std::vector<jint> packedOffsets(count);
+        std::vector<jint> packedSigOffsets(count);
+        size_t inputLen = 0;
+        size_t signaturesLen = 0;
+        for (jsize i = 0; i < count; i++) {
+            packedOffsets[i] = (jint)inputLen;
+            packedSigOffsets[i] = (jint)signaturesLen;
+            inputLen += lengths[i];
+            signaturesLen += sigLengths[i];
+            if (unlikely(inputLen > INT_MAX || signaturesLen > INT_MAX)) {
+                throw java_ex(EX_ILLEGAL_ARGUMENT, "Batch too large");
+            }
+        }
+        // Never empty, so that EVP_DigestVerify always sees a valid pointer
+        std::vector<uint8_t> inputCopy(inputLen + 1);
+        std::vector<uint8_t> signaturesCopy(signaturesLen + 1);
+        for (jsize i = 0; i < count; i++) {
+            input.get_bytes(env, &inputCopy[packedOffsets[i]], offsets[i], lengths[i]);
+            signatures.get_bytes(env, &signaturesCopy[packedSigOffsets[i]], sigOffsets[i], sigLengths[i]);
+        }
+
+        const size_t runCount
+            = std::min((size_t)threads, ((size_t)count + MIN_VERIFICATIONS_PER_RUN - 1) / MIN_VERIFICATIONS_PER_RUN);
+        const size_t perRun = (count + runCount - 1) / runCount;
+        std::vector<uint8_t> valid(count, 0);
+        std::vector<verify_run> runs;
+        {
+            for (size_t first = 0; first < (size_t)count; first += perRun) {
+                verify_run run;
+                run.md = md;
+                run.keys = keys.data();
+                run.keyIndices = keyIndices.data();
+                run.input = &inputCopy[0];
+                run.offsets = packedOffsets.data();
+                run.lengths = lengths.data();
+                run.signatures = &signaturesCopy[0];
+                run.sigOffsets = packedSigOffsets.data();
+                run.sigLengths = sigLengths.data();
+                run.valid = valid.data();
+                run.first = first;
+                run.end = std::min((size_t)count, first + perRun);
+                run.ok = false;
+                runs.push_back(run);
+            }
+
+            std::vector<pthread_t> workers(runs.size());
+            std::vector<bool> started(runs.size(), false);
+            struct run_cleanup {
+                std::vector<pthread_t>& workers;
+                std::vector<bool>& started;
+                ~run_cleanup()
+                {
+                    for (size_t i = 0; i < workers.size(); i++) {
+                        if (started[i]) {
+                            pthread_join(workers[i], nullptr);
+                        }
+                    }
+                }
+            } cleanup { workers, started };
+
+            for (size_t i = 1; i < runs.size(); i++) {
+                // If we cannot get another thread, the run is simply processed on this one below.
+                started[i] = pthread_create(&workers[i], nullptr, verify_run_worker, &runs[i]) == 0;
+            }
+            verify_run_worker(&runs[0]);
+            for (size_t i = 1; i < runs.size(); i++) {
+                if (started[i]) {
+                    pthread_join(workers[i], nullptr);
+                    started[i] = false;
+                } else {
+                    verify_run_worker(&runs[i]);
+                }
+            }
+        }
+        for (size_t i = 0; i < runs.size(); i++) {
+            if (!runs[i].ok) {
+                throw java_ex(EX_RUNTIME_CRYPTO, "Unable to initialize signature verification");
+            }
+        }
+
+        std::vector<jlong> verified(((size_t)count + 63) / 64, 0);
+        for (jsize i = 0; i < count; i++) {
+            verified[i / 64] |= (jlong)((uint64_t)valid[i] << (i % 64));
+        }
+        env->SetLongArrayRegion(verifiedArr, 0, verified.size(), verified.data());
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AsyncSignatures
+ * Method:    submit
+ * Signature: (JJIZZ[BII[BIILjava/util/concurrent/CompletableFuture;I)Z
+ *
+ * Copies the message (and, when verifying, the signature) and queues the operation for a worker. Returns false, without
+ * queuing anything, if |maxQueued| operations are already waiting.
+ */
+JNIEXPORT jboolean JNICALL Java_com_amazon_corretto_crypto_provider_AsyncSignatures_submit(JNIEnv* pEnv,
+    jclass,
+    jlong pKey,
+    jlong mdPtr,
+    jint paddingType,
+    jboolean p1363,
+    jboolean verify,
+    jbyteArray message,
+    jint offset,
+    jint length,
+    jbyteArray signature,
+    jint sigOff,
+    jint sigLen,
+    jobject future,
+    jint maxQueued)
+{
+    try {
+        raii_env env(pEnv);
+
+        if (unlikely(!pKey)) {
+            throw_java_ex(EX_NPE, "Null key");
+        }
+        if (unlikely(!future)) {
+            throw_java_ex(EX_NPE, "Null future");
+        }
+        std::unique_ptr<async_job> job(new async_job(reinterpret_cast<EVP_PKEY*>(pKey),
+            reinterpret_cast<const EVP_MD*>(mdPtr), paddingType, p1363, verify));
+        copyFromArray(env, job->message, message, offset, length);
+        if (verify) {
+            copyFromArray(env, job->signature, signature, sigOff, sigLen);
+        }
+
+        job->future = env->NewGlobalRef(future);
+        if (unlikely(!job->future)) {
+            throw_java_ex(EX_OOM, "Unable to reference future");
+        }
+        if (!async_submit(job.get(), maxQueued)) {
+            env->DeleteGlobalRef(job->future);
+            return false;
+        }
+        job.release();
+        return true;
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return false;
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_AsyncSignatures
+ * Method:    runWorker
+ * Signature: ()V
+ *
+ * Runs queued operations forever on the calling thread, completing each future through AsyncSignatures.complete. The
+ * calling thread is one of the daemon threads owned by AsyncSignatures, and spends all of its time in native code.
+ * Running under a Java frame lets exceptions be resolved through the provider's class loader.
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_AsyncSignatures_runWorker(JNIEnv* pEnv, jclass clazz)
+{
+    const jmethodID complete = pEnv->GetStaticMethodID(
+        clazz, "complete", "(Ljava/util/concurrent/CompletableFuture;[BZLjava/lang/Throwable;)V");
+    if (unlikely(!complete)) {
+        return; // NoSuchMethodError is pending
+    }
+
+    for (;;) {
+        // This frame never returns to Java, so each operation gets its own local reference frame.
+        if (unlikely(pEnv->PushLocalFrame(16) != 0)) {
+            return; // OutOfMemoryError is pending
+        }
+        std::unique_ptr<async_job> job(async_take());
+        jbyteArray signature = NULL;
+        jboolean verified = false;
+
+        try {
+            raii_env env(pEnv);
+            if (job->verify) {
+                verified = asyncVerify(env, *job);
+            } else {
+                signature = asyncSign(env, *job);
+            }
+        } catch (java_ex& ex) {
+            ex.throw_to_java(pEnv);
+        } catch (std::bad_alloc&) {
+            // Leaving any other exception unhandled would end the thread while its Java frame never returns, and
+            // leave the future pending forever.
+            java_ex(EX_OOM, "Unable to allocate memory for asynchronous signature").throw_to_java(pEnv);
+        } catch (std::exception& ex) {
+            java_ex(EX_RUNTIME_CRYPTO, ex.what()).throw_to_java(pEnv);
+        } catch (...) {
+            java_ex(EX_RUNTIME_CRYPTO, "Unexpected error in asynchronous signature").throw_to_java(pEnv);
+        }
+
+        jthrowable error = NULL;
+        if (unlikely(pEnv->ExceptionCheck())) {
+            error = pEnv->ExceptionOccurred();
+            pEnv->ExceptionClear();
+        }
+        pEnv->CallStaticVoidMethod(clazz, complete, job->future, signature, verified, error);
+        // complete() hands the result to the common pool, so dependent stages never run on this thread. Anything
+        // escaping it (such as an OutOfMemoryError) must not take down the worker.
+        pEnv->ExceptionClear();
+
+        pEnv->DeleteGlobalRef(job->future);
+        pEnv->PopLocalFrame(NULL);
+    }
+}
@@ -0,0 +1,89 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+#ifndef SLAB_ALLOCATOR_H
+#define SLAB_ALLOCATOR_H 1
+
+#include <openssl/mem.h>
+#include <new>
+#include <pthread.h>
+#include <stddef.h>
+#include <type_traits>
+
+namespace AmazonCorrettoCryptoProvider {
+
+/*
+ * Hands out uninitialized, suitably aligned storage for objects of type T, carved out of slabs of SLOTS_PER_SLAB
+ * objects. Released objects are zeroized and go onto a free list, so steady state allocation is a pop from that list
+ * under a mutex rather than a trip through malloc. Slabs are never returned to the system: the memory used is bounded
+ * by the peak number of live objects.
+ *
+ * T must be trivially destructible and must not be referenced by pointers from elsewhere, as objects are moved in
+ * and out of the free list with plain memory operations.
+ */
+template <typename T, size_t SLOTS_PER_SLAB = 64> class slab_allocator {
+private:
+    union slot {
+        slot* next;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    pthread_mutex_t lock_;
+    slot* free_;
+
+    class guard {
+        pthread_mutex_t* lock_;
+
+    public:
+        explicit guard(pthread_mutex_t* lock)
+            : lock_(lock)
+        {
+            pthread_mutex_lock(lock_);
+        }
+        ~guard() { pthread_mutex_unlock(lock_); }
+    };
+
+public:
+    slab_allocator()
+        : free_(nullptr)
+    {
+        pthread_mutex_init(&lock_, nullptr);
+    }
+
+    slab_allocator(const slab_allocator&) = delete;
+    slab_allocator& operator=(const slab_allocator&) = delete;
+
+    // Returns nullptr if a new slab was needed and could not be allocated.
+    T* allocate()
+    {
+        guard g(&lock_);
+        if (!free_) {
+            slot* slab = new (std::nothrow) slot[SLOTS_PER_SLAB];
+            if (!slab) {
+                return nullptr;
+            }
+            for (size_t i = 0; i < SLOTS_PER_SLAB; i++) {
+                slab[i].next = i + 1 < SLOTS_PER_SLAB ? &slab[i + 1] : nullptr;
+            }
+            free_ = slab;
+        }
+        slot* result = free_;
+        free_ = result->next;
+        return reinterpret_cast<T*>(&result->storage);
+    }
+
+    void release(T* obj)
+    {
+        if (!obj) {
+            return;
+        }
+        OPENSSL_cleanse(obj, sizeof(T));
+        slot* s = reinterpret_cast<slot*>(obj);
+        guard g(&lock_);
+        s->next = free_;
+        free_ = s;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,201 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+#include "buffer.h"
+#include "env.h"
+#include "generated-headers.h"
+#include "util.h"
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <algorithm>
+#include <pthread.h>
+#include <vector>
+
+// Domain separation prefix of leaf digests; interior nodes use 0x01 and are computed on the Java side.
+#define TREE_HASH_LEAF_PREFIX 0x00
+// Java memory is borrowed for at most this many bytes of data per thread at a time, unless a single chunk is larger.
+#define TREE_HASH_WINDOW_PER_THREAD (4 * 1024 * 1024)
+
+namespace AmazonCorrettoCryptoProvider {
+
+// Computes the digests of a contiguous run of leaves. Workers never touch the JNIEnv.
+struct leaf_run {
+    const EVP_MD* md;
+    uint8_t const* input;
+    size_t input_len;
+    size_t chunk_size;
+    uint8_t* output;
+    bool ok;
+};
+
+static void* leaf_run_worker(void* arg)
+{
+    leaf_run* run = reinterpret_cast<leaf_run*>(arg);
+    const uint8_t prefix = TREE_HASH_LEAF_PREFIX;
+    const size_t digest_len = EVP_MD_size(run->md);
+
+    run->ok = false;
+    EVP_MD_CTX* ctx = EVP_MD_CTX_new();
+    if (ctx != nullptr) {
+        run->ok = true;
+        size_t pos = 0;
+        uint8_t* out = run->output;
+        // An empty run still has one (empty) leaf: the one of an empty input.
+        do {
+            const size_t len = std::min(run->chunk_size, run->input_len - pos);
+            if (EVP_DigestInit_ex(ctx, run->md, nullptr) != 1 || EVP_DigestUpdate(ctx, &prefix, 1) != 1
+                || EVP_DigestUpdate(ctx, run->input + pos, len) != 1
+                || EVP_DigestFinal_ex(ctx, out, nullptr) != 1) {
+                run->ok = false;
+                break;
+            }
+            pos += len;
+            out += digest_len;
+        } while (pos < run->input_len);
+        EVP_MD_CTX_free(ctx);
+    }
+    if (!run->ok) {
+        // The error queue is thread-local, so the calling thread reports a generic failure instead.
+        ERR_clear_error();
+    }
+    return nullptr;
+}
+
+// Digests the leaves of one window of the data, borrowing only that window and its leaves. Returns false if any
+// digest could not be computed.
+static bool hash_leaf_window(raii_env& env,
+    const EVP_MD* md,
+    const java_buffer& data,
+    size_t chunkSize,
+    const java_buffer& leaves,
+    size_t leafCount,
+    size_t threads)
+{
+    const size_t digestLength = EVP_MD_size(md);
+    // Every run but possibly the last one holds the same number of whole chunks.
+    const size_t runCount = std::min(leafCount, threads);
+    const size_t leavesPerRun = (leafCount + runCount - 1) / runCount;
+    std::vector<leaf_run> runs;
+    for (size_t first = 0; first < leafCount; first += leavesPerRun) {
+        leaf_run run;
+        run.md = md;
+        run.chunk_size = chunkSize;
+        run.ok = false;
+        runs.push_back(run);
+    }
+
+    jni_borrow dataBorrow(env, data, "data");
+    jni_borrow leavesBorrow(env, leaves, "leaves");
+    for (size_t i = 0; i < runs.size(); i++) {
+        const size_t start = i * leavesPerRun * chunkSize;
+        const size_t end = std::min(data.len(), start + leavesPerRun * chunkSize);
+        runs[i].input = dataBorrow.data() + start;
+        runs[i].input_len = end - start;
+        runs[i].output = leavesBorrow.data() + i * leavesPerRun * digestLength;
+    }
+
+    std::vector<pthread_t> workers(runs.size());
+    std::vector<bool> started(runs.size(), false);
+    struct run_cleanup {
+        std::vector<pthread_t>& workers;
+        std::vector<bool>& started;
+        ~run_cleanup()
+        {
+            for (size_t i = 0; i < workers.size(); i++) {
+                if (started[i]) {
+                    pthread_join(workers[i], nullptr);
+                }
+            }
+        }
+    } cleanup { workers, started };
+
+    for (size_t i = 1; i < runs.size(); i++) {
+        // If we cannot get another thread, the run is simply processed on this one below.
+        started[i] = pthread_create(&workers[i], nullptr, leaf_run_worker, &runs[i]) == 0;
+    }
+    leaf_run_worker(&runs[0]);
+    for (size_t i = 1; i < runs.size(); i++) {
+        if (started[i]) {
+            pthread_join(workers[i], nullptr);
+            started[i] = false;
+        } else {
+            leaf_run_worker(&runs[i]);
+        }
+    }
+    for (size_t i = 0; i < runs.size(); i++) {
+        if (!runs[i].ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static const EVP_MD* treeHashDigest(jint digestLength)
+{
+    switch (digestLength) {
+    case 32:
+        return EVP_sha256();
+    case 64:
+        return EVP_sha512();
+    default:
+        throw java_ex(EX_ILLEGAL_ARGUMENT, "Unsupported tree hash digest");
+    }
+}
+
+}
+
+using namespace AmazonCorrettoCryptoProvider;
+
+/*
+ * Class:     com_amazon_corretto_crypto_provider_TreeHashSpi
+ * Method:    hashLeaves
+ * Signature: (I[BIII[BI)V
+ *
+ * Splits data[offset, offset + length) into chunks of chunkSize bytes, the last of which may be shorter, and writes
+ * the leaf digest H(0x00 || chunk) of each one to leavesArray. An empty input has a single, empty chunk. The leaves
+ * are divided into contiguous runs which are digested by up to |threads| threads, the calling thread included. Large
+ * inputs are processed one bounded window at a time, so that the arrays are never borrowed for the whole call.
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_TreeHashSpi_hashLeaves(JNIEnv* pEnv,
+    jclass,
+    jint digestLength,
+    jbyteArray dataArray,
+    jint offset,
+    jint length,
+    jint chunkSize,
+    jbyteArray leavesArray,
+    jint threads)
+{
+    try {
+        raii_env env(pEnv);
+
+        const EVP_MD* md = treeHashDigest(digestLength);
+        if (unlikely(chunkSize <= 0 || threads <= 0)) {
+            throw java_ex(EX_ILLEGAL_ARGUMENT, "Bad chunk size or thread count");
+        }
+        java_buffer data = java_buffer::from_array(env, dataArray, offset, length);
+        const size_t leafCount = data.len() == 0 ? 1 : (data.len() - 1) / chunkSize + 1;
+        java_buffer leaves = java_buffer::from_array(env, leavesArray);
+        if (unlikely(leaves.len() < leafCount * digestLength)) {
+            throw java_ex(EX_ARRAYOOB, "Leaf digests do not fit in the output");
+        }
+
+        // Critical sections hold off the garbage collector, so rather than borrowing a multi-gigabyte input for the
+        // whole call, the leaves are digested in windows of a bounded amount of data each.
+        const size_t leavesPerWindow
+            = (size_t)threads * std::max((size_t)1, (size_t)TREE_HASH_WINDOW_PER_THREAD / chunkSize);
+        for (size_t window = 0; window < leafCount; window += leavesPerWindow) {
+            const size_t windowLeaves = std::min(leavesPerWindow, leafCount - window);
+            const size_t windowStart = window * chunkSize;
+            const size_t windowLen = std::min(data.len() - windowStart, windowLeaves * chunkSize);
+            const java_buffer windowData = data.subrange(windowStart, windowLen);
+            const java_buffer windowDigests = leaves.subrange(window * digestLength, windowLeaves * digestLength);
+            if (!hash_leaf_window(env, md, windowData, chunkSize, windowDigests, windowLeaves, (size_t)threads)) {
+                jni_borrow leavesBorrow(env, leaves, "leaves");
+                leavesBorrow.zeroize();
+                throw java_ex(EX_RUNTIME_CRYPTO, "Unable to compute leaf digest");
+            }
+        }
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
@@ -48,6 +48,12 @@ extern "C" JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_Utils
     EVP_CIPHER_CTX_free(reinterpret_cast<EVP_CIPHER_CTX*>(ctxPtr));
 }
 
+extern "C" JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_provider_Utils_releaseEvpAeadCtx(
+    JNIEnv*, jclass, jlong ctxPtr)
+{
+    EVP_AEAD_CTX_free(reinterpret_cast<EVP_AEAD_CTX*>(ctxPtr));
+}
+
 EVP_MD const* digest_code_to_EVP_MD(int digestCode)
 {
     switch (digestCode) {
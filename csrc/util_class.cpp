@@ -2,13 +2,91 @@
 // SPDX-License-Identifier: Apache-2.0
 #include "generated-headers.h"
 
+#include "buffer.h"
 #include "env.h"
+#include "file_mapping.h"
 #include "keyutils.h"
 #include "util.h"
+#include <vector>
 // JNI methods needed by the Java Utils class rather than generic utilities needed by our code.
 
 using namespace AmazonCorrettoCryptoProvider;
 
+#if !defined(FIPS_BUILD) || defined(EXPERIMENTAL_FIPS_BUILD)
+namespace {
+
+const size_t ML_DSA_MU_LEN = 64;
+
+// Returns a SHAKE256 context which has absorbed tr and the empty context string prefix of mu (line 6 of Algorithm 7
+// in FIPS 204, https://nvlpubs.nist.gov/nistpubs/FIPS/NIST.FIPS.204.pdf), so that only the message remains.
+EVP_MD_CTX* newMuContext(raii_env& env, jbyteArray pubKeyEncodedArr)
+{
+    java_buffer pubKeyBuf = java_buffer::from_array(env, pubKeyEncodedArr);
+    std::vector<uint8_t> pubKeyDer(pubKeyBuf.len());
+    pubKeyBuf.get_bytes(env, pubKeyDer.data(), 0, pubKeyDer.size());
+
+    CBS cbs;
+    CBS_init(&cbs, pubKeyDer.data(), pubKeyDer.size());
+    EVP_PKEY_auto pkey = EVP_PKEY_auto::from(EVP_parse_public_key(&cbs));
+    if (!pkey.isInitialized()) {
+        throw_openssl(EX_ILLEGAL_ARGUMENT, "Unable to parse ML-DSA public key");
+    }
+
+    size_t pk_len; // fetch the public key length
+    CHECK_OPENSSL(EVP_PKEY_get_raw_public_key(pkey.get(), nullptr, &pk_len));
+    std::vector<uint8_t> pk(pk_len);
+    CHECK_OPENSSL(EVP_PKEY_get_raw_public_key(pkey.get(), pk.data(), &pk_len));
+    uint8_t tr[64] = { 0 };
+    uint8_t pre[2] = { 0 };
+
+    // get raw public key and hash it
+    EVP_MD_CTX_auto md_ctx_pk = EVP_MD_CTX_auto::from(EVP_MD_CTX_new());
+    CHECK_OPENSSL(md_ctx_pk.isInitialized());
+    CHECK_OPENSSL(EVP_DigestInit_ex(md_ctx_pk.get(), EVP_shake256(), nullptr));
+    CHECK_OPENSSL(EVP_DigestUpdate(md_ctx_pk.get(), pk.data(), pk_len));
+    CHECK_OPENSSL(EVP_DigestFinalXOF(md_ctx_pk.get(), tr, sizeof(tr)));
+
+    EVP_MD_CTX_auto md_ctx_mu = EVP_MD_CTX_auto::from(EVP_MD_CTX_new());
+    CHECK_OPENSSL(md_ctx_mu.isInitialized());
+    CHECK_OPENSSL(EVP_DigestInit_ex(md_ctx_mu.get(), EVP_shake256(), nullptr));
+    CHECK_OPENSSL(EVP_DigestUpdate(md_ctx_mu.get(), tr, sizeof(tr)));
+    CHECK_OPENSSL(EVP_DigestUpdate(md_ctx_mu.get(), pre, sizeof(pre)));
+    return md_ctx_mu.take();
+}
+
+EVP_MD_CTX* muContextFromPtr(jlong ctxPtr)
+{
+    if (unlikely(!ctxPtr)) {
+        throw java_ex(EX_NPE, "Null mu context");
+    }
+    return reinterpret_cast<EVP_MD_CTX*>(ctxPtr);
+}
+
+void muUpdate(raii_env& env, EVP_MD_CTX* ctx, java_buffer message)
+{
+    if (message.len() == 0) {
+        return;
+    }
+    jni_borrow borrow(env, message, "message");
+    CHECK_OPENSSL(EVP_DigestUpdate(ctx, borrow.data(), borrow.len()));
+}
+
+jbyteArray muFinish(raii_env& env, EVP_MD_CTX* ctx)
+{
+    uint8_t mu[ML_DSA_MU_LEN] = { 0 };
+    CHECK_OPENSSL(EVP_DigestFinalXOF(ctx, mu, sizeof(mu)));
+
+    jbyteArray ret = env->NewByteArray(sizeof(mu));
+    if (!ret) {
+        throw_java_ex(EX_OOM, "Unable to allocate mu array");
+    }
+    env->SetByteArrayRegion(ret, 0, sizeof(mu), (const jbyte*)mu);
+    return ret;
+}
+
+}
+#endif // !defined(FIPS_BUILD) || defined(EXPERIMENTAL_FIPS_BUILD)
+
 extern "C" {
 
 /*
@@ -137,51 +215,117 @@ JNIEXPORT jbyteArray JNICALL Java_com_amazon_corretto_crypto_utils_MlDsaUtils_co
 {
     try {
         raii_env env(pEnv);
-        jsize pub_key_der_len = env->GetArrayLength(pubKeyEncodedArr);
-        jsize message_len = env->GetArrayLength(messageArr);
-        uint8_t* pub_key_der = (uint8_t*)env->GetByteArrayElements(pubKeyEncodedArr, nullptr);
-        CHECK_OPENSSL(pub_key_der);
-        uint8_t* message = (uint8_t*)env->GetByteArrayElements(messageArr, nullptr);
-        CHECK_OPENSSL(message);
-
-        CBS cbs;
-        CBS_init(&cbs, pub_key_der, pub_key_der_len);
-        EVP_PKEY_auto pkey = EVP_PKEY_auto::from((EVP_parse_public_key(&cbs)));
-        EVP_PKEY_CTX_auto ctx = EVP_PKEY_CTX_auto::from(EVP_PKEY_CTX_new(pkey.get(), nullptr));
-        EVP_MD_CTX_auto md_ctx_mu = EVP_MD_CTX_auto::from(EVP_MD_CTX_new());
-        EVP_MD_CTX_auto md_ctx_pk = EVP_MD_CTX_auto::from(EVP_MD_CTX_new());
-
-        size_t pk_len; // fetch the public key length
-        CHECK_OPENSSL(EVP_PKEY_get_raw_public_key(pkey.get(), nullptr, &pk_len));
-        std::vector<uint8_t> pk(pk_len);
-        CHECK_OPENSSL(EVP_PKEY_get_raw_public_key(pkey.get(), pk.data(), &pk_len));
-        uint8_t tr[64] = { 0 };
-        uint8_t mu[64] = { 0 };
-        uint8_t pre[2] = { 0 };
-
-        // get raw public key and hash it
-        CHECK_OPENSSL(EVP_DigestInit_ex(md_ctx_pk.get(), EVP_shake256(), nullptr));
-        CHECK_OPENSSL(EVP_DigestUpdate(md_ctx_pk.get(), pk.data(), pk_len));
-        CHECK_OPENSSL(EVP_DigestFinalXOF(md_ctx_pk.get(), tr, sizeof(tr)));
-
-        // compute mu as defined on line 6 of Algorithm 7 in FIPS 204
-        // https://nvlpubs.nist.gov/nistpubs/FIPS/NIST.FIPS.204.pdf
-        CHECK_OPENSSL(EVP_DigestInit_ex(md_ctx_mu.get(), EVP_shake256(), nullptr));
-        CHECK_OPENSSL(EVP_DigestUpdate(md_ctx_mu.get(), tr, sizeof(tr)));
-        CHECK_OPENSSL(EVP_DigestUpdate(md_ctx_mu.get(), pre, sizeof(pre)));
-        CHECK_OPENSSL(EVP_DigestUpdate(md_ctx_mu.get(), message, message_len));
-        CHECK_OPENSSL(EVP_DigestFinalXOF(md_ctx_mu.get(), mu, sizeof(mu)));
-
-        env->ReleaseByteArrayElements(pubKeyEncodedArr, (jbyte*)pub_key_der, 0);
-        env->ReleaseByteArrayElements(messageArr, (jbyte*)message, 0);
-
-        jbyteArray ret = env->NewByteArray(sizeof(mu));
-        env->SetByteArrayRegion(ret, 0, sizeof(mu), (const jbyte*)mu);
-        return ret;
+        EVP_MD_CTX_auto ctx = EVP_MD_CTX_auto::from(newMuContext(env, pubKeyEncodedArr));
+        muUpdate(env, ctx, java_buffer::from_array(env, messageArr));
+        return muFinish(env, ctx);
     } catch (java_ex& ex) {
         ex.throw_to_java(pEnv);
         return 0;
     }
 }
+
+/*
+ * Class:     com_amazon_corretto_crypto_utils_MlDsaUtils
+ * Method:    muStart
+ * Signature: ([B)J
+ *
+ * Returns a context computing mu incrementally over a message which is supplied in pieces.
+ */
+JNIEXPORT jlong JNICALL Java_com_amazon_corretto_crypto_utils_MlDsaUtils_muStart(
+    JNIEnv* pEnv, jclass, jbyteArray pubKeyEncodedArr)
+{
+    try {
+        raii_env env(pEnv);
+        return reinterpret_cast<jlong>(newMuContext(env, pubKeyEncodedArr));
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return 0;
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_utils_MlDsaUtils
+ * Method:    muUpdate
+ * Signature: (J[BII)V
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_utils_MlDsaUtils_muUpdate(
+    JNIEnv* pEnv, jclass, jlong ctxPtr, jbyteArray messageArr, jint offset, jint length)
+{
+    try {
+        raii_env env(pEnv);
+        muUpdate(env, muContextFromPtr(ctxPtr), java_buffer::from_array(env, messageArr, offset, length));
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_utils_MlDsaUtils
+ * Method:    muUpdateDirect
+ * Signature: (JLjava/nio/ByteBuffer;II)V
+ *
+ * Absorbs a slice of a direct (possibly file mapped) buffer in place.
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_utils_MlDsaUtils_muUpdateDirect(
+    JNIEnv* pEnv, jclass, jlong ctxPtr, jobject messageBuf, jint offset, jint length)
+{
+    try {
+        raii_env env(pEnv);
+        EVP_MD_CTX* ctx = muContextFromPtr(ctxPtr);
+        muUpdate(env, ctx, java_buffer::from_direct(env, messageBuf).subrange(offset, length));
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_utils_MlDsaUtils
+ * Method:    muUpdateFile
+ * Signature: (J[B)V
+ *
+ * Maps the complete file at the given (not NUL-terminated) path and absorbs it. The mapping is removed before this
+ * returns, rather than whenever the garbage collector gets around to it as with FileChannel.map.
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_utils_MlDsaUtils_muUpdateFile(
+    JNIEnv* pEnv, jclass, jlong ctxPtr, jbyteArray pathArray)
+{
+    try {
+        raii_env env(pEnv);
+        EVP_MD_CTX* ctx = muContextFromPtr(ctxPtr);
+        file_mapping mapping(pathFromArray(env, pathArray));
+        if (mapping.len() != 0) {
+            CHECK_OPENSSL(EVP_DigestUpdate(ctx, mapping.data(), mapping.len()));
+        }
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_utils_MlDsaUtils
+ * Method:    muFinish
+ * Signature: (J)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_com_amazon_corretto_crypto_utils_MlDsaUtils_muFinish(
+    JNIEnv* pEnv, jclass, jlong ctxPtr)
+{
+    try {
+        raii_env env(pEnv);
+        return muFinish(env, muContextFromPtr(ctxPtr));
+    } catch (java_ex& ex) {
+        ex.throw_to_java(pEnv);
+        return 0;
+    }
+}
+
+/*
+ * Class:     com_amazon_corretto_crypto_utils_MlDsaUtils
+ * Method:    muFree
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_com_amazon_corretto_crypto_utils_MlDsaUtils_muFree(JNIEnv*, jclass, jlong ctxPtr)
+{
+    EVP_MD_CTX_free(reinterpret_cast<EVP_MD_CTX*>(ctxPtr));
+}
 #endif // !defined(FIPS_BUILD) || defined(EXPERIMENTAL_FIPS_BUILD)
 }
\ No newline at end of file
@@ -0,0 +1,187 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider;
+
+import java.nio.ByteBuffer;
+import java.security.InvalidAlgorithmParameterException;
+import java.security.InvalidKeyException;
+import java.security.Key;
+import java.security.spec.AlgorithmParameterSpec;
+import java.util.Arrays;
+import java.util.Objects;
+import javax.crypto.MacSpi;
+import javax.crypto.SecretKey;
+
+/**
+ * AES-CMAC as specified in NIST SP 800-38B and RFC 4493, with a 128-bit tag.
+ *
+ * <p>Like {@link EvpHmac}, input is buffered on the Java side so that short messages are
+ * authenticated by a single native call. The native context is keyed once per key, which derives
+ * the CMAC subkeys; re-initializing with the same key, or starting a new message, only resets it.
+ */
+final class AesCmacSpi extends MacSpi implements Cloneable {
+  static {
+    Loader.load();
+  }
+
+  private static final int MAC_LENGTH = 16;
+
+  /** Returns a new CMAC_CTX keyed with {@code key}, which must be freed with freeContext. */
+  private static native long newContext(byte[] key);
+
+  private static native void freeContext(long ctxPtr);
+
+  private static native long cloneContext(long ctxPtr);
+
+  /** Calls {@code CMAC_Update}, first resetting the context if {@code startMessage} is set. */
+  private static native void update(
+      long ctxPtr, byte[] input, int offset, int length, boolean startMessage);
+
+  /** As {@link #update}, but reads the remaining bytes of the direct ByteBuffer {@code input}. */
+  private static native void updateDirect(long ctxPtr, ByteBuffer input, boolean startMessage);
+
+  /** Calls {@code CMAC_Final}, and places the result in {@code result}. */
+  private static native void doFinal(long ctxPtr, byte[] result);
+
+  /** Resets the context and computes the CMAC of {@code input} into {@code result}. */
+  private static native void fastMac(
+      long ctxPtr, byte[] input, int offset, int length, byte[] result);
+
+  private static final class Context extends NativeResource {
+    private Context(final long ptr) {
+      super(ptr, AesCmacSpi::freeContext);
+    }
+  }
+
+  private SecretKey key;
+  // These must be explicitly cloned
+  private Context context;
+  private InputBuffer<byte[], Void, RuntimeException> buffer;
+
+  AesCmacSpi() {
+    Loader.checkNativeLibraryAvailability();
+    buffer = new InputBuffer<byte[], Void, RuntimeException>(1024);
+    configureLambdas();
+  }
+
+  private void configureLambdas() {
+    buffer
+        .withInitialUpdater(
+            (src, offset, length) -> {
+              assertInitialized();
+              context.useVoid(ptr -> update(ptr, src, offset, length, true));
+              return null;
+            })
+        .withUpdater(
+            (ignored, src, offset, length) -> {
+              assertInitialized();
+              context.useVoid(ptr -> update(ptr, src, offset, length, false));
+            })
+        .withInitialUpdater(
+            (src) -> {
+              assertInitialized();
+              context.useVoid(ptr -> updateDirect(ptr, src, true));
+              return null;
+            })
+        .withUpdater(
+            (ignored, src) -> {
+              assertInitialized();
+              context.useVoid(ptr -> updateDirect(ptr, src, false));
+            })
+        .withDoFinal(
+            (ignored) -> {
+              assertInitialized();
+              final byte[] result = new byte[MAC_LENGTH];
+              context.useVoid(ptr -> doFinal(ptr, result));
+              return result;
+            })
+        .withSinglePass(
+            (src, offset, length) -> {
+              assertInitialized();
+              final byte[] result = new byte[MAC_LENGTH];
+              context.useVoid(ptr -> fastMac(ptr, src, offset, length, result));
+              return result;
+            });
+  }
+
+  @Override
+  protected int engineGetMacLength() {
+    return MAC_LENGTH;
+  }
+
+  @Override
+  protected void engineInit(final Key key, final AlgorithmParameterSpec params)
+      throws InvalidKeyException, InvalidAlgorithmParameterException {
+    if (params != null) {
+      throw new InvalidAlgorithmParameterException("Params must be null");
+    }
+    if (!(key instanceof SecretKey)) {
+      throw new InvalidKeyException("AES-CMAC expects a SecretKey");
+    }
+    if (context == null || !Objects.equals(this.key, key)) {
+      if (!"RAW".equalsIgnoreCase(key.getFormat())) {
+        throw new InvalidKeyException("Key must support RAW encoding");
+      }
+      final byte[] encoded = key.getEncoded();
+      if (encoded == null) {
+        throw new InvalidKeyException("Key encoding must not be null");
+      }
+      try {
+        if (encoded.length != 16 && encoded.length != 24 && encoded.length != 32) {
+          throw new InvalidKeyException("Key must be 128, 192, or 256 bits long");
+        }
+        final Context newContext = new Context(newContext(encoded));
+        if (context != null) {
+          context.release();
+        }
+        context = newContext;
+        this.key = (SecretKey) key;
+      } finally {
+        Arrays.fill(encoded, (byte) 0);
+      }
+    }
+    engineReset();
+  }
+
+  @Override
+  protected void engineUpdate(final byte input) {
+    buffer.update(input);
+  }
+
+  @Override
+  protected void engineUpdate(final byte[] input, final int offset, final int len) {
+    buffer.update(input, offset, len);
+  }
+
+  @Override
+  protected void engineUpdate(final ByteBuffer input) {
+    buffer.update(input);
+  }
+
+  @Override
+  protected byte[] engineDoFinal() {
+    return buffer.doFinal();
+  }
+
+  @Override
+  protected void engineReset() {
+    buffer.reset();
+  }
+
+  private void assertInitialized() {
+    if (context == null) {
+      throw new IllegalStateException("Mac not initialized");
+    }
+  }
+
+  @Override
+  public AesCmacSpi clone() throws CloneNotSupportedException {
+    final AesCmacSpi cloned = (AesCmacSpi) super.clone();
+    if (context != null) {
+      cloned.context = new Context(context.use(AesCmacSpi::cloneContext));
+    }
+    cloned.buffer = buffer.clone();
+    cloned.configureLambdas();
+    return cloned;
+  }
+}
@@ -0,0 +1,522 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider;
+
+import java.nio.ByteBuffer;
+import java.security.AlgorithmParameters;
+import java.security.InvalidAlgorithmParameterException;
+import java.security.InvalidKeyException;
+import java.security.Key;
+import java.security.NoSuchAlgorithmException;
+import java.security.SecureRandom;
+import java.security.spec.AlgorithmParameterSpec;
+import java.security.spec.InvalidParameterSpecException;
+import java.util.Arrays;
+import java.util.logging.Logger;
+import javax.crypto.BadPaddingException;
+import javax.crypto.Cipher;
+import javax.crypto.CipherSpi;
+import javax.crypto.IllegalBlockSizeException;
+import javax.crypto.NoSuchPaddingException;
+import javax.crypto.ShortBufferException;
+import javax.crypto.spec.IvParameterSpec;
+
+/**
+ * AES in counter mode. The IV is the full 128-bit initial counter block, which is incremented as a
+ * big-endian integer, matching the SunJCE provider.
+ *
+ * <p>Since the keystream blocks are independent of each other, a single update or final call of at
+ * least {@link #PROPERTY_PARALLEL_THRESHOLD} bytes is split into block aligned slices which are
+ * processed by up to {@link #PROPERTY_THREADS} native threads, each seeking to its own counter.
+ * Java arrays are only pinned for a bounded window of the input at a time, so that even
+ * multi-gigabyte operations do not hold off the garbage collector for their whole duration.
+ */
+class AesCtrSpi extends CipherSpi {
+  private static final Logger LOG = Logger.getLogger("AmazonCorrettoCryptoProvider");
+  private static final int BLOCK_SIZE_IN_BYTES = 16;
+  private static final int IV_SIZE_IN_BYTES = BLOCK_SIZE_IN_BYTES;
+  private static final int KEY_LEN_AES128 = 16;
+  private static final int KEY_LEN_AES192 = 24;
+  private static final int KEY_LEN_AES256 = 32;
+
+  private static final String PROPERTY_PARALLEL_THRESHOLD = "aesCtrParallelThreshold";
+  private static final String PROPERTY_THREADS = "aesCtrThreads";
+  private static final int DEFAULT_PARALLEL_THRESHOLD = 1024 * 1024;
+  private static final int MAX_THREADS = 64;
+  private static final int PARALLEL_THRESHOLD =
+      readIntProperty(PROPERTY_PARALLEL_THRESHOLD, DEFAULT_PARALLEL_THRESHOLD, 1);
+  private static final int THREADS =
+      Math.min(
+          MAX_THREADS,
+          readIntProperty(PROPERTY_THREADS, Runtime.getRuntime().availableProcessors(), 1));
+
+  private IvParameterSpec ivParamSpec = null; // gets populated on initialization
+  private int keyLen;
+  private byte[] key = null;
+  private NativeResource context = null;
+  // Number of bytes processed since initialization, so that the native code can seek in the
+  // keystream.
+  private long position = 0;
+  private final AmazonCorrettoCryptoProvider provider;
+
+  AesCtrSpi(final AmazonCorrettoCryptoProvider provider) {
+    Loader.checkNativeLibraryAvailability();
+    this.provider = provider;
+  }
+
+  private static int readIntProperty(
+      final String propertyName, final int defaultValue, final int minValue) {
+    final String propertyStr = Loader.getProperty(propertyName, Integer.toString(defaultValue));
+    try {
+      final int value = Integer.parseInt(propertyStr);
+      if (value >= minValue) {
+        return value;
+      }
+    } catch (final NumberFormatException ex) {
+      // Fall through to the warning below
+    }
+    LOG.warning(
+        String.format(
+            "Valid values for %s are integers of at least %d, with %d as default",
+            propertyName, minValue, defaultValue));
+    return defaultValue;
+  }
+
+  private static int threadsFor(final int inputLen) {
+    return inputLen >= PARALLEL_THRESHOLD ? THREADS : 1;
+  }
+
+  @Override
+  protected void engineSetMode(String mode) throws NoSuchAlgorithmException {
+    if (!"CTR".equalsIgnoreCase(mode)) {
+      throw new NoSuchAlgorithmException();
+    }
+  }
+
+  @Override
+  protected void engineSetPadding(String padding) throws NoSuchPaddingException {
+    if (!"NoPadding".equalsIgnoreCase(padding)) {
+      throw new NoSuchPaddingException();
+    }
+  }
+
+  @Override
+  protected int engineGetBlockSize() {
+    return BLOCK_SIZE_IN_BYTES;
+  }
+
+  @Override
+  protected int engineGetOutputSize(final int inputLen) {
+    return inputLen; // CTR is a stream mode, so output len is always equal to inputLen
+  }
+
+  @Override
+  protected byte[] engineGetIV() {
+    if (ivParamSpec == null) {
+      return null;
+    }
+    return ivParamSpec.getIV();
+  }
+
+  @Override
+  protected AlgorithmParameters engineGetParameters() {
+    try {
+      // CipherSpi docs require that we don't return null here, as the algorithm supports
+      // parameters. If we're initialized, return the IV that was specified. Else, generate a new
+      // random one but do not update cipher initialization state.
+      AlgorithmParameters parameters = AlgorithmParameters.getInstance("AES");
+      if (ivParamSpec == null) {
+        byte[] ivForParams = new byte[BLOCK_SIZE_IN_BYTES];
+        new LibCryptoRng().nextBytes(ivForParams);
+        parameters.init(new IvParameterSpec(ivForParams));
+      } else {
+        parameters.init(ivParamSpec);
+      }
+      return parameters;
+    } catch (final InvalidParameterSpecException | NoSuchAlgorithmException e) {
+      throw new RuntimeCryptoException("Unexpected error", e);
+    }
+  }
+
+  @Override
+  protected void engineInit(final int opmode, final Key key, final SecureRandom random)
+      throws InvalidKeyException {
+    try {
+      byte[] iv = new byte[IV_SIZE_IN_BYTES];
+      random.nextBytes(iv);
+      engineInit(opmode, key, new IvParameterSpec(iv), random);
+    } catch (InvalidAlgorithmParameterException e) {
+      throw new InvalidKeyException("Failed to initialize with random IV", e);
+    }
+  }
+
+  @Override
+  protected void engineInit(
+      final int opmode,
+      final Key key,
+      final AlgorithmParameterSpec params,
+      final SecureRandom random)
+      throws InvalidKeyException, InvalidAlgorithmParameterException {
+    if (!(params instanceof IvParameterSpec)) {
+      throw new InvalidAlgorithmParameterException("Params must be an instance of IvParameterSpec");
+    }
+    final IvParameterSpec ivParameterSpec = (IvParameterSpec) params;
+    final byte[] ivBytes = ivParameterSpec.getIV();
+    init(opmode, key, ivBytes);
+  }
+
+  @Override
+  protected void engineInit(
+      final int opmode, final Key key, AlgorithmParameters params, final SecureRandom random)
+      throws InvalidKeyException, InvalidAlgorithmParameterException {
+    if (params == null) {
+      throw new InvalidAlgorithmParameterException("Params must not be null");
+    }
+    try {
+      engineInit(opmode, key, params.getParameterSpec(IvParameterSpec.class), random);
+    } catch (final InvalidParameterSpecException e) {
+      throw new InvalidAlgorithmParameterException(e);
+    }
+  }
+
+  private void init(final int opmode, final Key key, final byte[] ivBytes)
+      throws InvalidKeyException, InvalidAlgorithmParameterException {
+    if (ivBytes.length != IV_SIZE_IN_BYTES) {
+      throw new InvalidAlgorithmParameterException(
+          "Provided IV must be of length " + IV_SIZE_IN_BYTES);
+    }
+
+    if (!"RAW".equalsIgnoreCase(key.getFormat())) {
+      throw new InvalidKeyException("Key's format must be RAW");
+    }
+    final byte[] keyBytes = key.getEncoded();
+    if (keyBytes == null) {
+      throw new InvalidKeyException("Key must support encoding");
+    }
+    if (keyBytes.length != KEY_LEN_AES128
+        && keyBytes.length != KEY_LEN_AES192
+        && keyBytes.length != KEY_LEN_AES256) {
+      Arrays.fill(keyBytes, (byte) 0);
+      throw new InvalidKeyException(
+          "Key length must be "
+              + KEY_LEN_AES128
+              + ", "
+              + KEY_LEN_AES192
+              + ", or "
+              + KEY_LEN_AES256);
+    }
+
+    // Encryption and decryption are the same operation in CTR mode.
+    if (opmode != Cipher.ENCRYPT_MODE && opmode != Cipher.DECRYPT_MODE) {
+      Arrays.fill(keyBytes, (byte) 0);
+      throw new InvalidAlgorithmParameterException("Invalid opmode: " + opmode);
+    }
+    // getEncoded returns a fresh copy, which we keep instead of cloning it once more. The previous
+    // key is cleared so that reinitialization does not leave it behind on the heap.
+    if (this.key != null) {
+      Arrays.fill(this.key, (byte) 0);
+    }
+    this.keyLen = keyBytes.length;
+    this.key = keyBytes;
+    this.ivParamSpec = new IvParameterSpec(ivBytes);
+    this.position = 0;
+
+    // Free any existing context
+    if (context != null) {
+      context.release();
+      context = null;
+    }
+  }
+
+  @Override
+  protected byte[] engineUpdate(byte[] input, int inputOffset, int inputLen) {
+    final byte[] output = new byte[inputLen];
+    try {
+      engineUpdate(input, inputOffset, inputLen, output, 0);
+    } catch (ShortBufferException e) {
+      throw new AssertionError("Impossible condition", e);
+    }
+    return output;
+  }
+
+  @Override
+  protected int engineUpdate(
+      final byte[] input,
+      final int inputOffset,
+      final int inputLen,
+      final byte[] output,
+      final int outputOffset)
+      throws ShortBufferException {
+    Utils.checkArrayLimits(input, inputOffset, inputLen);
+    Utils.checkArrayLimits(output, outputOffset, output.length - outputOffset);
+    checkOutputSize(inputLen, output.length - outputOffset);
+    if (Utils.outputClobbersInput(input, inputOffset, inputLen, output, outputOffset)) {
+      final byte[] inputCopy = Arrays.copyOfRange(input, inputOffset, inputOffset + inputLen);
+      return update(null, inputCopy, 0, inputLen, null, output, outputOffset);
+    }
+    return update(null, input, inputOffset, inputLen, null, output, outputOffset);
+  }
+
+  @Override
+  protected int engineUpdate(final ByteBuffer input, final ByteBuffer output)
+      throws ShortBufferException {
+    checkOutputSize(input.remaining(), output.remaining());
+
+    final ByteBuffer source = copyIfClobbered(input, output);
+    final ShimByteBuffer inputShimByteBuffer = new ShimByteBuffer(source, true);
+    final ShimByteBuffer outputShimByteBuffer = new ShimByteBuffer(output, false);
+
+    final int result =
+        update(
+            inputShimByteBuffer.directByteBuffer,
+            inputShimByteBuffer.array,
+            inputShimByteBuffer.offset,
+            source.remaining(),
+            outputShimByteBuffer.directByteBuffer,
+            outputShimByteBuffer.array,
+            outputShimByteBuffer.offset);
+
+    outputShimByteBuffer.writeBack(result);
+
+    input.position(input.limit());
+    output.position(output.position() + result);
+
+    return result;
+  }
+
+  private static void checkOutputSize(final int inputLen, final int outputLen)
+      throws ShortBufferException {
+    if (outputLen < inputLen) {
+      throw new ShortBufferException();
+    }
+  }
+
+  /**
+   * The native code processes large inputs front to back in windows, so an output which starts
+   * within the input, after its start, would overwrite input that is yet to be read. Such inputs
+   * are copied first.
+   */
+  private static ByteBuffer copyIfClobbered(final ByteBuffer input, final ByteBuffer output) {
+    if (!Utils.outputClobbersInput(input, output)) {
+      return input;
+    }
+    final ByteBuffer copy = ByteBuffer.allocate(input.remaining());
+    copy.put(input.duplicate());
+    copy.flip();
+    return copy;
+  }
+
+  private int update(
+      final ByteBuffer inputDirect,
+      final byte[] inputArray,
+      final int inputOffset,
+      final int inputLen,
+      final ByteBuffer outputDirect,
+      final byte[] outputArray,
+      final int outputOffset) {
+    final int threads = threadsFor(inputLen);
+    final int result;
+    if (context == null) {
+      // First update, need to initialize
+      final long[] ctxContainer = new long[] {0};
+      result =
+          nInitUpdate(
+              key,
+              keyLen,
+              ivParamSpec.getIV(),
+              ctxContainer,
+              threads,
+              inputDirect,
+              inputArray,
+              inputOffset,
+              inputLen,
+              outputDirect,
+              outputArray,
+              outputOffset);
+      context = new NativeEvpCipherCtx(ctxContainer[0]);
+    } else {
+      // Subsequent update
+      final long start = position;
+      result =
+          context.use(
+              ctxPtr ->
+                  nUpdate(
+                      ctxPtr,
+                      ivParamSpec.getIV(),
+                      start,
+                      threads,
+                      inputDirect,
+                      inputArray,
+                      inputOffset,
+                      inputLen,
+                      outputDirect,
+                      outputArray,
+                      outputOffset));
+    }
+    position += result;
+    return result;
+  }
+
+  @Override
+  protected byte[] engineDoFinal(byte[] input, int inputOffset, int inputLen)
+      throws IllegalBlockSizeException, BadPaddingException {
+    final byte[] output = new byte[engineGetOutputSize(inputLen)];
+    try {
+      engineDoFinal(input, inputOffset, inputLen, output, 0);
+    } catch (ShortBufferException e) {
+      throw new AssertionError("Impossible condition", e);
+    }
+    return output;
+  }
+
+  @Override
+  protected int engineDoFinal(
+      final byte[] input,
+      final int inputOffset,
+      final int inputLen,
+      final byte[] output,
+      final int outputOffset)
+      throws ShortBufferException, IllegalBlockSizeException, BadPaddingException {
+    Utils.checkArrayLimits(input, inputOffset, inputLen);
+    Utils.checkArrayLimits(output, outputOffset, output.length - outputOffset);
+    checkOutputSize(inputLen, output.length - outputOffset);
+    if (Utils.outputClobbersInput(input, inputOffset, inputLen, output, outputOffset)) {
+      final byte[] inputCopy = Arrays.copyOfRange(input, inputOffset, inputOffset + inputLen);
+      return doFinal(null, inputCopy, 0, inputLen, null, output, outputOffset);
+    }
+    return doFinal(null, input, inputOffset, inputLen, null, output, outputOffset);
+  }
+
+  @Override
+  protected int engineDoFinal(final ByteBuffer input, final ByteBuffer output)
+      throws ShortBufferException, IllegalBlockSizeException, BadPaddingException {
+    checkOutputSize(input.remaining(), output.remaining());
+
+    final ByteBuffer source = copyIfClobbered(input, output);
+    final ShimByteBuffer inputShimByteBuffer = new ShimByteBuffer(source, true);
+    final ShimByteBuffer outputShimByteBuffer = new ShimByteBuffer(output, false);
+
+    final int result =
+        doFinal(
+            inputShimByteBuffer.directByteBuffer,
+            inputShimByteBuffer.array,
+            inputShimByteBuffer.offset,
+            source.remaining(),
+            outputShimByteBuffer.directByteBuffer,
+            outputShimByteBuffer.array,
+            outputShimByteBuffer.offset);
+
+    outputShimByteBuffer.writeBack(result);
+
+    input.position(input.limit());
+    output.position(output.position() + result);
+
+    return result;
+  }
+
+  private int doFinal(
+      final ByteBuffer inputDirect,
+      final byte[] inputArray,
+      final int inputOffset,
+      final int inputLen,
+      final ByteBuffer outputDirect,
+      final byte[] outputArray,
+      final int outputOffset) {
+    final int threads = threadsFor(inputLen);
+    int result;
+    if (context == null) {
+      // One-shot operation
+      result =
+          nInitUpdateFinal(
+              key,
+              keyLen,
+              ivParamSpec.getIV(),
+              threads,
+              inputDirect,
+              inputArray,
+              inputOffset,
+              inputLen,
+              outputDirect,
+              outputArray,
+              outputOffset);
+    } else {
+      // Final operation, take ownership of the context from Janitor
+      final long ctxPtr = context.take();
+      result =
+          nUpdateFinal(
+              ctxPtr,
+              ivParamSpec.getIV(),
+              position,
+              threads,
+              inputDirect,
+              inputArray,
+              inputOffset,
+              inputLen,
+              outputDirect,
+              outputArray,
+              outputOffset);
+      context = null; // nUpdateFinal releases the native context, so just null out our wrapper
+    }
+    // The cipher is reset to the state it was in after initialization.
+    position = 0;
+
+    return result;
+  }
+
+  // NOTE: a lot of the below functions could be decomposed into init, update,
+  // final, then combined in the java layer, but combining these functions into
+  // consolidated JNI lets us only make one JNI call per Java operation.
+
+  private static native int nInitUpdateFinal(
+      byte[] key,
+      int keyLen,
+      byte[] iv,
+      int threads,
+      ByteBuffer inputDirect,
+      byte[] inputArray,
+      int inputOffset,
+      int inputLen,
+      ByteBuffer outputDirect,
+      byte[] outputArray,
+      int outputOffset);
+
+  private static native int nInitUpdate(
+      byte[] key,
+      int keyLen,
+      byte[] iv,
+      long[] ctxContainer,
+      int threads,
+      ByteBuffer inputDirect,
+      byte[] inputArray,
+      int inputOffset,
+      int inputLen,
+      ByteBuffer outputDirect,
+      byte[] outputArray,
+      int outputOffset);
+
+  private static native int nUpdate(
+      long ctxPtr,
+      byte[] iv,
+      long position,
+      int threads,
+      ByteBuffer inputDirect,
+      byte[] inputArray,
+      int inputOffset,
+      int inputLen,
+      ByteBuffer outputDirect,
+      byte[] outputArray,
+      int outputOffset);
+
+  private static native int nUpdateFinal(
+      long ctxPtr,
+      byte[] iv,
+      long position,
+      int threads,
+      ByteBuffer inputDirect,
+      byte[] inputArray,
+      int inputOffset,
+      int inputLen,
+      ByteBuffer outputDirect,
+      byte[] outputArray,
+      int outputOffset);
+}
@@ -0,0 +1,89 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider;
+
+import java.util.logging.Logger;
+
+/**
+ * Opt-in, process-wide cache of keyed AES-GCM contexts shared by all {@link AesGcmSpi} instances.
+ *
+ * <p>Each {@link AesGcmSpi} normally only avoids re-keying its own native context when it is
+ * reused with the same key. Applications which create short-lived {@code Cipher} objects for a
+ * small set of keys therefore pay for AES key expansion and GHASH table setup on every operation.
+ * When this cache is enabled, new contexts are instead cloned from a context which was keyed once.
+ *
+ * <p>The cache is bounded by {@link #PROPERTY_CAPACITY} entries and is disabled by default. Entries
+ * are reference counted on the native side; an evicted entry is freed once the last {@link Entry}
+ * referring to it has been released.
+ */
+final class AesGcmKeyCache {
+  static {
+    Loader.load();
+  }
+
+  private static final Logger LOG = Logger.getLogger("AmazonCorrettoCryptoProvider");
+  private static final String PROPERTY_CAPACITY = "aesGcmKeyCacheSize";
+  private static final int CAPACITY = readCapacity();
+
+  private AesGcmKeyCache() {
+    // Prevent instantiation
+  }
+
+  /**
+   * Returns a referenced native cache entry for the given key, creating it if needed and evicting
+   * the least recently used entries beyond {@code capacity}.
+   */
+  private static native long acquireEntry(int capacity, byte[] key);
+
+  /** Drops the reference obtained from {@link #acquireEntry}. */
+  private static native void releaseEntry(long entryPtr);
+
+  /** Returns a new EVP_CIPHER_CTX cloned from the keyed entry and set up for {@code ivLen}. */
+  private static native long newContext(long entryPtr, int ivLen);
+
+  /** Overwrites an existing EVP_CIPHER_CTX with the keyed entry and sets up for {@code ivLen}. */
+  private static native void copyToContext(long entryPtr, long ctxPtr, int ivLen);
+
+  private static int readCapacity() {
+    final String propertyStr = Loader.getProperty(PROPERTY_CAPACITY, "0");
+    try {
+      final int capacity = Integer.parseInt(propertyStr);
+      if (capacity >= 0) {
+        return capacity;
+      }
+    } catch (final NumberFormatException ex) {
+      // Fall through to the warning below
+    }
+    LOG.warning(
+        String.format(
+            "Valid values for %s are non-negative integers, with 0 (disabled) as default",
+            PROPERTY_CAPACITY));
+    return 0;
+  }
+
+  static boolean isEnabled() {
+    return CAPACITY > 0;
+  }
+
+  /** A reference to a cached, keyed context. Released by the Janitor if not released explicitly. */
+  static final class Entry extends NativeResource {
+    private Entry(final long ptr) {
+      // Concurrent cloning of the cached context is safe, so readers need not be serialized.
+      super(ptr, AesGcmKeyCache::releaseEntry, true);
+    }
+
+    /** Returns a new native context holding this entry's key. */
+    NativeEvpCipherCtx newContext(final int ivLen) {
+      return new NativeEvpCipherCtx(use(ptr -> AesGcmKeyCache.newContext(ptr, ivLen)));
+    }
+
+    /** Re-keys an existing native context with this entry's key. */
+    void copyTo(final NativeResource context, final int ivLen) {
+      context.useVoid(ctxPtr -> useVoid(ptr -> AesGcmKeyCache.copyToContext(ptr, ctxPtr, ivLen)));
+    }
+  }
+
+  static Entry acquire(final byte[] key) {
+    return new Entry(acquireEntry(CAPACITY, key));
+  }
+}
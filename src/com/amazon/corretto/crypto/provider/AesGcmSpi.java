@@ -17,6 +17,7 @@ import java.security.spec.AlgorithmParameterSpec;
 import java.security.spec.InvalidKeySpecException;
 import java.security.spec.InvalidParameterSpecException;
 import java.util.Arrays;
+import java.util.logging.Logger;
 import javax.crypto.AEADBadTagException;
 import javax.crypto.BadPaddingException;
 import javax.crypto.Cipher;
@@ -171,7 +172,195 @@ final class AesGcmSpi extends CipherSpi {
       int outputOffset,
       int tagLen);
 
+  /**
+   * Equivalent to {@link #oneShotEncrypt} but reads from and writes to direct ByteBuffers without
+   * any intermediate copies. Offsets are absolute within each buffer.
+   */
+  private static native int oneShotEncryptDirect(
+      long ctxPtr,
+      boolean sameKey,
+      long[] ctxPtrOut,
+      ByteBuffer input,
+      int inputOffset,
+      int inputLength,
+      ByteBuffer result,
+      int resultOffset,
+      int tagLen,
+      byte[] key,
+      byte[] iv);
+
+  /**
+   * Equivalent to {@link #oneShotDecrypt} but reads from and writes to direct ByteBuffers. The
+   * plaintext is produced in native memory and only copied to {@code result} once the tag has been
+   * verified, so a failed decryption leaves {@code result} untouched. Offsets are absolute within
+   * each buffer.
+   */
+  private static native int oneShotDecryptDirect(
+      long ctxPtr,
+      boolean sameKey,
+      long[] ctxPtrOut,
+      ByteBuffer input,
+      int inoffset,
+      int inlen,
+      ByteBuffer result,
+      int resultOffset,
+      int tagLen,
+      byte[] key,
+      byte[] iv,
+      byte[] aadBuffer,
+      int aadSize)
+      throws AEADBadTagException;
+
+  /** Equivalent to {@link #encryptUpdate} but operates on direct ByteBuffers. */
+  private static native int encryptUpdateDirect(
+      long ptr, ByteBuffer input, int offset, int length, ByteBuffer output, int outputOffset);
+
+  /** Equivalent to {@link #encryptUpdateAAD} but operates on a direct ByteBuffer. */
+  private static native void encryptUpdateAADDirect(
+      long ptr, ByteBuffer input, int offset, int length);
+
+  /** Equivalent to {@link #encryptDoFinal} but operates on direct ByteBuffers. */
+  private static native int encryptDoFinalDirect(
+      long ptr,
+      boolean releaseContext,
+      ByteBuffer input,
+      int offset,
+      int length,
+      ByteBuffer output,
+      int outputOffset,
+      int tagLen);
+
+  /**
+   * Returns a new EVP_AEAD_CTX for the given key and the default 16-byte tag, which must be freed
+   * using {@link Utils#releaseEvpAeadCtx}.
+   */
+  private static native long aeadNewContext(byte[] key);
+
+  /**
+   * Encrypts a whole message with a 12-byte IV and a 16-byte tag using an EVP_AEAD_CTX. AAD is not
+   * supported. Input and output must not overlap.
+   *
+   * @return Number of bytes written, which is the input length plus the tag length
+   */
+  private static native int aeadSeal(
+      long ctxPtr,
+      byte[] input,
+      int inputOffset,
+      int inputLength,
+      byte[] result,
+      int resultOffset,
+      byte[] iv);
+
+  /**
+   * Decrypts and authenticates a whole message (ciphertext followed by a 16-byte tag) with a
+   * 12-byte IV using an EVP_AEAD_CTX. Input and output must not overlap. On failure, the output is
+   * zeroed.
+   *
+   * @return Number of bytes written, which is the input length minus the tag length
+   */
+  private static native int aeadOpen(
+      long ctxPtr,
+      byte[] input,
+      int inputOffset,
+      int inputLength,
+      byte[] result,
+      int resultOffset,
+      byte[] iv,
+      byte[] aadBuffer,
+      int aadSize)
+      throws AEADBadTagException;
+
+  /**
+   * Returns a reference to the process-wide NIST SP 800-38D deterministic IV generator for {@code
+   * key} and {@code fixedField}, which must be released using {@link #ivGeneratorRelease}. Every
+   * {@code Cipher} using the same key shares its counter, and generator numbers are never reused
+   * within the process.
+   */
+  private static native long ivGeneratorAcquire(byte[] key, int fixedField);
+
+  /**
+   * Returns a new generator which is not shared with any key and whose counter starts at {@code
+   * firstInvocation}, an unsigned value. Only used by tests.
+   */
+  private static native long ivGeneratorNew(int fixedField, int firstInvocation);
+
+  private static native void ivGeneratorRelease(long genPtr);
+
+  /** Writes the next 12-byte IV of the generator to {@code iv}. */
+  private static native void ivGeneratorNext(long genPtr, byte[] iv);
+
+  /**
+   * Like {@link #aeadSeal}, but takes the next IV from the generator and writes it to {@code
+   * ivOut}.
+   */
+  private static native int aeadSealWithGeneratedIv(
+      long ctxPtr,
+      long genPtr,
+      byte[] input,
+      int inputOffset,
+      int inputLength,
+      byte[] result,
+      int resultOffset,
+      byte[] ivOut);
+
+  private static final class IvGenerator extends NativeResource {
+    private IvGenerator(final byte[] key) {
+      // The invocation counter is atomic, so users of the shared generator need not be serialized.
+      super(
+          ivGeneratorAcquire(key, DETERMINISTIC_IV_FIXED_FIELD),
+          AesGcmSpi::ivGeneratorRelease,
+          true);
+    }
+  }
+
+  private static final Logger LOG = Logger.getLogger("AmazonCorrettoCryptoProvider");
+  private static final String PROPERTY_DETERMINISTIC_IV = "aesGcmDeterministicIv";
+  private static final String PROPERTY_DETERMINISTIC_IV_FIXED_FIELD =
+      "aesGcmDeterministicIvFixedField";
+  // The fixed field of deterministic IVs, which must identify this process among everything using
+  // the same keys. Only meaningful if DETERMINISTIC_IV is set.
+  private static final int DETERMINISTIC_IV_FIXED_FIELD;
+  // If enabled, encryption initialized without parameters uses deterministic IVs (the configured
+  // fixed field followed by a per-process generator number and a counter) instead of random ones.
+  private static final boolean DETERMINISTIC_IV;
+
+  static {
+    final Integer fixedField = readFixedFieldProperty();
+    boolean deterministic = Utils.getBooleanProperty(PROPERTY_DETERMINISTIC_IV, false);
+    if (deterministic && fixedField == null) {
+      // Without a fixed field unique to this process, another process using the same key could
+      // produce the same IVs. Random IVs are always safe, so keep using them.
+      LOG.warning(
+          String.format(
+              "%s requires %s to be set; using random IVs",
+              PROPERTY_DETERMINISTIC_IV, PROPERTY_DETERMINISTIC_IV_FIXED_FIELD));
+      deterministic = false;
+    }
+    DETERMINISTIC_IV = deterministic;
+    DETERMINISTIC_IV_FIXED_FIELD = fixedField != null ? fixedField : 0;
+  }
+
+  private static Integer readFixedFieldProperty() {
+    final String propertyStr = Loader.getProperty(PROPERTY_DETERMINISTIC_IV_FIXED_FIELD);
+    if (propertyStr == null) {
+      return null;
+    }
+    if (propertyStr.matches("[0-9a-fA-F]{8}")) {
+      return (int) Long.parseLong(propertyStr, 16);
+    }
+    LOG.warning(
+        String.format(
+            "Valid values for %s are exactly 8 hexadecimal digits, with no default",
+            PROPERTY_DETERMINISTIC_IV_FIXED_FIELD));
+    return null;
+  }
+
   private static final int BLOCK_SIZE = 128 / 8;
+  private static final int AEAD_IV_LENGTH_BYTES = 12;
+  private static final int AEAD_TAG_LENGTH_BYTES = 16;
+  // The EVP_AEAD path processes the whole message while holding the Java arrays, so it is limited
+  // to inputs which the EVP_CIPHER path would process in a single chunk anyway.
+  private static final int AEAD_MAX_INPUT_LENGTH = 256 * 1024;
 
   private final AmazonCorrettoCryptoProvider provider;
   private NativeResource context = null;
@@ -183,6 +372,20 @@ final class AesGcmSpi extends CipherSpi {
   // when the same Java key object is used to initialize a Cipher that was previously used.
   private Key lastKey = null;
   private byte[] iv, key;
+  // Reference into the shared AesGcmKeyCache for the key in cachedKeyBytes; only used if the cache
+  // is enabled.
+  private AesGcmKeyCache.Entry cachedKey = null;
+  private byte[] cachedKeyBytes = null;
+  // EVP_AEAD_CTX of the one-shot fast path, keyed with aeadKeyBytes. Kept across operations subject
+  // to the same release strategy as context.
+  private NativeResource aeadContext = null;
+  private byte[] aeadKeyBytes = null;
+  // Reference to the process-wide deterministic IV generator for ivGeneratorKey, kept across
+  // operations to avoid looking it up on every init.
+  private IvGenerator ivGenerator = null;
+  private byte[] ivGeneratorKey = null;
+  // True if iv is a placeholder to be filled from ivGenerator by the first native call needing it.
+  private boolean ivPending = false;
 
   /** GCM tag length in bytes. */
   private int tagLength = DEFAULT_TAG_LENGTH / 8;
@@ -273,6 +476,7 @@ final class AesGcmSpi extends CipherSpi {
 
   @Override
   protected byte[] engineGetIV() {
+    generatePendingIv();
     return (iv == null) ? null : iv.clone();
   }
 
@@ -280,6 +484,7 @@ final class AesGcmSpi extends CipherSpi {
   protected AlgorithmParameters engineGetParameters() {
     try {
       AlgorithmParameters parameters = AlgorithmParameters.getInstance("GCM");
+      generatePendingIv();
       byte[] ivForParams = iv;
       if (ivForParams == null) {
         // We aren't initialized so we return default and random values
@@ -300,6 +505,11 @@ final class AesGcmSpi extends CipherSpi {
       throw new InvalidKeyException("IV required for decrypt");
     }
 
+    if (DETERMINISTIC_IV) {
+      initWithGeneratedIv(key);
+      return;
+    }
+
     final byte[] iv = new byte[12];
     secureRandom.nextBytes(iv);
 
@@ -334,10 +544,50 @@ final class AesGcmSpi extends CipherSpi {
     this.key = newKey;
     this.lastKey = key;
     this.needReset = false;
+    this.ivPending = false;
 
     stateReset();
   }
 
+  /**
+   * Initializes for encryption with the default tag length and a deterministic IV, which is only
+   * produced by the native call which first needs it. A fresh IV is generated on every init, so
+   * the key/IV reuse check does not apply.
+   */
+  private void initWithGeneratedIv(final Key key) throws InvalidKeyException {
+    final byte[] newKey = checkKey(key, lastKey, this.key);
+
+    if (ivGenerator == null || !ConstantTime.equals(ivGeneratorKey, newKey)) {
+      if (ivGenerator != null) {
+        ivGenerator.release();
+      }
+      ivGenerator = new IvGenerator(newKey);
+      ivGeneratorKey = newKey;
+    }
+
+    this.opMode = NATIVE_MODE_ENCRYPT;
+    this.sameKey = ConstantTime.equals(this.key, newKey);
+    this.iv = new byte[DEFAULT_IV_LENGTH_BYTES];
+    this.tagLength = DEFAULT_TAG_LENGTH / 8;
+    this.key = newKey;
+    this.lastKey = key;
+    this.needReset = false;
+    this.ivPending = true;
+
+    stateReset();
+  }
+
+  /**
+   * Fills in a pending deterministic IV. Throws {@link IllegalStateException} if the invocation
+   * counter for the current key is exhausted.
+   */
+  private void generatePendingIv() {
+    if (ivPending) {
+      ivGenerator.useVoid(ptr -> ivGeneratorNext(ptr, iv));
+      ivPending = false;
+    }
+  }
+
   private static int checkOperation(final int opMode) throws InvalidAlgorithmParameterException {
     switch (opMode) {
       case Cipher.ENCRYPT_MODE:
@@ -513,7 +763,17 @@ final class AesGcmSpi extends CipherSpi {
 
   @Override
   protected void engineUpdateAAD(ByteBuffer byteBuffer) {
-    if (byteBuffer.hasArray()) {
+    if (byteBuffer.isDirect() && opMode == NATIVE_MODE_ENCRYPT) {
+      if (hasConsumedData) {
+        throw new IllegalStateException("AAD data cannot be updated after calling update()");
+      }
+
+      lazyInit();
+
+      final int offset = byteBuffer.position();
+      final int length = byteBuffer.remaining();
+      context.useVoid(ptr -> encryptUpdateAADDirect(ptr, byteBuffer, offset, length));
+    } else if (byteBuffer.hasArray()) {
       engineUpdateAAD(
           byteBuffer.array(),
           byteBuffer.arrayOffset() + byteBuffer.position(),
@@ -581,6 +841,12 @@ final class AesGcmSpi extends CipherSpi {
         // Context has not been initialized, meaning the user called doFinal immediately after
         // init(). In this case
         // we make a single native call to perform the encryption operation in one go.
+        if (canUseAead(finalInputLength)) {
+          return aeadSealOneShot(
+              finalInput, inputOffset, finalInputLength, output, finalOutputOffset);
+        }
+        generatePendingIv();
+        useCachedKeyState();
 
         if (context != null) {
           return context.use(
@@ -714,6 +980,12 @@ final class AesGcmSpi extends CipherSpi {
         throw new AEADBadTagException("Input too short - need tag");
       }
 
+      if (canUseAead(workingInputLength)) {
+        return aeadOpenOneShot(
+            workingInputArray, workingInputOffset, workingInputLength, output, outputOffset);
+      }
+
+      useCachedKeyState();
       if (context != null) {
         // We already have a context, so let's reuse it.
         return context.use(
@@ -833,6 +1105,221 @@ final class AesGcmSpi extends CipherSpi {
     }
   }
 
+  @Override
+  protected int engineDoFinal(final ByteBuffer input, final ByteBuffer output)
+      throws ShortBufferException, IllegalBlockSizeException, BadPaddingException {
+    // Only direct-to-direct operations benefit from a dedicated path; everything else goes through
+    // the array-based implementation.
+    if (!input.isDirect() || !output.isDirect() || Utils.outputClobbersInput(input, output)) {
+      return super.engineDoFinal(input, output);
+    }
+
+    switch (opMode) {
+      case NATIVE_MODE_ENCRYPT:
+        return engineEncryptFinalDirect(input, output);
+      case NATIVE_MODE_DECRYPT:
+        if (!decryptInputBuf.isEmpty()) {
+          // Previously buffered ciphertext must be processed together with this input.
+          return super.engineDoFinal(input, output);
+        }
+        return engineDecryptFinalDirect(input, output);
+      default:
+        throw new IllegalStateException("Cipher not initialized");
+    }
+  }
+
+  private void checkOutputBuffer(final int inputLength, final ByteBuffer output)
+      throws ShortBufferException {
+    final int requiredBufferSpace = engineGetOutputSize(inputLength);
+    if (output.remaining() < requiredBufferSpace) {
+      throw new ShortBufferException(
+          String.format(
+              "Expected a buffer of at least %d bytes; got %d",
+              requiredBufferSpace, output.remaining()));
+    }
+  }
+
+  private int engineEncryptFinalDirect(final ByteBuffer input, final ByteBuffer output)
+      throws ShortBufferException {
+    final int inputOffset = input.position();
+    final int inputLen = input.remaining();
+    final int outputOffset = output.position();
+
+    checkOutputBuffer(inputLen, output);
+
+    // Any future success or failure should trigger reset
+    try {
+      checkNeedReset();
+
+      this.needReset = true;
+      final int outputLen;
+
+      if (!contextInitialized) {
+        generatePendingIv();
+        useCachedKeyState();
+        if (context != null) {
+          outputLen =
+              context.use(
+                  ptr ->
+                      oneShotEncryptDirect(
+                          ptr,
+                          sameKey,
+                          null,
+                          input,
+                          inputOffset,
+                          inputLen,
+                          output,
+                          outputOffset,
+                          tagLength,
+                          key,
+                          iv));
+        } else if (saveNativeContext()) {
+          final long[] ptrOut = new long[1];
+          outputLen =
+              oneShotEncryptDirect(
+                  0,
+                  false,
+                  ptrOut,
+                  input,
+                  inputOffset,
+                  inputLen,
+                  output,
+                  outputOffset,
+                  tagLength,
+                  key,
+                  iv);
+          context = new NativeEvpCipherCtx(ptrOut[0]);
+        } else {
+          outputLen =
+              oneShotEncryptDirect(
+                  0,
+                  false,
+                  null,
+                  input,
+                  inputOffset,
+                  inputLen,
+                  output,
+                  outputOffset,
+                  tagLength,
+                  key,
+                  iv);
+        }
+      } else if (saveNativeContext()) {
+        outputLen =
+            context.use(
+                ptr ->
+                    encryptDoFinalDirect(
+                        ptr,
+                        false, // releaseContext
+                        input,
+                        inputOffset,
+                        inputLen,
+                        output,
+                        outputOffset,
+                        tagLength));
+      } else {
+        outputLen =
+            encryptDoFinalDirect(
+                context.take(),
+                true, // releaseContext
+                input,
+                inputOffset,
+                inputLen,
+                output,
+                outputOffset,
+                tagLength);
+        context = null;
+      }
+
+      input.position(input.limit());
+      output.position(outputOffset + outputLen);
+      return outputLen;
+    } finally {
+      stateReset();
+    }
+  }
+
+  private int engineDecryptFinalDirect(final ByteBuffer input, final ByteBuffer output)
+      throws AEADBadTagException, ShortBufferException {
+    final int inputOffset = input.position();
+    final int inputLen = input.remaining();
+    final int outputOffset = output.position();
+
+    checkOutputBuffer(inputLen, output);
+
+    // Any future failure (or success) should trigger reset
+    try {
+      if (inputLen < tagLength) {
+        throw new AEADBadTagException("Input too short - need tag");
+      }
+
+      final byte[] aad = decryptAADBuf.isEmpty() ? EMPTY_ARRAY : decryptAADBuf.getDataBuffer();
+      final int aadSize = decryptAADBuf.size();
+      final int outputLen;
+
+      useCachedKeyState();
+      if (context != null) {
+        outputLen =
+            context.use(
+                ptr ->
+                    oneShotDecryptDirect(
+                        ptr,
+                        sameKey,
+                        null,
+                        input,
+                        inputOffset,
+                        inputLen,
+                        output,
+                        outputOffset,
+                        tagLength,
+                        key,
+                        iv,
+                        aad,
+                        aadSize));
+      } else if (saveNativeContext()) {
+        final long[] ptrOut = new long[1];
+        outputLen =
+            oneShotDecryptDirect(
+                0,
+                false,
+                ptrOut,
+                input,
+                inputOffset,
+                inputLen,
+                output,
+                outputOffset,
+                tagLength,
+                key,
+                iv,
+                aad,
+                aadSize);
+        context = new NativeEvpCipherCtx(ptrOut[0]);
+      } else {
+        outputLen =
+            oneShotDecryptDirect(
+                0,
+                false,
+                null,
+                input,
+                inputOffset,
+                inputLen,
+                output,
+                outputOffset,
+                tagLength,
+                key,
+                iv,
+                aad,
+                aadSize);
+      }
+
+      input.position(input.limit());
+      output.position(outputOffset + outputLen);
+      return outputLen;
+    } finally {
+      stateReset();
+    }
+  }
+
   @Override
   protected byte[] engineWrap(final Key key) throws IllegalBlockSizeException, InvalidKeyException {
     if (opMode != NATIVE_MODE_ENCRYPT) {
@@ -926,6 +1413,27 @@ final class AesGcmSpi extends CipherSpi {
           throw new ShortBufferException();
         }
 
+        if (input.isDirect() && output.isDirect() && !Utils.outputClobbersInput(input, output)) {
+          // Both buffers live outside of the Java heap, so native code can work on them in place.
+          hasConsumedData = true;
+          lazyInit();
+
+          final ByteBuffer directInput = input;
+          final int outputBytes =
+              context.use(
+                  ptr ->
+                      encryptUpdateDirect(
+                          ptr,
+                          directInput,
+                          directInput.position(),
+                          directInput.remaining(),
+                          output,
+                          initialPosition));
+          input.position(input.limit());
+          output.position(initialPosition + outputBytes);
+          return outputBytes;
+        }
+
         if (Utils.outputClobbersInput(input, output)) {
           // We'll just copy the whole input buffer if it might overlap with output.
           ByteBuffer newInput = ByteBuffer.allocate(input.remaining());
@@ -997,6 +1505,8 @@ final class AesGcmSpi extends CipherSpi {
     }
 
     checkNeedReset();
+    generatePendingIv();
+    useCachedKeyState();
 
     if (context != null) {
       context.useVoid(ptr -> encryptInit(ptr, sameKey, key, iv));
@@ -1005,6 +1515,133 @@ final class AesGcmSpi extends CipherSpi {
     }
   }
 
+  /**
+   * Returns true if a whole-message operation of {@code inputLength} bytes can use the EVP_AEAD
+   * fast path. This covers the common 12-byte IV and 16-byte tag case. When the shared key cache is
+   * enabled, cloning cached contexts is preferred, since it also avoids key setup for new {@code
+   * Cipher} objects.
+   */
+  private boolean canUseAead(final int inputLength) {
+    return iv.length == AEAD_IV_LENGTH_BYTES
+        && tagLength == AEAD_TAG_LENGTH_BYTES
+        && inputLength <= AEAD_MAX_INPUT_LENGTH
+        && !AesGcmKeyCache.isEnabled();
+  }
+
+  private int aeadSealOneShot(
+      final byte[] input,
+      final int inputOffset,
+      final int inputLength,
+      final byte[] output,
+      final int outputOffset) {
+    try {
+      final NativeResource ctx = prepareAeadContext();
+      if (ivPending) {
+        final int result =
+            ivGenerator.use(
+                genPtr ->
+                    ctx.use(
+                        ptr ->
+                            aeadSealWithGeneratedIv(
+                                ptr,
+                                genPtr,
+                                input,
+                                inputOffset,
+                                inputLength,
+                                output,
+                                outputOffset,
+                                iv)));
+        ivPending = false;
+        return result;
+      }
+      return ctx.use(
+          ptr -> aeadSeal(ptr, input, inputOffset, inputLength, output, outputOffset, iv));
+    } finally {
+      finishAeadContext();
+    }
+  }
+
+  private int aeadOpenOneShot(
+      final byte[] input,
+      final int inputOffset,
+      final int inputLength,
+      final byte[] output,
+      final int outputOffset)
+      throws AEADBadTagException {
+    // See engineDecryptFinal on why we avoid decryptAADBuf.getDataBuffer() for empty AAD.
+    final byte[] aad = decryptAADBuf.isEmpty() ? EMPTY_ARRAY : decryptAADBuf.getDataBuffer();
+    final int aadLength = decryptAADBuf.size();
+    try {
+      return prepareAeadContext()
+          .use(
+              ptr ->
+                  aeadOpen(
+                      ptr,
+                      input,
+                      inputOffset,
+                      inputLength,
+                      output,
+                      outputOffset,
+                      iv,
+                      aad,
+                      aadLength));
+    } finally {
+      finishAeadContext();
+    }
+  }
+
+  private NativeResource prepareAeadContext() {
+    if (!sameKey && context != null) {
+      // The EVP_CIPHER context still holds the previous key. This operation does not re-key it, so
+      // drop it rather than let a later operation treat it as keyed with the current key.
+      context.release();
+      context = null;
+    }
+    if (aeadContext != null && !ConstantTime.equals(aeadKeyBytes, key)) {
+      aeadContext.release();
+      aeadContext = null;
+    }
+    if (aeadContext == null) {
+      aeadContext = new NativeEvpAeadCtx(aeadNewContext(key));
+    }
+    aeadKeyBytes = key;
+    return aeadContext;
+  }
+
+  private void finishAeadContext() {
+    if (aeadContext != null && !saveNativeContext()) {
+      aeadContext.release();
+      aeadContext = null;
+      aeadKeyBytes = null;
+    }
+  }
+
+  /**
+   * If the shared key cache is enabled and the native context would otherwise have to be keyed from
+   * scratch, clones (or re-keys) the context from the cached key state instead. Afterwards only the
+   * IV needs to be set, so {@code sameKey} is set accordingly.
+   */
+  private void useCachedKeyState() {
+    if (!AesGcmKeyCache.isEnabled() || (sameKey && context != null)) {
+      return;
+    }
+
+    if (cachedKey == null || cachedKeyBytes != key) {
+      if (cachedKey != null) {
+        cachedKey.release();
+      }
+      cachedKey = AesGcmKeyCache.acquire(key);
+      cachedKeyBytes = key;
+    }
+
+    if (context == null) {
+      context = cachedKey.newContext(iv.length);
+    } else {
+      cachedKey.copyTo(context, iv.length);
+    }
+    sameKey = true;
+  }
+
   /**
    * Throws {@link IllegalStateException} if we're about to do a second encrypt call without
    * changing either the key or IV.
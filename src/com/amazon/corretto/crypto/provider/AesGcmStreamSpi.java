@@ -0,0 +1,560 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider;
+
+import static com.amazon.corretto.crypto.provider.Utils.EMPTY_ARRAY;
+import static com.amazon.corretto.crypto.provider.Utils.checkArrayLimits;
+
+import java.security.AlgorithmParameters;
+import java.security.InvalidAlgorithmParameterException;
+import java.security.InvalidKeyException;
+import java.security.Key;
+import java.security.NoSuchAlgorithmException;
+import java.security.SecureRandom;
+import java.security.spec.AlgorithmParameterSpec;
+import java.security.spec.InvalidParameterSpecException;
+import java.util.Arrays;
+import java.util.logging.Logger;
+import javax.crypto.AEADBadTagException;
+import javax.crypto.BadPaddingException;
+import javax.crypto.Cipher;
+import javax.crypto.CipherSpi;
+import javax.crypto.IllegalBlockSizeException;
+import javax.crypto.NoSuchPaddingException;
+import javax.crypto.ShortBufferException;
+import javax.crypto.spec.IvParameterSpec;
+
+/**
+ * Segmented streaming AES-GCM, for encrypting objects too large to hold in memory.
+ *
+ * <p>The plaintext is split into segments of {@link #SEGMENT_SIZE} bytes (the last one may be
+ * shorter, or even empty) and every segment is sealed with its own AES-GCM tag. The per-stream key
+ * and nonce prefix are derived with HKDF-SHA256 from the key, the 16-byte IV (as salt) and the AAD
+ * (as info); segment nonces encode the segment index and whether it is the last segment, so
+ * segments cannot be reordered, dropped or truncated without detection. Unlike AES/GCM/NoPadding,
+ * decryption releases plaintext one authenticated segment at a time, so memory use is bounded by
+ * the segment size rather than by the size of the object.
+ *
+ * <p>Ciphertext is the concatenation of the sealed segments; the IV is not included. Since the
+ * final segment must be recognized as such, {@code update} always holds back the last (possibly
+ * complete) segment until more input or {@code doFinal} arrives.
+ *
+ * <p>Calls covering several complete segments may seal or open them on up to {@link
+ * #PROPERTY_THREADS} native threads in a single native call.
+ */
+final class AesGcmStreamSpi extends CipherSpi {
+  static {
+    Loader.load();
+  }
+
+  private static final Logger LOG = Logger.getLogger("AmazonCorrettoCryptoProvider");
+  static final int SEGMENT_SIZE = 64 * 1024;
+  private static final int TAG_LENGTH = 16;
+  private static final int IV_LENGTH = 16;
+  private static final long MAX_SEGMENTS = 1L << 32;
+
+  private static final String PROPERTY_THREADS = "aesGcmStreamThreads";
+  private static final int MAX_THREADS = 64;
+  private static final int THREADS = Math.min(MAX_THREADS, readThreadsProperty());
+
+  private static final int NATIVE_MODE_ENCRYPT = 1;
+  private static final int NATIVE_MODE_DECRYPT = 0;
+
+  /**
+   * Derives the stream key and nonce prefix. The result must be freed using {@link #freeStream}.
+   */
+  private static native long newStream(byte[] key, byte[] iv, byte[] aad, int aadSize);
+
+  private static native void freeStream(long streamPtr);
+
+  /**
+   * Seals consecutive segments, starting at {@code firstSegment}. Unless {@code isFinal}, the
+   * input must be a whole number of segments. Input and output must not overlap.
+   *
+   * @return the number of bytes written
+   */
+  private static native int sealSegments(
+      long streamPtr,
+      int segmentSize,
+      long firstSegment,
+      boolean isFinal,
+      int threads,
+      byte[] input,
+      int inputOffset,
+      int inputLength,
+      byte[] output,
+      int outputOffset);
+
+  /**
+   * Opens consecutive sealed segments, starting at {@code firstSegment}. Unless {@code isFinal},
+   * the input must be a whole number of sealed segments. Input and output must not overlap. On
+   * failure, the output is zeroed.
+   *
+   * @return the number of bytes written
+   */
+  private static native int openSegments(
+      long streamPtr,
+      int segmentSize,
+      long firstSegment,
+      boolean isFinal,
+      int threads,
+      byte[] input,
+      int inputOffset,
+      int inputLength,
+      byte[] output,
+      int outputOffset)
+      throws AEADBadTagException;
+
+  private static int readThreadsProperty() {
+    final String propertyStr = Loader.getProperty(PROPERTY_THREADS, "1");
+    try {
+      final int value = Integer.parseInt(propertyStr);
+      if (value >= 1) {
+        return value;
+      }
+    } catch (final NumberFormatException ex) {
+      // Fall through to the warning below
+    }
+    LOG.warning(
+        String.format(
+            "Valid values for %s are positive integers, with 1 as default", PROPERTY_THREADS));
+    return 1;
+  }
+
+  private static final class NativeStream extends NativeResource {
+    private NativeStream(final long ptr) {
+      super(ptr, AesGcmStreamSpi::freeStream);
+    }
+  }
+
+  private int opMode = -1;
+  private byte[] key;
+  private Key lastKey;
+  private byte[] iv;
+  private boolean needReset = false;
+
+  private final AccessibleByteArrayOutputStream aadBuf =
+      new AccessibleByteArrayOutputStream(0, Integer.MAX_VALUE);
+  private NativeStream stream = null;
+  private long nextSegment = 0;
+  // Input held back from the native code: at most one segment (plus tag, when decrypting).
+  private byte[] pending = null;
+  private int pendingLength = 0;
+
+  AesGcmStreamSpi(final AmazonCorrettoCryptoProvider provider) {
+    Loader.checkNativeLibraryAvailability();
+  }
+
+  private int inputUnit() {
+    return opMode == NATIVE_MODE_ENCRYPT ? SEGMENT_SIZE : SEGMENT_SIZE + TAG_LENGTH;
+  }
+
+  private int outputUnit() {
+    return opMode == NATIVE_MODE_ENCRYPT ? SEGMENT_SIZE + TAG_LENGTH : SEGMENT_SIZE;
+  }
+
+  @Override
+  protected void engineSetMode(final String mode) throws NoSuchAlgorithmException {
+    if (!"GCM-STREAM".equalsIgnoreCase(mode)) {
+      throw new NoSuchAlgorithmException();
+    }
+  }
+
+  @Override
+  protected void engineSetPadding(final String padding) throws NoSuchPaddingException {
+    if (!"NoPadding".equalsIgnoreCase(padding)) {
+      throw new NoSuchPaddingException();
+    }
+  }
+
+  @Override
+  protected int engineGetBlockSize() {
+    return 16;
+  }
+
+  @Override
+  protected int engineGetKeySize(final Key key) throws InvalidKeyException {
+    return checkKey(key).length * 8;
+  }
+
+  @Override
+  protected int engineGetOutputSize(final int inputLen) {
+    if (opMode < 0) {
+      throw new IllegalStateException("Cipher not initialized");
+    }
+    // Worst case is doFinal, which processes everything
+    final long total = (long) pendingLength + inputLen;
+    final long segments;
+    final long result;
+    if (opMode == NATIVE_MODE_ENCRYPT) {
+      segments = Math.max(1, (total + SEGMENT_SIZE - 1) / SEGMENT_SIZE);
+      result = total + segments * TAG_LENGTH;
+    } else {
+      segments = (total + inputUnit() - 1) / inputUnit();
+      result = Math.max(0, total - segments * TAG_LENGTH);
+    }
+    return (int) Math.min(Integer.MAX_VALUE, result);
+  }
+
+  /** Exact number of bytes written by an update with {@code inputLen} bytes. */
+  private int updateOutputSize(final int inputLen) {
+    final long total = (long) pendingLength + inputLen;
+    // The last segment, which may be complete, is always held back.
+    final long segments = total == 0 ? 0 : (total - 1) / inputUnit();
+    return (int) Math.min(Integer.MAX_VALUE, segments * outputUnit());
+  }
+
+  @Override
+  protected byte[] engineGetIV() {
+    return iv == null ? null : iv.clone();
+  }
+
+  @Override
+  protected AlgorithmParameters engineGetParameters() {
+    try {
+      final AlgorithmParameters parameters = AlgorithmParameters.getInstance("AES");
+      byte[] ivForParams = iv;
+      if (ivForParams == null) {
+        // We aren't initialized so we return a random IV
+        ivForParams = new byte[IV_LENGTH];
+        new LibCryptoRng().nextBytes(ivForParams);
+      }
+      parameters.init(new IvParameterSpec(ivForParams));
+      return parameters;
+    } catch (final InvalidParameterSpecException | NoSuchAlgorithmException e) {
+      throw new RuntimeCryptoException("Unexpected error", e);
+    }
+  }
+
+  @Override
+  protected void engineInit(final int opMode, final Key key, final SecureRandom random)
+      throws InvalidKeyException {
+    if (opMode != Cipher.ENCRYPT_MODE && opMode != Cipher.WRAP_MODE) {
+      throw new InvalidKeyException("IV required for decrypt");
+    }
+    final byte[] iv = new byte[IV_LENGTH];
+    random.nextBytes(iv);
+    try {
+      engineInit(opMode, key, new IvParameterSpec(iv), random);
+    } catch (final InvalidAlgorithmParameterException e) {
+      throw new AssertionError(e);
+    }
+  }
+
+  @Override
+  protected void engineInit(
+      final int jceOpMode,
+      final Key key,
+      final AlgorithmParameterSpec params,
+      final SecureRandom random)
+      throws InvalidKeyException, InvalidAlgorithmParameterException {
+    if (params == null) {
+      engineInit(jceOpMode, key, random);
+      return;
+    }
+    final int opMode;
+    switch (jceOpMode) {
+      case Cipher.ENCRYPT_MODE:
+      case Cipher.WRAP_MODE:
+        opMode = NATIVE_MODE_ENCRYPT;
+        break;
+      case Cipher.DECRYPT_MODE:
+      case Cipher.UNWRAP_MODE:
+        opMode = NATIVE_MODE_DECRYPT;
+        break;
+      default:
+        throw new InvalidAlgorithmParameterException("Unsupported cipher mode " + jceOpMode);
+    }
+    if (!(params instanceof IvParameterSpec)) {
+      throw new InvalidAlgorithmParameterException(
+          "I don't know how to handle a " + params.getClass());
+    }
+    final byte[] newIv = ((IvParameterSpec) params).getIV();
+    if (newIv.length != IV_LENGTH) {
+      throw new InvalidAlgorithmParameterException("IV must be " + IV_LENGTH + " bytes long");
+    }
+    final byte[] newKey = key == lastKey && this.key != null ? this.key : checkKey(key);
+    if (opMode == NATIVE_MODE_ENCRYPT
+        && Arrays.equals(newIv, this.iv)
+        && ConstantTime.equals(newKey, this.key)) {
+      throw new InvalidAlgorithmParameterException(
+          "Cannot reuse same IV and key for GCM-STREAM encryption");
+    }
+
+    this.opMode = opMode;
+    this.key = newKey;
+    this.lastKey = key;
+    this.iv = newIv;
+    this.needReset = false;
+    stateReset();
+  }
+
+  @Override
+  protected void engineInit(
+      final int opMode,
+      final Key key,
+      final AlgorithmParameters params,
+      final SecureRandom random)
+      throws InvalidKeyException, InvalidAlgorithmParameterException {
+    if (params == null) {
+      engineInit(opMode, key, random);
+      return;
+    }
+    try {
+      engineInit(opMode, key, params.getParameterSpec(IvParameterSpec.class), random);
+    } catch (final InvalidParameterSpecException e) {
+      throw new InvalidAlgorithmParameterException(e);
+    }
+  }
+
+  private static byte[] checkKey(final Key key) throws InvalidKeyException {
+    if (key == null) {
+      throw new InvalidKeyException("Key can't be null");
+    }
+    if (!"AES".equalsIgnoreCase(key.getAlgorithm())) {
+      throw new InvalidKeyException("Unsupported key algorithm: " + key.getAlgorithm());
+    }
+    if (!"RAW".equalsIgnoreCase(key.getFormat())) {
+      throw new InvalidKeyException("Key's format must be RAW");
+    }
+    final byte[] encoded = key.getEncoded();
+    if (encoded == null
+        || (encoded.length != 16 && encoded.length != 24 && encoded.length != 32)) {
+      throw new InvalidKeyException("Bad key length");
+    }
+    return encoded;
+  }
+
+  private void checkInitialized() {
+    if (opMode < 0) {
+      throw new IllegalStateException("Cipher not initialized");
+    }
+    if (needReset) {
+      throw new IllegalStateException("Must change key or IV for GCM-STREAM encryption");
+    }
+  }
+
+  @Override
+  protected void engineUpdateAAD(final byte[] input, final int offset, final int len) {
+    checkInitialized();
+    checkArrayLimits(input, offset, len);
+    if (stream != null || pendingLength != 0) {
+      throw new IllegalStateException("AAD must be supplied before encryption/decryption data");
+    }
+    aadBuf.write(input, offset, len);
+  }
+
+  @Override
+  protected byte[] engineUpdate(final byte[] input, final int offset, final int len) {
+    checkInitialized();
+    final byte[] output = new byte[updateOutputSize(len)];
+    try {
+      final int written = engineUpdate(input, offset, len, output, 0);
+      return written == output.length ? output : Arrays.copyOf(output, written);
+    } catch (final ShortBufferException e) {
+      throw new AssertionError(e);
+    }
+  }
+
+  @Override
+  protected int engineUpdate(
+      final byte[] input,
+      final int offset,
+      final int len,
+      final byte[] output,
+      final int outputOffset)
+      throws ShortBufferException {
+    checkInitialized();
+    checkArrayLimits(input, offset, len);
+    checkOutput(output, outputOffset, updateOutputSize(len));
+    try {
+      return process(input, offset, len, output, outputOffset, false);
+    } catch (final AEADBadTagException e) {
+      // Plaintext released by earlier calls was authenticated, but this stream cannot continue.
+      // update cannot throw AEADBadTagException itself, so it is wrapped.
+      stateReset();
+      throw new RuntimeCryptoException("Segment authentication failed", e);
+    }
+  }
+
+  @Override
+  protected byte[] engineDoFinal(final byte[] input, final int offset, final int len)
+      throws IllegalBlockSizeException, BadPaddingException {
+    checkInitialized();
+    final byte[] output = new byte[engineGetOutputSize(len)];
+    try {
+      final int written = engineDoFinal(input, offset, len, output, 0);
+      return written == output.length ? output : Arrays.copyOf(output, written);
+    } catch (final ShortBufferException e) {
+      throw new AssertionError(e);
+    }
+  }
+
+  @Override
+  protected int engineDoFinal(
+      byte[] input,
+      final int offset,
+      final int len,
+      final byte[] output,
+      final int outputOffset)
+      throws ShortBufferException, IllegalBlockSizeException, BadPaddingException {
+    // The following failures should not trigger reset
+    checkInitialized();
+    if (input == null) {
+      input = EMPTY_ARRAY;
+    }
+    checkArrayLimits(input, offset, len);
+    checkOutput(output, outputOffset, engineGetOutputSize(len));
+
+    // Any future failure (or success) should trigger reset
+    try {
+      if (opMode == NATIVE_MODE_ENCRYPT) {
+        needReset = true;
+      }
+      return process(input, offset, len, output, outputOffset, true);
+    } finally {
+      stateReset();
+    }
+  }
+
+  private static void checkOutput(final byte[] output, final int outputOffset, final int needed)
+      throws ShortBufferException {
+    if (needed == 0) {
+      return;
+    }
+    if (output == null || outputOffset < 0 || output.length - outputOffset < needed) {
+      throw new ShortBufferException(
+          String.format(
+              "Expected a buffer of at least %d bytes; got %d",
+              needed, output == null ? 0 : output.length - outputOffset));
+    }
+  }
+
+  /**
+   * Processes all complete segments which can be determined not to be the last one, or
+   * everything if {@code isFinal}, and holds back the rest in {@link #pending}.
+   */
+  private int process(
+      byte[] input,
+      int offset,
+      int len,
+      final byte[] output,
+      final int outputOffset,
+      final boolean isFinal)
+      throws AEADBadTagException {
+    final int unit = inputUnit();
+    if (!isFinal && (long) pendingLength + len <= unit) {
+      // Not enough to know whether the pending segment is the last one
+      appendPending(input, offset, len);
+      return 0;
+    }
+    if (input == output && len != 0) {
+      // Segments grow or shrink by a tag, so the output would run over unprocessed input.
+      input = Arrays.copyOfRange(input, offset, offset + len);
+      offset = 0;
+    }
+
+    int written = 0;
+    if (pendingLength != 0) {
+      final int fill = Math.min(unit - pendingLength, len);
+      appendPending(input, offset, fill);
+      offset += fill;
+      len -= fill;
+      // The pending segment is complete, and only the last one if no input remains.
+      final boolean last = isFinal && len == 0;
+      written += processSegments(pending, 0, pendingLength, output, outputOffset, last);
+      pendingLength = 0;
+      if (last) {
+        return written;
+      }
+    }
+    if (isFinal) {
+      return written + processSegments(input, offset, len, output, outputOffset + written, true);
+    }
+    final int direct = len == 0 ? 0 : ((len - 1) / unit) * unit;
+    if (direct != 0) {
+      written += processSegments(input, offset, direct, output, outputOffset + written, false);
+    }
+    appendPending(input, offset + direct, len - direct);
+    return written;
+  }
+
+  private void appendPending(final byte[] input, final int offset, final int len) {
+    if (len == 0) {
+      return;
+    }
+    if (pending == null || pending.length != inputUnit()) {
+      pending = new byte[inputUnit()];
+    }
+    System.arraycopy(input, offset, pending, pendingLength, len);
+    pendingLength += len;
+  }
+
+  private int processSegments(
+      final byte[] input,
+      final int offset,
+      final int len,
+      final byte[] output,
+      final int outputOffset,
+      final boolean isFinal)
+      throws AEADBadTagException {
+    final long segments =
+        isFinal ? Math.max(1, ((long) len + inputUnit() - 1) / inputUnit()) : len / inputUnit();
+    if (nextSegment + segments > MAX_SEGMENTS) {
+      throw new IllegalStateException("Too much data for a single GCM-STREAM stream");
+    }
+    if (stream == null) {
+      final byte[] aad = aadBuf.isEmpty() ? EMPTY_ARRAY : aadBuf.getDataBuffer();
+      stream = new NativeStream(newStream(key, iv, aad, aadBuf.size()));
+    }
+    final long firstSegment = nextSegment;
+    final int threads = (int) Math.min(THREADS, segments);
+    final int result;
+    if (opMode == NATIVE_MODE_ENCRYPT) {
+      result =
+          stream.use(
+              ptr ->
+                  sealSegments(
+                      ptr,
+                      SEGMENT_SIZE,
+                      firstSegment,
+                      isFinal,
+                      threads,
+                      input,
+                      offset,
+                      len,
+                      output,
+                      outputOffset));
+    } else {
+      result =
+          stream.use(
+              ptr ->
+                  openSegments(
+                      ptr,
+                      SEGMENT_SIZE,
+                      firstSegment,
+                      isFinal,
+                      threads,
+                      input,
+                      offset,
+                      len,
+                      output,
+                      outputOffset));
+    }
+    nextSegment += segments;
+    return result;
+  }
+
+  private void stateReset() {
+    aadBuf.reset();
+    if (stream != null) {
+      stream.release();
+      stream = null;
+    }
+    nextSegment = 0;
+    if (pending != null) {
+      Arrays.fill(pending, 0, pendingLength, (byte) 0);
+    }
+    pendingLength = 0;
+  }
+}
@@ -0,0 +1,201 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider;
+
+import java.nio.ByteBuffer;
+import java.security.InvalidAlgorithmParameterException;
+import java.security.InvalidKeyException;
+import java.security.Key;
+import java.security.spec.AlgorithmParameterSpec;
+import java.util.Arrays;
+import java.util.Objects;
+import javax.crypto.MacSpi;
+import javax.crypto.SecretKey;
+import javax.crypto.spec.GCMParameterSpec;
+import javax.crypto.spec.IvParameterSpec;
+
+/**
+ * AES-GMAC as specified in NIST SP 800-38D: AES-GCM with an empty plaintext, where the message is
+ * authenticated as AAD. Tags are 128 bits long.
+ *
+ * <p>The IV is given as an {@link IvParameterSpec} or a {@link GCMParameterSpec} (whose tag length
+ * must be 128 bits) when initializing the {@code Mac}. As required by the {@code Mac} contract,
+ * {@code doFinal} and {@code reset} keep both the key and the IV. Callers creating tags must
+ * therefore initialize the {@code Mac} with a fresh IV for every message: authenticating two
+ * different messages under the same key and IV reveals the GHASH key and allows forgeries.
+ *
+ * <p>Like {@link EvpHmac}, input is buffered on the Java side so that short messages are
+ * authenticated by a single native call. The native context is keyed once per key, which expands
+ * the AES key and precomputes the GHASH tables; re-initializing with the same key only sets the IV.
+ */
+final class AesGmacSpi extends MacSpi implements Cloneable {
+  static {
+    Loader.load();
+  }
+
+  private static final int MAC_LENGTH = 16;
+
+  /** Returns a new EVP_CIPHER_CTX keyed with {@code key} for AES-GCM. */
+  private static native long newContext(byte[] key);
+
+  private static native long cloneContext(long ctxPtr);
+
+  /** Absorbs {@code input} as AAD, first starting a new message if {@code iv} is not null. */
+  private static native void update(long ctxPtr, byte[] iv, byte[] input, int offset, int length);
+
+  /** As {@link #update}, but reads the remaining bytes of the direct ByteBuffer {@code input}. */
+  private static native void updateDirect(long ctxPtr, byte[] iv, ByteBuffer input);
+
+  /** Finishes the message and places the tag in {@code result}. */
+  private static native void doFinal(long ctxPtr, byte[] result);
+
+  /** Computes the GMAC of {@code input} under {@code iv} into {@code result}. */
+  private static native void fastMac(
+      long ctxPtr, byte[] iv, byte[] input, int offset, int length, byte[] result);
+
+  private SecretKey key;
+  private byte[] iv;
+  // These must be explicitly cloned
+  private NativeEvpCipherCtx context;
+  private InputBuffer<byte[], Void, RuntimeException> buffer;
+
+  AesGmacSpi() {
+    Loader.checkNativeLibraryAvailability();
+    buffer = new InputBuffer<byte[], Void, RuntimeException>(1024);
+    configureLambdas();
+  }
+
+  private void configureLambdas() {
+    buffer
+        .withInitialUpdater(
+            (src, offset, length) -> {
+              assertInitialized();
+              context.useVoid(ptr -> update(ptr, iv, src, offset, length));
+              return null;
+            })
+        .withUpdater(
+            (ignored, src, offset, length) -> {
+              assertInitialized();
+              context.useVoid(ptr -> update(ptr, null, src, offset, length));
+            })
+        .withInitialUpdater(
+            (src) -> {
+              assertInitialized();
+              context.useVoid(ptr -> updateDirect(ptr, iv, src));
+              return null;
+            })
+        .withUpdater(
+            (ignored, src) -> {
+              assertInitialized();
+              context.useVoid(ptr -> updateDirect(ptr, null, src));
+            })
+        .withDoFinal(
+            (ignored) -> {
+              assertInitialized();
+              final byte[] result = new byte[MAC_LENGTH];
+              context.useVoid(ptr -> doFinal(ptr, result));
+              return result;
+            })
+        .withSinglePass(
+            (src, offset, length) -> {
+              assertInitialized();
+              final byte[] result = new byte[MAC_LENGTH];
+              context.useVoid(ptr -> fastMac(ptr, iv, src, offset, length, result));
+              return result;
+            });
+  }
+
+  @Override
+  protected int engineGetMacLength() {
+    return MAC_LENGTH;
+  }
+
+  @Override
+  protected void engineInit(final Key key, final AlgorithmParameterSpec params)
+      throws InvalidKeyException, InvalidAlgorithmParameterException {
+    final byte[] newIv;
+    if (params instanceof IvParameterSpec) {
+      newIv = ((IvParameterSpec) params).getIV();
+    } else if (params instanceof GCMParameterSpec) {
+      if (((GCMParameterSpec) params).getTLen() != MAC_LENGTH * 8) {
+        throw new InvalidAlgorithmParameterException("Only 128 bit tags are supported");
+      }
+      newIv = ((GCMParameterSpec) params).getIV();
+    } else {
+      throw new InvalidAlgorithmParameterException(
+          "AES-GMAC requires an IvParameterSpec or GCMParameterSpec");
+    }
+    if (newIv == null || newIv.length == 0) {
+      throw new InvalidAlgorithmParameterException("IV must be at least one byte long");
+    }
+    if (!(key instanceof SecretKey)) {
+      throw new InvalidKeyException("AES-GMAC expects a SecretKey");
+    }
+    if (context == null || !Objects.equals(this.key, key)) {
+      if (!"RAW".equalsIgnoreCase(key.getFormat())) {
+        throw new InvalidKeyException("Key must support RAW encoding");
+      }
+      final byte[] encoded = key.getEncoded();
+      if (encoded == null) {
+        throw new InvalidKeyException("Key encoding must not be null");
+      }
+      try {
+        if (encoded.length != 16 && encoded.length != 24 && encoded.length != 32) {
+          throw new InvalidKeyException("Key must be 128, 192, or 256 bits long");
+        }
+        final NativeEvpCipherCtx newContext = new NativeEvpCipherCtx(newContext(encoded));
+        if (context != null) {
+          context.release();
+        }
+        context = newContext;
+        this.key = (SecretKey) key;
+      } finally {
+        Arrays.fill(encoded, (byte) 0);
+      }
+    }
+    this.iv = newIv;
+    engineReset();
+  }
+
+  @Override
+  protected void engineUpdate(final byte input) {
+    buffer.update(input);
+  }
+
+  @Override
+  protected void engineUpdate(final byte[] input, final int offset, final int len) {
+    buffer.update(input, offset, len);
+  }
+
+  @Override
+  protected void engineUpdate(final ByteBuffer input) {
+    buffer.update(input);
+  }
+
+  @Override
+  protected byte[] engineDoFinal() {
+    return buffer.doFinal();
+  }
+
+  @Override
+  protected void engineReset() {
+    buffer.reset();
+  }
+
+  private void assertInitialized() {
+    if (context == null) {
+      throw new IllegalStateException("Mac not initialized");
+    }
+  }
+
+  @Override
+  public AesGmacSpi clone() throws CloneNotSupportedException {
+    final AesGmacSpi cloned = (AesGmacSpi) super.clone();
+    if (context != null) {
+      cloned.context = new NativeEvpCipherCtx(context.use(AesGmacSpi::cloneContext));
+    }
+    cloned.buffer = buffer.clone();
+    cloned.configureLambdas();
+    return cloned;
+  }
+}
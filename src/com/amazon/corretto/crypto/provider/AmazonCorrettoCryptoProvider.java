@@ -56,6 +56,7 @@ public final class AmazonCorrettoCryptoProvider extends java.security.Provider {
   private static final String PROPERTY_REGISTER_SECURE_RANDOM = "registerSecureRandom";
   private static final String PROPERTY_REGISTER_ED_KEYFACTORY = "registerEdKeyFactory";
   private static final String PROPERTY_REGISTER_XEC = "registerXEC";
+  private static final String PROPERTY_SPECIALIZED_HMAC = "specializedHmac";
 
   private static final long serialVersionUID = 1L;
 
@@ -69,8 +70,12 @@ public final class AmazonCorrettoCryptoProvider extends java.security.Provider {
   private final boolean shouldRegisterSecureRandom;
   private final boolean shouldRegisterEdKeyFactory;
   private final boolean shouldRegisterXEC;
+  private final boolean shouldUseSpecializedHmac;
   private final boolean shouldRegisterMLDSA;
   private final boolean shouldRegisterAesCfb;
+  private final boolean shouldRegisterChaCha20Poly1305;
+  private final boolean shouldRegisterAesGcmStream;
+  private final boolean shouldRegisterTreeHash;
   private final boolean shouldRegisterMLKEM;
   private final Utils.NativeContextReleaseStrategy nativeContextReleaseStrategy;
 
@@ -89,6 +94,17 @@ public final class AmazonCorrettoCryptoProvider extends java.security.Provider {
     addService("MessageDigest", "SHA-256", "SHA256Spi");
     addService("MessageDigest", "SHA-1", "SHA1Spi");
     addService("MessageDigest", "MD5", "MD5Spi");
+    addService("MessageDigest", "SHA3-512", "SHA3Spi$SHA3_512");
+    addService("MessageDigest", "SHA3-384", "SHA3Spi$SHA3_384");
+    addService("MessageDigest", "SHA3-256", "SHA3Spi$SHA3_256");
+    addService("MessageDigest", "SHA3-224", "SHA3Spi$SHA3_224");
+    addService("MessageDigest", "SHAKE256", "SHA3Spi$SHAKE256", null, "SHAKE256-512");
+    addService("MessageDigest", "SHAKE128", "SHA3Spi$SHAKE128", null, "SHAKE128-256");
+
+    if (shouldRegisterTreeHash) {
+      addService("MessageDigest", "SHA-256-TREE", "TreeHashSpi$SHA256");
+      addService("MessageDigest", "SHA-512-TREE", "TreeHashSpi$SHA512");
+    }
 
     addService("Cipher", "AES/GCM/NoPadding", "AesGcmSpi");
     addService("Cipher", "AES_128/GCM/NoPadding", "AesGcmSpi");
@@ -189,6 +205,24 @@ public final class AmazonCorrettoCryptoProvider extends java.security.Provider {
           "AES_256/CFB");
     }
 
+    addService(
+        "Cipher",
+        "AES/CTR",
+        "AesCtrSpi",
+        true,
+        singletonMap("SupportedModes", "CTR"),
+        "AES_128/CTR",
+        "AES_192/CTR",
+        "AES_256/CTR");
+
+    if (shouldRegisterAesGcmStream) {
+      addService("Cipher", "AES/GCM-STREAM/NoPadding", "AesGcmStreamSpi");
+    }
+
+    if (shouldRegisterChaCha20Poly1305) {
+      addService("Cipher", "ChaCha20-Poly1305", "ChaCha20Poly1305Spi");
+    }
+
     addService(
         "Cipher",
         "AES/CBC",
@@ -205,10 +239,16 @@ public final class AmazonCorrettoCryptoProvider extends java.security.Provider {
     addService("Cipher", "RSA/ECB/OAEPWithSHA-1AndMGF1Padding", "RsaCipher$OAEPSha1");
     addService("Cipher", "RSA/ECB/OAEPWithSHA1AndMGF1Padding", "RsaCipher$OAEPSha1");
 
+    final List<String> specializedHmacDigests = Arrays.asList("SHA256", "SHA384", "SHA512");
     final String hmacWithPrecomputedKeyKeyFactorySpi = "HmacWithPrecomputedKeyKeyFactorySpi";
     for (String hash : new String[] {"MD5", "SHA1", "SHA256", "SHA384", "SHA512"}) {
       // Registration of regular Hmac
-      addService("Mac", "Hmac" + hash, "EvpHmac$" + hash);
+      if (shouldUseSpecializedHmac && specializedHmacDigests.contains(hash)) {
+        // Generated from TemplateHmacSpi
+        addService("Mac", "Hmac" + hash, "Hmac" + hash + "Spi");
+      } else {
+        addService("Mac", "Hmac" + hash, "EvpHmac$" + hash);
+      }
       // Registration of Hmac with precomputed keys
       addService(
           "Mac",
@@ -221,6 +261,9 @@ public final class AmazonCorrettoCryptoProvider extends java.security.Provider {
           false);
     }
 
+    addService("Mac", "AESCMAC", "AesCmacSpi", null, "AES-CMAC");
+    addService("Mac", "AESGMAC", "AesGmacSpi", null, "AES-GMAC");
+
     addService(
         "KeyAgreement",
         "ECDH",
@@ -579,10 +622,17 @@ public final class AmazonCorrettoCryptoProvider extends java.security.Provider {
 
     this.shouldRegisterXEC = Utils.getBooleanProperty(PROPERTY_REGISTER_XEC, false);
 
+    this.shouldUseSpecializedHmac = Utils.getBooleanProperty(PROPERTY_SPECIALIZED_HMAC, false);
+
     this.shouldRegisterMLDSA = (!isFips() || isExperimentalFips());
 
     this.shouldRegisterAesCfb = (!isFips() || isExperimentalFips());
 
+    this.shouldRegisterChaCha20Poly1305 = (!isFips() || isExperimentalFips());
+
+    this.shouldRegisterAesGcmStream = (!isFips() || isExperimentalFips());
+    this.shouldRegisterTreeHash = (!isFips() || isExperimentalFips());
+
     this.shouldRegisterMLKEM = (Utils.isMlKemSupported() && (!isFips() || isExperimentalFips()));
     this.nativeContextReleaseStrategy = Utils.getNativeContextReleaseStrategyProperty();
 
@@ -625,6 +675,11 @@ public final class AmazonCorrettoCryptoProvider extends java.security.Provider {
     selfTestSuite.addSelfTest(EvpHmac.SHA256.SELF_TEST);
     selfTestSuite.addSelfTest(EvpHmac.SHA1.SELF_TEST);
     selfTestSuite.addSelfTest(EvpHmac.MD5.SELF_TEST);
+    if (shouldUseSpecializedHmac) {
+      selfTestSuite.addSelfTest(HmacSHA512Spi.SELF_TEST);
+      selfTestSuite.addSelfTest(HmacSHA384Spi.SELF_TEST);
+      selfTestSuite.addSelfTest(HmacSHA256Spi.SELF_TEST);
+    }
 
     // Kick off self-tests in the background. It's vitally important that we don't actually _wait_
     // for these to complete, as if we do we'll end up recursing through some JCE internals back to
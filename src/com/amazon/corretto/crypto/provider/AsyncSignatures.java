@@ -0,0 +1,309 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider;
+
+import java.security.InvalidKeyException;
+import java.security.Key;
+import java.security.NoSuchAlgorithmException;
+import java.security.PrivateKey;
+import java.security.PublicKey;
+import java.util.Locale;
+import java.util.concurrent.CompletableFuture;
+import java.util.concurrent.ForkJoinPool;
+import java.util.concurrent.RejectedExecutionException;
+import java.util.logging.Logger;
+
+/**
+ * Signs and verifies on a bounded pool of native worker threads.
+ *
+ * <p>{@link java.security.Signature} does all of its work on the calling thread, inside a JNI call
+ * which keeps the message pinned. For RSA-3072 and larger keys that is several milliseconds during
+ * which the thread, or the carrier of a virtual thread, can do nothing else. These methods copy the
+ * message (and signature) into native memory and return immediately. The operation then runs on
+ * one of a fixed number of daemon threads which spend their entire life in native code. The workers
+ * only do the cryptography: the returned future is completed on the {@link
+ * ForkJoinPool#commonPool() common pool}, so dependent stages registered without an executor run
+ * there and may block, even on other asynchronous signatures, without stalling the workers.
+ *
+ * <p>Supported algorithms are {@code SHA1withRSA}, {@code SHA224withRSA}, {@code SHA256withRSA},
+ * {@code SHA384withRSA}, {@code SHA512withRSA}, the corresponding {@code withECDSA} and {@code
+ * withECDSAinP1363Format} algorithms, and {@code Ed25519}. RSA signatures use PKCS#1 v1.5 padding.
+ * Keys which did not come from this provider are translated on every call, so callers should
+ * prefer keys generated or parsed by it.
+ *
+ * <p>Failures complete the future exceptionally: with a {@link NoSuchAlgorithmException} for an
+ * unsupported algorithm, an {@link InvalidKeyException} for an unusable key, and a {@link
+ * java.security.SignatureException} when the operation itself fails. As with {@link
+ * java.security.Signature#verify(byte[])}, a signature which simply does not match completes the
+ * future with {@code false}.
+ *
+ * <p>The pool has one thread per available processor, at most 64, unless the system property
+ * {@code com.amazon.corretto.crypto.provider.asyncSignatureThreads} says otherwise. The threads are
+ * started when this class is first used. At most 256 operations per thread may wait for a worker;
+ * further operations fail with a {@link RejectedExecutionException} rather than queueing copies of
+ * their messages without bound.
+ */
+public final class AsyncSignatures {
+  private AsyncSignatures() {} // private constructor to prevent instantiation
+
+  private static final Logger LOG = Logger.getLogger("AmazonCorrettoCryptoProvider");
+  private static final String PROPERTY_THREADS = "asyncSignatureThreads";
+  private static final int MAX_THREADS = 64;
+  private static final int MAX_QUEUED_PER_THREAD = 256;
+  private static final int THREADS;
+  private static final int MAX_QUEUED;
+
+  static {
+    Loader.checkNativeLibraryAvailability();
+
+    THREADS =
+        Math.min(MAX_THREADS, readThreadsProperty(Runtime.getRuntime().availableProcessors()));
+    MAX_QUEUED = THREADS * MAX_QUEUED_PER_THREAD;
+
+    for (int i = 0; i < THREADS; i++) {
+      final Thread worker = new Thread(AsyncSignatures::runWorker);
+      worker.setDaemon(true);
+      worker.setName("ACCP async signature worker " + i);
+      worker.start();
+    }
+  }
+
+  private static int readThreadsProperty(final int defaultValue) {
+    final String propertyStr = Loader.getProperty(PROPERTY_THREADS, Integer.toString(defaultValue));
+    try {
+      final int value = Integer.parseInt(propertyStr);
+      if (value >= 1) {
+        return value;
+      }
+    } catch (final NumberFormatException ex) {
+      // Fall through to the warning below
+    }
+    LOG.warning(
+        String.format(
+            "Valid values for %s are positive integers, with %d as default",
+            PROPERTY_THREADS, defaultValue));
+    return defaultValue;
+  }
+
+  private static native boolean submit(
+      long pKey,
+      long mdPtr,
+      int paddingType,
+      boolean p1363,
+      boolean verify,
+      byte[] message,
+      int offset,
+      int length,
+      byte[] signature,
+      int sigOff,
+      int sigLen,
+      CompletableFuture<?> future,
+      int maxQueued);
+
+  /** Runs queued operations on the calling thread. Only returns if the worker cannot start. */
+  private static native void runWorker();
+
+  /**
+   * Called by the native workers with the result of each operation. The future is completed on the
+   * common pool, so that dependent stages never run on, and can never block, a worker. Anything
+   * which escapes completion is caught so that the future is never left pending.
+   */
+  @SuppressWarnings("unchecked")
+  private static void complete(
+      final CompletableFuture<?> future,
+      final byte[] signature,
+      final boolean verified,
+      final Throwable error) {
+    final Runnable completion =
+        () -> {
+          try {
+            if (error != null) {
+              future.completeExceptionally(error);
+            } else if (signature != null) {
+              ((CompletableFuture<byte[]>) future).complete(signature);
+            } else {
+              ((CompletableFuture<Boolean>) future).complete(verified);
+            }
+          } catch (final Throwable t) {
+            // Has no effect if the future was completed before the failure
+            future.completeExceptionally(t);
+          }
+        };
+    try {
+      ForkJoinPool.commonPool().execute(completion);
+    } catch (final Throwable t) {
+      // The completion could not be handed off, so complete the future here rather than leave it
+      // pending.
+      completion.run();
+    }
+  }
+
+  /** Signs all of {@code message}. */
+  public static CompletableFuture<byte[]> sign(
+      final String algorithm, final PrivateKey key, final byte[] message) {
+    return sign(algorithm, key, message, 0, message.length);
+  }
+
+  /**
+   * Signs {@code message[offset, offset + length)} with {@code key}. The message is copied before
+   * this method returns, so the caller may reuse the array immediately.
+   *
+   * @return a future completed with the signature
+   * @throws ArrayIndexOutOfBoundsException if the message range lies outside of {@code message}
+   */
+  public static CompletableFuture<byte[]> sign(
+      final String algorithm,
+      final PrivateKey key,
+      final byte[] message,
+      final int offset,
+      final int length) {
+    Utils.checkArrayLimits(message, offset, length);
+    final CompletableFuture<byte[]> result = new CompletableFuture<>();
+    enqueue(algorithm, key, message, offset, length, null, 0, 0, result);
+    return result;
+  }
+
+  /** Verifies {@code signature} over all of {@code message}. */
+  public static CompletableFuture<Boolean> verify(
+      final String algorithm, final PublicKey key, final byte[] message, final byte[] signature) {
+    return verify(algorithm, key, message, 0, message.length, signature, 0, signature.length);
+  }
+
+  /**
+   * Verifies {@code signature[sigOff, sigOff + sigLen)} over {@code message[offset, offset +
+   * length)} with {@code key}. Both are copied before this method returns, so the caller may reuse
+   * the arrays immediately.
+   *
+   * @return a future completed with whether the signature is valid
+   * @throws ArrayIndexOutOfBoundsException if the message or signature range lies outside of its
+   *     array
+   */
+  public static CompletableFuture<Boolean> verify(
+      final String algorithm,
+      final PublicKey key,
+      final byte[] message,
+      final int offset,
+      final int length,
+      final byte[] signature,
+      final int sigOff,
+      final int sigLen) {
+    Utils.checkArrayLimits(message, offset, length);
+    Utils.checkArrayLimits(signature, sigOff, sigLen);
+    final CompletableFuture<Boolean> result = new CompletableFuture<>();
+    enqueue(algorithm, key, message, offset, length, signature, sigOff, sigLen, result);
+    return result;
+  }
+
+  private static void enqueue(
+      final String algorithm,
+      final Key key,
+      final byte[] message,
+      final int offset,
+      final int length,
+      final byte[] signature,
+      final int sigOff,
+      final int sigLen,
+      final CompletableFuture<?> result) {
+    final EvpKey evpKey;
+    final Algorithm alg;
+    try {
+      alg = Algorithm.forName(algorithm);
+      evpKey = alg.translate(key);
+    } catch (final NoSuchAlgorithmException | InvalidKeyException ex) {
+      result.completeExceptionally(ex);
+      return;
+    }
+
+    final boolean queued;
+    try {
+      queued =
+          evpKey.use(
+              ptr ->
+                  submit(
+                      ptr,
+                      alg.mdPtr,
+                      alg.paddingType,
+                      alg.p1363,
+                      signature != null,
+                      message,
+                      offset,
+                      length,
+                      signature,
+                      sigOff,
+                      sigLen,
+                      result,
+                      MAX_QUEUED));
+    } finally {
+      // The queued operation holds its own reference to the native key
+      if (evpKey != key) {
+        evpKey.releaseEphemeral();
+      }
+    }
+    if (!queued) {
+      result.completeExceptionally(
+          new RejectedExecutionException("Too many pending asynchronous signature operations"));
+    }
+  }
+
+  private static final class Algorithm {
+    final EvpKeyType keyType;
+    final long mdPtr;
+    final int paddingType;
+    final boolean p1363;
+
+    private Algorithm(
+        final EvpKeyType keyType, final long mdPtr, final int paddingType, final boolean p1363) {
+      this.keyType = keyType;
+      this.mdPtr = mdPtr;
+      this.paddingType = paddingType;
+      this.p1363 = p1363;
+    }
+
+    static Algorithm forName(final String algorithm) throws NoSuchAlgorithmException {
+      if (algorithm == null) {
+        throw new NoSuchAlgorithmException("Algorithm must not be null");
+      }
+      final String name = algorithm.toLowerCase(Locale.ROOT);
+      if (name.equals("ed25519")) {
+        return new Algorithm(EvpKeyType.EdDSA, 0, 0, false);
+      }
+      final int with = name.indexOf("with");
+      if (with > 0) {
+        final String digest = name.substring(0, with);
+        final String suffix = name.substring(with);
+        if (digest.equals("sha1")
+            || digest.equals("sha224")
+            || digest.equals("sha256")
+            || digest.equals("sha384")
+            || digest.equals("sha512")) {
+          final long mdPtr = Utils.getMdPtr(digest);
+          switch (suffix) {
+            case "withrsa":
+              return new Algorithm(
+                  EvpKeyType.RSA, mdPtr, EvpSignatureBase.RSA_PKCS1_PADDING, false);
+            case "withecdsa":
+              return new Algorithm(EvpKeyType.EC, mdPtr, 0, false);
+            case "withecdsainp1363format":
+              return new Algorithm(EvpKeyType.EC, mdPtr, 0, true);
+            default:
+              break;
+          }
+        }
+      }
+      throw new NoSuchAlgorithmException("Unsupported signature algorithm: " + algorithm);
+    }
+
+    EvpKey translate(final Key key) throws InvalidKeyException {
+      if (key == null) {
+        throw new InvalidKeyException("Key must not be null");
+      }
+      final EvpKey evpKey = AmazonCorrettoCryptoProvider.INSTANCE.translateKey(key, keyType);
+      if (evpKey.type != keyType) {
+        throw new InvalidKeyException(
+            String.format(
+                "Invalid key type: %s, expected %s", evpKey.type.jceName, keyType.jceName));
+      }
+      return evpKey;
+    }
+  }
+}
@@ -0,0 +1,460 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider;
+
+import static com.amazon.corretto.crypto.provider.Utils.EMPTY_ARRAY;
+import static com.amazon.corretto.crypto.provider.Utils.checkArrayLimits;
+
+import java.security.AlgorithmParameters;
+import java.security.InvalidAlgorithmParameterException;
+import java.security.InvalidKeyException;
+import java.security.Key;
+import java.security.NoSuchAlgorithmException;
+import java.security.SecureRandom;
+import java.security.spec.AlgorithmParameterSpec;
+import java.security.spec.InvalidParameterSpecException;
+import java.util.Arrays;
+import javax.crypto.AEADBadTagException;
+import javax.crypto.BadPaddingException;
+import javax.crypto.Cipher;
+import javax.crypto.CipherSpi;
+import javax.crypto.IllegalBlockSizeException;
+import javax.crypto.NoSuchPaddingException;
+import javax.crypto.ShortBufferException;
+import javax.crypto.spec.IvParameterSpec;
+
+/**
+ * ChaCha20-Poly1305 as specified in RFC 8439, with a 256-bit key, a 96-bit nonce, and a 128-bit
+ * tag.
+ *
+ * <p>The native implementation is built on AWS-LC's EVP_AEAD interface, which only processes whole
+ * messages. Incremental input (and AAD) is therefore buffered and processed by {@code doFinal} in a
+ * single native call; {@code update} never returns any output, in either direction. The keyed
+ * native context is kept across operations with the same key, subject to the configured native
+ * context release strategy.
+ */
+final class ChaCha20Poly1305Spi extends CipherSpi {
+  static {
+    Loader.load();
+  }
+
+  private static final int KEY_LENGTH_BYTES = 32;
+  private static final int NONCE_LENGTH_BYTES = 12;
+  private static final int TAG_LENGTH_BYTES = 16;
+
+  private static final int NATIVE_MODE_ENCRYPT = 1;
+  private static final int NATIVE_MODE_DECRYPT = 0;
+
+  /**
+   * Returns a new EVP_AEAD_CTX keyed with {@code key}, which must be freed using {@link
+   * Utils#releaseEvpAeadCtx}.
+   */
+  private static native long newContext(byte[] key);
+
+  /**
+   * Encrypts a whole message. Input and output must not overlap.
+   *
+   * @return Number of bytes written, which is the input length plus the tag length
+   */
+  private static native int seal(
+      long ctxPtr,
+      byte[] input,
+      int inputOffset,
+      int inputLength,
+      byte[] result,
+      int resultOffset,
+      byte[] nonce,
+      byte[] aadBuffer,
+      int aadSize);
+
+  /**
+   * Decrypts and authenticates a whole message (ciphertext followed by the tag). Input and output
+   * must not overlap. On failure, the output is zeroed.
+   *
+   * @return Number of bytes written, which is the input length minus the tag length
+   */
+  private static native int open(
+      long ctxPtr,
+      byte[] input,
+      int inputOffset,
+      int inputLength,
+      byte[] result,
+      int resultOffset,
+      byte[] nonce,
+      byte[] aadBuffer,
+      int aadSize)
+      throws AEADBadTagException;
+
+  private final AmazonCorrettoCryptoProvider provider;
+  private NativeResource context = null;
+  // The key the native context has been initialized with.
+  private byte[] contextKey = null;
+  private boolean sameKey = false;
+  private Key lastKey = null;
+  private byte[] key, nonce;
+
+  private int opMode = -1;
+  private boolean needReset = false;
+
+  private final AccessibleByteArrayOutputStream inputBuf =
+      new AccessibleByteArrayOutputStream(0, Integer.MAX_VALUE);
+  private final AccessibleByteArrayOutputStream aadBuf =
+      new AccessibleByteArrayOutputStream(0, Integer.MAX_VALUE);
+
+  ChaCha20Poly1305Spi(final AmazonCorrettoCryptoProvider provider) {
+    Loader.checkNativeLibraryAvailability();
+    this.provider = provider;
+  }
+
+  private boolean saveNativeContext() {
+    switch (provider.getNativeContextReleaseStrategy()) {
+      case HYBRID:
+        return sameKey;
+      case LAZY:
+        return true;
+      case EAGER:
+        return false;
+      default:
+        throw new AssertionError("This should not be reachable.");
+    }
+  }
+
+  @Override
+  protected void engineSetMode(final String s) throws NoSuchAlgorithmException {
+    if (!"None".equalsIgnoreCase(s)) {
+      throw new NoSuchAlgorithmException();
+    }
+  }
+
+  @Override
+  protected void engineSetPadding(final String s) throws NoSuchPaddingException {
+    if (!"NoPadding".equalsIgnoreCase(s)) {
+      throw new NoSuchPaddingException();
+    }
+  }
+
+  @Override
+  protected int engineGetBlockSize() {
+    return 0; // Stream cipher
+  }
+
+  @Override
+  protected int engineGetKeySize(final Key key) throws InvalidKeyException {
+    return checkKey(key).length * 8;
+  }
+
+  @Override
+  protected int engineGetOutputSize(final int inputLen) {
+    switch (opMode) {
+      case NATIVE_MODE_ENCRYPT:
+        return inputBuf.size() + inputLen + TAG_LENGTH_BYTES;
+      case NATIVE_MODE_DECRYPT:
+        return Math.max(0, inputBuf.size() + inputLen - TAG_LENGTH_BYTES);
+      default:
+        throw new IllegalStateException("Cipher not initialized");
+    }
+  }
+
+  @Override
+  protected byte[] engineGetIV() {
+    return (nonce == null) ? null : nonce.clone();
+  }
+
+  @Override
+  protected AlgorithmParameters engineGetParameters() {
+    byte[] nonceForParams = nonce;
+    if (nonceForParams == null) {
+      // We aren't initialized so we return a random nonce
+      nonceForParams = new byte[NONCE_LENGTH_BYTES];
+      new LibCryptoRng().nextBytes(nonceForParams);
+    }
+    try {
+      final AlgorithmParameters parameters = AlgorithmParameters.getInstance("ChaCha20-Poly1305");
+      parameters.init(new IvParameterSpec(nonceForParams));
+      return parameters;
+    } catch (final NoSuchAlgorithmException e) {
+      // Older JDKs have no parameters implementation for this algorithm
+      return null;
+    } catch (final InvalidParameterSpecException e) {
+      throw new Error("Unexpected error", e);
+    }
+  }
+
+  @Override
+  protected void engineInit(final int opMode, final Key key, final SecureRandom secureRandom)
+      throws InvalidKeyException {
+    if (opMode != Cipher.ENCRYPT_MODE && opMode != Cipher.WRAP_MODE) {
+      throw new InvalidKeyException("Nonce required for decrypt");
+    }
+
+    final byte[] nonce = new byte[NONCE_LENGTH_BYTES];
+    secureRandom.nextBytes(nonce);
+
+    try {
+      engineInit(opMode, key, new IvParameterSpec(nonce), secureRandom);
+    } catch (final InvalidAlgorithmParameterException e) {
+      throw new AssertionError(e);
+    }
+  }
+
+  @Override
+  protected void engineInit(
+      final int jceOpMode,
+      final Key key,
+      final AlgorithmParameterSpec algorithmParameterSpec,
+      final SecureRandom secureRandom)
+      throws InvalidKeyException, InvalidAlgorithmParameterException {
+    if (algorithmParameterSpec == null) {
+      engineInit(jceOpMode, key, secureRandom);
+      return;
+    }
+    final int opMode;
+    switch (jceOpMode) {
+      case Cipher.ENCRYPT_MODE:
+      case Cipher.WRAP_MODE:
+        opMode = NATIVE_MODE_ENCRYPT;
+        break;
+      case Cipher.DECRYPT_MODE:
+      case Cipher.UNWRAP_MODE:
+        opMode = NATIVE_MODE_DECRYPT;
+        break;
+      default:
+        throw new InvalidAlgorithmParameterException("Unsupported cipher mode " + jceOpMode);
+    }
+    if (!(algorithmParameterSpec instanceof IvParameterSpec)) {
+      throw new InvalidAlgorithmParameterException(
+          "I don't know how to handle a " + algorithmParameterSpec.getClass());
+    }
+    final byte[] newNonce = ((IvParameterSpec) algorithmParameterSpec).getIV();
+    if (newNonce.length != NONCE_LENGTH_BYTES) {
+      throw new InvalidAlgorithmParameterException(
+          "Nonce must be " + NONCE_LENGTH_BYTES + " bytes long");
+    }
+
+    final byte[] newKey = key == lastKey && this.key != null ? this.key : checkKey(key);
+    final boolean sameKey = ConstantTime.equals(this.key, newKey);
+    if (sameKey && opMode == NATIVE_MODE_ENCRYPT && Arrays.equals(newNonce, this.nonce)) {
+      throw new InvalidAlgorithmParameterException(
+          "Cannot reuse same nonce and key for ChaCha20-Poly1305 encryption");
+    }
+
+    this.opMode = opMode;
+    this.sameKey = sameKey;
+    this.nonce = newNonce;
+    this.key = newKey;
+    this.lastKey = key;
+    this.needReset = false;
+
+    stateReset();
+  }
+
+  @Override
+  protected void engineInit(
+      final int opMode,
+      final Key key,
+      final AlgorithmParameters algorithmParameters,
+      final SecureRandom secureRandom)
+      throws InvalidKeyException, InvalidAlgorithmParameterException {
+    if (algorithmParameters == null) {
+      engineInit(opMode, key, secureRandom);
+      return;
+    }
+    try {
+      engineInit(
+          opMode,
+          key,
+          algorithmParameters.getParameterSpec(IvParameterSpec.class),
+          secureRandom);
+    } catch (final InvalidParameterSpecException e) {
+      throw new InvalidAlgorithmParameterException(e);
+    }
+  }
+
+  private static byte[] checkKey(final Key key) throws InvalidKeyException {
+    if (key == null) {
+      throw new InvalidKeyException("Key can't be null");
+    }
+    if (!"RAW".equalsIgnoreCase(key.getFormat())) {
+      throw new InvalidKeyException("Key's format must be RAW");
+    }
+    final byte[] encoded = key.getEncoded();
+    if (encoded == null || encoded.length != KEY_LENGTH_BYTES) {
+      throw new InvalidKeyException("Key must be " + KEY_LENGTH_BYTES + " bytes long");
+    }
+    return encoded;
+  }
+
+  private void checkInitialized() {
+    if (opMode < 0) {
+      throw new IllegalStateException("Cipher not initialized");
+    }
+    if (needReset) {
+      throw new IllegalStateException("Must change key or nonce for ChaCha20-Poly1305 encryption");
+    }
+  }
+
+  @Override
+  protected byte[] engineUpdate(final byte[] input, final int inputOffset, final int inputLen) {
+    try {
+      engineUpdate(input, inputOffset, inputLen, EMPTY_ARRAY, 0);
+    } catch (final ShortBufferException e) {
+      throw new AssertionError(e);
+    }
+    return EMPTY_ARRAY;
+  }
+
+  @Override
+  protected int engineUpdate(
+      final byte[] input,
+      final int inputOffset,
+      final int inputLen,
+      final byte[] output,
+      final int outputOffset)
+      throws ShortBufferException {
+    checkInitialized();
+    checkArrayLimits(input, inputOffset, inputLen);
+    // All output is produced by doFinal
+    inputBuf.write(input, inputOffset, inputLen);
+    return 0;
+  }
+
+  @Override
+  protected void engineUpdateAAD(final byte[] input, final int inputOffset, final int inputLen) {
+    checkInitialized();
+    checkArrayLimits(input, inputOffset, inputLen);
+    if (!inputBuf.isEmpty()) {
+      throw new IllegalStateException("AAD must be supplied before encryption/decryption data");
+    }
+    aadBuf.write(input, inputOffset, inputLen);
+  }
+
+  @Override
+  protected byte[] engineDoFinal(final byte[] input, final int inputOffset, final int inputLen)
+      throws IllegalBlockSizeException, BadPaddingException {
+    checkInitialized();
+    final byte[] output = new byte[engineGetOutputSize(inputLen)];
+    try {
+      final int outputLen = engineDoFinal(input, inputOffset, inputLen, output, 0);
+      return outputLen == output.length ? output : Arrays.copyOf(output, outputLen);
+    } catch (final ShortBufferException e) {
+      throw new AssertionError(e);
+    }
+  }
+
+  @Override
+  protected int engineDoFinal(
+      byte[] input,
+      final int inputOffset,
+      final int inputLen,
+      final byte[] output,
+      final int outputOffset)
+      throws ShortBufferException, IllegalBlockSizeException, BadPaddingException {
+    // The following failures should not trigger reset
+    checkInitialized();
+    if (input == null) {
+      input = EMPTY_ARRAY;
+    }
+    checkArrayLimits(input, inputOffset, inputLen);
+    final int outputLen = engineGetOutputSize(inputLen);
+    if (output == null || outputOffset < 0 || output.length - outputOffset < outputLen) {
+      throw new ShortBufferException(
+          String.format(
+              "Expected a buffer of at least %d bytes; got %d",
+              outputLen, output == null ? 0 : output.length - outputOffset));
+    }
+
+    // Any future failure (or success) should trigger reset
+    try {
+      final byte[] workingInputArray;
+      final int workingInputOffset;
+      final int workingInputLength;
+      if (inputBuf.isEmpty()
+          && !overlaps(input, inputOffset, inputLen, output, outputOffset, outputLen)) {
+        // Nothing has been buffered and the output does not clobber the input, so skip the copy.
+        workingInputArray = input;
+        workingInputOffset = inputOffset;
+        workingInputLength = inputLen;
+      } else {
+        inputBuf.finalWrite(input, inputOffset, inputLen);
+        workingInputArray = inputBuf.getDataBuffer();
+        workingInputOffset = 0;
+        workingInputLength = inputBuf.size();
+      }
+      final byte[] aad = aadBuf.isEmpty() ? EMPTY_ARRAY : aadBuf.getDataBuffer();
+      final int aadLength = aadBuf.size();
+
+      final NativeResource ctx = prepareContext();
+      if (opMode == NATIVE_MODE_ENCRYPT) {
+        needReset = true;
+        return ctx.use(
+            ptr ->
+                seal(
+                    ptr,
+                    workingInputArray,
+                    workingInputOffset,
+                    workingInputLength,
+                    output,
+                    outputOffset,
+                    nonce,
+                    aad,
+                    aadLength));
+      }
+      return ctx.use(
+          ptr ->
+              open(
+                  ptr,
+                  workingInputArray,
+                  workingInputOffset,
+                  workingInputLength,
+                  output,
+                  outputOffset,
+                  nonce,
+                  aad,
+                  aadLength));
+    } catch (final AEADBadTagException e) {
+      Arrays.fill(output, outputOffset, outputOffset + outputLen, (byte) 0);
+      throw e;
+    } finally {
+      if (context != null && !saveNativeContext()) {
+        context.release();
+        context = null;
+        contextKey = null;
+      }
+      stateReset();
+    }
+  }
+
+  /**
+   * EVP_AEAD only supports exactly in-place operation, so any other overlap between input and
+   * output (in either direction) requires copying the input first.
+   */
+  private static boolean overlaps(
+      final byte[] input,
+      final int inputOffset,
+      final int inputLen,
+      final byte[] output,
+      final int outputOffset,
+      final int outputLen) {
+    if (input != output || inputOffset == outputOffset) {
+      return false;
+    }
+    return outputOffset < inputOffset + inputLen && inputOffset < outputOffset + outputLen;
+  }
+
+  private NativeResource prepareContext() {
+    if (context != null && !ConstantTime.equals(contextKey, key)) {
+      context.release();
+      context = null;
+    }
+    if (context == null) {
+      context = new NativeEvpAeadCtx(newContext(key));
+    }
+    contextKey = key;
+    return context;
+  }
+
+  private void stateReset() {
+    inputBuf.reset();
+    aadBuf.reset();
+  }
+}
@@ -4,6 +4,7 @@ package com.amazon.corretto.crypto.provider;
 
 import static java.util.logging.Logger.getLogger;
 
+import java.nio.ByteBuffer;
 import java.nio.charset.StandardCharsets;
 import java.security.InvalidAlgorithmParameterException;
 import java.security.InvalidKeyException;
@@ -87,6 +88,26 @@ class EvpHmac extends MacSpi implements Cloneable {
     }
   }
 
+  /**
+   * As {@link #updateCtxArray(byte[], byte[], long, byte[], int, int, boolean)}, but reads the
+   * remaining bytes of the direct ByteBuffer {@code input}. This method should only be used via
+   * {@link #synchronizedUpdateCtxDirect(byte[], byte[], long, ByteBuffer, boolean)}.
+   *
+   * @param ctx opaque array containing native context
+   */
+  private static native void updateCtxDirect(
+      byte[] ctx, byte[] key, long evpMd, ByteBuffer input, boolean usePrecomputedKey);
+
+  /**
+   * @see {@link #updateCtxDirect(byte[], byte[], long, ByteBuffer, boolean)}
+   */
+  private static void synchronizedUpdateCtxDirect(
+      byte[] ctx, byte[] key, long evpMd, ByteBuffer input, boolean usePrecomputedKey) {
+    synchronized (ctx) {
+      updateCtxDirect(ctx, key, evpMd, input, usePrecomputedKey);
+    }
+  }
+
   /**
    * Calls {@code HMAC_Final}, and places the result in {@code result}. This method should only be
    * called via {@link #synchronizedDoFinal(byte[], byte[])}
@@ -141,6 +162,9 @@ class EvpHmac extends MacSpi implements Cloneable {
 
   private static final int CONTEXT_SIZE = getContextSize();
 
+  /** When true, keys are held in {@link HmacKeyCache} and contexts live in native memory. */
+  private static final boolean USE_KEY_CACHE = HmacKeyCache.isEnabled();
+
   // These must be explicitly cloned
   private HmacState state;
   private InputBuffer<byte[], Void, RuntimeException> buffer;
@@ -176,6 +200,10 @@ class EvpHmac extends MacSpi implements Cloneable {
   }
 
   private void configureLambdas() {
+    if (USE_KEY_CACHE) {
+      configureCachedLambdas();
+      return;
+    }
     buffer
         .withInitialUpdater(
             (src, offset, length) -> {
@@ -196,6 +224,24 @@ class EvpHmac extends MacSpi implements Cloneable {
               synchronizedUpdateCtxArray(
                   state.context, null, DO_NOT_INIT, src, offset, length, state.usePrecomputedKey);
             })
+        .withInitialUpdater(
+            (src) -> {
+              assertInitialized();
+              long evpMd = DO_NOT_REKEY;
+              if (state.needsRekey) {
+                evpMd = state.evpMd;
+              }
+              synchronizedUpdateCtxDirect(
+                  state.context, state.encoded_key, evpMd, src, state.usePrecomputedKey);
+              state.needsRekey = false;
+              return null;
+            })
+        .withUpdater(
+            (ignored, src) -> {
+              assertInitialized();
+              synchronizedUpdateCtxDirect(
+                  state.context, null, DO_NOT_INIT, src, state.usePrecomputedKey);
+            })
         .withDoFinal(
             (ignored) -> {
               assertInitialized();
@@ -226,6 +272,46 @@ class EvpHmac extends MacSpi implements Cloneable {
             });
   }
 
+  private void configureCachedLambdas() {
+    buffer
+        .withInitialUpdater(
+            (src, offset, length) -> {
+              assertInitialized();
+              state.cacheEntry.initUpdate(state.nativeContext, src, offset, length);
+              return null;
+            })
+        .withUpdater(
+            (ignored, src, offset, length) -> {
+              assertInitialized();
+              state.nativeContext.update(src, offset, length);
+            })
+        .withInitialUpdater(
+            (src) -> {
+              assertInitialized();
+              state.cacheEntry.initUpdate(state.nativeContext, src);
+              return null;
+            })
+        .withUpdater(
+            (ignored, src) -> {
+              assertInitialized();
+              state.nativeContext.update(src);
+            })
+        .withDoFinal(
+            (ignored) -> {
+              assertInitialized();
+              final byte[] result = new byte[state.digestLength];
+              state.nativeContext.doFinal(result);
+              return result;
+            })
+        .withSinglePass(
+            (src, offset, length) -> {
+              assertInitialized();
+              final byte[] result = new byte[state.digestLength];
+              state.cacheEntry.fastHmac(state.nativeContext, src, offset, length, result);
+              return result;
+            });
+  }
+
   @Override
   protected int engineGetMacLength() {
     return state.digestLength;
@@ -254,6 +340,11 @@ class EvpHmac extends MacSpi implements Cloneable {
     buffer.update(input, offset, len);
   }
 
+  @Override
+  protected void engineUpdate(ByteBuffer input) {
+    buffer.update(input);
+  }
+
   @Override
   protected byte[] engineDoFinal() {
     return buffer.doFinal();
@@ -290,9 +381,17 @@ class EvpHmac extends MacSpi implements Cloneable {
     private final String algorithm;
 
     private final int digestLength;
-    private byte[] context = new byte[CONTEXT_SIZE];
+    private byte[] context = USE_KEY_CACHE ? null : new byte[CONTEXT_SIZE];
     private byte[] encoded_key;
 
+    /**
+     * Only used when {@link #USE_KEY_CACHE} is set. The entry may be shared with clones of this
+     * state, so a replaced entry is left for the Janitor to release rather than released here.
+     */
+    private HmacKeyCache.Entry cacheEntry;
+
+    private HmacKeyCache.Context nativeContext = USE_KEY_CACHE ? new HmacKeyCache.Context() : null;
+
     /**
      * True if precomputed keys are used instead of raw HMAC keys, that is for algorithms
      * `HmacXXXWithPrecomputedKey`.
@@ -345,6 +444,9 @@ class EvpHmac extends MacSpi implements Cloneable {
         throw new InvalidKeyException(
             "Key must be of length \"" + precomputedKeyLength + "\" when using precomputed keys");
       }
+      if (USE_KEY_CACHE) {
+        this.cacheEntry = HmacKeyCache.acquire(evpMd, encoded, usePrecomputedKey);
+      }
       this.encoded_key = encoded;
       this.key = key;
       this.needsRekey = true;
@@ -354,7 +456,11 @@ class EvpHmac extends MacSpi implements Cloneable {
     public HmacState clone() {
       try {
         HmacState cloned = (HmacState) super.clone();
-        cloned.context = cloned.context.clone();
+        if (USE_KEY_CACHE) {
+          cloned.nativeContext = cloned.nativeContext.copy();
+        } else {
+          cloned.context = cloned.context.clone();
+        }
         return cloned;
       } catch (final CloneNotSupportedException ex) {
         throw new AssertionError(ex);
@@ -398,7 +504,7 @@ class EvpHmac extends MacSpi implements Cloneable {
     }
   }
 
-  private static SelfTestResult runSelfTest(String macName, Class<? extends MacSpi> spi) {
+  static SelfTestResult runSelfTest(String macName, Class<? extends MacSpi> spi) {
     Provider p = new TestMacProvider(macName, spi);
 
     int tests = 0;
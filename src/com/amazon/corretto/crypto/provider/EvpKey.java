@@ -21,6 +21,9 @@ import java.security.spec.PKCS8EncodedKeySpec;
 import java.security.spec.X509EncodedKeySpec;
 import java.util.Arrays;
 import java.util.Base64;
+import java.util.HashMap;
+import java.util.Map;
+import java.util.function.Supplier;
 import javax.security.auth.Destroyable;
 
 abstract class EvpKey implements Key, Destroyable {
@@ -42,6 +45,19 @@ abstract class EvpKey implements Key, Destroyable {
    */
   protected boolean ephemeral = false;
 
+  /**
+   * Upper bound on the number of {@link #getContextTemplate context templates} cached per key. A
+   * key is normally only used with one or two sets of signature parameters.
+   */
+  private static final int MAX_CONTEXT_TEMPLATES = 8;
+
+  /**
+   * Pre-initialized native contexts for operations using this key, indexed by their parameters.
+   * Released along with this key.
+   */
+  // @GuardedBy("contextTemplates") // Restore once replacement for JSR-305 available
+  private final transient Map<Object, NativeResource> contextTemplates = new HashMap<>();
+
   private volatile boolean isDestroyed = false;
   protected volatile byte[] encoded;
   protected volatile Integer cachedHashCode;
@@ -88,6 +104,36 @@ abstract class EvpKey implements Key, Destroyable {
     internalKey.useVoid(function);
   }
 
+  /**
+   * Returns the context template cached on this key for {@code params}, creating it with {@code
+   * factory} if needed. Returns {@code null} if this key already holds the maximum number of
+   * templates, in which case callers should fall back to initializing a context from scratch.
+   *
+   * @param params an immutable value with {@code equals} and {@code hashCode}, identifying all
+   *     parameters which are baked into the template
+   */
+  @SuppressWarnings("unchecked")
+  <T extends NativeResource> T getContextTemplate(final Object params, final Supplier<T> factory) {
+    synchronized (contextTemplates) {
+      assertNotDestroyed();
+      T result = (T) contextTemplates.get(params);
+      if (result == null && contextTemplates.size() < MAX_CONTEXT_TEMPLATES) {
+        result = factory.get();
+        contextTemplates.put(params, result);
+      }
+      return result;
+    }
+  }
+
+  private void releaseContextTemplates() {
+    synchronized (contextTemplates) {
+      for (final NativeResource template : contextTemplates.values()) {
+        template.release();
+      }
+      contextTemplates.clear();
+    }
+  }
+
   @Override
   public String getAlgorithm() {
     return type.jceName;
@@ -232,6 +278,7 @@ abstract class EvpKey implements Key, Destroyable {
   public synchronized void destroy() {
     assertNotDestroyed();
     isDestroyed = true;
+    releaseContextTemplates();
     if (!sharedKey) {
       internalKey.release();
     }
@@ -7,12 +7,15 @@ import java.security.InvalidAlgorithmParameterException;
 import java.security.SignatureException;
 import java.security.spec.AlgorithmParameterSpec;
 import java.security.spec.PSSParameterSpec;
+import java.util.Arrays;
 
 class EvpSignature extends EvpSignatureBase {
   /**
    * Generates a signature in a single pass.
    *
    * @param privateKey a pointer to the private key
+   * @param template a pointer to a context template from {@link #newContextTemplate} for this key
+   *     and the remaining parameters, or {@code 0}. If set, the remaining parameters are ignored.
    * @param digestPtr the value from {@link Utils#getEvpMdFromName(String)} representing the digest
    *     to use with this signature
    * @param paddingType the integer defined by OpenSSL as the padding type to be used.
@@ -21,6 +24,7 @@ class EvpSignature extends EvpSignatureBase {
    *     Function (MGF). This parameter is only necessary for RSA-PSS signatures.
    * @param saltLen the length of the salt in bytes. This parameter is only necessary for RSA-PSS
    *     signatures.
+   * @param p1363 whether the ECDSA signature is in IEEE P1363 format (r||s) rather than DER
    * @param message the message to be signed
    * @param offset the offset in {@code message} designating the start of the data to be signed.
    * @param length the length of the data in {@code message} to be signed.
@@ -35,20 +39,52 @@ class EvpSignature extends EvpSignatureBase {
    */
   private static native byte[] sign(
       long privateKey,
+      long template,
       long digestPtr,
       int paddingType,
       boolean preHash,
       long mgfMd,
       int saltLen,
+      boolean p1363,
       byte[] message,
       int offset,
       int length)
       throws SignatureException;
 
+  /**
+   * Generates a signature in a single pass, writing it to {@code out}.
+   *
+   * <p>Parameters are as for {@link #sign}, with the addition of the output range.
+   *
+   * @param out the array to write the signature to
+   * @param outOff the offset in {@code out} at which to write the signature
+   * @param outLen the space available in {@code out} for the signature
+   * @return the length of the signature
+   * @throws SignatureException if the signature does not fit in the output range
+   */
+  private static native int signInto(
+      long privateKey,
+      long template,
+      long digestPtr,
+      int paddingType,
+      boolean preHash,
+      long mgfMd,
+      int saltLen,
+      boolean p1363,
+      byte[] message,
+      int offset,
+      int length,
+      byte[] out,
+      int outOff,
+      int outLen)
+      throws SignatureException;
+
   /**
    * Performs a signature verification in a single pass.
    *
    * @param publicKey a pointer to the public key
+   * @param template a pointer to a context template from {@link #newContextTemplate} for this key
+   *     and the remaining parameters, or {@code 0}. If set, the remaining parameters are ignored.
    * @param digestPtr the value from {@link Utils#getEvpMdFromName(String)} representing the digest
    *     to use with this signature
    * @param paddingType the integer defined by OpenSSL as the padding type to be used.
@@ -57,6 +93,7 @@ class EvpSignature extends EvpSignatureBase {
    *     Function (MGF). This parameter is only necessary for RSA-PSS signatures.
    * @param saltLen the length of the salt in bytes. This parameter is only necessary for RSA-PSS
    *     signatures.
+   * @param p1363 whether the ECDSA signature is in IEEE P1363 format (r||s) rather than DER
    * @param message the message to be verified
    * @param offset the offset in {@code message} designating the start of the data to be verified.
    * @param length the length of the data in {@code message} to be verified.
@@ -74,11 +111,13 @@ class EvpSignature extends EvpSignatureBase {
    */
   private static native boolean verify(
       long publicKey,
+      long template,
       long digestPtr,
       int paddingType,
       boolean preHash,
       long mgfMd,
       int saltLen,
+      boolean p1363,
       byte[] message,
       int offset,
       int length,
@@ -91,6 +130,8 @@ class EvpSignature extends EvpSignatureBase {
    * Starts calculating a signature and returns a native pointer to the context.
    *
    * @param privateKey a pointer to the private key
+   * @param template a pointer to a context template from {@link #newContextTemplate} for this key
+   *     and the remaining parameters, or {@code 0}. If set, the remaining parameters are ignored.
    * @param digestPtr the value from {@link Utils#getEvpMdFromName(String)} representing the digest
    *     to use with this signature
    * @param paddingType the integer defined by OpenSSL as the padding type to be used.
@@ -113,6 +154,7 @@ class EvpSignature extends EvpSignatureBase {
    */
   private static native long signStart(
       long privateKey,
+      long template,
       long digestPtr,
       int paddingType,
       boolean preHash,
@@ -126,6 +168,8 @@ class EvpSignature extends EvpSignatureBase {
    * Starts calculating a signature and returns a native pointer to the context.
    *
    * @param privateKey a pointer to the private key
+   * @param template a pointer to a context template from {@link #newContextTemplate} for this key
+   *     and the remaining parameters, or {@code 0}. If set, the remaining parameters are ignored.
    * @param digestPtr the value from {@link Utils#getEvpMdFromName(String)} representing the digest
    *     to use with this signature
    * @param paddingType the integer defined by OpenSSL as the padding type to be used.
@@ -146,6 +190,7 @@ class EvpSignature extends EvpSignatureBase {
    */
   private static native long signStartBuffer(
       long privateKey,
+      long template,
       long digestPtr,
       int paddingType,
       boolean preHash,
@@ -157,6 +202,8 @@ class EvpSignature extends EvpSignatureBase {
    * Starts verifying a signature and returns a native pointer to the context.
    *
    * @param publicKey a pointer to the public key
+   * @param template a pointer to a context template from {@link #newContextTemplate} for this key
+   *     and the remaining parameters, or {@code 0}. If set, the remaining parameters are ignored.
    * @param digestPtr the value from {@link Utils#getEvpMdFromName(String)} representing the digest
    *     to use with this signature
    * @param paddingType the integer defined by OpenSSL as the padding type to be used.
@@ -179,6 +226,7 @@ class EvpSignature extends EvpSignatureBase {
    */
   private static native long verifyStart(
       long publicKey,
+      long template,
       long digestPtr,
       int paddingType,
       boolean preHash,
@@ -192,6 +240,8 @@ class EvpSignature extends EvpSignatureBase {
    * Starts verifying a signature and returns a native pointer to the context.
    *
    * @param publicKey a pointer to the public key
+   * @param template a pointer to a context template from {@link #newContextTemplate} for this key
+   *     and the remaining parameters, or {@code 0}. If set, the remaining parameters are ignored.
    * @param digestPtr the value from {@link Utils#getEvpMdFromName(String)} representing the digest
    *     to use with this signature
    * @param paddingType the integer defined by OpenSSL as the padding type to be used.
@@ -212,6 +262,7 @@ class EvpSignature extends EvpSignatureBase {
    */
   private static native long verifyStartBuffer(
       long publicKey,
+      long template,
       long digestPtr,
       int paddingType,
       boolean preHash,
@@ -269,8 +320,25 @@ class EvpSignature extends EvpSignatureBase {
    * @param ctx native context returned by either {@link #signStart(byte[], int, String, int,
    *     String, int, byte[], int, int)} or {@link #signStartBuffer(byte[], int, String, int,
    *     String, int, ByteBuffer)}.
+   * @param p1363 whether to return the ECDSA signature in IEEE P1363 format (r||s) rather than DER
+   */
+  private static native byte[] signFinish(long ctx, boolean p1363) throws SignatureException;
+
+  /**
+   * Calculates the signature into {@code out} and <em>destroys the context</em>.
+   *
+   * @param ctx native context returned by either {@link #signStart(byte[], int, String, int,
+   *     String, int, byte[], int, int)} or {@link #signStartBuffer(byte[], int, String, int,
+   *     String, int, ByteBuffer)}.
+   * @param p1363 whether to write the ECDSA signature in IEEE P1363 format (r||s) rather than DER
+   * @param out the array to write the signature to
+   * @param outOff the offset in {@code out} at which to write the signature
+   * @param outLen the space available in {@code out} for the signature
+   * @return the length of the signature
+   * @throws SignatureException if the signature does not fit in the output range
    */
-  private static native byte[] signFinish(long ctx) throws SignatureException;
+  private static native int signFinishInto(
+      long ctx, boolean p1363, byte[] out, int outOff, int outLen) throws SignatureException;
 
   /**
    * Verifies the signature and <em>destroys the context</em>.
@@ -278,15 +346,41 @@ class EvpSignature extends EvpSignatureBase {
    * @param ctx native context returned by either {@link #verifyStart(byte[], int, String, int,
    *     String, int, byte[], int, int)} or {@link #verifyStartBuffer(byte[], int, String, int,
    *     String, int, ByteBuffer)}.
+   * @param p1363 whether the ECDSA signature is in IEEE P1363 format (r||s) rather than DER
    * @param signature the signature to verify
    * @param sigOff the offset in {@code signature} of the actual signature to verify
    * @param sigLen the length of the signatue to verify
    * @return true if the signature was verified. false if not.
    */
-  private static native boolean verifyFinish(long ctx, byte[] signature, int sigOff, int sigLen)
+  private static native boolean verifyFinish(
+      long ctx, boolean p1363, byte[] signature, int sigOff, int sigLen)
       throws SignatureException;
 
+  /**
+   * Creates a context template: a native context initialized for the key and parameters, which
+   * holds no data. Contexts are then produced by copying it, which skips most of the setup work.
+   *
+   * @return a native pointer to the template, to be owned by an {@link EvpContextTemplate}
+   */
+  private static native long newContextTemplate(
+      long key,
+      boolean signMode,
+      long digestPtr,
+      int paddingType,
+      boolean preHash,
+      long mgfMd,
+      int saltLen);
+
+  /**
+   * When true, contexts for RSA and ECDSA signatures are copied from {@link EvpContextTemplate}s
+   * cached on the key, rather than being initialized from scratch for every operation.
+   */
+  private static final boolean USE_CONTEXT_TEMPLATES =
+      Utils.getBooleanProperty("signatureContextTemplates", false);
+
   private byte[] oneByteArray_ = null;
+  // Length of the signature last written by engineSign(byte[], int, int)
+  private int signatureLength_ = 0;
   private InputBuffer<byte[], EvpContext, SignatureException> signingBuffer;
   private InputBuffer<Boolean, EvpContext, SignatureException> verifyingBuffer;
 
@@ -323,49 +417,42 @@ class EvpSignature extends EvpSignatureBase {
         .withInitialUpdater(
             (src, offset, length) ->
                 new EvpContext(
-                    key_.use(
-                        ptr ->
-                            signStart(
-                                ptr,
-                                digest_,
-                                paddingType_,
-                                preHash_,
-                                pssMgfMd_,
-                                pssSaltLen_,
-                                src,
-                                offset,
-                                length))))
+                    useContextTemplate(
+                        template ->
+                            key_.use(
+                                ptr ->
+                                    signStart(
+                                        ptr,
+                                        template,
+                                        digest_,
+                                        paddingType_,
+                                        preHash_,
+                                        pssMgfMd_,
+                                        pssSaltLen_,
+                                        src,
+                                        offset,
+                                        length)))))
         .withInitialUpdater(
             (src) ->
                 new EvpContext(
-                    key_.use(
-                        ptr ->
-                            signStartBuffer(
-                                ptr,
-                                digest_,
-                                paddingType_,
-                                preHash_,
-                                pssMgfMd_,
-                                pssSaltLen_,
-                                src))))
+                    useContextTemplate(
+                        template ->
+                            key_.use(
+                                ptr ->
+                                    signStartBuffer(
+                                        ptr,
+                                        template,
+                                        digest_,
+                                        paddingType_,
+                                        preHash_,
+                                        pssMgfMd_,
+                                        pssSaltLen_,
+                                        src)))))
         .withUpdater(
             (ctx, src, offset, length) -> ctx.useVoid(ptr -> signUpdate(ptr, src, offset, length)))
-        .withUpdater((ctx, src) -> ctx.useVoid(ptr -> signUpdateBuffer(ptr, src)))
-        .withDoFinal((ctx) -> signFinish(ctx.take()))
-        .withSinglePass(
-            (src, offset, length) ->
-                key_.use(
-                    ptr ->
-                        sign(
-                            ptr,
-                            digest_,
-                            paddingType_,
-                            preHash_,
-                            pssMgfMd_,
-                            pssSaltLen_,
-                            src,
-                            offset,
-                            length)));
+        .withUpdater((ctx, src) -> ctx.useVoid(ptr -> signUpdateBuffer(ptr, src)));
+    // Both doFinal and SinglePass are defined by engineSign, as they depend on whether the
+    // signature is returned or written to a caller's array.
   }
 
   private InputBuffer<Boolean, EvpContext, SignatureException> getVerifyingBuffer() {
@@ -373,37 +460,76 @@ class EvpSignature extends EvpSignatureBase {
         .withInitialUpdater(
             (src, offset, length) ->
                 new EvpContext(
-                    key_.use(
-                        ptr ->
-                            verifyStart(
-                                ptr,
-                                digest_,
-                                paddingType_,
-                                preHash_,
-                                pssMgfMd_,
-                                pssSaltLen_,
-                                src,
-                                offset,
-                                length))))
+                    useContextTemplate(
+                        template ->
+                            key_.use(
+                                ptr ->
+                                    verifyStart(
+                                        ptr,
+                                        template,
+                                        digest_,
+                                        paddingType_,
+                                        preHash_,
+                                        pssMgfMd_,
+                                        pssSaltLen_,
+                                        src,
+                                        offset,
+                                        length)))))
         .withInitialUpdater(
             (src) ->
                 new EvpContext(
+                    useContextTemplate(
+                        template ->
+                            key_.use(
+                                ptr ->
+                                    verifyStartBuffer(
+                                        ptr,
+                                        template,
+                                        digest_,
+                                        paddingType_,
+                                        preHash_,
+                                        pssMgfMd_,
+                                        pssSaltLen_,
+                                        src)))))
+        .withUpdater(
+            (ctx, src, offset, length) ->
+                ctx.useVoid(ptr -> verifyUpdate(ptr, src, offset, length)))
+        .withUpdater((ctx, src) -> ctx.useVoid(ptr -> verifyUpdateBuffer(ptr, src)));
+    // Both doFinal and SinglePass need to be defined at the very end for verify
+    // because they need access to the passed in signature to verify it.
+  }
+
+  /**
+   * Passes {@code function} the context template for the current key and parameters, or {@code 0}
+   * if templates are disabled or unavailable for them. Only RSA and ECDSA contexts are templated.
+   */
+  private <T, X extends Throwable> T useContextTemplate(
+      final MiscInterfaces.ThrowingLongFunction<T, X> function) throws X {
+    if (!USE_CONTEXT_TEMPLATES || (keyType_ != EvpKeyType.RSA && keyType_ != EvpKeyType.EC)) {
+      return function.apply(0);
+    }
+    // All values baked into the template by newContextTemplate
+    final Object params =
+        Arrays.asList(signMode, digest_, paddingType_, preHash_, pssMgfMd_, pssSaltLen_);
+    final EvpContextTemplate template =
+        key_.getContextTemplate(
+            params,
+            () ->
+                new EvpContextTemplate(
                     key_.use(
                         ptr ->
-                            verifyStartBuffer(
+                            newContextTemplate(
                                 ptr,
+                                signMode,
                                 digest_,
                                 paddingType_,
                                 preHash_,
                                 pssMgfMd_,
-                                pssSaltLen_,
-                                src))))
-        .withUpdater(
-            (ctx, src, offset, length) ->
-                ctx.useVoid(ptr -> verifyUpdate(ptr, src, offset, length)))
-        .withUpdater((ctx, src) -> ctx.useVoid(ptr -> verifyUpdateBuffer(ptr, src)));
-    // Both doFinal and SinglePass need to be defined at the very end for verify
-    // because they need access to the passed in signature to verify it.
+                                pssSaltLen_))));
+    if (template == null) {
+      return function.apply(0);
+    }
+    return template.use(function);
   }
 
   protected synchronized void engineReset() {
@@ -430,7 +556,72 @@ class EvpSignature extends EvpSignatureBase {
   protected synchronized byte[] engineSign() throws SignatureException {
     ensureInitialized(true);
     try {
-      return maybeConvertSignatureToReturn(signingBuffer.doFinal());
+      final boolean p1363 = isP1363Format();
+      return signingBuffer
+          .withDoFinal((ctx) -> signFinish(ctx.take(), p1363))
+          .withSinglePass(
+              (src, offset, length) ->
+                  useContextTemplate(
+                      template ->
+                          key_.use(
+                              ptr ->
+                                  sign(
+                                      ptr,
+                                      template,
+                                      digest_,
+                                      paddingType_,
+                                      preHash_,
+                                      pssMgfMd_,
+                                      pssSaltLen_,
+                                      p1363,
+                                      src,
+                                      offset,
+                                      length))))
+          .doFinal();
+    } finally {
+      engineReset();
+    }
+  }
+
+  @Override
+  protected synchronized int engineSign(final byte[] outbuf, final int offset, final int len)
+      throws SignatureException {
+    ensureInitialized(true);
+    try {
+      final boolean p1363 = isP1363Format();
+      // The natives write straight into outbuf, so only the length needs returning
+      signingBuffer
+          .withDoFinal(
+              (ctx) -> {
+                signatureLength_ = signFinishInto(ctx.take(), p1363, outbuf, offset, len);
+                return outbuf;
+              })
+          .withSinglePass(
+              (src, srcOffset, srcLength) -> {
+                signatureLength_ =
+                    useContextTemplate(
+                        template ->
+                            key_.use(
+                                ptr ->
+                                    signInto(
+                                        ptr,
+                                        template,
+                                        digest_,
+                                        paddingType_,
+                                        preHash_,
+                                        pssMgfMd_,
+                                        pssSaltLen_,
+                                        p1363,
+                                        src,
+                                        srcOffset,
+                                        srcLength,
+                                        outbuf,
+                                        offset,
+                                        len)));
+                return outbuf;
+              })
+          .doFinal();
+      return signatureLength_;
     } finally {
       engineReset();
     }
@@ -476,39 +667,31 @@ class EvpSignature extends EvpSignatureBase {
       throws SignatureException {
     ensureInitialized(false);
     try {
-      byte[] tempSig = maybeConvertSignatureToVerify(sigBytes, off, len);
-      final byte[] finalSigBytes;
-      final int finalOff;
-      final int finalLen;
-      if (tempSig != null) {
-        finalSigBytes = tempSig;
-        finalOff = 0;
-        finalLen = finalSigBytes.length;
-      } else {
-        finalSigBytes = sigBytes;
-        finalOff = off;
-        finalLen = len;
-      }
-      sniffTest(finalSigBytes, finalOff, finalLen);
+      final boolean p1363 = isP1363Format();
+      sniffTest(sigBytes, off, len);
       return verifyingBuffer
-          .withDoFinal((ctx) -> verifyFinish(ctx.take(), finalSigBytes, finalOff, finalLen))
+          .withDoFinal((ctx) -> verifyFinish(ctx.take(), p1363, sigBytes, off, len))
           .withSinglePass(
               (src, offset, length) ->
-                  key_.use(
-                      ptr ->
-                          verify(
-                              ptr,
-                              digest_,
-                              paddingType_,
-                              preHash_,
-                              pssMgfMd_,
-                              pssSaltLen_,
-                              src,
-                              offset,
-                              length,
-                              finalSigBytes,
-                              finalOff,
-                              finalLen)))
+                  useContextTemplate(
+                      template ->
+                          key_.use(
+                              ptr ->
+                                  verify(
+                                      ptr,
+                                      template,
+                                      digest_,
+                                      paddingType_,
+                                      preHash_,
+                                      pssMgfMd_,
+                                      pssSaltLen_,
+                                      p1363,
+                                      src,
+                                      offset,
+                                      length,
+                                      sigBytes,
+                                      off,
+                                      len))))
           .doFinal();
     } finally {
       // Clear the handlers which we don't need anymore.
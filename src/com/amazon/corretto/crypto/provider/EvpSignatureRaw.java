@@ -50,6 +50,30 @@ class EvpSignatureRaw extends EvpSignatureBase {
     }
   }
 
+  @Override
+  protected int engineSign(final byte[] outbuf, final int offset, final int len)
+      throws SignatureException {
+    try {
+      ensureInitialized(true);
+      return key_.use(
+          ptr ->
+              signRawInto(
+                  ptr,
+                  paddingType_,
+                  preHash_,
+                  0,
+                  0,
+                  buffer.getDataBuffer(),
+                  0,
+                  buffer.size(),
+                  outbuf,
+                  offset,
+                  len));
+    } finally {
+      engineReset();
+    }
+  }
+
   @Override
   protected boolean engineVerify(final byte[] sigBytes) throws SignatureException {
     return engineVerify(sigBytes, 0, sigBytes.length);
@@ -94,6 +118,20 @@ class EvpSignatureRaw extends EvpSignatureBase {
       int offset,
       int length);
 
+  private static native int signRawInto(
+      long privateKey,
+      int paddingType,
+      boolean preHash,
+      long mgfMd,
+      int saltLen,
+      byte[] message,
+      int offset,
+      int length,
+      byte[] out,
+      int outOff,
+      int outLen)
+      throws SignatureException;
+
   private static native boolean verifyRaw(
       long publicKey,
       int paddingType,
@@ -0,0 +1,151 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider;
+
+import java.nio.ByteBuffer;
+import java.util.logging.Logger;
+
+/**
+ * Opt-in, process-wide cache of keyed HMAC templates shared by all {@link EvpHmac} instances.
+ *
+ * <p>By default each {@link EvpHmac} keeps its {@code HMAC_CTX} in a Java {@code byte[]}, which is
+ * bounced into native memory on every call and re-keyed whenever a {@code Mac} is initialized.
+ * When this cache is enabled, each distinct key (per digest and key type) is set up once into an
+ * immutable native template, and every message only copies the template state into a context
+ * which lives in native memory for the lifetime of the {@code Mac}.
+ *
+ * <p>The cache is bounded by {@link #PROPERTY_CAPACITY} entries and is disabled by default. Entries
+ * are reference counted on the native side; an evicted entry is freed once the last {@link Entry}
+ * referring to it has been released.
+ */
+final class HmacKeyCache {
+  static {
+    Loader.load();
+  }
+
+  private static final Logger LOG = Logger.getLogger("AmazonCorrettoCryptoProvider");
+  private static final String PROPERTY_CAPACITY = "hmacKeyCacheSize";
+  private static final int CAPACITY = readCapacity();
+
+  private HmacKeyCache() {
+    // Prevent instantiation
+  }
+
+  /**
+   * Returns a referenced native cache entry for the given key, creating it if needed and evicting
+   * the least recently used entries beyond {@code capacity}.
+   */
+  private static native long acquireEntry(
+      int capacity, long evpMd, byte[] key, boolean usePrecomputedKey);
+
+  /** Drops the reference obtained from {@link #acquireEntry}. */
+  private static native void releaseEntry(long entryPtr);
+
+  private static native long newContext();
+
+  private static native long copyContext(long ctxPtr);
+
+  private static native void freeContext(long ctxPtr);
+
+  /** Resets the context to the entry's template and absorbs {@code input}. */
+  private static native void initUpdate(
+      long entryPtr, long ctxPtr, byte[] input, int offset, int length);
+
+  private static native void update(long ctxPtr, byte[] input, int offset, int length);
+
+  /** As {@link #initUpdate}, but absorbs the remaining bytes of a direct ByteBuffer. */
+  private static native void initUpdateDirect(long entryPtr, long ctxPtr, ByteBuffer input);
+
+  private static native void updateDirect(long ctxPtr, ByteBuffer input);
+
+  /** Calls {@code HMAC_Final}, and places the result in {@code result}. */
+  private static native void doFinal(long ctxPtr, byte[] result);
+
+  /** Resets the context to the entry's template and computes the HMAC of {@code input}. */
+  private static native void fastHmac(
+      long entryPtr, long ctxPtr, byte[] input, int offset, int length, byte[] result);
+
+  private static int readCapacity() {
+    final String propertyStr = Loader.getProperty(PROPERTY_CAPACITY, "0");
+    try {
+      final int capacity = Integer.parseInt(propertyStr);
+      if (capacity >= 0) {
+        return capacity;
+      }
+    } catch (final NumberFormatException ex) {
+      // Fall through to the warning below
+    }
+    LOG.warning(
+        String.format(
+            "Valid values for %s are non-negative integers, with 0 (disabled) as default",
+            PROPERTY_CAPACITY));
+    return 0;
+  }
+
+  static boolean isEnabled() {
+    return CAPACITY > 0;
+  }
+
+  /** A reference to a cached HMAC template. Released by the Janitor if not released explicitly. */
+  static final class Entry extends NativeResource {
+    private Entry(final long ptr) {
+      // The template is never written after creation, so readers need not be serialized.
+      super(ptr, HmacKeyCache::releaseEntry, true);
+    }
+
+    /** Starts a new message on {@code context} and absorbs {@code input}. */
+    void initUpdate(
+        final Context context, final byte[] input, final int offset, final int length) {
+      context.useVoid(
+          ctxPtr -> useVoid(ptr -> HmacKeyCache.initUpdate(ptr, ctxPtr, input, offset, length)));
+    }
+
+    /** Starts a new message on {@code context} and absorbs the direct ByteBuffer {@code input}. */
+    void initUpdate(final Context context, final ByteBuffer input) {
+      context.useVoid(ctxPtr -> useVoid(ptr -> HmacKeyCache.initUpdateDirect(ptr, ctxPtr, input)));
+    }
+
+    /** Computes the HMAC of {@code input} on {@code context} into {@code result}. */
+    void fastHmac(
+        final Context context,
+        final byte[] input,
+        final int offset,
+        final int length,
+        final byte[] result) {
+      context.useVoid(
+          ctxPtr ->
+              useVoid(ptr -> HmacKeyCache.fastHmac(ptr, ctxPtr, input, offset, length, result)));
+    }
+  }
+
+  /** A native {@code HMAC_CTX} owned by a single {@link EvpHmac}. */
+  static final class Context extends NativeResource {
+    Context() {
+      this(newContext());
+    }
+
+    private Context(final long ptr) {
+      super(ptr, HmacKeyCache::freeContext);
+    }
+
+    void update(final byte[] input, final int offset, final int length) {
+      useVoid(ptr -> HmacKeyCache.update(ptr, input, offset, length));
+    }
+
+    void update(final ByteBuffer input) {
+      useVoid(ptr -> HmacKeyCache.updateDirect(ptr, input));
+    }
+
+    void doFinal(final byte[] result) {
+      useVoid(ptr -> HmacKeyCache.doFinal(ptr, result));
+    }
+
+    Context copy() {
+      return new Context(use(HmacKeyCache::copyContext));
+    }
+  }
+
+  static Entry acquire(final long evpMd, final byte[] key, final boolean usePrecomputedKey) {
+    return new Entry(acquireEntry(CAPACITY, evpMd, key, usePrecomputedKey));
+  }
+}
@@ -0,0 +1,13 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider;
+
+/**
+ * This class is used in AesGcmSpi to ensure the EVP_AEAD_CTX of its one-shot fast path is properly
+ * cleaned.
+ */
+final class NativeEvpAeadCtx extends NativeResource {
+  NativeEvpAeadCtx(final long ptr) {
+    super(ptr, Utils::releaseEvpAeadCtx);
+  }
+}
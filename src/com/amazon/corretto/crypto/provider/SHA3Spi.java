@@ -0,0 +1,212 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider;
+
+import java.nio.ByteBuffer;
+import java.security.DigestException;
+import java.security.MessageDigestSpi;
+
+/**
+ * SHA-3 digests and the SHAKE extendable-output functions, backed by AWS-LC's Keccak.
+ *
+ * <p>The SHA-2 digests keep their native state in a Java {@code byte[]} (see {@code
+ * TemplateHashSpi}), which is not possible here as AWS-LC only exposes Keccak through EVP. Instead,
+ * input is buffered on the Java side exactly like for the SHA-2 digests: messages which fit in the
+ * buffer are digested by a single native call without any native allocation, while longer messages
+ * are absorbed into a native context.
+ *
+ * <p>The SHAKE functions have a default output length of 32 (SHAKE128) and 64 (SHAKE256) bytes,
+ * which is what {@link java.security.MessageDigest#digest()} returns. Any other output length can
+ * be requested through {@link java.security.MessageDigest#digest(byte[], int, int)}, which then
+ * returns exactly {@code len} bytes.
+ */
+abstract class SHA3Spi extends MessageDigestSpi implements Cloneable {
+  static {
+    Loader.load();
+  }
+
+  // Keep in sync with the codes in sha3.cpp
+  private static final int SHA3_224_CODE = 0;
+  private static final int SHA3_256_CODE = 1;
+  private static final int SHA3_384_CODE = 2;
+  private static final int SHA3_512_CODE = 3;
+  private static final int SHAKE128_CODE = 4;
+  private static final int SHAKE256_CODE = 5;
+
+  /**
+   * Single-shot digest routine: writes the first {@code outLen} bytes of the digest of {@code
+   * buf[bufOffset, bufOffset + bufLen)} to {@code digest}.
+   */
+  static native void fastDigest(
+      int algorithm, byte[] digest, int outLen, byte[] buf, int bufOffset, int bufLen);
+
+  /** Returns a new native context which has absorbed {@code buf[offset, offset + length)}. */
+  private static native long initUpdate(int algorithm, byte[] buf, int offset, int length);
+
+  private static native void update(long ctx, byte[] buf, int offset, int length);
+
+  /**
+   * Writes {@code outLen} bytes of output to {@code digest}. The context is freed, even on failure.
+   */
+  private static native void finish(long ctx, int algorithm, byte[] digest, int outLen);
+
+  private static native long cloneContext(long ctx);
+
+  private static native void freeContext(long ctx);
+
+  private static final class Context extends NativeResource {
+    private Context(final long ptr) {
+      super(ptr, SHA3Spi::freeContext);
+    }
+  }
+
+  private final int algorithm;
+  private final int digestLength;
+  private final boolean xof;
+  // Output length of the digest currently being finished; only differs from digestLength for XOFs.
+  private int outputLength;
+  private InputBuffer<byte[], Context, RuntimeException> buffer;
+
+  SHA3Spi(final int algorithm, final int digestLength, final boolean xof) {
+    Loader.checkNativeLibraryAvailability();
+    this.algorithm = algorithm;
+    this.digestLength = digestLength;
+    this.xof = xof;
+    this.outputLength = digestLength;
+    this.buffer =
+        new InputBuffer<byte[], Context, RuntimeException>(1024)
+            .withInitialUpdater(
+                (src, offset, length) -> new Context(initUpdate(algorithm, src, offset, length)))
+            .withUpdater(
+                (ctx, src, offset, length) -> ctx.useVoid(ptr -> update(ptr, src, offset, length)))
+            .withDoFinal(this::doFinal)
+            .withSinglePass(this::singlePass)
+            .withStateCloner(SHA3Spi::cloneState);
+  }
+
+  private static Context cloneState(final Context ctx) {
+    // A context which has already been finished belongs to no message and is not worth copying.
+    return ctx.isReleased() ? null : new Context(ctx.use(SHA3Spi::cloneContext));
+  }
+
+  private byte[] doFinal(final Context ctx) {
+    final byte[] result = new byte[outputLength];
+    finish(ctx.take(), algorithm, result, outputLength);
+    return result;
+  }
+
+  private byte[] singlePass(final byte[] src, final int offset, final int length) {
+    final byte[] result = new byte[outputLength];
+    fastDigest(algorithm, result, outputLength, src, offset, length);
+    return result;
+  }
+
+  @Override
+  protected void engineUpdate(final byte input) {
+    buffer.update(input);
+  }
+
+  @Override
+  protected void engineUpdate(final byte[] input, final int offset, final int length) {
+    buffer.update(input, offset, length);
+  }
+
+  @Override
+  protected void engineUpdate(final ByteBuffer buf) {
+    buffer.update(buf);
+  }
+
+  @Override
+  protected int engineGetDigestLength() {
+    return digestLength;
+  }
+
+  @Override
+  protected byte[] engineDigest() {
+    try {
+      outputLength = digestLength;
+      return buffer.doFinal();
+    } finally {
+      engineReset();
+    }
+  }
+
+  @Override
+  protected int engineDigest(final byte[] buf, final int offset, final int len)
+      throws DigestException {
+    final int resultLength = xof ? len : digestLength;
+    if (len < resultLength || resultLength <= 0) {
+      throw new IllegalArgumentException("Buffer length too small");
+    }
+    if (offset < 0 || buf.length - offset < resultLength) {
+      throw new IllegalArgumentException("Buffer too small for output");
+    }
+    final byte[] digest;
+    try {
+      outputLength = resultLength;
+      digest = buffer.doFinal();
+    } finally {
+      outputLength = digestLength;
+      engineReset();
+    }
+    System.arraycopy(digest, 0, buf, offset, resultLength);
+    return resultLength;
+  }
+
+  @Override
+  protected void engineReset() {
+    buffer.reset();
+  }
+
+  @Override
+  public Object clone() {
+    try {
+      final SHA3Spi clonedObject = (SHA3Spi) super.clone();
+      // The final handlers depend on the output length of the instance they are bound to.
+      clonedObject.buffer =
+          buffer
+              .clone()
+              .withDoFinal(clonedObject::doFinal)
+              .withSinglePass(clonedObject::singlePass);
+      return clonedObject;
+    } catch (final CloneNotSupportedException e) {
+      throw new Error("Unexpected CloneNotSupportedException", e);
+    }
+  }
+
+  static final class SHA3_224 extends SHA3Spi {
+    public SHA3_224() {
+      super(SHA3_224_CODE, 28, false);
+    }
+  }
+
+  static final class SHA3_256 extends SHA3Spi {
+    public SHA3_256() {
+      super(SHA3_256_CODE, 32, false);
+    }
+  }
+
+  static final class SHA3_384 extends SHA3Spi {
+    public SHA3_384() {
+      super(SHA3_384_CODE, 48, false);
+    }
+  }
+
+  static final class SHA3_512 extends SHA3Spi {
+    public SHA3_512() {
+      super(SHA3_512_CODE, 64, false);
+    }
+  }
+
+  static final class SHAKE128 extends SHA3Spi {
+    public SHAKE128() {
+      super(SHAKE128_CODE, 32, true);
+    }
+  }
+
+  static final class SHAKE256 extends SHA3Spi {
+    public SHAKE256() {
+      super(SHAKE256_CODE, 64, true);
+    }
+  }
+}
@@ -0,0 +1,228 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider;
+
+import java.security.MessageDigestSpi;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.logging.Logger;
+
+/**
+ * Parallel tree hashing of large inputs ("SHA-256-TREE" and "SHA-512-TREE").
+ *
+ * <p>The input is split into chunks of {@link #CHUNK_SIZE} bytes, the last of which may be shorter;
+ * an empty input consists of a single empty chunk. The result is the Merkle tree hash of RFC 6962,
+ * section 2.1, with the chunks as leaves:
+ *
+ * <ul>
+ *   <li>the hash of a single chunk {@code c} is {@code H(0x00 || c)};
+ *   <li>the hash of chunks {@code c[0..n)}, {@code n > 1}, is {@code H(0x01 || L || R)}, where
+ *       {@code L} is the hash of {@code c[0..k)}, {@code R} that of {@code c[k..n)}, and {@code k}
+ *       the largest power of two smaller than {@code n}.
+ * </ul>
+ *
+ * <p>The result therefore only depends on the input, not on how it is passed to {@code update} or
+ * on the number of threads. Leaf digests are computed by up to {@link #PROPERTY_THREADS} native
+ * threads; interior nodes, one per chunk, are cheap by comparison.
+ */
+abstract class TreeHashSpi extends MessageDigestSpi implements Cloneable {
+  static {
+    Loader.load();
+  }
+
+  private static final Logger LOG = Logger.getLogger("AmazonCorrettoCryptoProvider");
+  private static final String PROPERTY_THREADS = "treeHashThreads";
+  private static final int MAX_THREADS = 64;
+  private static final int THREADS = readThreads();
+
+  /** Size of the chunks forming the leaves of the tree. */
+  static final int CHUNK_SIZE = 1024 * 1024;
+
+  // Input is collected until there are enough chunks to keep all threads busy.
+  private static final int MAX_PENDING = THREADS * CHUNK_SIZE;
+  private static final byte NODE_PREFIX = 0x01;
+
+  /**
+   * Writes the leaf digests of the chunks of {@code data[offset, offset + length)} to {@code
+   * leaves}, using up to {@code threads} threads. Empty input has one empty chunk.
+   */
+  private static native void hashLeaves(
+      int digestLength,
+      byte[] data,
+      int offset,
+      int length,
+      int chunkSize,
+      byte[] leaves,
+      int threads);
+
+  private static int readThreads() {
+    final int defaultValue = Runtime.getRuntime().availableProcessors();
+    final String propertyStr = Loader.getProperty(PROPERTY_THREADS, Integer.toString(defaultValue));
+    try {
+      final int value = Integer.parseInt(propertyStr);
+      if (value >= 1) {
+        return Math.min(MAX_THREADS, value);
+      }
+    } catch (final NumberFormatException ex) {
+      // Fall through to the warning below
+    }
+    LOG.warning(
+        String.format(
+            "Valid values for %s are positive integers, with the number of processors as default",
+            PROPERTY_THREADS));
+    return Math.min(MAX_THREADS, defaultValue);
+  }
+
+  private final int digestLength;
+  private byte[] pending = Utils.EMPTY_ARRAY;
+  private int pendingLength = 0;
+  // Roots of the complete subtrees seen so far, with the number of leaves of each. The counts are
+  // strictly decreasing powers of two, so this is the binary representation of leafCount.
+  private ArrayList<byte[]> subtrees = new ArrayList<>();
+  private ArrayList<Long> subtreeLeaves = new ArrayList<>();
+  private long leafCount = 0;
+
+  TreeHashSpi(final int digestLength) {
+    Loader.checkNativeLibraryAvailability();
+    this.digestLength = digestLength;
+  }
+
+  /** Writes {@code H(input)} to {@code digest}. */
+  abstract void hash(byte[] digest, byte[] input);
+
+  @Override
+  protected int engineGetDigestLength() {
+    return digestLength;
+  }
+
+  @Override
+  protected void engineUpdate(final byte input) {
+    engineUpdate(new byte[] {input}, 0, 1);
+  }
+
+  @Override
+  protected void engineUpdate(final byte[] input, int offset, int length) {
+    Utils.checkArrayLimits(input, offset, length);
+    while (length > 0) {
+      if (pendingLength == 0 && length >= CHUNK_SIZE) {
+        // Whole chunks are hashed straight from the caller's array.
+        final int direct = length - length % CHUNK_SIZE;
+        addLeaves(input, offset, direct);
+        offset += direct;
+        length -= direct;
+        continue;
+      }
+      if (pending.length == pendingLength) {
+        final int grown = Math.max(pendingLength + length, 2 * pending.length);
+        pending = Arrays.copyOf(pending, Math.min(MAX_PENDING, grown));
+      }
+      final int step = Math.min(length, pending.length - pendingLength);
+      System.arraycopy(input, offset, pending, pendingLength, step);
+      pendingLength += step;
+      offset += step;
+      length -= step;
+      if (pendingLength == MAX_PENDING) {
+        flushPending();
+      }
+    }
+  }
+
+  @Override
+  protected byte[] engineDigest() {
+    try {
+      if (pendingLength > 0 || leafCount == 0) {
+        flushPending();
+      }
+      byte[] root = subtrees.get(subtrees.size() - 1);
+      for (int i = subtrees.size() - 2; i >= 0; i--) {
+        root = hashNode(subtrees.get(i), root);
+      }
+      return root;
+    } finally {
+      engineReset();
+    }
+  }
+
+  @Override
+  protected void engineReset() {
+    if (pending.length > CHUNK_SIZE) {
+      // Don't hold on to the full batch buffer between messages.
+      pending = Utils.EMPTY_ARRAY;
+    }
+    pendingLength = 0;
+    subtrees.clear();
+    subtreeLeaves.clear();
+    leafCount = 0;
+  }
+
+  @Override
+  public Object clone() throws CloneNotSupportedException {
+    final TreeHashSpi clone = (TreeHashSpi) super.clone();
+    clone.pending = pending.clone();
+    clone.subtrees = new ArrayList<>(subtrees);
+    clone.subtreeLeaves = new ArrayList<>(subtreeLeaves);
+    return clone;
+  }
+
+  private void flushPending() {
+    addLeaves(pending, 0, pendingLength);
+    pendingLength = 0;
+  }
+
+  private void addLeaves(final byte[] data, final int offset, final int length) {
+    final int count = length == 0 ? 1 : (length - 1) / CHUNK_SIZE + 1;
+    final byte[] leaves = new byte[count * digestLength];
+    hashLeaves(digestLength, data, offset, length, CHUNK_SIZE, leaves, THREADS);
+    for (int i = 0; i < count; i++) {
+      pushLeaf(Arrays.copyOfRange(leaves, i * digestLength, (i + 1) * digestLength));
+    }
+  }
+
+  private void pushLeaf(final byte[] leaf) {
+    byte[] node = leaf;
+    long leaves = 1;
+    int top = subtrees.size() - 1;
+    // Merge equally sized subtrees, as when incrementing a binary counter.
+    while (top >= 0 && subtreeLeaves.get(top) == leaves) {
+      node = hashNode(subtrees.remove(top), node);
+      subtreeLeaves.remove(top);
+      leaves *= 2;
+      top--;
+    }
+    subtrees.add(node);
+    subtreeLeaves.add(leaves);
+    leafCount++;
+  }
+
+  private byte[] hashNode(final byte[] left, final byte[] right) {
+    final byte[] input = new byte[1 + 2 * digestLength];
+    input[0] = NODE_PREFIX;
+    System.arraycopy(left, 0, input, 1, digestLength);
+    System.arraycopy(right, 0, input, 1 + digestLength, digestLength);
+    final byte[] result = new byte[digestLength];
+    hash(result, input);
+    return result;
+  }
+
+  static final class SHA256 extends TreeHashSpi {
+    public SHA256() {
+      super(32);
+    }
+
+    @Override
+    void hash(final byte[] digest, final byte[] input) {
+      SHA256Spi.fastDigest(digest, input, 0, input.length);
+    }
+  }
+
+  static final class SHA512 extends TreeHashSpi {
+    public SHA512() {
+      super(64);
+    }
+
+    @Override
+    void hash(final byte[] digest, final byte[] input) {
+      SHA512Spi.fastDigest(digest, input, 0, input.length);
+    }
+  }
+}
@@ -0,0 +1,218 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.utils;
+
+import java.nio.ByteBuffer;
+import java.security.Key;
+import java.util.Arrays;
+import java.util.BitSet;
+import java.util.HashSet;
+import java.util.Set;
+
+/**
+ * Seals and opens many small AES-GCM records under a single key in one native call.
+ *
+ * <p>Going through {@link javax.crypto.Cipher} costs a full context initialization and a JNI
+ * transition per record, which dominates for messages of a few hundred bytes. These methods compute
+ * the AES key schedule once and then only change the IV between records.
+ *
+ * <p>Records are described by parallel arrays: record {@code i} uses {@code ivs[i]}, optional
+ * {@code aads[i]}, and the input bytes {@code input[offsets[i], offsets[i] + lengths[i])}. Results
+ * are written back to back: the result of record {@code i} directly follows that of record {@code
+ * i - 1}.
+ */
+public final class AesGcmBatchUtils {
+  private AesGcmBatchUtils() {} // private constructor to prevent instantiation
+
+  private static native int sealInternal(
+      byte[] key,
+      int tagLen,
+      byte[][] ivs,
+      byte[][] aads,
+      byte[] input,
+      int[] offsets,
+      int[] lengths,
+      byte[] output);
+
+  private static native int openInternal(
+      byte[] key,
+      int tagLen,
+      byte[][] ivs,
+      byte[][] aads,
+      byte[] input,
+      int[] offsets,
+      int[] lengths,
+      byte[] output,
+      byte[] status);
+
+  /**
+   * Encrypts every record of the batch. Each record in the result is its ciphertext immediately
+   * followed by its tag, so record {@code i} is {@code lengths[i] + tagLenBits / 8} bytes long.
+   *
+   * <p>All IVs within a batch must be distinct.
+   *
+   * @param key AES key
+   * @param tagLenBits GCM tag length in bits; one of {128, 120, 112, 104, 96}
+   * @param ivs IV of each record
+   * @param aads optional AAD of each record; either the array or any of its elements may be null
+   * @param input buffer holding the plaintext of all records
+   * @param offsets start of each record within {@code input}
+   * @param lengths length of each record within {@code input}
+   * @return the concatenated sealed records
+   */
+  public static byte[] seal(
+      final Key key,
+      final int tagLenBits,
+      final byte[][] ivs,
+      final byte[][] aads,
+      final byte[] input,
+      final int[] offsets,
+      final int[] lengths) {
+    checkArguments(key, tagLenBits, ivs, aads, input, offsets, lengths);
+    final int tagLen = tagLenBits / 8;
+
+    final Set<ByteBuffer> seenIvs = new HashSet<>();
+    for (final byte[] iv : ivs) {
+      if (!seenIvs.add(ByteBuffer.wrap(iv))) {
+        throw new IllegalArgumentException("Cannot reuse same iv and key for GCM encryption");
+      }
+    }
+
+    long outputSize = 0;
+    for (final int length : lengths) {
+      outputSize += length + tagLen;
+    }
+    final byte[] output = new byte[checkedSize(outputSize)];
+
+    final byte[] rawKey = rawKey(key);
+    try {
+      sealInternal(rawKey, tagLen, ivs, aads, input, offsets, lengths, output);
+    } finally {
+      Arrays.fill(rawKey, (byte) 0);
+    }
+    return output;
+  }
+
+  /**
+   * Decrypts and authenticates every record of the batch. Each input record is its ciphertext
+   * immediately followed by its tag, and its plaintext ({@code lengths[i] - tagLenBits / 8} bytes)
+   * is written to {@code output}.
+   *
+   * <p>A record which fails authentication does not abort the batch. Instead its index is set in
+   * the returned {@link BitSet} and its region of {@code output} is zeroed.
+   *
+   * @param key AES key
+   * @param tagLenBits GCM tag length in bits; one of {128, 120, 112, 104, 96}
+   * @param ivs IV of each record
+   * @param aads optional AAD of each record; either the array or any of its elements may be null
+   * @param input buffer holding the sealed records
+   * @param offsets start of each record within {@code input}
+   * @param lengths length (ciphertext and tag) of each record within {@code input}
+   * @param output receives the concatenated plaintexts; must hold at least {@link
+   *     #getOpenOutputSize(int, int[])} bytes
+   * @return indices of the records which failed authentication; empty if all records are authentic
+   */
+  public static BitSet open(
+      final Key key,
+      final int tagLenBits,
+      final byte[][] ivs,
+      final byte[][] aads,
+      final byte[] input,
+      final int[] offsets,
+      final int[] lengths,
+      final byte[] output) {
+    checkArguments(key, tagLenBits, ivs, aads, input, offsets, lengths);
+    if (output == null) {
+      throw new IllegalArgumentException("Output must not be null");
+    }
+    if (output.length < getOpenOutputSize(tagLenBits, lengths)) {
+      throw new IllegalArgumentException("Output buffer too small");
+    }
+
+    final byte[] status = new byte[ivs.length];
+    final byte[] rawKey = rawKey(key);
+    try {
+      openInternal(rawKey, tagLenBits / 8, ivs, aads, input, offsets, lengths, output, status);
+    } finally {
+      Arrays.fill(rawKey, (byte) 0);
+    }
+
+    final BitSet failures = new BitSet(status.length);
+    for (int i = 0; i < status.length; i++) {
+      if (status[i] != 0) {
+        failures.set(i);
+      }
+    }
+    return failures;
+  }
+
+  /**
+   * Returns the number of bytes {@link #open} writes for records of the given lengths.
+   *
+   * @param tagLenBits GCM tag length in bits
+   * @param lengths length (ciphertext and tag) of each record
+   * @return total plaintext length
+   */
+  public static int getOpenOutputSize(final int tagLenBits, final int[] lengths) {
+    final int tagLen = tagLenBits / 8;
+    long size = 0;
+    for (final int length : lengths) {
+      size += Math.max(0, length - tagLen);
+    }
+    return checkedSize(size);
+  }
+
+  private static void checkArguments(
+      final Key key,
+      final int tagLenBits,
+      final byte[][] ivs,
+      final byte[][] aads,
+      final byte[] input,
+      final int[] offsets,
+      final int[] lengths) {
+    if (key == null || !"AES".equalsIgnoreCase(key.getAlgorithm())) {
+      throw new IllegalArgumentException("Key must be an AES key");
+    }
+    if ((tagLenBits % 8 != 0) || tagLenBits > 128 || tagLenBits < 96) {
+      throw new IllegalArgumentException(
+          "Unsupported TLen value; must be one of {128, 120, 112, 104, 96}");
+    }
+    if (ivs == null || input == null || offsets == null || lengths == null) {
+      throw new IllegalArgumentException("Batch arrays must not be null");
+    }
+    if (offsets.length != ivs.length
+        || lengths.length != ivs.length
+        || (aads != null && aads.length != ivs.length)) {
+      throw new IllegalArgumentException("Batch arrays must all have the same length");
+    }
+    for (int i = 0; i < ivs.length; i++) {
+      if (ivs[i] == null || ivs[i].length == 0) {
+        throw new IllegalArgumentException("IV must be at least one byte long");
+      }
+      if (offsets[i] < 0 || lengths[i] < 0 || offsets[i] > input.length - lengths[i]) {
+        throw new ArrayIndexOutOfBoundsException("Record " + i + " is outside of the input");
+      }
+    }
+  }
+
+  /** Returns a copy of the key material, which the caller must clear once done with it. */
+  private static byte[] rawKey(final Key key) {
+    final byte[] rawKey = key.getEncoded();
+    if (rawKey == null
+        || !"RAW".equalsIgnoreCase(key.getFormat())
+        || (rawKey.length != 16 && rawKey.length != 24 && rawKey.length != 32)) {
+      if (rawKey != null) {
+        Arrays.fill(rawKey, (byte) 0);
+      }
+      throw new IllegalArgumentException("Key must be a raw 128, 192, or 256 bit AES key");
+    }
+    return rawKey;
+  }
+
+  private static int checkedSize(final long size) {
+    if (size > Integer.MAX_VALUE) {
+      throw new IllegalArgumentException("Batch output exceeds maximum array size");
+    }
+    return (int) size;
+  }
+}
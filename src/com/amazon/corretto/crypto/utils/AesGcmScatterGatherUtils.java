@@ -0,0 +1,269 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.utils;
+
+import java.nio.ByteBuffer;
+import java.nio.ReadOnlyBufferException;
+import java.security.Key;
+import java.util.Arrays;
+import javax.crypto.AEADBadTagException;
+import javax.crypto.spec.GCMParameterSpec;
+
+/**
+ * Seals and opens a single AES-GCM message which is spread over several {@link ByteBuffer}s, such
+ * as a frame assembled from a header, payload slices and a trailer.
+ *
+ * <p>The input is the concatenation of the remaining bytes of each input buffer, in order, and the
+ * result is written across the remaining space of the output buffers, in order. Everything is
+ * processed in a single native call without first copying the slices into one array. On success,
+ * the position of every input buffer is advanced to its limit and the positions of the output
+ * buffers are advanced past the bytes written to them.
+ *
+ * <p>Direct and heap buffers may be mixed freely. Read-only heap input buffers are copied before
+ * use. Input and output buffers must not share memory.
+ */
+public final class AesGcmScatterGatherUtils {
+  private AesGcmScatterGatherUtils() {} // private constructor to prevent instantiation
+
+  private static native int sealInternal(
+      byte[] key,
+      int tagLen,
+      byte[] iv,
+      byte[] aad,
+      Object[] inputBuffers,
+      int[] inputOffsets,
+      int[] inputLengths,
+      Object[] outputBuffers,
+      int[] outputOffsets,
+      int[] outputLengths);
+
+  private static native int openInternal(
+      byte[] key,
+      int tagLen,
+      byte[] iv,
+      byte[] aad,
+      Object[] inputBuffers,
+      int[] inputOffsets,
+      int[] inputLengths,
+      Object[] outputBuffers,
+      int[] outputOffsets,
+      int[] outputLengths)
+      throws AEADBadTagException;
+
+  /**
+   * Encrypts the gathered input. The result is the ciphertext immediately followed by the tag, so
+   * the output buffers must have room for the input length plus {@code params.getTLen() / 8}
+   * bytes.
+   *
+   * <p>As with {@link javax.crypto.Cipher}, an IV must never be reused with the same key.
+   *
+   * @param key AES key
+   * @param params IV and tag length; the tag length must be one of {128, 120, 112, 104, 96}
+   * @param aad optional AAD
+   * @param inputs plaintext slices
+   * @param outputs receive the ciphertext and tag
+   * @return the number of bytes written
+   */
+  public static int seal(
+      final Key key,
+      final GCMParameterSpec params,
+      final byte[] aad,
+      final ByteBuffer[] inputs,
+      final ByteBuffer[] outputs) {
+    checkArguments(key, params);
+    final Slices in = Slices.of(inputs, false);
+    final Slices out = Slices.of(outputs, true);
+    if (out.total < in.total + params.getTLen() / 8) {
+      throw new IllegalArgumentException("Output buffers too small");
+    }
+
+    final byte[] rawKey = rawKey(key);
+    final int written;
+    try {
+      written =
+          sealInternal(
+              rawKey,
+              params.getTLen() / 8,
+              params.getIV(),
+              aad,
+              in.buffers,
+              in.offsets,
+              in.lengths,
+              out.buffers,
+              out.offsets,
+              out.lengths);
+    } finally {
+      Arrays.fill(rawKey, (byte) 0);
+    }
+    consume(inputs);
+    advance(outputs, written);
+    return written;
+  }
+
+  /**
+   * Decrypts and authenticates the gathered input, whose last {@code params.getTLen() / 8} bytes
+   * are the tag. The output buffers must have room for the input length minus the tag length.
+   *
+   * <p>If authentication fails, the bytes written to the output buffers are zeroed and no buffer
+   * positions change.
+   *
+   * @param key AES key
+   * @param params IV and tag length; the tag length must be one of {128, 120, 112, 104, 96}
+   * @param aad optional AAD
+   * @param inputs ciphertext and tag slices
+   * @param outputs receive the plaintext
+   * @return the number of bytes written
+   * @throws AEADBadTagException if the tag does not verify
+   */
+  public static int open(
+      final Key key,
+      final GCMParameterSpec params,
+      final byte[] aad,
+      final ByteBuffer[] inputs,
+      final ByteBuffer[] outputs)
+      throws AEADBadTagException {
+    checkArguments(key, params);
+    final Slices in = Slices.of(inputs, false);
+    final Slices out = Slices.of(outputs, true);
+    final int tagLen = params.getTLen() / 8;
+    if (in.total < tagLen) {
+      throw new AEADBadTagException("Input too short - need tag");
+    }
+    if (out.total < in.total - tagLen) {
+      throw new IllegalArgumentException("Output buffers too small");
+    }
+
+    final byte[] rawKey = rawKey(key);
+    final int written;
+    try {
+      written =
+          openInternal(
+              rawKey,
+              tagLen,
+              params.getIV(),
+              aad,
+              in.buffers,
+              in.offsets,
+              in.lengths,
+              out.buffers,
+              out.offsets,
+              out.lengths);
+    } finally {
+      Arrays.fill(rawKey, (byte) 0);
+    }
+    consume(inputs);
+    advance(outputs, written);
+    return written;
+  }
+
+  /** Native view of the remaining bytes of a list of buffers. Empty buffers are left out. */
+  private static final class Slices {
+    final Object[] buffers;
+    final int[] offsets;
+    final int[] lengths;
+    final long total;
+
+    private Slices(
+        final Object[] buffers, final int[] offsets, final int[] lengths, final long total) {
+      this.buffers = buffers;
+      this.offsets = offsets;
+      this.lengths = lengths;
+      this.total = total;
+    }
+
+    static Slices of(final ByteBuffer[] source, final boolean writable) {
+      if (source == null) {
+        throw new IllegalArgumentException("Buffer arrays must not be null");
+      }
+      int count = 0;
+      for (final ByteBuffer buffer : source) {
+        if (buffer == null) {
+          throw new IllegalArgumentException("Buffers must not be null");
+        }
+        if (writable && buffer.isReadOnly()) {
+          throw new ReadOnlyBufferException();
+        }
+        if (buffer.hasRemaining()) {
+          count++;
+        }
+      }
+
+      final Object[] buffers = new Object[count];
+      final int[] offsets = new int[count];
+      final int[] lengths = new int[count];
+      long total = 0;
+      int i = 0;
+      for (final ByteBuffer buffer : source) {
+        final int remaining = buffer.remaining();
+        if (remaining == 0) {
+          continue;
+        }
+        if (buffer.isDirect()) {
+          buffers[i] = buffer;
+          offsets[i] = buffer.position();
+        } else if (buffer.hasArray()) {
+          buffers[i] = buffer.array();
+          offsets[i] = buffer.arrayOffset() + buffer.position();
+        } else {
+          // Read-only heap buffer
+          final byte[] copy = new byte[remaining];
+          buffer.duplicate().get(copy);
+          buffers[i] = copy;
+          offsets[i] = 0;
+        }
+        lengths[i] = remaining;
+        total += remaining;
+        i++;
+      }
+      if (total > Integer.MAX_VALUE) {
+        throw new IllegalArgumentException("Message exceeds maximum array size");
+      }
+      return new Slices(buffers, offsets, lengths, total);
+    }
+  }
+
+  private static void consume(final ByteBuffer[] buffers) {
+    for (final ByteBuffer buffer : buffers) {
+      buffer.position(buffer.limit());
+    }
+  }
+
+  private static void advance(final ByteBuffer[] buffers, int written) {
+    for (int i = 0; i < buffers.length && written > 0; i++) {
+      final int step = Math.min(written, buffers[i].remaining());
+      buffers[i].position(buffers[i].position() + step);
+      written -= step;
+    }
+  }
+
+  private static void checkArguments(final Key key, final GCMParameterSpec params) {
+    if (key == null || !"AES".equalsIgnoreCase(key.getAlgorithm())) {
+      throw new IllegalArgumentException("Key must be an AES key");
+    }
+    if (params == null) {
+      throw new IllegalArgumentException("GCM parameters must not be null");
+    }
+    final int tagLenBits = params.getTLen();
+    if ((tagLenBits % 8 != 0) || tagLenBits > 128 || tagLenBits < 96) {
+      throw new IllegalArgumentException(
+          "Unsupported TLen value; must be one of {128, 120, 112, 104, 96}");
+    }
+    if (params.getIV().length == 0) {
+      throw new IllegalArgumentException("IV must be at least one byte long");
+    }
+  }
+
+  /** Returns a copy of the key material, which the caller must clear once done with it. */
+  private static byte[] rawKey(final Key key) {
+    final byte[] rawKey = key.getEncoded();
+    if (rawKey == null
+        || !"RAW".equalsIgnoreCase(key.getFormat())
+        || (rawKey.length != 16 && rawKey.length != 24 && rawKey.length != 32)) {
+      if (rawKey != null) {
+        Arrays.fill(rawKey, (byte) 0);
+      }
+      throw new IllegalArgumentException("Key must be a raw 128, 192, or 256 bit AES key");
+    }
+    return rawKey;
+  }
+}
@@ -0,0 +1,161 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.utils;
+
+import java.util.Locale;
+
+/**
+ * Digests many independent messages in one native call.
+ *
+ * <p>For small messages, going through {@link java.security.MessageDigest} costs more in JNI
+ * transitions and digest arrays than in hashing. These methods instead digest every message of the
+ * batch natively and write the digests into a single array.
+ *
+ * <p>Messages are described by parallel arrays: message {@code i} is {@code data[offsets[i],
+ * offsets[i] + lengths[i])}. Digests are laid out back to back: the digest of message {@code i} is
+ * {@code digests[digestsOffset + i * L, digestsOffset + (i + 1) * L)}, where {@code L} is {@link
+ * #getDigestLength(String)}.
+ *
+ * <p>Supported algorithms are MD5, SHA-1, SHA-256, SHA-384 and SHA-512.
+ */
+public final class DigestBatchUtils {
+  private DigestBatchUtils() {} // private constructor to prevent instantiation
+
+  private static final int MD5 = 0;
+  private static final int SHA1 = 1;
+  private static final int SHA256 = 2;
+  private static final int SHA384 = 3;
+  private static final int SHA512 = 4;
+
+  private static native void digestBatchMD5(
+      byte[] data, int[] offsets, int[] lengths, byte[] digests, int digestsOffset);
+
+  private static native void digestBatchSHA1(
+      byte[] data, int[] offsets, int[] lengths, byte[] digests, int digestsOffset);
+
+  private static native void digestBatchSHA256(
+      byte[] data, int[] offsets, int[] lengths, byte[] digests, int digestsOffset);
+
+  private static native void digestBatchSHA384(
+      byte[] data, int[] offsets, int[] lengths, byte[] digests, int digestsOffset);
+
+  private static native void digestBatchSHA512(
+      byte[] data, int[] offsets, int[] lengths, byte[] digests, int digestsOffset);
+
+  /**
+   * Digests every message of the batch into {@code digests}.
+   *
+   * @param algorithm digest algorithm, such as {@code SHA-256}
+   * @param data buffer holding all messages
+   * @param offsets start of each message within {@code data}
+   * @param lengths length of each message within {@code data}
+   * @param digests receives the concatenated digests
+   * @param digestsOffset position of the first digest within {@code digests}
+   * @throws IllegalArgumentException if an argument is null, the algorithm is not supported, {@code
+   *     offsets} and {@code lengths} have different lengths, or {@code data} and {@code digests}
+   *     are the same array
+   * @throws ArrayIndexOutOfBoundsException if a message lies outside of {@code data} or the digests
+   *     do not fit in {@code digests}
+   */
+  public static void digestBatch(
+      final String algorithm,
+      final byte[] data,
+      final int[] offsets,
+      final int[] lengths,
+      final byte[] digests,
+      final int digestsOffset) {
+    final int digest = digestId(algorithm);
+    if (data == null || offsets == null || lengths == null || digests == null) {
+      throw new IllegalArgumentException("Batch arrays must not be null");
+    }
+    if (offsets.length != lengths.length) {
+      throw new IllegalArgumentException("Offsets and lengths must have the same length");
+    }
+    if (data == digests) {
+      throw new IllegalArgumentException("Digests must not be written to the input array");
+    }
+    switch (digest) {
+      case MD5:
+        digestBatchMD5(data, offsets, lengths, digests, digestsOffset);
+        break;
+      case SHA1:
+        digestBatchSHA1(data, offsets, lengths, digests, digestsOffset);
+        break;
+      case SHA256:
+        digestBatchSHA256(data, offsets, lengths, digests, digestsOffset);
+        break;
+      case SHA384:
+        digestBatchSHA384(data, offsets, lengths, digests, digestsOffset);
+        break;
+      default:
+        digestBatchSHA512(data, offsets, lengths, digests, digestsOffset);
+        break;
+    }
+  }
+
+  /**
+   * Returns the digests of every message of the batch, concatenated. See {@link
+   * #digestBatch(String, byte[], int[], int[], byte[], int)}.
+   *
+   * @return the concatenated digests, {@code getDigestLength(algorithm)} bytes per message
+   */
+  public static byte[] digestBatch(
+      final String algorithm, final byte[] data, final int[] offsets, final int[] lengths) {
+    final int digestLength = getDigestLength(algorithm);
+    if (lengths == null) {
+      throw new IllegalArgumentException("Batch arrays must not be null");
+    }
+    final long size = (long) lengths.length * digestLength;
+    if (size > Integer.MAX_VALUE) {
+      throw new IllegalArgumentException("Batch output exceeds maximum array size");
+    }
+    final byte[] digests = new byte[(int) size];
+    digestBatch(algorithm, data, offsets, lengths, digests, 0);
+    return digests;
+  }
+
+  /**
+   * Returns the length of the digests produced by {@code algorithm}.
+   *
+   * @param algorithm digest algorithm, such as {@code SHA-256}
+   * @return the digest length
+   */
+  public static int getDigestLength(final String algorithm) {
+    switch (digestId(algorithm)) {
+      case MD5:
+        return 16;
+      case SHA1:
+        return 20;
+      case SHA256:
+        return 32;
+      case SHA384:
+        return 48;
+      default:
+        return 64;
+    }
+  }
+
+  private static int digestId(final String algorithm) {
+    if (algorithm == null) {
+      throw new IllegalArgumentException("Algorithm must not be null");
+    }
+    switch (algorithm.toUpperCase(Locale.ROOT)) {
+      case "MD5":
+        return MD5;
+      case "SHA-1":
+      case "SHA1":
+        return SHA1;
+      case "SHA-256":
+      case "SHA256":
+        return SHA256;
+      case "SHA-384":
+      case "SHA384":
+        return SHA384;
+      case "SHA-512":
+      case "SHA512":
+        return SHA512;
+      default:
+        throw new IllegalArgumentException("Unsupported digest algorithm: " + algorithm);
+    }
+  }
+}
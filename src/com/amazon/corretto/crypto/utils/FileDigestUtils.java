@@ -0,0 +1,225 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.utils;
+
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.MappedByteBuffer;
+import java.nio.channels.FileChannel;
+import java.nio.charset.Charset;
+import java.nio.file.FileSystems;
+import java.nio.file.Path;
+import java.nio.file.StandardOpenOption;
+import java.security.Key;
+import java.util.Arrays;
+import java.util.Collections;
+import java.util.HashMap;
+import java.util.Locale;
+import java.util.Map;
+
+/**
+ * Computes message digests and HMACs of whole files by memory mapping them, so that file contents
+ * are digested straight from the page cache instead of being copied through Java buffers first.
+ * Mappings are advised for sequential access, so the kernel reads ahead aggressively. Files larger
+ * than 2 GiB are supported.
+ *
+ * <p>Supported digests are MD5, SHA-1, SHA-224, SHA-256, SHA-384, SHA-512, SHA-512/224 and
+ * SHA-512/256, and the corresponding HMACs (for example {@code HmacSHA256}).
+ *
+ * <p><b>Warning:</b> as with any memory mapping, truncating a file while it is being digested
+ * causes the process to receive {@code SIGBUS}, which crashes the JVM. Only use these methods on
+ * files which are not modified concurrently.
+ */
+public final class FileDigestUtils {
+  private FileDigestUtils() {} // private constructor to prevent instantiation
+
+  // Larger regions of a FileChannel are mapped and digested in windows of this size.
+  private static final int MAX_WINDOW = 1 << 30;
+  private static final String HMAC_PREFIX = "hmac";
+  private static final Map<String, String> DIGESTS;
+
+  static {
+    final Map<String, String> digests = new HashMap<>();
+    digests.put("md5", "md5");
+    digests.put("sha-1", "sha1");
+    digests.put("sha1", "sha1");
+    digests.put("sha-224", "sha224");
+    digests.put("sha224", "sha224");
+    digests.put("sha-256", "sha256");
+    digests.put("sha256", "sha256");
+    digests.put("sha-384", "sha384");
+    digests.put("sha384", "sha384");
+    digests.put("sha-512", "sha512");
+    digests.put("sha512", "sha512");
+    digests.put("sha-512/224", "sha512-224");
+    digests.put("sha512/224", "sha512-224");
+    digests.put("sha-512/256", "sha512-256");
+    digests.put("sha512/256", "sha512-256");
+    DIGESTS = Collections.unmodifiableMap(digests);
+  }
+
+  private static native long newContext(String digestName, byte[] hmacKey);
+
+  private static native void freeContext(long ctx);
+
+  private static native void updateFile(long ctx, byte[] path) throws IOException;
+
+  private static native void updateMapped(long ctx, ByteBuffer mapped, int length);
+
+  private static native byte[] finish(long ctx);
+
+  /**
+   * Returns the digest of the complete file at {@code path}.
+   *
+   * @param algorithm digest algorithm, such as {@code SHA-256}
+   * @param path the file to digest
+   * @return the digest of the file
+   * @throws IOException if the file cannot be opened or mapped
+   */
+  public static byte[] digest(final String algorithm, final Path path) throws IOException {
+    return compute(digestName(algorithm, false), null, path);
+  }
+
+  /**
+   * Returns the digest of the contents of {@code channel} from its current position to its end.
+   * Afterwards the position of the channel is its size.
+   *
+   * @param algorithm digest algorithm, such as {@code SHA-256}
+   * @param channel the channel to digest; must be readable
+   * @return the digest of the remaining contents of the channel
+   * @throws IOException if the channel cannot be mapped
+   */
+  public static byte[] digest(final String algorithm, final FileChannel channel)
+      throws IOException {
+    return compute(digestName(algorithm, false), null, channel);
+  }
+
+  /**
+   * Returns the HMAC of the complete file at {@code path}.
+   *
+   * @param algorithm HMAC algorithm, such as {@code HmacSHA256}
+   * @param key HMAC key; must support RAW encoding
+   * @param path the file to authenticate
+   * @return the HMAC of the file
+   * @throws IOException if the file cannot be opened or mapped
+   */
+  public static byte[] hmac(final String algorithm, final Key key, final Path path)
+      throws IOException {
+    final String digestName = digestName(algorithm, true);
+    final byte[] rawKey = rawKey(key);
+    try {
+      return compute(digestName, rawKey, path);
+    } finally {
+      Arrays.fill(rawKey, (byte) 0);
+    }
+  }
+
+  /**
+   * Returns the HMAC of the contents of {@code channel} from its current position to its end.
+   * Afterwards the position of the channel is its size.
+   *
+   * @param algorithm HMAC algorithm, such as {@code HmacSHA256}
+   * @param key HMAC key; must support RAW encoding
+   * @param channel the channel to authenticate; must be readable
+   * @return the HMAC of the remaining contents of the channel
+   * @throws IOException if the channel cannot be mapped
+   */
+  public static byte[] hmac(final String algorithm, final Key key, final FileChannel channel)
+      throws IOException {
+    final String digestName = digestName(algorithm, true);
+    final byte[] rawKey = rawKey(key);
+    try {
+      return compute(digestName, rawKey, channel);
+    } finally {
+      Arrays.fill(rawKey, (byte) 0);
+    }
+  }
+
+  private static byte[] compute(final String digestName, final byte[] hmacKey, final Path path)
+      throws IOException {
+    if (path == null) {
+      throw new IllegalArgumentException("Path must not be null");
+    }
+    if (path.getFileSystem() != FileSystems.getDefault()) {
+      // Only files of the default file system can be opened natively.
+      try (FileChannel channel = FileChannel.open(path, StandardOpenOption.READ)) {
+        return compute(digestName, hmacKey, channel);
+      }
+    }
+    final byte[] nativePath = path.toAbsolutePath().toString().getBytes(nativeCharset());
+    final long ctx = newContext(digestName, hmacKey);
+    try {
+      updateFile(ctx, nativePath);
+      return finish(ctx);
+    } finally {
+      freeContext(ctx);
+    }
+  }
+
+  private static byte[] compute(
+      final String digestName, final byte[] hmacKey, final FileChannel channel)
+      throws IOException {
+    if (channel == null) {
+      throw new IllegalArgumentException("Channel must not be null");
+    }
+    final long ctx = newContext(digestName, hmacKey);
+    try {
+      // Without access to the underlying descriptor, the channel maps each window for us.
+      final long size = channel.size();
+      long position = channel.position();
+      while (position < size) {
+        final int window = (int) Math.min(MAX_WINDOW, size - position);
+        final MappedByteBuffer mapped =
+            channel.map(FileChannel.MapMode.READ_ONLY, position, window);
+        updateMapped(ctx, mapped, window);
+        position += window;
+      }
+      channel.position(Math.max(position, channel.position()));
+      return finish(ctx);
+    } finally {
+      freeContext(ctx);
+    }
+  }
+
+  private static String digestName(final String algorithm, final boolean hmac) {
+    if (algorithm == null) {
+      throw new IllegalArgumentException("Algorithm must not be null");
+    }
+    String name = algorithm.toLowerCase(Locale.ROOT);
+    if (hmac) {
+      if (!name.startsWith(HMAC_PREFIX)) {
+        throw new IllegalArgumentException("Unsupported HMAC algorithm: " + algorithm);
+      }
+      name = name.substring(HMAC_PREFIX.length());
+    }
+    final String digestName = DIGESTS.get(name);
+    if (digestName == null) {
+      throw new IllegalArgumentException("Unsupported algorithm: " + algorithm);
+    }
+    return digestName;
+  }
+
+  private static byte[] rawKey(final Key key) {
+    if (key == null) {
+      throw new IllegalArgumentException("Key must not be null");
+    }
+    final byte[] rawKey = key.getEncoded();
+    if (rawKey == null || !"RAW".equalsIgnoreCase(key.getFormat())) {
+      if (rawKey != null) {
+        Arrays.fill(rawKey, (byte) 0);
+      }
+      throw new IllegalArgumentException("Key must support RAW encoding");
+    }
+    return rawKey;
+  }
+
+  /** Returns the charset in which the platform expects file names, as used by the JDK itself. */
+  static Charset nativeCharset() {
+    final String encoding = System.getProperty("sun.jnu.encoding");
+    try {
+      return encoding == null ? Charset.defaultCharset() : Charset.forName(encoding);
+    } catch (final IllegalArgumentException ex) {
+      return Charset.defaultCharset();
+    }
+  }
+}
@@ -0,0 +1,235 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.utils;
+
+import java.security.Key;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.BitSet;
+import java.util.IdentityHashMap;
+import java.util.List;
+import java.util.Locale;
+import java.util.Map;
+
+/**
+ * Computes or verifies the HMACs of many messages in one native call.
+ *
+ * <p>Going through {@link javax.crypto.Mac} costs a JNI transition and a tag array per message,
+ * plus a comparison in Java for every verification. These methods instead set up each distinct key
+ * once, compute all MACs natively, and either write them into a single array or compare them
+ * against expected tags in constant time without returning the computed MACs to Java at all.
+ *
+ * <p>Messages are described by parallel arrays: message {@code i} is {@code input[offsets[i],
+ * offsets[i] + lengths[i])} and is keyed with {@code keys[i]}. Passing the same {@link Key} object
+ * for several messages lets the batch set that key up only once. Tags are laid out back to back:
+ * the tag of message {@code i} is {@code tags[i * L, (i + 1) * L)}, where {@code L} is {@link
+ * #getMacLength(String)}. Truncated tags are not supported.
+ *
+ * <p>Supported algorithms are HmacMD5, HmacSHA1, HmacSHA256, HmacSHA384 and HmacSHA512.
+ */
+public final class HmacBatchUtils {
+  private HmacBatchUtils() {} // private constructor to prevent instantiation
+
+  private static native void computeInternal(
+      String digestName,
+      byte[][] keys,
+      int[] keyIndices,
+      byte[] input,
+      int[] offsets,
+      int[] lengths,
+      byte[] tags);
+
+  private static native void verifyInternal(
+      String digestName,
+      byte[][] keys,
+      int[] keyIndices,
+      byte[] input,
+      int[] offsets,
+      int[] lengths,
+      byte[] tags,
+      long[] verified);
+
+  /**
+   * Returns the HMACs of every message of the batch, concatenated.
+   *
+   * @param algorithm HMAC algorithm, such as {@code HmacSHA256}
+   * @param keys key of each message; each must support RAW encoding
+   * @param input buffer holding all messages
+   * @param offsets start of each message within {@code input}
+   * @param lengths length of each message within {@code input}
+   * @return the concatenated tags, {@code getMacLength(algorithm)} bytes per message
+   */
+  public static byte[] compute(
+      final String algorithm,
+      final Key[] keys,
+      final byte[] input,
+      final int[] offsets,
+      final int[] lengths) {
+    final Batch batch = new Batch(algorithm, keys, input, offsets, lengths);
+    final long size = (long) lengths.length * batch.macLength;
+    if (size > Integer.MAX_VALUE) {
+      batch.zeroizeKeys();
+      throw new IllegalArgumentException("Batch output exceeds maximum array size");
+    }
+    final byte[] tags = new byte[(int) size];
+    try {
+      computeInternal(
+          batch.digestName, batch.rawKeys, batch.keyIndices, input, offsets, lengths, tags);
+    } finally {
+      batch.zeroizeKeys();
+    }
+    return tags;
+  }
+
+  /**
+   * Verifies the HMACs of every message of the batch against the expected tags. Every tag is
+   * checked in constant time, and a mismatch does not stop the batch.
+   *
+   * @param algorithm HMAC algorithm, such as {@code HmacSHA256}
+   * @param keys key of each message; each must support RAW encoding
+   * @param input buffer holding all messages
+   * @param offsets start of each message within {@code input}
+   * @param lengths length of each message within {@code input}
+   * @param tags the expected tags, concatenated
+   * @return indices of the messages whose tag is valid; a clear bit means the tag did not match
+   */
+  public static BitSet verify(
+      final String algorithm,
+      final Key[] keys,
+      final byte[] input,
+      final int[] offsets,
+      final int[] lengths,
+      final byte[] tags) {
+    final Batch batch = new Batch(algorithm, keys, input, offsets, lengths);
+    final long[] verified = new long[(lengths.length + 63) / 64];
+    try {
+      if (tags == null || tags.length != (long) lengths.length * batch.macLength) {
+        throw new IllegalArgumentException(
+            "Tags must hold exactly one full-length tag per message");
+      }
+      verifyInternal(
+          batch.digestName,
+          batch.rawKeys,
+          batch.keyIndices,
+          input,
+          offsets,
+          lengths,
+          tags,
+          verified);
+    } finally {
+      batch.zeroizeKeys();
+    }
+    return BitSet.valueOf(verified);
+  }
+
+  /**
+   * Returns the length in bytes of the tags of {@code algorithm}.
+   *
+   * @param algorithm HMAC algorithm, such as {@code HmacSHA256}
+   * @return the tag length
+   */
+  public static int getMacLength(final String algorithm) {
+    return macLength(digestName(algorithm));
+  }
+
+  private static String digestName(final String algorithm) {
+    if (algorithm == null) {
+      throw new IllegalArgumentException("Algorithm must not be null");
+    }
+    switch (algorithm.toLowerCase(Locale.ROOT)) {
+      case "hmacmd5":
+        return "md5";
+      case "hmacsha1":
+        return "sha1";
+      case "hmacsha256":
+        return "sha256";
+      case "hmacsha384":
+        return "sha384";
+      case "hmacsha512":
+        return "sha512";
+      default:
+        throw new IllegalArgumentException("Unsupported HMAC algorithm: " + algorithm);
+    }
+  }
+
+  private static int macLength(final String digestName) {
+    switch (digestName) {
+      case "md5":
+        return 16;
+      case "sha1":
+        return 20;
+      case "sha256":
+        return 32;
+      case "sha384":
+        return 48;
+      default:
+        return 64;
+    }
+  }
+
+  /** Checked arguments of a batch, with each distinct {@link Key} object encoded once. */
+  private static final class Batch {
+    private final String digestName;
+    private final int macLength;
+    private final byte[][] rawKeys;
+    private final int[] keyIndices;
+
+    private Batch(
+        final String algorithm,
+        final Key[] keys,
+        final byte[] input,
+        final int[] offsets,
+        final int[] lengths) {
+      digestName = digestName(algorithm);
+      macLength = macLength(digestName);
+      if (keys == null || input == null || offsets == null || lengths == null) {
+        throw new IllegalArgumentException("Batch arrays must not be null");
+      }
+      if (offsets.length != keys.length || lengths.length != keys.length) {
+        throw new IllegalArgumentException("Batch arrays must all have the same length");
+      }
+
+      final Map<Key, Integer> seen = new IdentityHashMap<>();
+      final List<byte[]> distinct = new ArrayList<>();
+      keyIndices = new int[keys.length];
+      try {
+        for (int i = 0; i < keys.length; i++) {
+          if (offsets[i] < 0 || lengths[i] < 0 || offsets[i] > input.length - lengths[i]) {
+            throw new ArrayIndexOutOfBoundsException("Message " + i + " is outside of the input");
+          }
+          Integer index = seen.get(keys[i]);
+          if (index == null) {
+            index = distinct.size();
+            distinct.add(rawKey(keys[i]));
+            seen.put(keys[i], index);
+          }
+          keyIndices[i] = index;
+        }
+      } catch (final RuntimeException ex) {
+        for (final byte[] rawKey : distinct) {
+          Arrays.fill(rawKey, (byte) 0);
+        }
+        throw ex;
+      }
+      rawKeys = distinct.toArray(new byte[0][]);
+    }
+
+    /** Clears the encoded keys once the native call no longer needs them. */
+    private void zeroizeKeys() {
+      for (final byte[] rawKey : rawKeys) {
+        Arrays.fill(rawKey, (byte) 0);
+      }
+    }
+  }
+
+  private static byte[] rawKey(final Key key) {
+    if (key == null) {
+      throw new IllegalArgumentException("Key must not be null");
+    }
+    final byte[] rawKey = key.getEncoded();
+    if (rawKey == null || !"RAW".equalsIgnoreCase(key.getFormat())) {
+      throw new IllegalArgumentException("Key must support RAW encoding");
+    }
+    return rawKey;
+  }
+}
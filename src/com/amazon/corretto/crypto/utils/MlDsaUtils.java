@@ -2,6 +2,12 @@
 // SPDX-License-Identifier: Apache-2.0
 package com.amazon.corretto.crypto.utils;
 
+import java.io.IOException;
+import java.io.InputStream;
+import java.nio.ByteBuffer;
+import java.nio.file.FileSystems;
+import java.nio.file.Files;
+import java.nio.file.Path;
 import java.security.PrivateKey;
 import java.security.PublicKey;
 
@@ -13,6 +19,21 @@ public final class MlDsaUtils {
 
   private static native byte[] expandPrivateKeyInternal(byte[] key);
 
+  private static native long muStart(byte[] pubKeyEncoded);
+
+  private static native void muUpdate(long ctx, byte[] message, int offset, int length);
+
+  private static native void muUpdateDirect(long ctx, ByteBuffer message, int offset, int length);
+
+  private static native void muUpdateFile(long ctx, byte[] path) throws IOException;
+
+  private static native byte[] muFinish(long ctx);
+
+  private static native void muFree(long ctx);
+
+  // Size of the buffer through which streams are read.
+  private static final int STREAM_CHUNK = 64 * 1024;
+
   /**
    * Computes mu as defined on line 6 of Algorithm 7 and line 7 of Algorithm 8 in NIST FIPS 204.
    *
@@ -29,6 +50,120 @@ public final class MlDsaUtils {
     return computeMuInternal(publicKey.getEncoded(), message);
   }
 
+  /**
+   * Computes mu over the remaining contents of {@code message}, as {@link #computeMu(PublicKey,
+   * byte[])} does, and advances its position to its limit. Direct buffers, including memory mapped
+   * ones, are read in place.
+   *
+   * @param publicKey ML-DSA public key
+   * @param message buffer holding the message over which to compute mu
+   * @return a byte[] of length 64 containing mu
+   */
+  public static byte[] computeMu(PublicKey publicKey, ByteBuffer message) {
+    if (message == null) {
+      throw new IllegalArgumentException();
+    }
+    final long ctx = muStart(encodedPublicKey(publicKey));
+    try {
+      update(ctx, message);
+      return muFinish(ctx);
+    } finally {
+      muFree(ctx);
+    }
+  }
+
+  /**
+   * Computes mu over everything remaining in {@code message}, as {@link #computeMu(PublicKey,
+   * byte[])} does, without ever holding the whole message in memory. The stream is not closed.
+   *
+   * <p>Together with the {@code ML-DSA-ExtMu} signature, this lets large or streamed messages be
+   * signed at a cost independent of their size, and lets mu be computed on a different thread or
+   * host than the one holding the private key.
+   *
+   * @param publicKey ML-DSA public key
+   * @param message stream of the message over which to compute mu
+   * @return a byte[] of length 64 containing mu
+   * @throws IOException if reading from the stream fails
+   */
+  public static byte[] computeMu(PublicKey publicKey, InputStream message) throws IOException {
+    if (message == null) {
+      throw new IllegalArgumentException();
+    }
+    final long ctx = muStart(encodedPublicKey(publicKey));
+    try {
+      final byte[] chunk = new byte[STREAM_CHUNK];
+      int read;
+      while ((read = message.read(chunk)) >= 0) {
+        muUpdate(ctx, chunk, 0, read);
+      }
+      return muFinish(ctx);
+    } finally {
+      muFree(ctx);
+    }
+  }
+
+  /**
+   * Computes mu over the complete file at {@code message}, as {@link #computeMu(PublicKey,
+   * byte[])} does. Files of the default file system are memory mapped natively and absorbed
+   * straight from the page cache, so files larger than 2 GiB are supported, and unmapped before
+   * this method returns. Files of other file systems are read as streams.
+   *
+   * <p><b>Warning:</b> as with any memory mapping, truncating the file while mu is being computed
+   * causes the process to receive {@code SIGBUS}, which crashes the JVM.
+   *
+   * @param publicKey ML-DSA public key
+   * @param message the file over which to compute mu
+   * @return a byte[] of length 64 containing mu
+   * @throws IOException if the file cannot be opened or mapped
+   */
+  public static byte[] computeMu(PublicKey publicKey, Path message) throws IOException {
+    if (message == null) {
+      throw new IllegalArgumentException();
+    }
+    final byte[] pubKeyEncoded = encodedPublicKey(publicKey);
+    if (message.getFileSystem() != FileSystems.getDefault()) {
+      // Only files of the default file system can be opened natively.
+      try (InputStream stream = Files.newInputStream(message)) {
+        return computeMu(publicKey, stream);
+      }
+    }
+    final byte[] nativePath =
+        message.toAbsolutePath().toString().getBytes(FileDigestUtils.nativeCharset());
+    final long ctx = muStart(pubKeyEncoded);
+    try {
+      muUpdateFile(ctx, nativePath);
+      return muFinish(ctx);
+    } finally {
+      muFree(ctx);
+    }
+  }
+
+  private static byte[] encodedPublicKey(final PublicKey publicKey) {
+    if (publicKey == null || !publicKey.getAlgorithm().startsWith("ML-DSA")) {
+      throw new IllegalArgumentException();
+    }
+    return publicKey.getEncoded();
+  }
+
+  private static void update(final long ctx, final ByteBuffer message) {
+    final int length = message.remaining();
+    if (message.isDirect()) {
+      muUpdateDirect(ctx, message, message.position(), length);
+    } else if (message.hasArray()) {
+      muUpdate(ctx, message.array(), message.arrayOffset() + message.position(), length);
+    } else {
+      // Read-only heap buffers expose neither an address nor an array
+      final byte[] chunk = new byte[Math.min(length, STREAM_CHUNK)];
+      final ByteBuffer source = message.duplicate();
+      while (source.hasRemaining()) {
+        final int read = Math.min(chunk.length, source.remaining());
+        source.get(chunk, 0, read);
+        muUpdate(ctx, chunk, 0, read);
+      }
+    }
+    message.position(message.limit());
+  }
+
   /**
    * Returns an expanded ML-DSA private key, whether the key passed in is based on a seed or
    * expanded. It returns the PKCS8-encoded expanded key.
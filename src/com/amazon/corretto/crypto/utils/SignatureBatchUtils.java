@@ -0,0 +1,203 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.utils;
+
+import java.security.PublicKey;
+import java.util.ArrayList;
+import java.util.BitSet;
+import java.util.IdentityHashMap;
+import java.util.List;
+import java.util.Locale;
+import java.util.Map;
+
+/**
+ * Verifies many signatures in one native call, spread over several native threads.
+ *
+ * <p>Going through {@link java.security.Signature} costs at least three JNI transitions and a
+ * native context per signature, all on the calling thread. These methods instead parse each
+ * distinct key once and verify the whole batch natively, dividing it between up to {@code threads}
+ * threads (the calling thread included). The messages and signatures are copied into native memory
+ * first, so no Java array stays pinned while the threads run.
+ *
+ * <p>Messages and signatures are described by parallel arrays: signature {@code i} is {@code
+ * signatures[sigOffsets[i], sigOffsets[i] + sigLengths[i])} over the message {@code
+ * input[offsets[i], offsets[i] + lengths[i])}, and is verified with {@code keys[i]}. Passing the
+ * same {@link PublicKey} object for several signatures lets the batch parse that key only once.
+ * ECDSA signatures are DER encoded, as produced by {@code SHA256withECDSA} and similar.
+ *
+ * <p>Supported algorithms are {@code SHA1withRSA}, {@code SHA224withRSA}, {@code SHA256withRSA},
+ * {@code SHA384withRSA}, {@code SHA512withRSA}, the corresponding {@code withECDSA} algorithms, and
+ * {@code Ed25519}. Ed25519 signatures are verified individually, as the underlying library offers
+ * no batch verification for them.
+ */
+public final class SignatureBatchUtils {
+  private SignatureBatchUtils() {} // private constructor to prevent instantiation
+
+  // Must be kept in sync with batch_key_type in sign.cpp
+  private static final int KEY_RSA = 0;
+  private static final int KEY_EC = 1;
+  private static final int KEY_ED25519 = 2;
+
+  private static final int MAX_THREADS = 64;
+
+  private static native void verifyInternal(
+      int keyType,
+      String digestName,
+      byte[][] keys,
+      int[] keyIndices,
+      byte[] input,
+      int[] offsets,
+      int[] lengths,
+      byte[] signatures,
+      int[] sigOffsets,
+      int[] sigLengths,
+      long[] verified,
+      int threads);
+
+  /**
+   * Verifies every signature of the batch, using up to one thread per available processor.
+   *
+   * @see #verify(String, PublicKey[], byte[], int[], int[], byte[], int[], int[], int)
+   */
+  public static BitSet verify(
+      final String algorithm,
+      final PublicKey[] keys,
+      final byte[] input,
+      final int[] offsets,
+      final int[] lengths,
+      final byte[] signatures,
+      final int[] sigOffsets,
+      final int[] sigLengths) {
+    return verify(
+        algorithm,
+        keys,
+        input,
+        offsets,
+        lengths,
+        signatures,
+        sigOffsets,
+        sigLengths,
+        Runtime.getRuntime().availableProcessors());
+  }
+
+  /**
+   * Verifies every signature of the batch. A signature which fails to verify, including one which
+   * is malformed, does not stop the batch.
+   *
+   * @param algorithm signature algorithm, such as {@code SHA256withECDSA}
+   * @param keys key of each signature; each must be an X.509 encodable key of the algorithm's type
+   * @param input buffer holding all messages
+   * @param offsets start of each message within {@code input}
+   * @param lengths length of each message within {@code input}
+   * @param signatures buffer holding all signatures
+   * @param sigOffsets start of each signature within {@code signatures}
+   * @param sigLengths length of each signature within {@code signatures}
+   * @param threads maximum number of threads to verify on, at most 64
+   * @return indices of the valid signatures; a clear bit means the signature did not verify
+   * @throws IllegalArgumentException if the algorithm or a key is not supported, or the batch
+   *     arrays are null or of different lengths
+   * @throws ArrayIndexOutOfBoundsException if a message or signature lies outside of its array
+   */
+  public static BitSet verify(
+      final String algorithm,
+      final PublicKey[] keys,
+      final byte[] input,
+      final int[] offsets,
+      final int[] lengths,
+      final byte[] signatures,
+      final int[] sigOffsets,
+      final int[] sigLengths,
+      final int threads) {
+    if (algorithm == null) {
+      throw new IllegalArgumentException("Algorithm must not be null");
+    }
+    if (keys == null
+        || input == null
+        || offsets == null
+        || lengths == null
+        || signatures == null
+        || sigOffsets == null
+        || sigLengths == null) {
+      throw new IllegalArgumentException("Batch arrays must not be null");
+    }
+    if (offsets.length != keys.length
+        || lengths.length != keys.length
+        || sigOffsets.length != keys.length
+        || sigLengths.length != keys.length) {
+      throw new IllegalArgumentException("Batch arrays must all have the same length");
+    }
+    if (threads <= 0) {
+      throw new IllegalArgumentException("Thread count must be positive");
+    }
+
+    final int keyType;
+    final String digestName;
+    final String name = algorithm.toLowerCase(Locale.ROOT);
+    if (name.equals("ed25519")) {
+      keyType = KEY_ED25519;
+      digestName = null;
+    } else if (name.endsWith("withrsa")) {
+      keyType = KEY_RSA;
+      digestName = digestName(algorithm, name.substring(0, name.length() - "withrsa".length()));
+    } else if (name.endsWith("withecdsa")) {
+      keyType = KEY_EC;
+      digestName = digestName(algorithm, name.substring(0, name.length() - "withecdsa".length()));
+    } else {
+      throw new IllegalArgumentException("Unsupported signature algorithm: " + algorithm);
+    }
+
+    // Encode each distinct key object once
+    final Map<PublicKey, Integer> seen = new IdentityHashMap<>();
+    final List<byte[]> distinct = new ArrayList<>();
+    final int[] keyIndices = new int[keys.length];
+    for (int i = 0; i < keys.length; i++) {
+      Integer index = seen.get(keys[i]);
+      if (index == null) {
+        index = distinct.size();
+        distinct.add(encodedKey(keys[i]));
+        seen.put(keys[i], index);
+      }
+      keyIndices[i] = index;
+    }
+
+    final long[] verified = new long[(keys.length + 63) / 64];
+    verifyInternal(
+        keyType,
+        digestName,
+        distinct.toArray(new byte[0][]),
+        keyIndices,
+        input,
+        offsets,
+        lengths,
+        signatures,
+        sigOffsets,
+        sigLengths,
+        verified,
+        Math.min(threads, MAX_THREADS));
+    return BitSet.valueOf(verified);
+  }
+
+  private static String digestName(final String algorithm, final String digest) {
+    switch (digest) {
+      case "sha1":
+      case "sha224":
+      case "sha256":
+      case "sha384":
+      case "sha512":
+        return digest;
+      default:
+        throw new IllegalArgumentException("Unsupported signature algorithm: " + algorithm);
+    }
+  }
+
+  private static byte[] encodedKey(final PublicKey key) {
+    if (key == null) {
+      throw new IllegalArgumentException("Key must not be null");
+    }
+    final byte[] encoded = key.getEncoded();
+    if (encoded == null || !"X.509".equalsIgnoreCase(key.getFormat())) {
+      throw new IllegalArgumentException("Key must support X.509 encoding");
+    }
+    return encoded;
+  }
+}
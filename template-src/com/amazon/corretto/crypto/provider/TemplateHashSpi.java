@@ -22,13 +22,19 @@ import java.util.Arrays;
  * ABI we should be safe. By doing this hack, then, we avoid malloc/free overheads as well as Java finalizer overhead,
  * and can avoid a native call for initializing the hash function (by instead cloning a copy of the initial state of the
  * hash function).
+ *
+ * The price is that every native call copies the whole state in and out of the Java array. When the
+ * {@code nativeDigestContexts} system property is set to {@code true}, the state instead lives in native memory
+ * (taken from a per-digest slab, so it is still not malloc'ed per instance) owned by a {@link NativeResource}, and
+ * native calls only pass its handle. This favours streaming workloads with many updates per message.
  */
 public final class TemplateHashSpi extends MessageDigestSpi implements Cloneable {
     private static final String HASH_NAME = "@@@HASH_NAME@@@";
     private static final int HASH_SIZE;
     private static final byte[] INITIAL_CONTEXT;
+    private static final boolean NATIVE_CONTEXTS = Utils.getBooleanProperty("nativeDigestContexts", false);
 
-    private InputBuffer<byte[], byte[], RuntimeException> buffer;
+    private InputBuffer<byte[], ?, RuntimeException> buffer;
 
     static {
         Loader.checkNativeLibraryAvailability();
@@ -47,6 +53,13 @@ public final class TemplateHashSpi extends MessageDigestSpi implements Cloneable
     // NOTE: This method trusts that all of the array lengths and bufLen are sane.
     static native void fastDigest(byte[] digest, byte[] buf, int bufOffset, int bufLen);
 
+    /**
+     * Batch digest routine - digests each message of a batch; see {@link #digestBatch}. Offsets and lengths are checked
+     * on the native side.
+     */
+    private static native void fastDigestBatch(
+            byte[] data, int[] offsets, int[] lengths, byte[] digests, int digestsOffset);
+
     /**
      * @return The size of result hashes for this hash function
      */
@@ -107,6 +120,55 @@ public final class TemplateHashSpi extends MessageDigestSpi implements Cloneable
         }
     }
 
+    /**
+     * Allocates and initializes a native-resident context, returning its handle.
+     */
+    private static native long nativeContextNew();
+
+    /**
+     * Allocates a native-resident context holding a copy of the given one, returning its handle.
+     */
+    private static native long nativeContextCopy(long handle);
+
+    private static native void nativeContextFree(long handle);
+
+    /**
+     * Re-initializes a native-resident context.
+     */
+    private static native void nativeContextReset(long handle);
+
+    private static native void nativeContextUpdateByteArray(long handle, byte[] buf, int offset, int length);
+
+    /**
+     * Note that the native-side code does not check offset and length; Java code must do this.
+     */
+    private static native void nativeContextUpdateNativeByteBuffer(long handle, ByteBuffer buf);
+
+    /**
+     * Finishes the digest operation. The native context is left in an undefined state until it is reset.
+     */
+    private static native void nativeContextFinish(long handle, byte[] digest, int offset);
+
+    private static final class NativeContext extends NativeResource {
+        private NativeContext(final long handle) {
+            super(handle, TemplateHashSpi::nativeContextFree);
+        }
+    }
+
+    private static NativeContext resetNativeContext(final NativeContext context) {
+        if (context == null) {
+            return new NativeContext(nativeContextNew());
+        }
+        context.useVoid(TemplateHashSpi::nativeContextReset);
+        return context;
+    }
+
+    private static byte[] nativeDoFinal(final NativeContext context) {
+        final byte[] result = new byte[HASH_SIZE];
+        context.useVoid(handle -> nativeContextFinish(handle, result, 0));
+        return result;
+    }
+
     private static byte[] resetContext(byte[] context) {
 	if (context == null) {
 	    context = INITIAL_CONTEXT.clone();
@@ -128,16 +190,73 @@ public final class TemplateHashSpi extends MessageDigestSpi implements Cloneable
         return result;
     }
 
+    /**
+     * Digests many independent messages with a single native call. For small messages this is much faster than calling
+     * {@link java.security.MessageDigest#digest(byte[])} once per message.
+     *
+     * Message {@code i} consists of the {@code lengths[i]} bytes of {@code data} starting at {@code offsets[i]}. Its
+     * digest is written to {@code digests} starting at {@code digestsOffset + i * L}, where {@code L} is the digest
+     * length of this hash function.
+     *
+     * @throws IllegalArgumentException if an argument is null, {@code offsets} and {@code lengths} have different
+     *         lengths, or {@code data} and {@code digests} are the same array
+     * @throws ArrayIndexOutOfBoundsException if a message lies outside of {@code data} or the digests do not fit in
+     *         {@code digests}
+     */
+    static void digestBatch(
+            final byte[] data, final int[] offsets, final int[] lengths, final byte[] digests, final int digestsOffset) {
+        if (data == null || offsets == null || lengths == null || digests == null) {
+            throw new IllegalArgumentException("Batch arrays must not be null");
+        }
+        if (offsets.length != lengths.length) {
+            throw new IllegalArgumentException("Offsets and lengths must have the same length");
+        }
+        if (data == digests) {
+            throw new IllegalArgumentException("Digests must not be written to the input array");
+        }
+        fastDigestBatch(data, offsets, lengths, digests, digestsOffset);
+    }
+
+    /**
+     * Digests many independent messages with a single native call and returns the concatenated digests. See
+     * {@link #digestBatch(byte[], int[], int[], byte[], int)}.
+     */
+    static byte[] digestBatch(final byte[] data, final int[] offsets, final int[] lengths) {
+        if (lengths == null) {
+            throw new IllegalArgumentException("Batch arrays must not be null");
+        }
+        final long size = (long) lengths.length * HASH_SIZE;
+        if (size > Integer.MAX_VALUE) {
+            throw new IllegalArgumentException("Batch output exceeds maximum array size");
+        }
+        final byte[] digests = new byte[(int) size];
+        digestBatch(data, offsets, lengths, digests, 0);
+        return digests;
+    }
+
     public TemplateHashSpi() {
         Loader.checkNativeLibraryAvailability();
 
-        this.buffer = new InputBuffer<byte[], byte[], RuntimeException>(1024)
-            .withInitialStateSupplier(TemplateHashSpi::resetContext)
-            .withUpdater(TemplateHashSpi::synchronizedUpdateContextByteArray)
-            .withUpdater(TemplateHashSpi::synchronizedUpdateNativeByteBuffer)
-            .withDoFinal(TemplateHashSpi::doFinal)
-            .withSinglePass(TemplateHashSpi::singlePass)
-            .withStateCloner((context) -> context.clone());
+        if (NATIVE_CONTEXTS) {
+            this.buffer = new InputBuffer<byte[], NativeContext, RuntimeException>(1024)
+                .withInitialStateSupplier(TemplateHashSpi::resetNativeContext)
+                .withUpdater((context, src, offset, length) ->
+                    context.useVoid(handle -> nativeContextUpdateByteArray(handle, src, offset, length)))
+                .withUpdater((context, src) ->
+                    context.useVoid(handle -> nativeContextUpdateNativeByteBuffer(handle, src)))
+                .withDoFinal(TemplateHashSpi::nativeDoFinal)
+                .withSinglePass(TemplateHashSpi::singlePass)
+                .withStateCloner(
+                    (context) -> new NativeContext(context.use(TemplateHashSpi::nativeContextCopy)));
+        } else {
+            this.buffer = new InputBuffer<byte[], byte[], RuntimeException>(1024)
+                .withInitialStateSupplier(TemplateHashSpi::resetContext)
+                .withUpdater(TemplateHashSpi::synchronizedUpdateContextByteArray)
+                .withUpdater(TemplateHashSpi::synchronizedUpdateNativeByteBuffer)
+                .withDoFinal(TemplateHashSpi::doFinal)
+                .withSinglePass(TemplateHashSpi::singlePass)
+                .withStateCloner((context) -> context.clone());
+        }
     }
 
     @Override
@@ -0,0 +1,235 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+package com.amazon.corretto.crypto.provider;
+
+import java.nio.ByteBuffer;
+import java.security.InvalidAlgorithmParameterException;
+import java.security.InvalidKeyException;
+import java.security.Key;
+import java.security.spec.AlgorithmParameterSpec;
+import java.util.Arrays;
+import java.util.Objects;
+import javax.crypto.MacSpi;
+import javax.crypto.SecretKey;
+
+
+/**
+ * Template for HMAC bindings specialized to a single digest. {@link EvpHmac} drives every digest through
+ * {@code HMAC_CTX}, which dispatches through the EVP layer on each call and copies the whole (digest independent)
+ * HMAC context in and out of Java. Like the hash function bindings, this template is instead expanded once per
+ * digest on both the Java and C++ sides and calls the low-level digest functions directly.
+ *
+ * Setting a key precomputes the digest contexts for the inner and outer padded key into a key state array. A message
+ * starts from a copy of the inner context, so only that fixed-size digest context is held in (and copied through)
+ * the per-message context array.
+ *
+ * These classes are only registered when the {@code specializedHmac} system property is set to {@code true}.
+ */
+public final class TemplateHmacSpi extends MacSpi implements Cloneable {
+    static final String HMAC_NAME = "@@@HMAC_NAME@@@";
+    private static final int CONTEXT_SIZE;
+    private static final int KEY_STATE_SIZE;
+    private static final int MAC_SIZE;
+
+    static final SelfTestSuite.SelfTest SELF_TEST =
+            new SelfTestSuite.SelfTest(HMAC_NAME, TemplateHmacSpi::runSelfTest);
+
+    static {
+        Loader.checkNativeLibraryAvailability();
+
+        CONTEXT_SIZE = getContextSize();
+        KEY_STATE_SIZE = getKeyStateSize();
+        MAC_SIZE = getMacSize();
+    }
+
+    /**
+     * @return The size of MACs (and digests) for this digest
+     */
+    private static native int getMacSize();
+
+    /**
+     * The size of the native digest context datastructure
+     */
+    private static native int getContextSize();
+
+    /**
+     * The size of the native key state, holding the inner and outer digest contexts
+     */
+    private static native int getKeyStateSize();
+
+    /**
+     * Absorbs the inner and outer padded key into the key state array.
+     */
+    private static native void initKey(byte[] keyState, byte[] key);
+
+    /**
+     * Starts a new message in the context array from the key state, then updates it with some bytes from a byte array.
+     */
+    private static native void initUpdate(byte[] keyState, byte[] context, byte[] buf, int offset, int length);
+
+    /**
+     * As {@link #initUpdate}, but reads the remaining bytes of a direct ByteBuffer.
+     */
+    private static native void initUpdateDirect(byte[] keyState, byte[] context, ByteBuffer buf);
+
+    /**
+     * Updates a started message with some bytes from a byte array
+     */
+    private static native void update(byte[] context, byte[] buf, int offset, int length);
+
+    /**
+     * Updates a started message with the remaining bytes of a direct ByteBuffer
+     */
+    private static native void updateDirect(byte[] context, ByteBuffer buf);
+
+    /**
+     * Finishes a started message and writes the MAC to result. The context array is cleared.
+     */
+    private static native void finish(byte[] keyState, byte[] context, byte[] result);
+
+    /**
+     * Single-shot MAC routine. The message context never leaves native code.
+     */
+    private static native void fastHmac(byte[] keyState, byte[] buf, int offset, int length, byte[] result);
+
+    static SelfTestResult runSelfTest() {
+        return EvpHmac.runSelfTest(HMAC_NAME, TemplateHmacSpi.class);
+    }
+
+    // These must be explicitly cloned
+    private byte[] context = new byte[CONTEXT_SIZE];
+    private InputBuffer<byte[], Void, RuntimeException> buffer;
+
+    private SecretKey key;
+    // Shared with clones; it is only ever replaced, never modified in place.
+    private byte[] keyState;
+
+    public TemplateHmacSpi() {
+        Loader.checkNativeLibraryAvailability();
+
+        this.buffer = new InputBuffer<byte[], Void, RuntimeException>(1024);
+        configureLambdas();
+    }
+
+    private void configureLambdas() {
+        buffer
+            .withInitialUpdater((src, offset, length) -> {
+                final byte[] ks = assertInitialized();
+                synchronized (context) {
+                    initUpdate(ks, context, src, offset, length);
+                }
+                return null;
+            })
+            .withUpdater((ignored, src, offset, length) -> {
+                assertInitialized();
+                synchronized (context) {
+                    update(context, src, offset, length);
+                }
+            })
+            .withInitialUpdater((src) -> {
+                final byte[] ks = assertInitialized();
+                synchronized (context) {
+                    initUpdateDirect(ks, context, src);
+                }
+                return null;
+            })
+            .withUpdater((ignored, src) -> {
+                assertInitialized();
+                synchronized (context) {
+                    updateDirect(context, src);
+                }
+            })
+            .withDoFinal((ignored) -> {
+                final byte[] ks = assertInitialized();
+                final byte[] result = new byte[MAC_SIZE];
+                synchronized (context) {
+                    finish(ks, context, result);
+                }
+                return result;
+            })
+            .withSinglePass((src, offset, length) -> {
+                final byte[] ks = assertInitialized();
+                final byte[] result = new byte[MAC_SIZE];
+                fastHmac(ks, src, offset, length, result);
+                return result;
+            });
+    }
+
+    private byte[] assertInitialized() {
+        if (keyState == null) {
+            throw new IllegalStateException("Mac not initialized");
+        }
+        return keyState;
+    }
+
+    @Override
+    protected int engineGetMacLength() {
+        return MAC_SIZE;
+    }
+
+    @Override
+    protected void engineInit(Key key, AlgorithmParameterSpec params)
+            throws InvalidKeyException, InvalidAlgorithmParameterException {
+        if (params != null) {
+            throw new InvalidAlgorithmParameterException("Params must be null");
+        }
+        if (!(key instanceof SecretKey)) {
+            throw new InvalidKeyException("Hmac uses expects a SecretKey");
+        }
+        if (!Objects.equals(this.key, key)) {
+            if (!"RAW".equalsIgnoreCase(key.getFormat())) {
+                throw new InvalidKeyException("Key must support RAW encoding");
+            }
+            final byte[] encoded = key.getEncoded();
+            if (encoded == null) {
+                throw new InvalidKeyException("Key encoding must not be null");
+            }
+            final byte[] newKeyState = new byte[KEY_STATE_SIZE];
+            try {
+                initKey(newKeyState, encoded);
+            } finally {
+                Arrays.fill(encoded, (byte) 0);
+            }
+            this.keyState = newKeyState;
+            this.key = (SecretKey) key;
+        }
+        engineReset();
+    }
+
+    @Override
+    protected void engineUpdate(byte input) {
+        buffer.update(input);
+    }
+
+    @Override
+    protected void engineUpdate(byte[] input, int offset, int len) {
+        buffer.update(input, offset, len);
+    }
+
+    @Override
+    protected void engineUpdate(ByteBuffer input) {
+        buffer.update(input);
+    }
+
+    @Override
+    protected byte[] engineDoFinal() {
+        return buffer.doFinal();
+    }
+
+    @Override
+    protected void engineReset() {
+        buffer.reset();
+    }
+
+    @Override
+    public TemplateHmacSpi clone() throws CloneNotSupportedException {
+        TemplateHmacSpi cloned = (TemplateHmacSpi) super.clone();
+        synchronized (context) {
+            cloned.context = context.clone();
+        }
+        cloned.buffer = buffer.clone();
+        cloned.configureLambdas();
+        return cloned;
+    }
+}
@@ -0,0 +1,386 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider.test;
+
+import static com.amazon.corretto.crypto.provider.test.TestUtil.assertThrows;
+import static com.amazon.corretto.crypto.provider.test.TestUtil.sneakyInvoke;
+import static com.amazon.corretto.crypto.provider.test.TestUtil.sneakyInvoke_int;
+import static org.junit.jupiter.api.Assertions.assertArrayEquals;
+import static org.junit.jupiter.api.Assertions.assertEquals;
+
+import java.nio.ByteBuffer;
+import java.security.InvalidAlgorithmParameterException;
+import java.security.InvalidKeyException;
+import java.util.Arrays;
+import javax.crypto.Cipher;
+import javax.crypto.NoSuchPaddingException;
+import javax.crypto.SecretKey;
+import javax.crypto.ShortBufferException;
+import javax.crypto.spec.IvParameterSpec;
+import javax.crypto.spec.SecretKeySpec;
+import org.junit.jupiter.api.Test;
+import org.junit.jupiter.api.extension.ExtendWith;
+import org.junit.jupiter.api.parallel.Execution;
+import org.junit.jupiter.api.parallel.ExecutionMode;
+import org.junit.jupiter.api.parallel.ResourceAccessMode;
+import org.junit.jupiter.api.parallel.ResourceLock;
+import org.junit.jupiter.params.ParameterizedTest;
+import org.junit.jupiter.params.provider.ValueSource;
+
+@Execution(ExecutionMode.CONCURRENT)
+@ExtendWith(TestResultLogger.class)
+@ResourceLock(value = TestUtil.RESOURCE_GLOBAL, mode = ResourceAccessMode.READ)
+public class AesCtrTest {
+  private static final String ALGORITHM = "AES/CTR/NoPadding";
+  private static final int BLOCK_SIZE = 16;
+  private static final Class<?> SPI_CLASS;
+
+  static {
+    try {
+      SPI_CLASS = Class.forName("com.amazon.corretto.crypto.provider.AesCtrSpi");
+    } catch (final ClassNotFoundException ex) {
+      throw new AssertionError(ex);
+    }
+  }
+
+  private static byte[] jceCtr(final SecretKey key, final byte[] iv, final byte[] input)
+      throws Exception {
+    final Cipher jce = Cipher.getInstance(ALGORITHM, "SunJCE");
+    jce.init(Cipher.ENCRYPT_MODE, key, new IvParameterSpec(iv));
+    return jce.doFinal(input);
+  }
+
+  @ParameterizedTest
+  @ValueSource(ints = {128, 192, 256})
+  public void matchesJce(final int keyBits) throws Exception {
+    final SecretKey key = new SecretKeySpec(TestUtil.getRandomBytes(keyBits / 8), "AES");
+    final byte[] iv = TestUtil.getRandomBytes(BLOCK_SIZE);
+    final Cipher cipher = Cipher.getInstance(ALGORITHM, TestUtil.NATIVE_PROVIDER);
+    for (int len = 0; len < 100; len++) {
+      final byte[] plaintext = TestUtil.getRandomBytes(len);
+      cipher.init(Cipher.ENCRYPT_MODE, key, new IvParameterSpec(iv));
+      final byte[] ciphertext = cipher.doFinal(plaintext);
+      assertArrayEquals(jceCtr(key, iv, plaintext), ciphertext);
+      cipher.init(Cipher.DECRYPT_MODE, key, new IvParameterSpec(iv));
+      assertArrayEquals(plaintext, cipher.doFinal(ciphertext));
+    }
+  }
+
+  @Test
+  public void counterCarriesAcrossAllBytes() throws Exception {
+    // The counter block is a single 128-bit big-endian integer, so the carry must ripple all the
+    // way to the first byte.
+    final SecretKey key = new SecretKeySpec(TestUtil.getRandomBytes(16), "AES");
+    final byte[] iv = new byte[BLOCK_SIZE];
+    Arrays.fill(iv, (byte) 0xff);
+    iv[BLOCK_SIZE - 1] = (byte) 0xfd;
+    final byte[] plaintext = TestUtil.getRandomBytes(10 * BLOCK_SIZE + 3);
+
+    final Cipher cipher = Cipher.getInstance(ALGORITHM, TestUtil.NATIVE_PROVIDER);
+    cipher.init(Cipher.ENCRYPT_MODE, key, new IvParameterSpec(iv));
+    assertArrayEquals(jceCtr(key, iv, plaintext), cipher.doFinal(plaintext));
+  }
+
+  @Test
+  public void unalignedUpdatesMatchOneShot() throws Exception {
+    final SecretKey key = new SecretKeySpec(TestUtil.getRandomBytes(32), "AES");
+    final byte[] iv = TestUtil.getRandomBytes(BLOCK_SIZE);
+    final byte[] plaintext = TestUtil.getRandomBytes(1000);
+    final byte[] expected = jceCtr(key, iv, plaintext);
+
+    final Cipher cipher = Cipher.getInstance(ALGORITHM, TestUtil.NATIVE_PROVIDER);
+    // Run twice to make sure doFinal resets the cipher to its initial state.
+    for (int round = 0; round < 2; round++) {
+      final byte[] ciphertext = new byte[plaintext.length];
+      int offset = 0;
+      for (int chunk = 1; offset + chunk < plaintext.length; chunk += 7) {
+        offset += cipher.update(plaintext, offset, chunk, ciphertext, offset);
+      }
+      cipher.doFinal(plaintext, offset, plaintext.length - offset, ciphertext, offset);
+      assertArrayEquals(expected, ciphertext);
+    }
+  }
+
+  @Test
+  public void inPlace() throws Exception {
+    final SecretKey key = new SecretKeySpec(TestUtil.getRandomBytes(16), "AES");
+    final byte[] iv = TestUtil.getRandomBytes(BLOCK_SIZE);
+    final byte[] plaintext = TestUtil.getRandomBytes(300);
+    final byte[] expected = jceCtr(key, iv, plaintext);
+
+    final Cipher cipher = Cipher.getInstance(ALGORITHM, TestUtil.NATIVE_PROVIDER);
+    cipher.init(Cipher.ENCRYPT_MODE, key, new IvParameterSpec(iv));
+    final byte[] buffer = plaintext.clone();
+    cipher.doFinal(buffer, 0, buffer.length, buffer, 0);
+    assertArrayEquals(expected, buffer);
+
+    // Overlapping, but shifted, input and output
+    final byte[] shifted = new byte[plaintext.length + 5];
+    System.arraycopy(plaintext, 0, shifted, 0, plaintext.length);
+    cipher.doFinal(shifted, 0, plaintext.length, shifted, 5);
+    assertArrayEquals(expected, Arrays.copyOfRange(shifted, 5, shifted.length));
+  }
+
+  @Test
+  public void largeInputMatchesJce() throws Exception {
+    // Above the default parallel threshold, so multi-core hosts use the threaded path.
+    final SecretKey key = new SecretKeySpec(TestUtil.getRandomBytes(16), "AES");
+    final byte[] iv = TestUtil.getRandomBytes(BLOCK_SIZE);
+    final byte[] plaintext = TestUtil.getRandomBytes(3 * 1024 * 1024 + 5);
+    final byte[] expected = jceCtr(key, iv, plaintext);
+
+    final Cipher cipher = Cipher.getInstance(ALGORITHM, TestUtil.NATIVE_PROVIDER);
+    cipher.init(Cipher.ENCRYPT_MODE, key, new IvParameterSpec(iv));
+    assertArrayEquals(expected, cipher.doFinal(plaintext));
+
+    final byte[] ciphertext = new byte[plaintext.length];
+    final int first = cipher.update(plaintext, 0, 7, ciphertext, 0);
+    cipher.doFinal(plaintext, first, plaintext.length - first, ciphertext, first);
+    assertArrayEquals(expected, ciphertext);
+  }
+
+  @ParameterizedTest
+  @ValueSource(ints = {2, 3, 4, 7, 16})
+  public void threadedNativePathMatchesJce(final int threads) throws Throwable {
+    // Drive the native functions directly so the threaded path is covered regardless of the
+    // number of processors and the configured threshold.
+    final byte[] key = TestUtil.getRandomBytes(24);
+    final byte[] iv = TestUtil.getRandomBytes(BLOCK_SIZE);
+    iv[BLOCK_SIZE - 1] = (byte) 0xf0; // Make the counter carry within the input
+    final byte[] plaintext = TestUtil.getRandomBytes(64 * 1024 + 9);
+    final byte[] expected = jceCtr(new SecretKeySpec(key, "AES"), iv, plaintext);
+
+    byte[] ciphertext = new byte[plaintext.length];
+    assertEquals(
+        plaintext.length,
+        sneakyInvoke_int(
+            SPI_CLASS,
+            "nInitUpdateFinal",
+            key,
+            key.length,
+            iv,
+            threads,
+            null,
+            plaintext,
+            0,
+            plaintext.length,
+            null,
+            ciphertext,
+            0));
+    assertArrayEquals(expected, ciphertext);
+
+    // Start with an unaligned update, then a threaded update, then a threaded final
+    ciphertext = new byte[plaintext.length];
+    final long[] ctxContainer = new long[1];
+    int position =
+        sneakyInvoke_int(
+            SPI_CLASS,
+            "nInitUpdate",
+            key,
+            key.length,
+            iv,
+            ctxContainer,
+            threads,
+            null,
+            plaintext,
+            0,
+            5,
+            null,
+            ciphertext,
+            0);
+    position +=
+        sneakyInvoke_int(
+            SPI_CLASS,
+            "nUpdate",
+            ctxContainer[0],
+            iv,
+            (long) position,
+            threads,
+            null,
+            plaintext,
+            position,
+            30000,
+            null,
+            ciphertext,
+            position);
+    final Integer last =
+        sneakyInvoke(
+            SPI_CLASS,
+            "nUpdateFinal",
+            ctxContainer[0],
+            iv,
+            (long) position,
+            threads,
+            null,
+            plaintext,
+            position,
+            plaintext.length - position,
+            null,
+            ciphertext,
+            position);
+    assertEquals(plaintext.length, position + last);
+    assertArrayEquals(expected, ciphertext);
+
+    // In place
+    final byte[] buffer = plaintext.clone();
+    sneakyInvoke_int(
+        SPI_CLASS,
+        "nInitUpdateFinal",
+        key,
+        key.length,
+        iv,
+        threads,
+        null,
+        buffer,
+        0,
+        buffer.length,
+        null,
+        buffer,
+        0);
+    assertArrayEquals(expected, buffer);
+  }
+
+  @Test
+  public void windowedNativePathMatchesJce() throws Throwable {
+    // Larger than the window which a single thread borrows at a time, with direct buffers, so that
+    // the input is processed in several windows which do not start on a block boundary.
+    final byte[] key = TestUtil.getRandomBytes(16);
+    final byte[] iv = TestUtil.getRandomBytes(BLOCK_SIZE);
+    final byte[] plaintext = TestUtil.getRandomBytes(9 * 1024 * 1024 + 5);
+    final byte[] expected = jceCtr(new SecretKeySpec(key, "AES"), iv, plaintext);
+
+    final ByteBuffer input = ByteBuffer.allocateDirect(plaintext.length);
+    input.put(plaintext).flip();
+    final ByteBuffer output = ByteBuffer.allocateDirect(plaintext.length);
+    final long[] ctxContainer = new long[1];
+    final int first =
+        sneakyInvoke_int(
+            SPI_CLASS,
+            "nInitUpdate",
+            key,
+            key.length,
+            iv,
+            ctxContainer,
+            1,
+            input,
+            null,
+            0,
+            3,
+            output,
+            null,
+            0);
+    final int last =
+        sneakyInvoke_int(
+            SPI_CLASS,
+            "nUpdateFinal",
+            ctxContainer[0],
+            iv,
+            (long) first,
+            1,
+            input,
+            null,
+            first,
+            plaintext.length - first,
+            output,
+            null,
+            first);
+    assertEquals(plaintext.length, first + last);
+    final byte[] ciphertext = new byte[plaintext.length];
+    output.get(ciphertext);
+    assertArrayEquals(expected, ciphertext);
+  }
+
+  @Test
+  public void byteBuffersMatchJce() throws Exception {
+    final SecretKey key = new SecretKeySpec(TestUtil.getRandomBytes(16), "AES");
+    final byte[] iv = TestUtil.getRandomBytes(BLOCK_SIZE);
+    final byte[] plaintext = TestUtil.getRandomBytes(1000);
+    final byte[] expected = jceCtr(key, iv, plaintext);
+    final Cipher cipher = Cipher.getInstance(ALGORITHM, TestUtil.NATIVE_PROVIDER);
+
+    final ByteBuffer[] inputs = {
+      ByteBuffer.wrap(plaintext),
+      ByteBuffer.wrap(plaintext).asReadOnlyBuffer(),
+      ByteBuffer.allocateDirect(plaintext.length).put(plaintext)
+    };
+    inputs[2].flip();
+    for (final ByteBuffer input : inputs) {
+      for (final boolean direct : new boolean[] {false, true}) {
+        final ByteBuffer in = input.duplicate();
+        final ByteBuffer out =
+            direct
+                ? ByteBuffer.allocateDirect(plaintext.length)
+                : ByteBuffer.allocate(plaintext.length);
+        cipher.init(Cipher.ENCRYPT_MODE, key, new IvParameterSpec(iv));
+        in.limit(7);
+        assertEquals(7, cipher.update(in, out));
+        in.limit(plaintext.length);
+        assertEquals(plaintext.length - 7, cipher.doFinal(in, out));
+        assertEquals(plaintext.length, in.position());
+        assertEquals(plaintext.length, out.position());
+
+        final byte[] ciphertext = new byte[plaintext.length];
+        out.flip();
+        out.get(ciphertext);
+        assertArrayEquals(expected, ciphertext);
+      }
+    }
+
+    // Overlapping, but shifted, buffers
+    final ByteBuffer shifted = ByteBuffer.allocate(plaintext.length + 5);
+    shifted.put(plaintext).flip();
+    final ByteBuffer out = shifted.duplicate();
+    out.position(5).limit(shifted.capacity());
+    cipher.init(Cipher.ENCRYPT_MODE, key, new IvParameterSpec(iv));
+    cipher.doFinal(shifted, out);
+    assertArrayEquals(expected, Arrays.copyOfRange(shifted.array(), 5, shifted.capacity()));
+  }
+
+  @Test
+  public void shortOutputThrowsShortBufferException() throws Exception {
+    final SecretKey key = new SecretKeySpec(TestUtil.getRandomBytes(16), "AES");
+    final IvParameterSpec iv = new IvParameterSpec(TestUtil.getRandomBytes(BLOCK_SIZE));
+    final byte[] plaintext = TestUtil.getRandomBytes(100);
+    final Cipher cipher = Cipher.getInstance(ALGORITHM, TestUtil.NATIVE_PROVIDER);
+    cipher.init(Cipher.ENCRYPT_MODE, key, iv);
+
+    assertThrows(
+        ShortBufferException.class,
+        () -> cipher.update(plaintext, 0, plaintext.length, new byte[plaintext.length], 1));
+    assertThrows(
+        ShortBufferException.class,
+        () -> cipher.doFinal(plaintext, 0, plaintext.length, new byte[plaintext.length - 1], 0));
+    assertThrows(
+        ShortBufferException.class,
+        () -> cipher.update(ByteBuffer.wrap(plaintext), ByteBuffer.allocate(99)));
+    assertThrows(
+        ShortBufferException.class,
+        () -> cipher.doFinal(ByteBuffer.wrap(plaintext), ByteBuffer.allocateDirect(99)));
+
+    // None of the failures advanced the keystream
+    assertArrayEquals(jceCtr(key, iv.getIV(), plaintext), cipher.doFinal(plaintext));
+  }
+
+  @Test
+  public void badParameters() throws Exception {
+    final Cipher cipher = Cipher.getInstance(ALGORITHM, TestUtil.NATIVE_PROVIDER);
+    final byte[] iv = new byte[BLOCK_SIZE];
+    assertThrows(
+        InvalidKeyException.class,
+        () ->
+            cipher.init(
+                Cipher.ENCRYPT_MODE,
+                new SecretKeySpec(new byte[20], "AES"),
+                new IvParameterSpec(iv)));
+    assertThrows(
+        InvalidAlgorithmParameterException.class,
+        () ->
+            cipher.init(
+                Cipher.ENCRYPT_MODE,
+                new SecretKeySpec(new byte[16], "AES"),
+                new IvParameterSpec(new byte[12])));
+    assertThrows(
+        NoSuchPaddingException.class,
+        () -> Cipher.getInstance("AES/CTR/PKCS5Padding", TestUtil.NATIVE_PROVIDER));
+  }
+}
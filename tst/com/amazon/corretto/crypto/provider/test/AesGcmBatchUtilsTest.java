@@ -0,0 +1,201 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider.test;
+
+import static com.amazon.corretto.crypto.provider.test.TestUtil.assertThrows;
+import static org.junit.jupiter.api.Assertions.assertArrayEquals;
+import static org.junit.jupiter.api.Assertions.assertEquals;
+import static org.junit.jupiter.api.Assertions.assertTrue;
+
+import com.amazon.corretto.crypto.utils.AesGcmBatchUtils;
+import java.util.Arrays;
+import java.util.BitSet;
+import javax.crypto.Cipher;
+import javax.crypto.SecretKey;
+import javax.crypto.spec.GCMParameterSpec;
+import javax.crypto.spec.SecretKeySpec;
+import org.junit.jupiter.api.Test;
+import org.junit.jupiter.api.extension.ExtendWith;
+import org.junit.jupiter.api.parallel.Execution;
+import org.junit.jupiter.api.parallel.ExecutionMode;
+import org.junit.jupiter.api.parallel.ResourceAccessMode;
+import org.junit.jupiter.api.parallel.ResourceLock;
+import org.junit.jupiter.params.ParameterizedTest;
+import org.junit.jupiter.params.provider.ValueSource;
+
+@Execution(ExecutionMode.CONCURRENT)
+@ExtendWith(TestResultLogger.class)
+@ResourceLock(value = TestUtil.RESOURCE_GLOBAL, mode = ResourceAccessMode.READ)
+public class AesGcmBatchUtilsTest {
+  private static final int RECORDS = 50;
+
+  private static final class Batch {
+    final byte[][] ivs = new byte[RECORDS][];
+    final byte[][] aads = new byte[RECORDS][];
+    final int[] offsets = new int[RECORDS];
+    final int[] lengths = new int[RECORDS];
+    final byte[] input;
+
+    Batch() {
+      int total = 0;
+      for (int i = 0; i < RECORDS; i++) {
+        ivs[i] = TestUtil.getRandomBytes(i % 3 == 0 ? 16 : 12);
+        // Leave some AADs null and some empty to cover both cases
+        aads[i] = i % 4 == 0 ? null : TestUtil.getRandomBytes(i % 5);
+        // Leave a gap between records to make sure offsets are honored
+        offsets[i] = total + 3;
+        lengths[i] = i * 13;
+        total = offsets[i] + lengths[i];
+      }
+      input = TestUtil.getRandomBytes(total);
+    }
+  }
+
+  @ParameterizedTest
+  @ValueSource(ints = {128, 192, 256})
+  public void sealMatchesCipher(final int keyBits) throws Exception {
+    final SecretKey key = new SecretKeySpec(TestUtil.getRandomBytes(keyBits / 8), "AES");
+    final Batch batch = new Batch();
+
+    final byte[] sealed =
+        AesGcmBatchUtils.seal(
+            key, 128, batch.ivs, batch.aads, batch.input, batch.offsets, batch.lengths);
+
+    final Cipher jce = Cipher.getInstance("AES/GCM/NoPadding", "SunJCE");
+    int pos = 0;
+    for (int i = 0; i < RECORDS; i++) {
+      jce.init(Cipher.ENCRYPT_MODE, key, new GCMParameterSpec(128, batch.ivs[i]));
+      if (batch.aads[i] != null) {
+        jce.updateAAD(batch.aads[i]);
+      }
+      final byte[] expected = jce.doFinal(batch.input, batch.offsets[i], batch.lengths[i]);
+      assertArrayEquals(expected, Arrays.copyOfRange(sealed, pos, pos + expected.length));
+      pos += expected.length;
+    }
+    assertEquals(sealed.length, pos);
+  }
+
+  @Test
+  public void openRoundTripAndReportsFailures() throws Exception {
+    final SecretKey key = new SecretKeySpec(TestUtil.getRandomBytes(16), "AES");
+    final Batch batch = new Batch();
+    final int tagBits = 96;
+    final int tagLen = tagBits / 8;
+
+    final byte[] sealed =
+        AesGcmBatchUtils.seal(
+            key, tagBits, batch.ivs, batch.aads, batch.input, batch.offsets, batch.lengths);
+    final int[] sealedOffsets = new int[RECORDS];
+    final int[] sealedLengths = new int[RECORDS];
+    int pos = 0;
+    for (int i = 0; i < RECORDS; i++) {
+      sealedOffsets[i] = pos;
+      sealedLengths[i] = batch.lengths[i] + tagLen;
+      pos += sealedLengths[i];
+    }
+
+    final byte[] plaintext =
+        new byte[AesGcmBatchUtils.getOpenOutputSize(tagBits, sealedLengths)];
+    BitSet failures =
+        AesGcmBatchUtils.open(
+            key, tagBits, batch.ivs, batch.aads, sealed, sealedOffsets, sealedLengths, plaintext);
+    assertTrue(failures.isEmpty());
+    pos = 0;
+    for (int i = 0; i < RECORDS; i++) {
+      assertArrayEquals(
+          Arrays.copyOfRange(batch.input, batch.offsets[i], batch.offsets[i] + batch.lengths[i]),
+          Arrays.copyOfRange(plaintext, pos, pos + batch.lengths[i]));
+      pos += batch.lengths[i];
+    }
+
+    // Corrupt a few records; the others must still decrypt
+    sealed[sealedOffsets[3]] ^= 1;
+    sealed[sealedOffsets[7] + sealedLengths[7] - 1] ^= 1;
+    batch.aads[10] = new byte[] {1};
+    failures =
+        AesGcmBatchUtils.open(
+            key, tagBits, batch.ivs, batch.aads, sealed, sealedOffsets, sealedLengths, plaintext);
+    final BitSet expectedFailures = new BitSet();
+    expectedFailures.set(3);
+    expectedFailures.set(7);
+    expectedFailures.set(10);
+    assertEquals(expectedFailures, failures);
+
+    pos = 0;
+    for (int i = 0; i < RECORDS; i++) {
+      final byte[] record = Arrays.copyOfRange(plaintext, pos, pos + batch.lengths[i]);
+      if (failures.get(i)) {
+        assertArrayEquals(new byte[batch.lengths[i]], record);
+      } else {
+        assertArrayEquals(
+            Arrays.copyOfRange(
+                batch.input, batch.offsets[i], batch.offsets[i] + batch.lengths[i]),
+            record);
+      }
+      pos += batch.lengths[i];
+    }
+  }
+
+  @Test
+  public void emptyBatch() {
+    final SecretKey key = new SecretKeySpec(TestUtil.getRandomBytes(16), "AES");
+    assertEquals(
+        0,
+        AesGcmBatchUtils.seal(key, 128, new byte[0][], null, new byte[0], new int[0], new int[0])
+            .length);
+    assertTrue(
+        AesGcmBatchUtils.open(
+                key, 128, new byte[0][], null, new byte[0], new int[0], new int[0], new byte[0])
+            .isEmpty());
+  }
+
+  @Test
+  public void badArguments() {
+    final SecretKey key = new SecretKeySpec(TestUtil.getRandomBytes(16), "AES");
+    final byte[] iv = TestUtil.getRandomBytes(12);
+    final byte[] input = new byte[10];
+
+    assertThrows(
+        IllegalArgumentException.class,
+        () ->
+            AesGcmBatchUtils.seal(
+                key, 128, new byte[][] {iv, iv.clone()}, null, input, new int[2], new int[2]));
+    assertThrows(
+        IllegalArgumentException.class,
+        () ->
+            AesGcmBatchUtils.seal(key, 64, new byte[][] {iv}, null, input, new int[1], new int[1]));
+    assertThrows(
+        IllegalArgumentException.class,
+        () ->
+            AesGcmBatchUtils.seal(
+                new SecretKeySpec(new byte[15], "AES"),
+                128,
+                new byte[][] {iv},
+                null,
+                input,
+                new int[1],
+                new int[1]));
+    assertThrows(
+        IllegalArgumentException.class,
+        () ->
+            AesGcmBatchUtils.seal(
+                key, 128, new byte[][] {iv}, null, input, new int[2], new int[1]));
+    assertThrows(
+        ArrayIndexOutOfBoundsException.class,
+        () ->
+            AesGcmBatchUtils.seal(
+                key, 128, new byte[][] {iv}, null, input, new int[] {5}, new int[] {6}));
+    assertThrows(
+        IllegalArgumentException.class,
+        () ->
+            AesGcmBatchUtils.open(
+                key,
+                128,
+                new byte[][] {iv},
+                null,
+                new byte[20],
+                new int[1],
+                new int[] {20},
+                new byte[3]));
+  }
+}
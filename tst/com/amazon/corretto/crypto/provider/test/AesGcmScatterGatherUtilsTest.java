@@ -0,0 +1,208 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider.test;
+
+import static com.amazon.corretto.crypto.provider.test.TestUtil.assertThrows;
+import static org.junit.jupiter.api.Assertions.assertArrayEquals;
+import static org.junit.jupiter.api.Assertions.assertEquals;
+
+import com.amazon.corretto.crypto.utils.AesGcmScatterGatherUtils;
+import java.nio.ByteBuffer;
+import java.nio.ReadOnlyBufferException;
+import java.util.Arrays;
+import javax.crypto.AEADBadTagException;
+import javax.crypto.Cipher;
+import javax.crypto.SecretKey;
+import javax.crypto.spec.GCMParameterSpec;
+import javax.crypto.spec.SecretKeySpec;
+import org.junit.jupiter.api.Test;
+import org.junit.jupiter.api.extension.ExtendWith;
+import org.junit.jupiter.api.parallel.Execution;
+import org.junit.jupiter.api.parallel.ExecutionMode;
+import org.junit.jupiter.api.parallel.ResourceAccessMode;
+import org.junit.jupiter.api.parallel.ResourceLock;
+import org.junit.jupiter.params.ParameterizedTest;
+import org.junit.jupiter.params.provider.ValueSource;
+
+@Execution(ExecutionMode.CONCURRENT)
+@ExtendWith(TestResultLogger.class)
+@ResourceLock(value = TestUtil.RESOURCE_GLOBAL, mode = ResourceAccessMode.READ)
+public class AesGcmScatterGatherUtilsTest {
+  // Slice sizes chosen so that slice boundaries fall inside blocks and inside the tag
+  private static final int[] SLICES = {5, 0, 16, 33, 1, 100, 7};
+
+  /** Splits {@code data} into slices, alternating between heap and direct buffers. */
+  private static ByteBuffer[] split(final byte[] data, final int[] sizes) {
+    final ByteBuffer[] result = new ByteBuffer[sizes.length + 1];
+    int offset = 0;
+    for (int i = 0; i <= sizes.length; i++) {
+      final int left = data.length - offset;
+      final int size = i == sizes.length ? left : Math.min(sizes[i], left);
+      result[i] = allocate(i, size);
+      result[i].put(data, offset, size).flip();
+      offset += size;
+    }
+    return result;
+  }
+
+  /** Empty output slices of the given sizes, plus one for everything else. */
+  private static ByteBuffer[] outputs(final int total, final int[] sizes) {
+    final ByteBuffer[] result = new ByteBuffer[sizes.length + 1];
+    int remaining = total;
+    for (int i = 0; i <= sizes.length; i++) {
+      final int size = i == sizes.length ? remaining : Math.min(sizes[i], remaining);
+      result[i] = allocate(i + 1, size);
+      remaining -= size;
+    }
+    return result;
+  }
+
+  private static ByteBuffer allocate(final int index, final int size) {
+    if (index % 2 == 0) {
+      return ByteBuffer.allocateDirect(size);
+    }
+    // Heap buffer with a non-zero array offset
+    final ByteBuffer backing = ByteBuffer.allocate(size + 3);
+    backing.position(3);
+    return backing.slice();
+  }
+
+  private static byte[] gather(final ByteBuffer[] buffers) {
+    int total = 0;
+    for (final ByteBuffer buffer : buffers) {
+      total += buffer.position();
+    }
+    final byte[] result = new byte[total];
+    int offset = 0;
+    for (final ByteBuffer buffer : buffers) {
+      final ByteBuffer written = buffer.duplicate();
+      written.flip();
+      final int len = written.remaining();
+      written.get(result, offset, len);
+      offset += len;
+    }
+    return result;
+  }
+
+  @ParameterizedTest
+  @ValueSource(ints = {0, 1, 15, 16, 161, 1000})
+  public void matchesCipher(final int length) throws Exception {
+    final SecretKey key = new SecretKeySpec(TestUtil.getRandomBytes(16), "AES");
+    final GCMParameterSpec params = new GCMParameterSpec(128, TestUtil.getRandomBytes(12));
+    final byte[] aad = TestUtil.getRandomBytes(9);
+    final byte[] plaintext = TestUtil.getRandomBytes(length);
+
+    final Cipher cipher = Cipher.getInstance("AES/GCM/NoPadding", TestUtil.NATIVE_PROVIDER);
+    cipher.init(Cipher.ENCRYPT_MODE, key, params);
+    cipher.updateAAD(aad);
+    final byte[] expected = cipher.doFinal(plaintext);
+
+    final ByteBuffer[] inputs = split(plaintext, SLICES);
+    final ByteBuffer[] sealed = outputs(expected.length, SLICES);
+    assertEquals(
+        expected.length, AesGcmScatterGatherUtils.seal(key, params, aad, inputs, sealed));
+    assertArrayEquals(expected, gather(sealed));
+    for (final ByteBuffer input : inputs) {
+      assertEquals(0, input.remaining());
+    }
+
+    // Open with a different slicing, so that the tag straddles slices
+    final ByteBuffer[] ciphertext = split(expected, new int[] {3, length, 9});
+    final ByteBuffer[] opened = outputs(plaintext.length, new int[] {7, 7});
+    assertEquals(
+        plaintext.length, AesGcmScatterGatherUtils.open(key, params, aad, ciphertext, opened));
+    assertArrayEquals(plaintext, gather(opened));
+  }
+
+  @Test
+  public void badTag() throws Exception {
+    final SecretKey key = new SecretKeySpec(TestUtil.getRandomBytes(32), "AES");
+    final GCMParameterSpec params = new GCMParameterSpec(96, TestUtil.getRandomBytes(12));
+    final byte[] plaintext = TestUtil.getRandomBytes(200);
+    final ByteBuffer[] sealed = outputs(plaintext.length + 12, SLICES);
+    AesGcmScatterGatherUtils.seal(key, params, null, split(plaintext, SLICES), sealed);
+    final byte[] ciphertext = gather(sealed);
+    ciphertext[ciphertext.length - 1] ^= 1;
+
+    final ByteBuffer[] opened = outputs(plaintext.length, SLICES);
+    assertThrows(
+        AEADBadTagException.class,
+        () ->
+            AesGcmScatterGatherUtils.open(key, params, null, split(ciphertext, SLICES), opened));
+    for (final ByteBuffer buffer : opened) {
+      // Positions are unchanged and no plaintext was released
+      assertEquals(0, buffer.position());
+      final byte[] contents = new byte[buffer.remaining()];
+      buffer.duplicate().get(contents);
+      assertArrayEquals(new byte[contents.length], contents);
+    }
+  }
+
+  @Test
+  public void readOnlyBuffers() throws Exception {
+    final SecretKey key = new SecretKeySpec(TestUtil.getRandomBytes(16), "AES");
+    final GCMParameterSpec params = new GCMParameterSpec(128, TestUtil.getRandomBytes(12));
+    final byte[] plaintext = TestUtil.getRandomBytes(50);
+
+    // Read-only inputs are fine
+    final ByteBuffer[] inputs = {ByteBuffer.wrap(plaintext).asReadOnlyBuffer()};
+    final ByteBuffer[] sealed = {ByteBuffer.allocate(plaintext.length + 16)};
+    AesGcmScatterGatherUtils.seal(key, params, null, inputs, sealed);
+    sealed[0].flip();
+    final byte[] opened = new byte[plaintext.length];
+    AesGcmScatterGatherUtils.open(
+        key,
+        params,
+        null,
+        new ByteBuffer[] {sealed[0].asReadOnlyBuffer()},
+        new ByteBuffer[] {ByteBuffer.wrap(opened)});
+    assertArrayEquals(plaintext, opened);
+
+    // Read-only outputs are not
+    assertThrows(
+        ReadOnlyBufferException.class,
+        () ->
+            AesGcmScatterGatherUtils.seal(
+                key,
+                params,
+                null,
+                new ByteBuffer[] {ByteBuffer.wrap(plaintext)},
+                new ByteBuffer[] {ByteBuffer.allocate(100).asReadOnlyBuffer()}));
+  }
+
+  @Test
+  public void badArguments() throws Exception {
+    final SecretKey key = new SecretKeySpec(TestUtil.getRandomBytes(16), "AES");
+    final GCMParameterSpec params = new GCMParameterSpec(128, TestUtil.getRandomBytes(12));
+    final ByteBuffer[] inputs = {ByteBuffer.allocate(10)};
+    assertThrows(
+        IllegalArgumentException.class,
+        () ->
+            AesGcmScatterGatherUtils.seal(
+                key, params, null, inputs, new ByteBuffer[] {ByteBuffer.allocate(25)}));
+    assertThrows(
+        IllegalArgumentException.class,
+        () ->
+            AesGcmScatterGatherUtils.seal(
+                key,
+                new GCMParameterSpec(64, new byte[12]),
+                null,
+                inputs,
+                new ByteBuffer[] {ByteBuffer.allocate(26)}));
+    assertThrows(
+        IllegalArgumentException.class,
+        () ->
+            AesGcmScatterGatherUtils.seal(
+                new SecretKeySpec(new byte[10], "AES"),
+                params,
+                null,
+                inputs,
+                new ByteBuffer[] {ByteBuffer.allocate(26)}));
+    assertThrows(
+        AEADBadTagException.class,
+        () ->
+            AesGcmScatterGatherUtils.open(
+                key, params, null, inputs, new ByteBuffer[] {ByteBuffer.allocate(26)}));
+    assertEquals(10, Arrays.stream(inputs).mapToInt(ByteBuffer::remaining).sum());
+  }
+}
@@ -0,0 +1,329 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider.test;
+
+import static com.amazon.corretto.crypto.provider.test.TestUtil.assertThrows;
+import static com.amazon.corretto.crypto.provider.test.TestUtil.sneakyInvoke;
+import static com.amazon.corretto.crypto.provider.test.TestUtil.sneakyInvoke_int;
+import static org.junit.jupiter.api.Assertions.assertArrayEquals;
+import static org.junit.jupiter.api.Assertions.assertEquals;
+import static org.junit.jupiter.api.Assertions.assertFalse;
+
+import com.amazon.corretto.crypto.provider.RuntimeCryptoException;
+import java.io.ByteArrayOutputStream;
+import java.security.GeneralSecurityException;
+import java.security.InvalidAlgorithmParameterException;
+import java.security.InvalidKeyException;
+import java.util.Arrays;
+import javax.crypto.AEADBadTagException;
+import javax.crypto.Cipher;
+import javax.crypto.SecretKey;
+import javax.crypto.spec.IvParameterSpec;
+import javax.crypto.spec.SecretKeySpec;
+import org.junit.jupiter.api.Test;
+import org.junit.jupiter.api.condition.DisabledIf;
+import org.junit.jupiter.api.extension.ExtendWith;
+import org.junit.jupiter.api.parallel.Execution;
+import org.junit.jupiter.api.parallel.ExecutionMode;
+import org.junit.jupiter.api.parallel.ResourceAccessMode;
+import org.junit.jupiter.api.parallel.ResourceLock;
+import org.junit.jupiter.params.ParameterizedTest;
+import org.junit.jupiter.params.provider.ValueSource;
+
+@DisabledIf("com.amazon.corretto.crypto.provider.test.AesGcmStreamTest#isDisabled")
+@Execution(ExecutionMode.CONCURRENT)
+@ExtendWith(TestResultLogger.class)
+@ResourceLock(value = TestUtil.RESOURCE_GLOBAL, mode = ResourceAccessMode.READ)
+public class AesGcmStreamTest {
+  private static final String ALGORITHM = "AES/GCM-STREAM/NoPadding";
+  private static final int SEGMENT_SIZE = 64 * 1024;
+  private static final int TAG_LENGTH = 16;
+  private static final Class<?> SPI_CLASS;
+
+  static {
+    try {
+      SPI_CLASS = Class.forName("com.amazon.corretto.crypto.provider.AesGcmStreamSpi");
+    } catch (final ClassNotFoundException ex) {
+      throw new AssertionError(ex);
+    }
+  }
+
+  public static boolean isDisabled() {
+    return TestUtil.NATIVE_PROVIDER.isFips() && !TestUtil.NATIVE_PROVIDER.isExperimentalFips();
+  }
+
+  private static int sealedLength(final int plaintextLength) {
+    final int segments = Math.max(1, (plaintextLength + SEGMENT_SIZE - 1) / SEGMENT_SIZE);
+    return plaintextLength + segments * TAG_LENGTH;
+  }
+
+  private static Cipher cipher(final int mode, final SecretKey key, final byte[] iv)
+      throws GeneralSecurityException {
+    final Cipher cipher = Cipher.getInstance(ALGORITHM, TestUtil.NATIVE_PROVIDER);
+    cipher.init(mode, key, new IvParameterSpec(iv));
+    return cipher;
+  }
+
+  private static byte[] chunked(final Cipher cipher, final byte[] input, final int chunkSize)
+      throws GeneralSecurityException {
+    final ByteArrayOutputStream out = new ByteArrayOutputStream();
+    for (int offset = 0; offset < input.length; offset += chunkSize) {
+      final byte[] part = cipher.update(input, offset, Math.min(chunkSize, input.length - offset));
+      if (part != null) {
+        out.write(part, 0, part.length);
+      }
+    }
+    final byte[] last = cipher.doFinal();
+    out.write(last, 0, last.length);
+    return out.toByteArray();
+  }
+
+  @ParameterizedTest
+  @ValueSource(
+      ints = {
+        0,
+        1,
+        SEGMENT_SIZE - 1,
+        SEGMENT_SIZE,
+        SEGMENT_SIZE + 1,
+        3 * SEGMENT_SIZE,
+        3 * SEGMENT_SIZE + 17
+      })
+  public void roundTrip(final int length) throws Exception {
+    final SecretKey key = new SecretKeySpec(TestUtil.getRandomBytes(32), "AES");
+    final byte[] iv = TestUtil.getRandomBytes(16);
+    final byte[] aad = TestUtil.getRandomBytes(20);
+    final byte[] plaintext = TestUtil.getRandomBytes(length);
+
+    final Cipher encryptor = cipher(Cipher.ENCRYPT_MODE, key, iv);
+    encryptor.updateAAD(aad);
+    final byte[] ciphertext = encryptor.doFinal(plaintext);
+    assertEquals(sealedLength(length), ciphertext.length);
+
+    for (final int chunk : new int[] {1000, SEGMENT_SIZE, SEGMENT_SIZE + TAG_LENGTH, 200_000}) {
+      final Cipher chunkedEncryptor = cipher(Cipher.ENCRYPT_MODE, key, iv);
+      chunkedEncryptor.updateAAD(aad);
+      assertArrayEquals(ciphertext, chunked(chunkedEncryptor, plaintext, chunk));
+
+      final Cipher decryptor = cipher(Cipher.DECRYPT_MODE, key, iv);
+      decryptor.updateAAD(aad);
+      assertArrayEquals(plaintext, chunked(decryptor, ciphertext, chunk));
+    }
+
+    final Cipher decryptor = cipher(Cipher.DECRYPT_MODE, key, iv);
+    decryptor.updateAAD(aad);
+    assertArrayEquals(plaintext, decryptor.doFinal(ciphertext));
+  }
+
+  @Test
+  public void decryptionReleasesAuthenticatedSegments() throws Exception {
+    final SecretKey key = new SecretKeySpec(TestUtil.getRandomBytes(16), "AES");
+    final byte[] iv = TestUtil.getRandomBytes(16);
+    final byte[] plaintext = TestUtil.getRandomBytes(2 * SEGMENT_SIZE + 100);
+    final byte[] ciphertext = cipher(Cipher.ENCRYPT_MODE, key, iv).doFinal(plaintext);
+
+    final Cipher decryptor = cipher(Cipher.DECRYPT_MODE, key, iv);
+    final int sealedSegment = SEGMENT_SIZE + TAG_LENGTH;
+    // A complete segment is held back until it is known not to be the last one
+    assertEquals(0, decryptor.update(ciphertext, 0, sealedSegment).length);
+    final byte[] first = decryptor.update(ciphertext, sealedSegment, 1);
+    assertArrayEquals(Arrays.copyOf(plaintext, SEGMENT_SIZE), first);
+  }
+
+  @Test
+  public void inPlace() throws Exception {
+    final SecretKey key = new SecretKeySpec(TestUtil.getRandomBytes(16), "AES");
+    final byte[] iv = TestUtil.getRandomBytes(16);
+    final byte[] plaintext = TestUtil.getRandomBytes(SEGMENT_SIZE + 5);
+    final byte[] expected = cipher(Cipher.ENCRYPT_MODE, key, iv).doFinal(plaintext);
+
+    final byte[] buffer = Arrays.copyOf(plaintext, expected.length);
+    cipher(Cipher.ENCRYPT_MODE, key, iv).doFinal(buffer, 0, plaintext.length, buffer, 0);
+    assertArrayEquals(expected, buffer);
+    cipher(Cipher.DECRYPT_MODE, key, iv).doFinal(buffer, 0, buffer.length, buffer, 0);
+    assertArrayEquals(plaintext, Arrays.copyOf(buffer, plaintext.length));
+  }
+
+  @Test
+  public void tamperingIsDetected() throws Exception {
+    final SecretKey key = new SecretKeySpec(TestUtil.getRandomBytes(16), "AES");
+    final byte[] iv = TestUtil.getRandomBytes(16);
+    final byte[] aad = TestUtil.getRandomBytes(8);
+    final byte[] plaintext = TestUtil.getRandomBytes(3 * SEGMENT_SIZE);
+    final Cipher encryptor = cipher(Cipher.ENCRYPT_MODE, key, iv);
+    encryptor.updateAAD(aad);
+    final byte[] ciphertext = encryptor.doFinal(plaintext);
+    final int sealedSegment = SEGMENT_SIZE + TAG_LENGTH;
+
+    // Bit flip in the middle segment
+    final byte[] flipped = ciphertext.clone();
+    flipped[sealedSegment + 7] ^= 1;
+    assertOpenFails(key, iv, aad, flipped);
+
+    // Truncation at a segment boundary
+    assertOpenFails(key, iv, aad, Arrays.copyOf(ciphertext, 2 * sealedSegment));
+
+    // Reordered segments
+    final byte[] swapped = ciphertext.clone();
+    System.arraycopy(ciphertext, 0, swapped, sealedSegment, sealedSegment);
+    System.arraycopy(ciphertext, sealedSegment, swapped, 0, sealedSegment);
+    assertOpenFails(key, iv, aad, swapped);
+
+    // Wrong AAD and wrong IV
+    assertOpenFails(key, iv, new byte[8], ciphertext);
+    assertOpenFails(key, TestUtil.getRandomBytes(16), aad, ciphertext);
+
+    // Streaming decryption reports a bad segment as soon as it is reached
+    final Cipher decryptor = cipher(Cipher.DECRYPT_MODE, key, iv);
+    decryptor.updateAAD(aad);
+    assertThrows(RuntimeCryptoException.class, () -> decryptor.update(flipped));
+  }
+
+  private static void assertOpenFails(
+      final SecretKey key, final byte[] iv, final byte[] aad, final byte[] ciphertext)
+      throws Exception {
+    final Cipher decryptor = cipher(Cipher.DECRYPT_MODE, key, iv);
+    decryptor.updateAAD(aad);
+    assertThrows(AEADBadTagException.class, () -> decryptor.doFinal(ciphertext));
+  }
+
+  @ParameterizedTest
+  @ValueSource(ints = {2, 3, 4, 7, 16})
+  public void threadedNativePathMatchesSerial(final int threads) throws Throwable {
+    // Drive the native functions directly with small segments so the threaded path is covered
+    // regardless of the configured number of threads.
+    final int segmentSize = 100;
+    final byte[] key = TestUtil.getRandomBytes(24);
+    final byte[] iv = TestUtil.getRandomBytes(16);
+    final byte[] aad = TestUtil.getRandomBytes(5);
+    final byte[] plaintext = TestUtil.getRandomBytes(37 * segmentSize + 11);
+    final int sealedLength = plaintext.length + 38 * TAG_LENGTH;
+
+    final long stream = sneakyInvoke(SPI_CLASS, "newStream", key, iv, aad, aad.length);
+    try {
+      final byte[] serial = new byte[sealedLength];
+      assertEquals(sealedLength, seal(stream, segmentSize, 1, plaintext, serial));
+      final byte[] threaded = new byte[sealedLength];
+      assertEquals(sealedLength, seal(stream, segmentSize, threads, plaintext, threaded));
+      assertArrayEquals(serial, threaded);
+
+      final byte[] opened = new byte[plaintext.length];
+      assertEquals(plaintext.length, open(stream, segmentSize, threads, serial, opened));
+      assertArrayEquals(plaintext, opened);
+
+      // A bad tag in any segment fails the whole call and releases no plaintext
+      serial[20 * (segmentSize + TAG_LENGTH) + 3] ^= 1;
+      assertThrows(
+          AEADBadTagException.class, () -> open(stream, segmentSize, threads, serial, opened));
+      assertArrayEquals(new byte[opened.length], opened);
+    } finally {
+      sneakyInvoke(SPI_CLASS, "freeStream", stream);
+    }
+  }
+
+  @Test
+  public void callsSpanningSeveralWindowsMatchSerial() throws Throwable {
+    // The native code borrows Java memory for 4 MiB of input per thread at a time, so with 1 MiB
+    // segments these calls are processed in several windows.
+    final int segmentSize = 1024 * 1024;
+    final byte[] key = TestUtil.getRandomBytes(16);
+    final byte[] iv = TestUtil.getRandomBytes(16);
+    final byte[] plaintext = TestUtil.getRandomBytes(9 * segmentSize + segmentSize / 2);
+    final int sealedLength = plaintext.length + 10 * TAG_LENGTH;
+
+    final long stream = sneakyInvoke(SPI_CLASS, "newStream", key, iv, new byte[0], 0);
+    try {
+      final byte[] serial = new byte[sealedLength];
+      assertEquals(sealedLength, seal(stream, segmentSize, 1, plaintext, serial));
+      final byte[] threaded = new byte[sealedLength];
+      assertEquals(sealedLength, seal(stream, segmentSize, 3, plaintext, threaded));
+      assertArrayEquals(serial, threaded);
+
+      final byte[] opened = new byte[plaintext.length];
+      assertEquals(plaintext.length, open(stream, segmentSize, 1, serial, opened));
+      assertArrayEquals(plaintext, opened);
+
+      // A bad tag in the last window also clears the plaintext of the earlier ones
+      serial[sealedLength - 1] ^= 1;
+      assertThrows(AEADBadTagException.class, () -> open(stream, segmentSize, 1, serial, opened));
+      assertArrayEquals(new byte[opened.length], opened);
+    } finally {
+      sneakyInvoke(SPI_CLASS, "freeStream", stream);
+    }
+  }
+
+  private static int seal(
+      final long stream,
+      final int segmentSize,
+      final int threads,
+      final byte[] input,
+      final byte[] output)
+      throws Throwable {
+    return sneakyInvoke_int(
+        SPI_CLASS,
+        "sealSegments",
+        stream,
+        segmentSize,
+        0L,
+        true,
+        threads,
+        input,
+        0,
+        input.length,
+        output,
+        0);
+  }
+
+  private static int open(
+      final long stream,
+      final int segmentSize,
+      final int threads,
+      final byte[] input,
+      final byte[] output)
+      throws Throwable {
+    return sneakyInvoke_int(
+        SPI_CLASS,
+        "openSegments",
+        stream,
+        segmentSize,
+        0L,
+        true,
+        threads,
+        input,
+        0,
+        input.length,
+        output,
+        0);
+  }
+
+  @Test
+  public void badParameters() throws Exception {
+    final Cipher cipher = Cipher.getInstance(ALGORITHM, TestUtil.NATIVE_PROVIDER);
+    final SecretKey key = new SecretKeySpec(TestUtil.getRandomBytes(16), "AES");
+    assertThrows(
+        InvalidKeyException.class,
+        () ->
+            cipher.init(
+                Cipher.ENCRYPT_MODE,
+                new SecretKeySpec(new byte[20], "AES"),
+                new IvParameterSpec(new byte[16])));
+    assertThrows(
+        InvalidAlgorithmParameterException.class,
+        () -> cipher.init(Cipher.ENCRYPT_MODE, key, new IvParameterSpec(new byte[12])));
+    assertThrows(InvalidKeyException.class, () -> cipher.init(Cipher.DECRYPT_MODE, key));
+
+    final byte[] iv = TestUtil.getRandomBytes(16);
+    cipher.init(Cipher.ENCRYPT_MODE, key, new IvParameterSpec(iv));
+    cipher.update(new byte[1]);
+    assertThrows(IllegalStateException.class, () -> cipher.updateAAD(new byte[1]));
+    cipher.doFinal();
+    assertThrows(IllegalStateException.class, () -> cipher.doFinal());
+    assertThrows(
+        InvalidAlgorithmParameterException.class,
+        () -> cipher.init(Cipher.ENCRYPT_MODE, key, new IvParameterSpec(iv)));
+
+    // A random IV is generated when none is supplied
+    cipher.init(Cipher.ENCRYPT_MODE, key);
+    assertFalse(Arrays.equals(iv, cipher.getIV()));
+  }
+}
@@ -0,0 +1,210 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider.test;
+
+import static com.amazon.corretto.crypto.provider.test.TestUtil.NATIVE_PROVIDER;
+import static com.amazon.corretto.crypto.provider.test.TestUtil.assertArraysHexEquals;
+import static com.amazon.corretto.crypto.provider.test.TestUtil.assertThrows;
+import static org.junit.jupiter.api.Assertions.assertEquals;
+
+import java.nio.ByteBuffer;
+import java.security.InvalidAlgorithmParameterException;
+import java.security.InvalidKeyException;
+import java.security.spec.AlgorithmParameterSpec;
+import javax.crypto.Cipher;
+import javax.crypto.Mac;
+import javax.crypto.SecretKey;
+import javax.crypto.spec.GCMParameterSpec;
+import javax.crypto.spec.IvParameterSpec;
+import javax.crypto.spec.SecretKeySpec;
+import org.junit.jupiter.api.Test;
+import org.junit.jupiter.api.extension.ExtendWith;
+import org.junit.jupiter.api.parallel.Execution;
+import org.junit.jupiter.api.parallel.ExecutionMode;
+import org.junit.jupiter.api.parallel.ResourceAccessMode;
+import org.junit.jupiter.api.parallel.ResourceLock;
+import org.junit.jupiter.params.ParameterizedTest;
+import org.junit.jupiter.params.provider.ValueSource;
+
+@Execution(ExecutionMode.CONCURRENT)
+@ExtendWith(TestResultLogger.class)
+@ResourceLock(value = TestUtil.RESOURCE_GLOBAL, mode = ResourceAccessMode.READ)
+public class AesMacTest {
+  // Message lengths around the block size and the Java side input buffer size
+  private static final int[] LENGTHS = {0, 1, 15, 16, 17, 40, 64, 1023, 1024, 1025, 5000};
+
+  private static SecretKey randomKey(final int keyBits) {
+    return new SecretKeySpec(TestUtil.getRandomBytes(keyBits / 8), "AES");
+  }
+
+  private static AlgorithmParameterSpec paramsFor(final String algorithm) {
+    return algorithm.equals("AESGMAC") ? new IvParameterSpec(TestUtil.getRandomBytes(12)) : null;
+  }
+
+  @Test
+  public void cmacKnownAnswers() throws Exception {
+    // RFC 4493, section 4
+    final SecretKey key =
+        new SecretKeySpec(TestUtil.decodeHex("2b7e151628aed2a6abf7158809cf4f3c"), "AES");
+    final byte[] message =
+        TestUtil.decodeHex(
+            "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+                + "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710");
+    final Mac mac = Mac.getInstance("AESCMAC", NATIVE_PROVIDER);
+    mac.init(key);
+    assertArraysHexEquals(
+        TestUtil.decodeHex("bb1d6929e95937287fa37d129b756746"), mac.doFinal());
+    mac.update(message, 0, 16);
+    assertArraysHexEquals(
+        TestUtil.decodeHex("070a16b46b4d4144f79bdd9dd04a287c"), mac.doFinal());
+    mac.update(message, 0, 40);
+    assertArraysHexEquals(
+        TestUtil.decodeHex("dfa66747de9ae63030ca32611497c827"), mac.doFinal());
+    assertArraysHexEquals(
+        TestUtil.decodeHex("51f0bebf7e3b9d92fc49741779363cfe"), mac.doFinal(message));
+    assertEquals(16, mac.getMacLength());
+  }
+
+  @ParameterizedTest
+  @ValueSource(ints = {128, 192, 256})
+  public void cmacMatchesBouncyCastle(final int keyBits) throws Exception {
+    final SecretKey key = randomKey(keyBits);
+    final Mac nativeMac = Mac.getInstance("AES-CMAC", NATIVE_PROVIDER);
+    final Mac bcMac = Mac.getInstance("AESCMAC", TestUtil.BC_PROVIDER);
+    nativeMac.init(key);
+    bcMac.init(key);
+    for (final int length : LENGTHS) {
+      final byte[] message = TestUtil.getRandomBytes(length);
+      assertArraysHexEquals(bcMac.doFinal(message), nativeMac.doFinal(message));
+    }
+  }
+
+  @ParameterizedTest
+  @ValueSource(ints = {128, 192, 256})
+  public void gmacMatchesGcm(final int keyBits) throws Exception {
+    final SecretKey key = randomKey(keyBits);
+    final Mac mac = Mac.getInstance("AES-GMAC", NATIVE_PROVIDER);
+    final Cipher gcm = Cipher.getInstance("AES/GCM/NoPadding", NATIVE_PROVIDER);
+    for (final int ivLength : new int[] {12, 16, 8}) {
+      for (final int length : LENGTHS) {
+        final byte[] iv = TestUtil.getRandomBytes(ivLength);
+        final byte[] message = TestUtil.getRandomBytes(length);
+        mac.init(key, new GCMParameterSpec(128, iv));
+        gcm.init(Cipher.ENCRYPT_MODE, key, new GCMParameterSpec(128, iv));
+        gcm.updateAAD(message);
+        assertArraysHexEquals(gcm.doFinal(), mac.doFinal(message));
+      }
+    }
+  }
+
+  @Test
+  public void gmacMatchesBouncyCastle() throws Exception {
+    final SecretKey key = randomKey(256);
+    final IvParameterSpec iv = new IvParameterSpec(TestUtil.getRandomBytes(12));
+    final Mac nativeMac = Mac.getInstance("AESGMAC", NATIVE_PROVIDER);
+    final Mac bcMac = Mac.getInstance("AES-GMAC", TestUtil.BC_PROVIDER);
+    nativeMac.init(key, iv);
+    bcMac.init(key, iv);
+    for (final int length : LENGTHS) {
+      final byte[] message = TestUtil.getRandomBytes(length);
+      assertArraysHexEquals(bcMac.doFinal(message), nativeMac.doFinal(message));
+    }
+  }
+
+  @ParameterizedTest
+  @ValueSource(strings = {"AESCMAC", "AESGMAC"})
+  public void incrementalAndDirectUpdates(final String algorithm) throws Exception {
+    final SecretKey key = randomKey(128);
+    final AlgorithmParameterSpec params = paramsFor(algorithm);
+    final Mac mac = Mac.getInstance(algorithm, NATIVE_PROVIDER);
+    mac.init(key, params);
+    final byte[] message = TestUtil.getRandomBytes(10000);
+    final byte[] expected = mac.doFinal(message);
+
+    // Chunks of several sizes, alternating arrays, single bytes and direct buffers
+    final ByteBuffer direct = ByteBuffer.allocateDirect(message.length);
+    direct.put(message).flip();
+    int pos = 0;
+    int step = 0;
+    while (pos < message.length) {
+      final int chunk = Math.min(message.length - pos, new int[] {1, 7, 1500, 300, 2048}[step % 5]);
+      switch (step % 3) {
+        case 0:
+          mac.update(message, pos, chunk);
+          break;
+        case 1:
+          mac.update((ByteBuffer) direct.duplicate().position(pos).limit(pos + chunk));
+          break;
+        default:
+          for (int i = 0; i < chunk; i++) {
+            mac.update(message[pos + i]);
+          }
+      }
+      pos += chunk;
+      step++;
+    }
+    assertArraysHexEquals(expected, mac.doFinal());
+
+    // A message which starts with a large direct buffer
+    mac.update(direct.duplicate());
+    assertArraysHexEquals(expected, mac.doFinal());
+  }
+
+  @ParameterizedTest
+  @ValueSource(strings = {"AESCMAC", "AESGMAC"})
+  public void cloneAndRekey(final String algorithm) throws Exception {
+    final SecretKey key1 = randomKey(128);
+    final SecretKey key2 = randomKey(256);
+    final AlgorithmParameterSpec params = paramsFor(algorithm);
+    final Mac mac = Mac.getInstance(algorithm, NATIVE_PROVIDER);
+    final Mac reference = Mac.getInstance(algorithm, NATIVE_PROVIDER);
+    final byte[] prefix = TestUtil.getRandomBytes(2000);
+    final byte[] suffix1 = TestUtil.getRandomBytes(30);
+    final byte[] suffix2 = TestUtil.getRandomBytes(3000);
+
+    mac.init(key1, params);
+    reference.init(key1, params);
+    mac.update(prefix);
+    final Mac clone = (Mac) mac.clone();
+    mac.update(suffix1);
+    clone.update(suffix2);
+    reference.update(prefix);
+    reference.update(suffix1);
+    assertArraysHexEquals(reference.doFinal(), mac.doFinal());
+    reference.update(prefix);
+    reference.update(suffix2);
+    assertArraysHexEquals(reference.doFinal(), clone.doFinal());
+
+    // Switching keys, and back again, must not leak state between keys
+    final byte[] withKey1 = mac.doFinal(suffix1);
+    mac.init(key2, params);
+    reference.init(key2, params);
+    assertArraysHexEquals(reference.doFinal(suffix1), mac.doFinal(suffix1));
+    mac.init(key1, params);
+    assertArraysHexEquals(withKey1, mac.doFinal(suffix1));
+  }
+
+  @Test
+  public void badInitialization() throws Exception {
+    final Mac cmac = Mac.getInstance("AESCMAC", NATIVE_PROVIDER);
+    assertThrows(IllegalStateException.class, () -> cmac.update(new byte[1]));
+    assertThrows(
+        InvalidKeyException.class,
+        () -> cmac.init(new SecretKeySpec(TestUtil.getRandomBytes(20), "AES")));
+    assertThrows(
+        InvalidAlgorithmParameterException.class,
+        () -> cmac.init(randomKey(128), new IvParameterSpec(new byte[16])));
+
+    final Mac gmac = Mac.getInstance("AESGMAC", NATIVE_PROVIDER);
+    assertThrows(InvalidAlgorithmParameterException.class, () -> gmac.init(randomKey(128)));
+    assertThrows(
+        InvalidAlgorithmParameterException.class,
+        () -> gmac.init(randomKey(128), new GCMParameterSpec(96, new byte[12])));
+    assertThrows(
+        InvalidKeyException.class,
+        () ->
+            gmac.init(
+                new SecretKeySpec(TestUtil.getRandomBytes(8), "AES"),
+                new IvParameterSpec(new byte[12])));
+  }
+}
@@ -15,7 +15,9 @@ import static org.junit.jupiter.api.Assertions.assertEquals;
 import static org.junit.jupiter.api.Assertions.assertFalse;
 import static org.junit.jupiter.api.Assertions.assertNotNull;
 import static org.junit.jupiter.api.Assertions.assertNull;
+import static org.junit.jupiter.api.Assertions.assertTrue;
 
+import com.amazon.corretto.crypto.provider.RuntimeCryptoException;
 import java.io.ByteArrayOutputStream;
 import java.math.BigInteger;
 import java.nio.ByteBuffer;
@@ -30,7 +32,9 @@ import java.security.SecureRandom;
 import java.security.spec.AlgorithmParameterSpec;
 import java.util.ArrayList;
 import java.util.Arrays;
+import java.util.HashSet;
 import java.util.List;
+import java.util.Set;
 import java.util.concurrent.ThreadLocalRandom;
 import javax.crypto.AEADBadTagException;
 import javax.crypto.Cipher;
@@ -946,6 +950,295 @@ public class AesTest {
     }
   }
 
+  @Test
+  public void testBadAEADTagException_directByteBuffer() throws Throwable {
+    final SecureRandom rnd = TestUtil.MISC_SECURE_RANDOM.get();
+
+    Cipher c = Cipher.getInstance(ALGO_NAME, PROVIDER_SUN);
+    GCMParameterSpec algorithmParameterSpec = new GCMParameterSpec(128, randomIV());
+    c.init(Cipher.ENCRYPT_MODE, key, algorithmParameterSpec, rnd);
+
+    byte[] plaintext = TestUtil.getRandomBytes(100);
+    byte[] data = c.doFinal(plaintext);
+
+    for (int bit = 0; bit < data.length * 8; bit += 7) {
+      byte[] corruptData = data.clone();
+      corruptData[bit / 8] ^= (1 << (bit % 8));
+      ByteBuffer corruptBuff = ByteBuffer.allocateDirect(corruptData.length);
+      corruptBuff.put(corruptData).flip();
+      // Unverified plaintext never reaches the output buffer, not even transiently, so its previous
+      // contents survive a failed decryption
+      final byte[] previous = new byte[plaintext.length + 4];
+      Arrays.fill(previous, (byte) 0x55);
+      ByteBuffer outputBuff = ByteBuffer.allocateDirect(previous.length);
+      outputBuff.put(previous);
+      outputBuff.position(4);
+
+      Cipher check = Cipher.getInstance(ALGO_NAME, NATIVE_PROVIDER);
+      check.init(Cipher.DECRYPT_MODE, key, algorithmParameterSpec, rnd);
+
+      assertThrows(AEADBadTagException.class, () -> check.doFinal(corruptBuff, outputBuff));
+      byte[] output = new byte[outputBuff.capacity()];
+      outputBuff.duplicate().clear().get(output);
+      assertArrayEquals(previous, output);
+    }
+  }
+
+  @Test
+  public void directByteBuffers_matchJce() throws Throwable {
+    final SecureRandom rnd = TestUtil.MISC_SECURE_RANDOM.get();
+    final byte[] aad = TestUtil.getRandomBytes(37);
+
+    for (final int length : new int[] {0, 1, 16, 1000, 70000}) {
+      final byte[] plaintext = TestUtil.getRandomBytes(length);
+      final GCMParameterSpec spec = new GCMParameterSpec(128, randomIV());
+
+      final Cipher jce = Cipher.getInstance(ALGO_NAME, PROVIDER_SUN);
+      jce.init(Cipher.ENCRYPT_MODE, key, spec, rnd);
+      jce.updateAAD(aad);
+      final byte[] expected = jce.doFinal(plaintext);
+
+      // Encrypt in two steps so that both the update and final direct paths are exercised.
+      final Cipher amzn = Cipher.getInstance(ALGO_NAME, NATIVE_PROVIDER);
+      amzn.init(Cipher.ENCRYPT_MODE, key, spec, rnd);
+      final ByteBuffer directAad = ByteBuffer.allocateDirect(aad.length);
+      directAad.put(aad).flip();
+      amzn.updateAAD(directAad);
+      assertEquals(0, directAad.remaining());
+
+      final ByteBuffer input = ByteBuffer.allocateDirect(length);
+      input.put(plaintext).flip();
+      final ByteBuffer ciphertext = ByteBuffer.allocateDirect(expected.length);
+      input.limit(length / 2);
+      amzn.update(input, ciphertext);
+      input.limit(length);
+      amzn.doFinal(input, ciphertext);
+      assertEquals(0, input.remaining());
+      assertEquals(expected.length, ciphertext.position());
+
+      final byte[] actual = new byte[expected.length];
+      ciphertext.flip();
+      ciphertext.duplicate().get(actual);
+      assertArraysHexEquals(expected, actual);
+
+      // Decrypt the same direct buffer one-shot.
+      amzn.init(Cipher.DECRYPT_MODE, key, spec, rnd);
+      amzn.updateAAD(aad);
+      final ByteBuffer decrypted = ByteBuffer.allocateDirect(length);
+      assertEquals(length, amzn.doFinal(ciphertext, decrypted));
+      final byte[] roundTrip = new byte[length];
+      decrypted.flip();
+      decrypted.get(roundTrip);
+      assertArrayEquals(plaintext, roundTrip);
+    }
+  }
+
+  @Test
+  public void keyCache_sharesEntriesByKeyValue() throws Throwable {
+    final Class<?> cacheClass =
+        Class.forName("com.amazon.corretto.crypto.provider.AesGcmKeyCache");
+    final byte[] keyBytes = TestUtil.getRandomBytes(16);
+
+    final long first = sneakyInvoke(cacheClass, "acquireEntry", 4, keyBytes);
+    final long second = sneakyInvoke(cacheClass, "acquireEntry", 4, keyBytes.clone());
+    final long other = sneakyInvoke(cacheClass, "acquireEntry", 4, TestUtil.getRandomBytes(32));
+    try {
+      assertEquals(first, second);
+      assertFalse(first == other);
+
+      // A context cloned from the cache must behave like one keyed directly.
+      final long ctx = sneakyInvoke(cacheClass, "newContext", first, 12);
+      assertFalse(ctx == 0);
+      sneakyInvoke(cacheClass, "copyToContext", other, ctx, 16);
+      sneakyInvoke(
+          Class.forName("com.amazon.corretto.crypto.provider.Utils"), "releaseEvpCipherCtx", ctx);
+
+      assertThrows(
+          RuntimeCryptoException.class,
+          () -> sneakyInvoke(cacheClass, "acquireEntry", 4, new byte[15]));
+    } finally {
+      sneakyInvoke(cacheClass, "releaseEntry", first);
+      sneakyInvoke(cacheClass, "releaseEntry", second);
+      sneakyInvoke(cacheClass, "releaseEntry", other);
+    }
+  }
+
+  @Test
+  public void deterministicIvGenerator_countsAndFailsWhenExhausted() throws Throwable {
+    final long gen = sneakyInvoke(SPI_CLASS, "ivGeneratorNew", 0x01020304, 0);
+    final long nearlyExhausted = sneakyInvoke(SPI_CLASS, "ivGeneratorNew", 0x01020304, -1);
+    try {
+      final byte[] first = new byte[12];
+      final byte[] second = new byte[12];
+      sneakyInvoke(SPI_CLASS, "ivGeneratorNext", gen, first);
+      sneakyInvoke(SPI_CLASS, "ivGeneratorNext", gen, second);
+      // The supplied fixed field and the generator number, followed by the big-endian counter
+      assertArrayEquals(new byte[] {1, 2, 3, 4}, Arrays.copyOf(first, 4));
+      assertArrayEquals(Arrays.copyOf(first, 8), Arrays.copyOf(second, 8));
+      assertArrayEquals(new byte[4], Arrays.copyOfRange(first, 8, 12));
+      assertArrayEquals(new byte[] {0, 0, 0, 1}, Arrays.copyOfRange(second, 8, 12));
+
+      final byte[] last = new byte[12];
+      sneakyInvoke(SPI_CLASS, "ivGeneratorNext", nearlyExhausted, last);
+      assertArrayEquals(new byte[] {-1, -1, -1, -1}, Arrays.copyOfRange(last, 8, 12));
+      assertFalse(Arrays.equals(Arrays.copyOf(first, 8), Arrays.copyOf(last, 8)));
+      assertThrows(
+          IllegalStateException.class,
+          () -> sneakyInvoke(SPI_CLASS, "ivGeneratorNext", nearlyExhausted, new byte[12]));
+      assertThrows(
+          IllegalArgumentException.class,
+          () -> sneakyInvoke(SPI_CLASS, "ivGeneratorNext", gen, new byte[16]));
+    } finally {
+      sneakyInvoke(SPI_CLASS, "ivGeneratorRelease", gen);
+      sneakyInvoke(SPI_CLASS, "ivGeneratorRelease", nearlyExhausted);
+    }
+  }
+
+  @Test
+  public void deterministicIvGenerator_sharedPerKeyWithUniqueGeneratorNumbers() throws Throwable {
+    // Every user of a key shares one counter, so no two of them ever get the same IV
+    final int fixedField = 0x0a0b0c0d;
+    final byte[] keyBytes = key.getEncoded();
+    final long[] gens = new long[5000];
+    final Set<ByteBuffer> ivs = new HashSet<>();
+    final Set<ByteBuffer> prefixes = new HashSet<>();
+    try {
+      for (int i = 0; i < gens.length; i++) {
+        gens[i] = sneakyInvoke(SPI_CLASS, "ivGeneratorAcquire", keyBytes, fixedField);
+        final byte[] iv = new byte[12];
+        sneakyInvoke(SPI_CLASS, "ivGeneratorNext", gens[i], iv);
+        assertTrue(ivs.add(ByteBuffer.wrap(iv)), "Repeated IV");
+        assertArrayEquals(new byte[] {0x0a, 0x0b, 0x0c, 0x0d}, Arrays.copyOf(iv, 4));
+        prefixes.add(ByteBuffer.wrap(Arrays.copyOf(iv, 8)));
+      }
+      assertEquals(1, prefixes.size());
+
+      // Other keys, other fixed fields, and unshared generators, never get a generator number which
+      // is already in use
+      final byte[] otherKey = keyBytes.clone();
+      otherKey[0] ^= 1;
+      final long other = sneakyInvoke(SPI_CLASS, "ivGeneratorAcquire", otherKey, fixedField);
+      final long otherFixed = sneakyInvoke(SPI_CLASS, "ivGeneratorAcquire", keyBytes, 0x01020304);
+      final long unshared = sneakyInvoke(SPI_CLASS, "ivGeneratorNew", fixedField, 0);
+      try {
+        for (final long gen : new long[] {other, otherFixed, unshared}) {
+          final byte[] iv = new byte[12];
+          sneakyInvoke(SPI_CLASS, "ivGeneratorNext", gen, iv);
+          assertTrue(prefixes.add(ByteBuffer.wrap(Arrays.copyOf(iv, 8))));
+        }
+      } finally {
+        sneakyInvoke(SPI_CLASS, "ivGeneratorRelease", other);
+        sneakyInvoke(SPI_CLASS, "ivGeneratorRelease", otherFixed);
+        sneakyInvoke(SPI_CLASS, "ivGeneratorRelease", unshared);
+      }
+    } finally {
+      for (final long gen : gens) {
+        if (gen != 0) {
+          sneakyInvoke(SPI_CLASS, "ivGeneratorRelease", gen);
+        }
+      }
+    }
+  }
+
+  @Test
+  public void initWithoutIv_manyCiphersUnderOneKeyNeverRepeatIvs() throws Throwable {
+    // Short-lived Ciphers under a single key, as created per request by many applications. This
+    // holds for random IVs and, when aesGcmDeterministicIv is set, for deterministic ones.
+    final Set<ByteBuffer> ivs = new HashSet<>();
+    for (int i = 0; i < 5000; i++) {
+      final Cipher cipher = Cipher.getInstance(ALGO_NAME, NATIVE_PROVIDER);
+      cipher.init(Cipher.ENCRYPT_MODE, key);
+      cipher.doFinal(PLAINTEXT);
+      assertTrue(ivs.add(ByteBuffer.wrap(cipher.getIV())), "Repeated IV");
+    }
+  }
+
+  @Test
+  public void initWithoutIv_producesUsableDistinctIvs() throws Throwable {
+    // Covers both random IVs and, when aesGcmDeterministicIv is set, deterministic ones. The latter
+    // are produced by the seal call itself or, for getIV() before doFinal, by a separate call.
+    // Deterministic IVs are only used when the fixed field is configured too
+    final String fixedField =
+        System.getProperty("com.amazon.corretto.crypto.provider.aesGcmDeterministicIvFixedField");
+    final boolean deterministic =
+        Boolean.getBoolean("com.amazon.corretto.crypto.provider.aesGcmDeterministicIv")
+            && fixedField != null;
+    final Cipher decrypt = Cipher.getInstance(ALGO_NAME, NATIVE_PROVIDER);
+    final List<byte[]> ivs = new ArrayList<>();
+    for (int i = 0; i < 4; i++) {
+      amznC.init(Cipher.ENCRYPT_MODE, key);
+      final byte[] early = i % 2 == 0 ? amznC.getIV() : null;
+      final byte[] ciphertext = amznC.doFinal(PLAINTEXT);
+      final byte[] iv = amznC.getIV();
+      if (early != null) {
+        assertArrayEquals(early, iv);
+      }
+      assertEquals(12, iv.length);
+
+      decrypt.init(Cipher.DECRYPT_MODE, key, new GCMParameterSpec(128, iv));
+      assertArrayEquals(PLAINTEXT, decrypt.doFinal(ciphertext));
+      for (final byte[] previous : ivs) {
+        assertFalse(Arrays.equals(previous, iv));
+      }
+      if (deterministic) {
+        assertEquals(
+            Long.parseLong(fixedField, 16), new BigInteger(1, Arrays.copyOf(iv, 4)).longValue());
+      }
+      if (deterministic && !ivs.isEmpty()) {
+        final byte[] previous = ivs.get(ivs.size() - 1);
+        assertArrayEquals(Arrays.copyOf(previous, 8), Arrays.copyOf(iv, 8));
+        assertEquals(
+            new BigInteger(1, Arrays.copyOfRange(previous, 8, 12)).add(BigInteger.ONE),
+            new BigInteger(1, Arrays.copyOfRange(iv, 8, 12)));
+      }
+      ivs.add(iv);
+    }
+  }
+
+  @Test
+  public void aeadFastPath_interleavedWithStreamingAndKeyChanges() throws Throwable {
+    // One-shot operations with a 12-byte IV and a 16-byte tag go through EVP_AEAD, everything else
+    // through EVP_CIPHER. Switching between the two while changing keys must never use stale keys.
+    final SecretKey key1 = new SecretKeySpec(TestUtil.getRandomBytes(16), "AES");
+    final SecretKey key2 = new SecretKeySpec(TestUtil.getRandomBytes(32), "AES");
+    final byte[] plaintext = TestUtil.getRandomBytes(100);
+    final byte[] aad = TestUtil.getRandomBytes(13);
+    final Cipher accp = Cipher.getInstance(ALGO_NAME, NATIVE_PROVIDER);
+    final Cipher jce = Cipher.getInstance(ALGO_NAME, PROVIDER_SUN);
+
+    final SecretKey[] keys = {key1, key1, key2, key2, key1, key2, key2};
+    for (int i = 0; i < keys.length; i++) {
+      final GCMParameterSpec spec = new GCMParameterSpec(128, TestUtil.getRandomBytes(12));
+      jce.init(Cipher.ENCRYPT_MODE, keys[i], spec);
+      accp.init(Cipher.ENCRYPT_MODE, keys[i], spec);
+      final boolean streaming = i % 2 == 1;
+      if (streaming) {
+        jce.updateAAD(aad);
+        accp.updateAAD(aad);
+      }
+      final byte[] ciphertext = jce.doFinal(plaintext);
+      assertArrayEquals(ciphertext, accp.doFinal(plaintext));
+
+      // Decryption with AAD buffered in Java still takes the one-shot path.
+      accp.init(Cipher.DECRYPT_MODE, keys[i], spec);
+      if (streaming) {
+        accp.updateAAD(aad);
+      }
+      assertArrayEquals(plaintext, accp.doFinal(ciphertext));
+
+      ciphertext[i] ^= 1;
+      accp.init(Cipher.DECRYPT_MODE, keys[i], spec);
+      if (streaming) {
+        accp.updateAAD(aad);
+      }
+      final byte[] output = new byte[plaintext.length];
+      assertThrows(
+          AEADBadTagException.class,
+          () -> accp.doFinal(ciphertext, 0, ciphertext.length, output));
+      assertArrayEquals(new byte[plaintext.length], output);
+    }
+  }
+
   @Test
   public void whenCipherReusedWithoutReinit_throwsIVReuseException() throws Throwable {
     final SecureRandom rnd = TestUtil.MISC_SECURE_RANDOM.get();
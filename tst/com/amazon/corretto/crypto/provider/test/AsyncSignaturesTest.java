@@ -0,0 +1,224 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider.test;
+
+import static com.amazon.corretto.crypto.provider.test.TestUtil.assertThrows;
+import static org.junit.jupiter.api.Assertions.assertEquals;
+import static org.junit.jupiter.api.Assertions.assertFalse;
+import static org.junit.jupiter.api.Assertions.assertTrue;
+import static org.junit.jupiter.api.Assertions.fail;
+
+import com.amazon.corretto.crypto.provider.AsyncSignatures;
+import java.security.InvalidKeyException;
+import java.security.KeyPair;
+import java.security.KeyPairGenerator;
+import java.security.NoSuchAlgorithmException;
+import java.security.Signature;
+import java.security.SignatureException;
+import java.security.spec.ECGenParameterSpec;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+import java.util.concurrent.CompletableFuture;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.Future;
+import java.util.concurrent.TimeUnit;
+import org.junit.jupiter.api.Test;
+import org.junit.jupiter.api.extension.ExtendWith;
+import org.junit.jupiter.api.parallel.Execution;
+import org.junit.jupiter.api.parallel.ExecutionMode;
+import org.junit.jupiter.api.parallel.ResourceAccessMode;
+import org.junit.jupiter.api.parallel.ResourceLock;
+import org.junit.jupiter.params.ParameterizedTest;
+import org.junit.jupiter.params.provider.ValueSource;
+
+@Execution(ExecutionMode.CONCURRENT)
+@ExtendWith(TestResultLogger.class)
+@ResourceLock(value = TestUtil.RESOURCE_GLOBAL, mode = ResourceAccessMode.READ)
+public class AsyncSignaturesTest {
+  private static final long TIMEOUT_SECONDS = 60;
+
+  private static KeyPair keyPair(final String algorithm) throws Exception {
+    final String keyAlgorithm;
+    if (algorithm.contains("withRSA")) {
+      keyAlgorithm = "RSA";
+    } else if (algorithm.contains("withECDSA")) {
+      keyAlgorithm = "EC";
+    } else {
+      keyAlgorithm = algorithm;
+    }
+    return KeyPairGenerator.getInstance(keyAlgorithm, TestUtil.NATIVE_PROVIDER).generateKeyPair();
+  }
+
+  private static <T> T get(final Future<T> future) throws Exception {
+    return future.get(TIMEOUT_SECONDS, TimeUnit.SECONDS);
+  }
+
+  private static void assertFailsWith(
+      final Class<? extends Throwable> expected, final Future<?> future) throws Exception {
+    try {
+      get(future);
+      fail("Expected " + expected.getSimpleName());
+    } catch (final ExecutionException ex) {
+      assertTrue(expected.isInstance(ex.getCause()), String.valueOf(ex.getCause()));
+    }
+  }
+
+  @ParameterizedTest
+  @ValueSource(
+      strings = {
+        "SHA1withRSA",
+        "SHA256withRSA",
+        "SHA512withRSA",
+        "SHA256withECDSA",
+        "SHA384withECDSA",
+        "SHA256withECDSAinP1363Format",
+        "Ed25519"
+      })
+  public void matchesSignature(final String algorithm) throws Exception {
+    final KeyPair pair = keyPair(algorithm);
+    final Signature jce = Signature.getInstance(algorithm, TestUtil.NATIVE_PROVIDER);
+    final byte[] message = TestUtil.getRandomBytes(1000);
+
+    final byte[] signature = get(AsyncSignatures.sign(algorithm, pair.getPrivate(), message));
+    jce.initVerify(pair.getPublic());
+    jce.update(message);
+    assertTrue(jce.verify(signature));
+
+    jce.initSign(pair.getPrivate());
+    jce.update(message, 10, 500);
+    final byte[] jceSignature = jce.sign();
+    final CompletableFuture<Boolean> jceVerified =
+        AsyncSignatures.verify(
+            algorithm, pair.getPublic(), message, 10, 500, jceSignature, 0, jceSignature.length);
+    assertTrue(get(jceVerified));
+    assertTrue(get(AsyncSignatures.verify(algorithm, pair.getPublic(), message, signature)));
+
+    // Signatures over other messages, and corrupted signatures, do not verify
+    assertFalse(get(AsyncSignatures.verify(algorithm, pair.getPublic(), message, jceSignature)));
+    final byte[] corrupted = signature.clone();
+    corrupted[corrupted.length - 1] ^= 1;
+    assertFalse(get(AsyncSignatures.verify(algorithm, pair.getPublic(), message, corrupted)));
+  }
+
+  @Test
+  public void inputsAreCopiedOnSubmission() throws Exception {
+    final KeyPair pair = keyPair("SHA384withRSA");
+    final byte[] message = TestUtil.getRandomBytes(256);
+    final byte[] original = message.clone();
+
+    final List<CompletableFuture<byte[]>> signatures = new ArrayList<>();
+    for (int i = 0; i < 64; i++) {
+      signatures.add(AsyncSignatures.sign("SHA384withRSA", pair.getPrivate(), message));
+    }
+    // Changing the message after submission must not affect queued operations
+    Arrays.fill(message, (byte) 0);
+
+    final Signature jce = Signature.getInstance("SHA384withRSA", TestUtil.NATIVE_PROVIDER);
+    jce.initVerify(pair.getPublic());
+    for (final CompletableFuture<byte[]> signature : signatures) {
+      jce.update(original);
+      assertTrue(jce.verify(get(signature)));
+    }
+  }
+
+  @Test
+  public void p1363SignaturesHaveFixedLength() throws Exception {
+    final KeyPairGenerator kpg = KeyPairGenerator.getInstance("EC", TestUtil.NATIVE_PROVIDER);
+    kpg.initialize(new ECGenParameterSpec("secp256r1"));
+    final KeyPair pair = kpg.generateKeyPair();
+    for (int i = 0; i < 32; i++) {
+      final byte[] signature =
+          get(
+              AsyncSignatures.sign(
+                  "SHA256withECDSAinP1363Format", pair.getPrivate(), TestUtil.getRandomBytes(i)));
+      assertEquals(64, signature.length);
+    }
+  }
+
+  @Test
+  public void failingDependentStagesDoNotStopWorkers() throws Exception {
+    final KeyPair pair = keyPair("SHA256withECDSA");
+    final byte[] message = TestUtil.getRandomBytes(100);
+
+    // Enough operations that every worker completes some of them
+    final List<CompletableFuture<Void>> stages = new ArrayList<>();
+    for (int i = 0; i < 8 * Runtime.getRuntime().availableProcessors(); i++) {
+      stages.add(
+          AsyncSignatures.sign("SHA256withECDSA", pair.getPrivate(), message)
+              .thenAccept(
+                  signature -> {
+                    throw new IllegalStateException("Failing dependent stage");
+                  }));
+    }
+    for (final CompletableFuture<Void> stage : stages) {
+      assertFailsWith(IllegalStateException.class, stage);
+    }
+
+    final byte[] signature =
+        get(AsyncSignatures.sign("SHA256withECDSA", pair.getPrivate(), message));
+    assertTrue(
+        get(AsyncSignatures.verify("SHA256withECDSA", pair.getPublic(), message, signature)));
+  }
+
+  @Test
+  public void blockingDependentStagesDoNotStallWorkers() throws Exception {
+    final KeyPair pair = keyPair("SHA256withECDSA");
+    final byte[] message = TestUtil.getRandomBytes(100);
+
+    // More blocking stages than there are workers. Each one waits for another asynchronous
+    // operation, which could never complete if the stages ran on the workers themselves.
+    final List<CompletableFuture<Boolean>> stages = new ArrayList<>();
+    for (int i = 0; i < 4 * Runtime.getRuntime().availableProcessors() + 8; i++) {
+      stages.add(
+          AsyncSignatures.sign("SHA256withECDSA", pair.getPrivate(), message)
+              .thenApply(
+                  signature -> {
+                    assertFalse(
+                        Thread.currentThread().getName().startsWith("ACCP async signature worker"));
+                    try {
+                      return get(
+                          AsyncSignatures.verify(
+                              "SHA256withECDSA", pair.getPublic(), message, signature));
+                    } catch (final Exception ex) {
+                      throw new AssertionError(ex);
+                    }
+                  }));
+    }
+    for (final CompletableFuture<Boolean> stage : stages) {
+      assertTrue(get(stage));
+    }
+  }
+
+  @Test
+  public void failuresCompleteExceptionally() throws Exception {
+    final KeyPair ec = keyPair("SHA256withECDSA");
+    final KeyPair rsa = keyPair("SHA256withRSA");
+    final byte[] message = TestUtil.getRandomBytes(100);
+
+    assertFailsWith(
+        NoSuchAlgorithmException.class,
+        AsyncSignatures.sign("SHA3-256withECDSA", ec.getPrivate(), message));
+    assertFailsWith(
+        NoSuchAlgorithmException.class,
+        AsyncSignatures.sign("RSASSA-PSS", rsa.getPrivate(), message));
+    assertFailsWith(
+        InvalidKeyException.class,
+        AsyncSignatures.sign("SHA256withRSA", ec.getPrivate(), message));
+    assertFailsWith(
+        InvalidKeyException.class,
+        AsyncSignatures.verify("SHA256withECDSA", rsa.getPublic(), message, message));
+    // P1363 signatures have a fixed length
+    assertFailsWith(
+        SignatureException.class,
+        AsyncSignatures.verify(
+            "SHA256withECDSAinP1363Format", ec.getPublic(), message, new byte[63]));
+
+    assertThrows(
+        ArrayIndexOutOfBoundsException.class,
+        () -> AsyncSignatures.sign("SHA256withECDSA", ec.getPrivate(), message, 90, 11));
+    assertThrows(
+        IllegalArgumentException.class,
+        () -> AsyncSignatures.sign("SHA256withECDSA", ec.getPrivate(), null, 0, 0));
+  }
+}
@@ -0,0 +1,249 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider.test;
+
+import static com.amazon.corretto.crypto.provider.test.TestUtil.assertThrows;
+import static org.junit.jupiter.api.Assertions.assertArrayEquals;
+import static org.junit.jupiter.api.Assertions.assertEquals;
+import static org.junit.jupiter.api.Assumptions.assumeTrue;
+
+import java.nio.charset.StandardCharsets;
+import java.security.GeneralSecurityException;
+import java.security.InvalidAlgorithmParameterException;
+import java.security.InvalidKeyException;
+import java.util.Arrays;
+import javax.crypto.AEADBadTagException;
+import javax.crypto.Cipher;
+import javax.crypto.SecretKey;
+import javax.crypto.spec.IvParameterSpec;
+import javax.crypto.spec.SecretKeySpec;
+import org.junit.jupiter.api.Test;
+import org.junit.jupiter.api.condition.DisabledIf;
+import org.junit.jupiter.api.extension.ExtendWith;
+import org.junit.jupiter.api.parallel.Execution;
+import org.junit.jupiter.api.parallel.ExecutionMode;
+import org.junit.jupiter.api.parallel.ResourceAccessMode;
+import org.junit.jupiter.api.parallel.ResourceLock;
+
+@DisabledIf("com.amazon.corretto.crypto.provider.test.ChaCha20Poly1305Test#isDisabled")
+@Execution(ExecutionMode.CONCURRENT)
+@ExtendWith(TestResultLogger.class)
+@ResourceLock(value = TestUtil.RESOURCE_GLOBAL, mode = ResourceAccessMode.READ)
+public class ChaCha20Poly1305Test {
+  private static final String ALGORITHM = "ChaCha20-Poly1305";
+  private static final int TAG_LENGTH = 16;
+
+  // RFC 8439, section 2.8.2
+  private static final byte[] RFC_KEY =
+      TestUtil.decodeHex("808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f");
+  private static final byte[] RFC_NONCE = TestUtil.decodeHex("070000004041424344454647");
+  private static final byte[] RFC_AAD = TestUtil.decodeHex("50515253c0c1c2c3c4c5c6c7");
+  private static final byte[] RFC_PLAINTEXT =
+      ("Ladies and Gentlemen of the class of '99: If I could offer you only one tip for the "
+              + "future, sunscreen would be it.")
+          .getBytes(StandardCharsets.US_ASCII);
+  private static final byte[] RFC_CIPHERTEXT =
+      TestUtil.decodeHex(
+          "d31a8d34648e60db7b86afbc53ef7ec2a4aded51296e08fea9e2b5a736ee62d6"
+              + "3dbea45e8ca9671282fafb69da92728b1a71de0a9e060b2905d6a5b67ecd3b36"
+              + "92ddbd7f2d778b8c9803aee328091b58fab324e4fad675945585808b4831d7bc"
+              + "3ff4def08e4b7a9de576d26586cec64b6116"
+              + "1ae10b594f09e26a7e902ecbd0600691");
+
+  public static boolean isDisabled() {
+    return TestUtil.NATIVE_PROVIDER.isFips() && !TestUtil.NATIVE_PROVIDER.isExperimentalFips();
+  }
+
+  private static SecretKey randomKey() {
+    return new SecretKeySpec(TestUtil.getRandomBytes(32), "ChaCha20");
+  }
+
+  private static Cipher nativeCipher() throws GeneralSecurityException {
+    return Cipher.getInstance(ALGORITHM, TestUtil.NATIVE_PROVIDER);
+  }
+
+  @Test
+  public void knownAnswer() throws Exception {
+    final SecretKey key = new SecretKeySpec(RFC_KEY, "ChaCha20");
+    final Cipher cipher = nativeCipher();
+    cipher.init(Cipher.ENCRYPT_MODE, key, new IvParameterSpec(RFC_NONCE));
+    cipher.updateAAD(RFC_AAD);
+    assertArrayEquals(RFC_CIPHERTEXT, cipher.doFinal(RFC_PLAINTEXT));
+
+    cipher.init(Cipher.DECRYPT_MODE, key, new IvParameterSpec(RFC_NONCE));
+    cipher.updateAAD(RFC_AAD);
+    assertArrayEquals(RFC_PLAINTEXT, cipher.doFinal(RFC_CIPHERTEXT));
+  }
+
+  @Test
+  public void incrementalMatchesOneShot() throws Exception {
+    final SecretKey key = new SecretKeySpec(RFC_KEY, "ChaCha20");
+    final Cipher cipher = nativeCipher();
+    cipher.init(Cipher.ENCRYPT_MODE, key, new IvParameterSpec(RFC_NONCE));
+    cipher.updateAAD(RFC_AAD, 0, 5);
+    cipher.updateAAD(RFC_AAD, 5, RFC_AAD.length - 5);
+    final byte[] ciphertext = new byte[cipher.getOutputSize(RFC_PLAINTEXT.length)];
+    int offset = 0;
+    for (int chunk = 1, pos = 0; pos < RFC_PLAINTEXT.length; pos += chunk, chunk += 3) {
+      final int len = Math.min(chunk, RFC_PLAINTEXT.length - pos);
+      // All output is deferred to doFinal
+      assertEquals(0, cipher.update(RFC_PLAINTEXT, pos, len, ciphertext, offset));
+    }
+    offset += cipher.doFinal(ciphertext, offset);
+    assertEquals(RFC_CIPHERTEXT.length, offset);
+    assertArrayEquals(RFC_CIPHERTEXT, ciphertext);
+
+    cipher.init(Cipher.DECRYPT_MODE, key, new IvParameterSpec(RFC_NONCE));
+    cipher.updateAAD(RFC_AAD);
+    for (int pos = 0; pos < RFC_CIPHERTEXT.length; pos += 17) {
+      cipher.update(RFC_CIPHERTEXT, pos, Math.min(17, RFC_CIPHERTEXT.length - pos));
+    }
+    assertArrayEquals(RFC_PLAINTEXT, cipher.doFinal());
+  }
+
+  @Test
+  public void inPlace() throws Exception {
+    final SecretKey key = new SecretKeySpec(RFC_KEY, "ChaCha20");
+    final Cipher cipher = nativeCipher();
+
+    // Exactly in-place, and shifted in both directions
+    for (final int shift : new int[] {0, 3, -3}) {
+      final int inOffset = shift < 0 ? -shift : 0;
+      final int outOffset = shift > 0 ? shift : 0;
+      final byte[] buffer = new byte[RFC_CIPHERTEXT.length + Math.abs(shift)];
+      System.arraycopy(RFC_PLAINTEXT, 0, buffer, inOffset, RFC_PLAINTEXT.length);
+      cipher.init(Cipher.ENCRYPT_MODE, key, new IvParameterSpec(RFC_NONCE));
+      cipher.updateAAD(RFC_AAD);
+      cipher.doFinal(buffer, inOffset, RFC_PLAINTEXT.length, buffer, outOffset);
+      assertArrayEquals(
+          RFC_CIPHERTEXT, Arrays.copyOfRange(buffer, outOffset, outOffset + RFC_CIPHERTEXT.length));
+
+      System.arraycopy(RFC_CIPHERTEXT, 0, buffer, inOffset, RFC_CIPHERTEXT.length);
+      cipher.init(Cipher.DECRYPT_MODE, key, new IvParameterSpec(RFC_NONCE));
+      cipher.updateAAD(RFC_AAD);
+      cipher.doFinal(buffer, inOffset, RFC_CIPHERTEXT.length, buffer, outOffset);
+      assertArrayEquals(
+          RFC_PLAINTEXT, Arrays.copyOfRange(buffer, outOffset, outOffset + RFC_PLAINTEXT.length));
+    }
+  }
+
+  @Test
+  public void matchesJce() throws Exception {
+    final Cipher jce;
+    try {
+      jce = Cipher.getInstance(ALGORITHM, "SunJCE");
+    } catch (final GeneralSecurityException ex) {
+      assumeTrue(false, "SunJCE does not support " + ALGORITHM);
+      return;
+    }
+    final Cipher cipher = nativeCipher();
+    for (int len = 0; len < 150; len++) {
+      final SecretKey key = randomKey();
+      final byte[] nonce = TestUtil.getRandomBytes(12);
+      final byte[] aad = TestUtil.getRandomBytes(len % 20);
+      final byte[] plaintext = TestUtil.getRandomBytes(len);
+
+      jce.init(Cipher.ENCRYPT_MODE, key, new IvParameterSpec(nonce));
+      jce.updateAAD(aad);
+      final byte[] expected = jce.doFinal(plaintext);
+
+      cipher.init(Cipher.ENCRYPT_MODE, key, new IvParameterSpec(nonce));
+      cipher.updateAAD(aad);
+      assertArrayEquals(expected, cipher.doFinal(plaintext));
+
+      cipher.init(Cipher.DECRYPT_MODE, key, new IvParameterSpec(nonce));
+      cipher.updateAAD(aad);
+      assertArrayEquals(plaintext, cipher.doFinal(expected));
+    }
+  }
+
+  @Test
+  public void contextReuseAcrossKeys() throws Exception {
+    final Cipher cipher = nativeCipher();
+    final SecretKey rfcKey = new SecretKeySpec(RFC_KEY, "ChaCha20");
+    for (int round = 0; round < 3; round++) {
+      // Alternate between a fixed key (reusing the native context) and fresh keys
+      final SecretKey other = randomKey();
+      final byte[] nonce = TestUtil.getRandomBytes(12);
+      cipher.init(Cipher.ENCRYPT_MODE, other, new IvParameterSpec(nonce));
+      final byte[] ciphertext = cipher.doFinal(RFC_PLAINTEXT);
+      cipher.init(Cipher.DECRYPT_MODE, other, new IvParameterSpec(nonce));
+      assertArrayEquals(RFC_PLAINTEXT, cipher.doFinal(ciphertext));
+
+      cipher.init(Cipher.DECRYPT_MODE, rfcKey, new IvParameterSpec(RFC_NONCE));
+      cipher.updateAAD(RFC_AAD);
+      assertArrayEquals(RFC_PLAINTEXT, cipher.doFinal(RFC_CIPHERTEXT));
+      // Decryption may be repeated without re-initialization
+      cipher.updateAAD(RFC_AAD);
+      assertArrayEquals(RFC_PLAINTEXT, cipher.doFinal(RFC_CIPHERTEXT));
+    }
+  }
+
+  @Test
+  public void badTag() throws Exception {
+    final Cipher cipher = nativeCipher();
+    final SecretKey key = new SecretKeySpec(RFC_KEY, "ChaCha20");
+    for (final int index : new int[] {0, RFC_CIPHERTEXT.length - 1}) {
+      final byte[] corrupted = RFC_CIPHERTEXT.clone();
+      corrupted[index] ^= 1;
+      cipher.init(Cipher.DECRYPT_MODE, key, new IvParameterSpec(RFC_NONCE));
+      cipher.updateAAD(RFC_AAD);
+      final byte[] output = new byte[RFC_PLAINTEXT.length];
+      Arrays.fill(output, (byte) 0x55);
+      assertThrows(
+          AEADBadTagException.class,
+          () -> cipher.doFinal(corrupted, 0, corrupted.length, output, 0));
+      // No unauthenticated plaintext is released
+      assertArrayEquals(new byte[output.length], output);
+    }
+
+    // Missing AAD
+    cipher.init(Cipher.DECRYPT_MODE, key, new IvParameterSpec(RFC_NONCE));
+    assertThrows(AEADBadTagException.class, () -> cipher.doFinal(RFC_CIPHERTEXT));
+
+    // Shorter than a tag
+    cipher.init(Cipher.DECRYPT_MODE, key, new IvParameterSpec(RFC_NONCE));
+    assertThrows(AEADBadTagException.class, () -> cipher.doFinal(new byte[TAG_LENGTH - 1]));
+  }
+
+  @Test
+  public void nonceReuse() throws Exception {
+    final Cipher cipher = nativeCipher();
+    final SecretKey key = randomKey();
+    final byte[] nonce = TestUtil.getRandomBytes(12);
+    cipher.init(Cipher.ENCRYPT_MODE, key, new IvParameterSpec(nonce));
+    cipher.doFinal(RFC_PLAINTEXT);
+    // Encryption must be re-initialized after each message
+    assertThrows(IllegalStateException.class, () -> cipher.doFinal(RFC_PLAINTEXT));
+    assertThrows(
+        InvalidAlgorithmParameterException.class,
+        () -> cipher.init(Cipher.ENCRYPT_MODE, key, new IvParameterSpec(nonce)));
+
+    // Randomly generated nonces are exposed to the caller
+    cipher.init(Cipher.ENCRYPT_MODE, key);
+    final byte[] generated = cipher.getIV();
+    assertEquals(12, generated.length);
+    final byte[] ciphertext = cipher.doFinal(RFC_PLAINTEXT);
+    cipher.init(Cipher.DECRYPT_MODE, key, new IvParameterSpec(generated));
+    assertArrayEquals(RFC_PLAINTEXT, cipher.doFinal(ciphertext));
+  }
+
+  @Test
+  public void badParameters() throws Exception {
+    final Cipher cipher = nativeCipher();
+    final IvParameterSpec nonce = new IvParameterSpec(new byte[12]);
+    assertThrows(
+        InvalidKeyException.class,
+        () ->
+            cipher.init(
+                Cipher.ENCRYPT_MODE, new SecretKeySpec(new byte[16], "ChaCha20"), nonce));
+    assertThrows(
+        InvalidAlgorithmParameterException.class,
+        () -> cipher.init(Cipher.ENCRYPT_MODE, randomKey(), new IvParameterSpec(new byte[8])));
+    assertThrows(InvalidKeyException.class, () -> cipher.init(Cipher.DECRYPT_MODE, randomKey()));
+
+    cipher.init(Cipher.ENCRYPT_MODE, randomKey(), nonce);
+    cipher.update(new byte[1]);
+    assertThrows(IllegalStateException.class, () -> cipher.updateAAD(new byte[1]));
+  }
+}
@@ -457,6 +457,31 @@ public class EdDSATest {
     assertFalse(jceSig.verify(signature));
   }
 
+  @Test
+  public void signIntoArray() throws GeneralSecurityException {
+    final KeyPair kp = nativeGen.generateKeyPair();
+    final byte[] message = new byte[] {1, 2, 3, 4, 5};
+    final Signature nativeSig = Signature.getInstance("Ed25519", NATIVE_PROVIDER);
+    nativeSig.initSign(kp.getPrivate());
+    nativeSig.update(message);
+    final byte[] expected = nativeSig.sign();
+
+    // Ed25519 is deterministic, so the signature written in place must match
+    final byte[] output = new byte[expected.length + 2];
+    nativeSig.update(message);
+    assertEquals(expected.length, nativeSig.sign(output, 1, expected.length));
+    assertArrayEquals(expected, Arrays.copyOfRange(output, 1, expected.length + 1));
+    assertEquals(0, output[0]);
+    assertEquals(0, output[output.length - 1]);
+
+    nativeSig.update(message);
+    TestUtil.assertThrows(
+        SignatureException.class, () -> nativeSig.sign(output, 0, expected.length - 1));
+    // The failure resets the signature
+    nativeSig.update(message);
+    assertArrayEquals(expected, nativeSig.sign());
+  }
+
   @Test
   public void testInvalidKey() throws GeneralSecurityException {
     assumeTrue(TestUtil.edKeyFactoryRegistered());
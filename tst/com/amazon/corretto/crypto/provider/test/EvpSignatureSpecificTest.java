@@ -4,12 +4,17 @@ package com.amazon.corretto.crypto.provider.test;
 
 import static com.amazon.corretto.crypto.provider.test.TestUtil.JAVA_VERSION;
 import static com.amazon.corretto.crypto.provider.test.TestUtil.NATIVE_PROVIDER;
+import static com.amazon.corretto.crypto.provider.test.TestUtil.NATIVE_PROVIDER_PACKAGE;
 import static com.amazon.corretto.crypto.provider.test.TestUtil.assertThrows;
 import static com.amazon.corretto.crypto.provider.test.TestUtil.assumeMinimumVersion;
+import static com.amazon.corretto.crypto.provider.test.TestUtil.sneakyGetField;
+import static com.amazon.corretto.crypto.provider.test.TestUtil.sneakyInvoke;
+import static com.amazon.corretto.crypto.provider.test.TestUtil.sneakyInvoke_boolean;
 import static com.amazon.corretto.crypto.provider.test.TestUtil.versionCompare;
 import static org.junit.jupiter.api.Assertions.assertEquals;
 import static org.junit.jupiter.api.Assertions.assertFalse;
 import static org.junit.jupiter.api.Assertions.assertNull;
+import static org.junit.jupiter.api.Assertions.assertSame;
 import static org.junit.jupiter.api.Assertions.assertTrue;
 import static org.junit.jupiter.api.Assertions.fail;
 import static org.junit.jupiter.api.Assumptions.assumeFalse;
@@ -43,6 +48,7 @@ import java.security.spec.RSAKeyGenParameterSpec;
 import java.security.spec.RSAPrivateKeySpec;
 import java.util.ArrayList;
 import java.util.List;
+import java.util.Map;
 import java.util.Set;
 import java.util.regex.Matcher;
 import java.util.regex.Pattern;
@@ -195,6 +201,78 @@ public final class EvpSignatureSpecificTest {
     doCorruptionSweep("NONEwithECDSA", ECDSA_PAIR);
     doCorruptionSweep("SHA1withECDSA", ECDSA_PAIR);
     doCorruptionSweep("SHA1withRSA", RSA_PAIR);
+    doCorruptionSweep("SHA256withECDSAinP1363Format", ECDSA_PAIR);
+  }
+
+  @Test
+  public void p1363SignaturesHaveFixedLength() throws Exception {
+    final ECPublicKey pubKey = (ECPublicKey) ECDSA_PAIR.getPublic();
+    final int elementLength = (pubKey.getParams().getOrder().bitLength() + 7) / 8;
+    final byte[] message = new byte[] {1, 2, 3, 4};
+    final Signature signer = Signature.getInstance("SHA256withECDSAinP1363Format", NATIVE_PROVIDER);
+    final Signature verifier =
+        Signature.getInstance("SHA256withECDSAinP1363Format", NATIVE_PROVIDER);
+    signer.initSign(ECDSA_PAIR.getPrivate());
+    verifier.initVerify(pubKey);
+
+    // Enough signatures that some r or s values have leading zero bytes, which must be kept
+    final byte[] output = new byte[2 * elementLength];
+    for (int i = 0; i < 512; i++) {
+      signer.update(message);
+      assertEquals(output.length, signer.sign(output, 0, output.length));
+      verifier.update(message);
+      assertTrue(verifier.verify(output));
+    }
+  }
+
+  @Test
+  public void signIntoShortBufferRepeatedly() throws Exception {
+    // Messages longer than the signing buffer go through a native context which is released before
+    // the output length is checked, so every failure must still free it.
+    final byte[] longMessage = TestUtil.getRandomBytes(4096);
+    final Signature signer = Signature.getInstance("SHA256withRSA", NATIVE_PROVIDER);
+    final Signature verifier = Signature.getInstance("SHA256withRSA", NATIVE_PROVIDER);
+    signer.initSign(RSA_PAIR.getPrivate());
+    verifier.initVerify(RSA_PAIR.getPublic());
+
+    final byte[] shortOutput = new byte[16];
+    for (int i = 0; i < 10_000; i++) {
+      signer.update(longMessage);
+      assertThrows(SignatureException.class, () -> signer.sign(shortOutput, 0, shortOutput.length));
+      signer.update(MESSAGE);
+      assertThrows(SignatureException.class, () -> signer.sign(shortOutput, 0, shortOutput.length));
+    }
+
+    signer.update(longMessage);
+    verifier.update(longMessage);
+    assertTrue(verifier.verify(signer.sign()));
+  }
+
+  @Test
+  public void p1363SignIntoShortBufferRepeatedly() throws Exception {
+    final ECPublicKey pubKey = (ECPublicKey) ECDSA_PAIR.getPublic();
+    final int elementLength = (pubKey.getParams().getOrder().bitLength() + 7) / 8;
+    final byte[] longMessage = TestUtil.getRandomBytes(4096);
+    final Signature signer = Signature.getInstance("SHA256withECDSAinP1363Format", NATIVE_PROVIDER);
+    final Signature verifier =
+        Signature.getInstance("SHA256withECDSAinP1363Format", NATIVE_PROVIDER);
+    signer.initSign(ECDSA_PAIR.getPrivate());
+    verifier.initVerify(pubKey);
+
+    // One byte short of r||s, which is still longer than many DER encodings of the same signature
+    final byte[] shortOutput = new byte[2 * elementLength - 1];
+    for (int i = 0; i < 10_000; i++) {
+      signer.update(longMessage);
+      assertThrows(SignatureException.class, () -> signer.sign(shortOutput, 0, shortOutput.length));
+      signer.update(MESSAGE);
+      assertThrows(SignatureException.class, () -> signer.sign(shortOutput, 0, shortOutput.length));
+    }
+
+    final byte[] output = new byte[2 * elementLength];
+    signer.update(longMessage);
+    assertEquals(output.length, signer.sign(output, 0, output.length));
+    verifier.update(longMessage);
+    assertTrue(verifier.verify(output));
   }
 
   private void doCorruptionSweep(final String algorithm, final KeyPair keyPair) throws Exception {
@@ -870,6 +948,123 @@ public final class EvpSignatureSpecificTest {
     assertThrows(InvalidKeyException.class, () -> signature.initVerify(emptyPublicKey));
   }
 
+  private static void assumeContextTemplates() throws Exception {
+    assumeTrue(
+        (Boolean)
+            sneakyGetField(
+                Class.forName(NATIVE_PROVIDER_PACKAGE + ".EvpSignature"), "USE_CONTEXT_TEMPLATES"),
+        "Signature context templates are disabled");
+  }
+
+  private static KeyPair nativeRsaPair() throws GeneralSecurityException {
+    final KeyPairGenerator kg = KeyPairGenerator.getInstance("RSA", NATIVE_PROVIDER);
+    kg.initialize(2048);
+    return kg.generateKeyPair();
+  }
+
+  private static Map<?, ?> contextTemplates(final Key key) {
+    return (Map<?, ?>) sneakyGetField(key, "contextTemplates");
+  }
+
+  private static byte[] signRsa(final Signature signature, final PrivateKey key) throws Exception {
+    signature.initSign(key);
+    signature.update(MESSAGE);
+    return signature.sign();
+  }
+
+  private static boolean verifyRsa(
+      final Signature signature, final PublicKey key, final byte[] signed) throws Exception {
+    signature.initVerify(key);
+    signature.update(MESSAGE);
+    return signature.verify(signed);
+  }
+
+  @Test
+  public void contextTemplatesAreReused() throws Exception {
+    assumeContextTemplates();
+    final KeyPair pair = nativeRsaPair();
+    final Signature signer = Signature.getInstance("SHA256withRSA", NATIVE_PROVIDER);
+    final byte[] signed = signRsa(signer, pair.getPrivate());
+    assertEquals(1, contextTemplates(pair.getPrivate()).size());
+    final Object template = contextTemplates(pair.getPrivate()).values().iterator().next();
+
+    // Further operations with the same parameters, by any Signature, use the same template
+    signRsa(signer, pair.getPrivate());
+    signRsa(Signature.getInstance("SHA256withRSA", NATIVE_PROVIDER), pair.getPrivate());
+    assertEquals(1, contextTemplates(pair.getPrivate()).size());
+    assertSame(template, contextTemplates(pair.getPrivate()).values().iterator().next());
+
+    // Other parameters, and the public key, get their own
+    signRsa(Signature.getInstance("SHA384withRSA", NATIVE_PROVIDER), pair.getPrivate());
+    assertEquals(2, contextTemplates(pair.getPrivate()).size());
+    assertTrue(verifyRsa(signer, pair.getPublic(), signed));
+    assertTrue(verifyRsa(signer, pair.getPublic(), signed));
+    assertEquals(1, contextTemplates(pair.getPublic()).size());
+  }
+
+  @Test
+  public void contextTemplatesAreCapped() throws Exception {
+    assumeContextTemplates();
+    final KeyPair pair = nativeRsaPair();
+    final Signature signer = Signature.getInstance("RSASSA-PSS", NATIVE_PROVIDER);
+    final Signature verifier = Signature.getInstance("RSASSA-PSS", NATIVE_PROVIDER);
+    // Each salt length is a distinct set of parameters. Those beyond the cap are initialized from
+    // scratch, and must work just the same.
+    for (int saltLen = 0; saltLen < 12; saltLen++) {
+      final PSSParameterSpec spec =
+          new PSSParameterSpec("SHA-256", "MGF1", MGF1ParameterSpec.SHA256, saltLen, 1);
+      signer.setParameter(spec);
+      verifier.setParameter(spec);
+      assertTrue(verifyRsa(verifier, pair.getPublic(), signRsa(signer, pair.getPrivate())));
+    }
+    assertEquals(8, contextTemplates(pair.getPrivate()).size());
+    assertEquals(8, contextTemplates(pair.getPublic()).size());
+  }
+
+  @Test
+  public void contextTemplatesAreFreedOnDestroy() throws Throwable {
+    assumeContextTemplates();
+    final KeyPair pair = nativeRsaPair();
+    signRsa(Signature.getInstance("SHA256withRSA", NATIVE_PROVIDER), pair.getPrivate());
+    signRsa(Signature.getInstance("SHA512withRSA", NATIVE_PROVIDER), pair.getPrivate());
+    final List<Object> templates = new ArrayList<>(contextTemplates(pair.getPrivate()).values());
+    assertEquals(2, templates.size());
+
+    pair.getPrivate().destroy();
+    assertTrue(contextTemplates(pair.getPrivate()).isEmpty());
+    for (final Object template : templates) {
+      assertTrue(sneakyInvoke_boolean(template, "isReleased"));
+    }
+  }
+
+  @Test
+  public void signatureSurvivesTemplateRelease() throws Throwable {
+    assumeContextTemplates();
+    final KeyPair pair = nativeRsaPair();
+    final Signature signer = Signature.getInstance("SHA256withRSA", NATIVE_PROVIDER);
+    final Signature verifier = Signature.getInstance("SHA256withRSA", NATIVE_PROVIDER);
+    signer.initSign(pair.getPrivate());
+    signer.update(MESSAGE);
+    assertTrue(verifyRsa(verifier, pair.getPublic(), signer.sign()));
+    final Object template = contextTemplates(pair.getPrivate()).values().iterator().next();
+
+    // Drop the templates of both keys part way through an operation. The Signature objects stay
+    // initialized and pick up new templates.
+    signer.update(MESSAGE);
+    sneakyInvoke(pair.getPrivate(), "releaseContextTemplates");
+    sneakyInvoke(pair.getPublic(), "releaseContextTemplates");
+    assertTrue(sneakyInvoke_boolean(template, "isReleased"));
+    final byte[] signed = signer.sign();
+    verifier.initVerify(pair.getPublic());
+    verifier.update(MESSAGE);
+    verifier.update(MESSAGE);
+    assertTrue(verifier.verify(signed));
+
+    signer.update(MESSAGE);
+    assertTrue(verifyRsa(verifier, pair.getPublic(), signer.sign()));
+    assertEquals(1, contextTemplates(pair.getPrivate()).size());
+  }
+
   @SuppressWarnings("serial")
   private static class RawKey implements PublicKey, PrivateKey {
     private final String algorithm_;
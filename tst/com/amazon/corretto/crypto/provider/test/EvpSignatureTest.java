@@ -363,6 +363,22 @@ public class EvpSignatureTest {
     }
   }
 
+  @ParameterizedTest
+  @MethodSource("params")
+  public void signIntoArray(TestParams params) throws GeneralSecurityException {
+    final byte[] output = new byte[1024];
+    Arrays.fill(output, (byte) 0x5a);
+    params.signer.update(params.message);
+    final int sigLength = params.signer.sign(output, 3, output.length - 3);
+
+    assertEquals((byte) 0x5a, output[2]);
+    for (int x = 3 + sigLength; x < output.length; x++) {
+      assertEquals((byte) 0x5a, output[x]);
+    }
+    params.jceVerifier.update(params.message);
+    assertTrue(params.jceVerifier.verify(output, 3, sigLength));
+  }
+
   @ParameterizedTest
   @MethodSource("params")
   public void signSingleByteBufferWrap(TestParams params) throws GeneralSecurityException {
@@ -0,0 +1,118 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider.test;
+
+import static com.amazon.corretto.crypto.provider.test.TestUtil.assertArraysHexEquals;
+import static com.amazon.corretto.crypto.provider.test.TestUtil.assertThrows;
+import static org.junit.jupiter.api.Assertions.assertEquals;
+
+import com.amazon.corretto.crypto.utils.FileDigestUtils;
+import java.io.IOException;
+import java.nio.channels.FileChannel;
+import java.nio.file.Files;
+import java.nio.file.Path;
+import java.nio.file.StandardOpenOption;
+import java.security.MessageDigest;
+import javax.crypto.Mac;
+import javax.crypto.SecretKey;
+import javax.crypto.spec.SecretKeySpec;
+import org.junit.jupiter.api.Test;
+import org.junit.jupiter.api.extension.ExtendWith;
+import org.junit.jupiter.api.io.TempDir;
+import org.junit.jupiter.api.parallel.Execution;
+import org.junit.jupiter.api.parallel.ExecutionMode;
+import org.junit.jupiter.api.parallel.ResourceAccessMode;
+import org.junit.jupiter.api.parallel.ResourceLock;
+import org.junit.jupiter.params.ParameterizedTest;
+import org.junit.jupiter.params.provider.ValueSource;
+
+@Execution(ExecutionMode.CONCURRENT)
+@ExtendWith(TestResultLogger.class)
+@ResourceLock(value = TestUtil.RESOURCE_GLOBAL, mode = ResourceAccessMode.READ)
+public class FileDigestUtilsTest {
+  private static final String[] DIGESTS = {"MD5", "SHA-1", "SHA-256", "SHA-384", "SHA-512"};
+
+  @TempDir Path tempDir;
+
+  private Path writeFile(final byte[] contents) throws IOException {
+    final Path file = Files.createTempFile(tempDir, "digest", ".bin");
+    Files.write(file, contents);
+    return file;
+  }
+
+  @ParameterizedTest
+  @ValueSource(ints = {0, 1, 4095, 4096, 4097, 1024 * 1024 + 3})
+  public void matchesMessageDigest(final int length) throws Exception {
+    final byte[] contents = TestUtil.getRandomBytes(length);
+    final Path file = writeFile(contents);
+    for (final String algorithm : DIGESTS) {
+      final byte[] expected = MessageDigest.getInstance(algorithm, "SUN").digest(contents);
+      assertArraysHexEquals(expected, FileDigestUtils.digest(algorithm, file));
+      try (FileChannel channel = FileChannel.open(file, StandardOpenOption.READ)) {
+        assertArraysHexEquals(expected, FileDigestUtils.digest(algorithm, channel));
+        assertEquals(length, channel.position());
+      }
+    }
+  }
+
+  @ParameterizedTest
+  @ValueSource(ints = {0, 1, 100, 65 * 1024 + 7})
+  public void matchesMac(final int length) throws Exception {
+    final byte[] contents = TestUtil.getRandomBytes(length);
+    final Path file = writeFile(contents);
+    for (final String digest : new String[] {"SHA1", "SHA256", "SHA384", "SHA512"}) {
+      final String algorithm = "Hmac" + digest;
+      final SecretKey key = new SecretKeySpec(TestUtil.getRandomBytes(32), algorithm);
+      final Mac mac = Mac.getInstance(algorithm, "SunJCE");
+      mac.init(key);
+      final byte[] expected = mac.doFinal(contents);
+      assertArraysHexEquals(expected, FileDigestUtils.hmac(algorithm, key, file));
+      try (FileChannel channel = FileChannel.open(file, StandardOpenOption.READ)) {
+        assertArraysHexEquals(expected, FileDigestUtils.hmac(algorithm, key, channel));
+      }
+    }
+  }
+
+  @Test
+  public void channelStartsAtPosition() throws Exception {
+    final byte[] contents = TestUtil.getRandomBytes(10000);
+    final Path file = writeFile(contents);
+    final MessageDigest md = MessageDigest.getInstance("SHA-256", "SUN");
+    md.update(contents, 1234, contents.length - 1234);
+    try (FileChannel channel = FileChannel.open(file, StandardOpenOption.READ)) {
+      channel.position(1234);
+      assertArraysHexEquals(md.digest(), FileDigestUtils.digest("SHA-256", channel));
+      assertEquals(contents.length, channel.position());
+    }
+  }
+
+  @Test
+  public void badArguments() throws Exception {
+    final Path file = writeFile(new byte[10]);
+    final SecretKey key = new SecretKeySpec(new byte[16], "HmacSHA256");
+    assertThrows(IllegalArgumentException.class, () -> FileDigestUtils.digest("SHA-42", file));
+    assertThrows(IllegalArgumentException.class, () -> FileDigestUtils.digest(null, file));
+    assertThrows(
+        IllegalArgumentException.class, () -> FileDigestUtils.digest("SHA-256", (Path) null));
+    assertThrows(IllegalArgumentException.class, () -> FileDigestUtils.hmac("SHA-256", key, file));
+    assertThrows(
+        IllegalArgumentException.class, () -> FileDigestUtils.hmac("HmacSHA256", null, file));
+    assertThrows(
+        IOException.class,
+        () -> FileDigestUtils.digest("SHA-256", tempDir.resolve("does-not-exist")));
+    assertThrows(IOException.class, () -> FileDigestUtils.digest("SHA-256", tempDir));
+  }
+
+  @Test
+  public void failuresDoNotLeakDescriptors() throws Exception {
+    // Directories can be opened but not mapped. More failures than common descriptor limits would
+    // leave none for the final digest if any of them leaked.
+    for (int i = 0; i < 100_000; i++) {
+      assertThrows(IOException.class, () -> FileDigestUtils.digest("SHA-256", tempDir));
+    }
+    final byte[] contents = TestUtil.getRandomBytes(100);
+    assertArraysHexEquals(
+        MessageDigest.getInstance("SHA-256", "SUN").digest(contents),
+        FileDigestUtils.digest("SHA-256", writeFile(contents)));
+  }
+}
@@ -4,12 +4,16 @@ package com.amazon.corretto.crypto.provider.test;
 
 import static com.amazon.corretto.crypto.provider.test.TestUtil.assertArraysHexEquals;
 import static com.amazon.corretto.crypto.provider.test.TestUtil.assertThrows;
+import static com.amazon.corretto.crypto.provider.test.TestUtil.sneakyConstruct;
+import static com.amazon.corretto.crypto.provider.test.TestUtil.sneakyGetField;
 import static com.amazon.corretto.crypto.provider.test.TestUtil.sneakyInvoke;
+import static com.amazon.corretto.crypto.provider.test.TestUtil.sneakyInvoke_boolean;
 import static org.junit.jupiter.api.Assertions.assertArrayEquals;
 import static org.junit.jupiter.api.Assertions.assertEquals;
 import static org.junit.jupiter.api.Assertions.assertTrue;
 
 import com.amazon.corretto.crypto.provider.AmazonCorrettoCryptoProvider;
+import com.amazon.corretto.crypto.utils.DigestBatchUtils;
 import java.lang.invoke.MethodHandle;
 import java.lang.invoke.MethodHandles;
 import java.lang.invoke.MethodType;
@@ -18,8 +22,10 @@ import java.nio.Buffer;
 import java.nio.ByteBuffer;
 import java.security.DigestException;
 import java.security.MessageDigest;
+import java.util.ArrayList;
 import java.util.Arrays;
 import java.util.Iterator;
+import java.util.List;
 import java.util.Random;
 
 public class HashFunctionTester {
@@ -227,6 +233,178 @@ public class HashFunctionTester {
     return result;
   }
 
+  /**
+   * Checks {@link DigestBatchUtils} and the static {@code digestBatch} methods of the given SPI
+   * class (e.g. {@code SHA256Spi}) against the default provider.
+   */
+  public void testBatch(final String spiClassName) throws Throwable {
+    final Class<?> spi = Class.forName("com.amazon.corretto.crypto.provider." + spiClassName);
+    final MessageDigest jce = getDefaultInstance();
+    final int hashSize = jce.getDigestLength();
+    final Random r = new Random();
+
+    // Many small messages, some empty or overlapping, and one message which is larger than the
+    // amount of input digested while the arrays are borrowed.
+    final byte[] data = new byte[512 * 1024];
+    r.nextBytes(data);
+    final int count = 2000;
+    final int[] offsets = new int[count];
+    final int[] lengths = new int[count];
+    for (int i = 0; i < count; i++) {
+      lengths[i] = i == count / 2 ? 300 * 1024 : r.nextInt(300);
+      offsets[i] = r.nextInt(data.length - lengths[i] + 1);
+    }
+
+    final byte[] digests = sneakyInvoke(spi, "digestBatch", data, offsets, lengths);
+    final byte[] shifted = new byte[count * hashSize + 7];
+    sneakyInvoke(spi, "digestBatch", data, offsets, lengths, shifted, 7);
+    for (int i = 0; i < count; i++) {
+      jce.update(data, offsets[i], lengths[i]);
+      final byte[] expected = jce.digest();
+      assertArraysHexEquals(
+          expected, Arrays.copyOfRange(digests, i * hashSize, (i + 1) * hashSize));
+      assertArraysHexEquals(
+          expected, Arrays.copyOfRange(shifted, 7 + i * hashSize, 7 + (i + 1) * hashSize));
+    }
+    final byte[] empty = sneakyInvoke(spi, "digestBatch", data, new int[0], new int[0]);
+    assertEquals(0, empty.length);
+
+    assertEquals(hashSize, DigestBatchUtils.getDigestLength(algorithm));
+    assertArraysHexEquals(digests, DigestBatchUtils.digestBatch(algorithm, data, offsets, lengths));
+    final byte[] utilsShifted = new byte[count * hashSize + 7];
+    DigestBatchUtils.digestBatch(algorithm, data, offsets, lengths, utilsShifted, 7);
+    assertArraysHexEquals(shifted, utilsShifted);
+    assertThrows(
+        IllegalArgumentException.class,
+        () -> DigestBatchUtils.digestBatch("SHA-224", data, offsets, lengths));
+    assertThrows(
+        IllegalArgumentException.class,
+        () -> DigestBatchUtils.digestBatch(null, data, offsets, lengths));
+    assertThrows(
+        IllegalArgumentException.class,
+        () -> DigestBatchUtils.digestBatch(algorithm, data, new int[1], new int[1], data, 0));
+    assertThrows(
+        ArrayIndexOutOfBoundsException.class,
+        () -> DigestBatchUtils.digestBatch(algorithm, data, new int[] {-1}, new int[] {1}));
+
+    assertThrows(
+        IllegalArgumentException.class,
+        () -> sneakyInvoke(spi, "digestBatch", data, new int[2], new int[1]));
+    assertThrows(
+        IllegalArgumentException.class,
+        () -> sneakyInvoke(spi, "digestBatch", data, new int[1], new int[1], data, 0));
+    assertThrows(
+        ArrayIndexOutOfBoundsException.class,
+        () -> sneakyInvoke(spi, "digestBatch", data, new int[] {data.length}, new int[] {1}));
+    assertThrows(
+        ArrayIndexOutOfBoundsException.class,
+        () -> sneakyInvoke(spi, "digestBatch", data, new int[] {-1}, new int[] {1}));
+    assertThrows(
+        ArrayIndexOutOfBoundsException.class,
+        () ->
+            sneakyInvoke(
+                spi, "digestBatch", data, new int[2], new int[2], new byte[2 * hashSize], 1));
+  }
+
+  /**
+   * Checks that digests of the given SPI class (e.g. {@code SHA256Spi}) survive clone, reset and
+   * reuse after digest. When native-resident contexts are enabled it also checks that released
+   * contexts are recycled cleanly and that unreachable ones are released by the Janitor.
+   */
+  public void testContexts(final String spiClassName) throws Throwable {
+    final String spiClass = "com.amazon.corretto.crypto.provider." + spiClassName;
+    final MessageDigest jce = getDefaultInstance();
+    final MessageDigest md = getAmazonInstance();
+    // Larger than the input buffer, so that every update reaches the context itself
+    final byte[] prefix = TestUtil.getRandomBytes(5000);
+    final byte[] suffix1 = TestUtil.getRandomBytes(3000);
+    final byte[] suffix2 = TestUtil.getRandomBytes(4000);
+
+    // Clones are independent of the original
+    md.update(prefix);
+    final MessageDigest clone = (MessageDigest) md.clone();
+    clone.update(suffix1);
+    md.update(suffix2);
+    assertArraysHexEquals(digestOf(jce, prefix, suffix1), clone.digest());
+    assertArraysHexEquals(digestOf(jce, prefix, suffix2), md.digest());
+
+    // Both can be reused after digest
+    md.update(suffix1);
+    assertArraysHexEquals(digestOf(jce, suffix1), md.digest());
+    clone.update(prefix);
+    clone.update(suffix2);
+    assertArraysHexEquals(digestOf(jce, prefix, suffix2), clone.digest());
+
+    // Reset discards everything digested so far
+    md.update(prefix);
+    md.reset();
+    final ByteBuffer direct = ByteBuffer.allocateDirect(suffix2.length);
+    direct.put(suffix2);
+    ((Buffer) direct).flip();
+    md.update(direct);
+    assertArraysHexEquals(digestOf(jce, suffix2), md.digest());
+
+    if (!(Boolean) sneakyGetField(Class.forName(spiClass), "NATIVE_CONTEXTS")) {
+      return;
+    }
+
+    // Releasing the context of a clone leaves the original intact
+    final Object spi = sneakyConstruct(spiClass);
+    sneakyInvoke(spi, "engineUpdate", prefix, 0, prefix.length);
+    final Object spiClone = sneakyInvoke(spi, "clone");
+    sneakyInvoke(nativeContext(spiClone), "release");
+    sneakyInvoke(spi, "engineUpdate", suffix1, 0, suffix1.length);
+    assertArraysHexEquals(digestOf(jce, prefix, suffix1), sneakyInvoke(spi, "engineDigest"));
+
+    // Contexts come from slabs of 64 and released ones are recycled. Release several slabs worth
+    // part way through a digest; contexts reusing their slots must start afresh.
+    final List<Object> spis = new ArrayList<>();
+    for (int i = 0; i < 200; i++) {
+      final Object partial = sneakyConstruct(spiClass);
+      sneakyInvoke(partial, "engineUpdate", prefix, 0, prefix.length);
+      spis.add(partial);
+    }
+    for (final Object partial : spis) {
+      sneakyInvoke(nativeContext(partial), "release");
+    }
+    final byte[] expected = digestOf(jce, suffix1);
+    for (int i = 0; i < spis.size(); i++) {
+      final Object fresh = sneakyConstruct(spiClass);
+      sneakyInvoke(fresh, "engineUpdate", suffix1, 0, suffix1.length);
+      assertArraysHexEquals(expected, sneakyInvoke(fresh, "engineDigest"));
+    }
+
+    // Contexts of unreachable digests are released by the Janitor
+    final Object cell = unreachableContextCell(spiClass, prefix);
+    for (int i = 0; i < 250 && !sneakyInvoke_boolean(cell, "isReleased"); i++) {
+      System.gc();
+      Thread.sleep(50);
+    }
+    assertTrue(sneakyInvoke_boolean(cell, "isReleased"));
+  }
+
+  private static byte[] digestOf(final MessageDigest md, final byte[]... parts) {
+    for (final byte[] part : parts) {
+      md.update(part);
+    }
+    return md.digest();
+  }
+
+  private static Object nativeContext(final Object spi) {
+    return sneakyGetField(sneakyGetField(spi, "buffer"), "state");
+  }
+
+  /**
+   * Returns the cell holding the native context of a digest which is no longer referenced. The
+   * cell is what the Janitor releases, and holding it does not keep the digest reachable.
+   */
+  private static Object unreachableContextCell(final String spiClass, final byte[] data)
+      throws Throwable {
+    final Object spi = sneakyConstruct(spiClass);
+    sneakyInvoke(spi, "engineUpdate", data, 0, data.length);
+    return sneakyGetField(nativeContext(spi), "cell");
+  }
+
   public void testAPI() throws Exception {
     MessageDigest md = getAmazonInstance();
 
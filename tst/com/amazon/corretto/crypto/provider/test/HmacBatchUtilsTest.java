@@ -0,0 +1,167 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider.test;
+
+import static com.amazon.corretto.crypto.provider.test.TestUtil.assertThrows;
+import static org.junit.jupiter.api.Assertions.assertArrayEquals;
+import static org.junit.jupiter.api.Assertions.assertEquals;
+import static org.junit.jupiter.api.Assertions.assertTrue;
+
+import com.amazon.corretto.crypto.utils.HmacBatchUtils;
+import java.security.Key;
+import java.util.Arrays;
+import java.util.BitSet;
+import javax.crypto.Mac;
+import javax.crypto.spec.SecretKeySpec;
+import org.junit.jupiter.api.Test;
+import org.junit.jupiter.api.extension.ExtendWith;
+import org.junit.jupiter.api.parallel.Execution;
+import org.junit.jupiter.api.parallel.ExecutionMode;
+import org.junit.jupiter.api.parallel.ResourceAccessMode;
+import org.junit.jupiter.api.parallel.ResourceLock;
+import org.junit.jupiter.params.ParameterizedTest;
+import org.junit.jupiter.params.provider.ValueSource;
+
+@Execution(ExecutionMode.CONCURRENT)
+@ExtendWith(TestResultLogger.class)
+@ResourceLock(value = TestUtil.RESOURCE_GLOBAL, mode = ResourceAccessMode.READ)
+public class HmacBatchUtilsTest {
+  // More than 64 messages, so the result bitmap spans several words
+  private static final int MESSAGES = 150;
+
+  private static final class Batch {
+    final Key[] keys = new Key[MESSAGES];
+    final int[] offsets = new int[MESSAGES];
+    final int[] lengths = new int[MESSAGES];
+    final byte[] input;
+
+    Batch(final String algorithm) {
+      // A few shared key objects, and some one-off keys of varying lengths
+      final Key[] shared = new Key[3];
+      for (int i = 0; i < shared.length; i++) {
+        shared[i] = new SecretKeySpec(TestUtil.getRandomBytes(32), algorithm);
+      }
+      int total = 0;
+      for (int i = 0; i < MESSAGES; i++) {
+        keys[i] =
+            i % 5 == 0
+                ? new SecretKeySpec(TestUtil.getRandomBytes(1 + i), algorithm)
+                : shared[i % shared.length];
+        // Leave a gap between messages to make sure offsets are honored
+        offsets[i] = total + 2;
+        lengths[i] = (i * 37) % 300;
+        total = offsets[i] + lengths[i];
+      }
+      input = TestUtil.getRandomBytes(total);
+    }
+  }
+
+  private static byte[] expectedTags(final String algorithm, final Batch batch) throws Exception {
+    final Mac mac = Mac.getInstance(algorithm, TestUtil.NATIVE_PROVIDER);
+    final int macLength = mac.getMacLength();
+    final byte[] expected = new byte[MESSAGES * macLength];
+    for (int i = 0; i < MESSAGES; i++) {
+      mac.init(batch.keys[i]);
+      mac.update(batch.input, batch.offsets[i], batch.lengths[i]);
+      mac.doFinal(expected, i * macLength);
+    }
+    return expected;
+  }
+
+  @ParameterizedTest
+  @ValueSource(strings = {"HmacMD5", "HmacSHA1", "HmacSHA256", "HmacSHA384", "HmacSHA512"})
+  public void computeMatchesMac(final String algorithm) throws Exception {
+    final Batch batch = new Batch(algorithm);
+    final byte[] tags =
+        HmacBatchUtils.compute(algorithm, batch.keys, batch.input, batch.offsets, batch.lengths);
+    assertArrayEquals(expectedTags(algorithm, batch), tags);
+    assertEquals(
+        Mac.getInstance(algorithm, TestUtil.NATIVE_PROVIDER).getMacLength(),
+        HmacBatchUtils.getMacLength(algorithm));
+  }
+
+  @ParameterizedTest
+  @ValueSource(strings = {"HmacSHA256", "HmacSHA512"})
+  public void verifyReportsEachMessage(final String algorithm) throws Exception {
+    final Batch batch = new Batch(algorithm);
+    final byte[] tags = expectedTags(algorithm, batch);
+    final int macLength = HmacBatchUtils.getMacLength(algorithm);
+
+    BitSet verified =
+        HmacBatchUtils.verify(
+            algorithm, batch.keys, batch.input, batch.offsets, batch.lengths, tags);
+    assertEquals(MESSAGES, verified.cardinality());
+
+    // Corrupt the first and last byte of some tags
+    final BitSet corrupted = new BitSet();
+    for (int i = 0; i < MESSAGES; i += 7) {
+      tags[i * macLength + (i % 2 == 0 ? 0 : macLength - 1)] ^= 1;
+      corrupted.set(i);
+    }
+    verified =
+        HmacBatchUtils.verify(
+            algorithm, batch.keys, batch.input, batch.offsets, batch.lengths, tags);
+    for (int i = 0; i < MESSAGES; i++) {
+      assertEquals(!corrupted.get(i), verified.get(i), "Message " + i);
+    }
+  }
+
+  @Test
+  public void emptyBatch() {
+    final Key[] keys = new Key[0];
+    final int[] none = new int[0];
+    assertEquals(
+        0, HmacBatchUtils.compute("HmacSHA256", keys, new byte[0], none, none).length);
+    assertTrue(
+        HmacBatchUtils.verify("HmacSHA256", keys, new byte[0], none, none, new byte[0])
+            .isEmpty());
+  }
+
+  @Test
+  public void badArguments() {
+    final Batch batch = new Batch("HmacSHA256");
+    final byte[] tags = new byte[MESSAGES * 32];
+
+    assertThrows(
+        IllegalArgumentException.class,
+        () ->
+            HmacBatchUtils.compute(
+                "HmacSHA3-256", batch.keys, batch.input, batch.offsets, batch.lengths));
+    assertThrows(
+        IllegalArgumentException.class,
+        () ->
+            HmacBatchUtils.compute(
+                "HmacSHA256",
+                batch.keys,
+                batch.input,
+                Arrays.copyOf(batch.offsets, 3),
+                batch.lengths));
+    assertThrows(
+        IllegalArgumentException.class,
+        () ->
+            HmacBatchUtils.verify(
+                "HmacSHA256",
+                batch.keys,
+                batch.input,
+                batch.offsets,
+                batch.lengths,
+                Arrays.copyOf(tags, tags.length - 1)));
+
+    final Key[] withNull = batch.keys.clone();
+    withNull[4] = null;
+    assertThrows(
+        IllegalArgumentException.class,
+        () ->
+            HmacBatchUtils.compute(
+                "HmacSHA256", withNull, batch.input, batch.offsets, batch.lengths));
+
+    final int[] badOffsets = batch.offsets.clone();
+    badOffsets[MESSAGES - 1] = batch.input.length;
+    batch.lengths[MESSAGES - 1] = 1;
+    assertThrows(
+        ArrayIndexOutOfBoundsException.class,
+        () ->
+            HmacBatchUtils.compute(
+                "HmacSHA256", batch.keys, batch.input, badOffsets, batch.lengths));
+  }
+}
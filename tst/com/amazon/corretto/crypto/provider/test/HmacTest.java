@@ -6,9 +6,14 @@ import static com.amazon.corretto.crypto.provider.test.TestUtil.NATIVE_PROVIDER;
 import static com.amazon.corretto.crypto.provider.test.TestUtil.NATIVE_PROVIDER_PACKAGE;
 import static com.amazon.corretto.crypto.provider.test.TestUtil.assertArraysHexEquals;
 import static com.amazon.corretto.crypto.provider.test.TestUtil.assertThrows;
+import static com.amazon.corretto.crypto.provider.test.TestUtil.sneakyConstruct;
+import static com.amazon.corretto.crypto.provider.test.TestUtil.sneakyGetField;
 import static com.amazon.corretto.crypto.provider.test.TestUtil.sneakyInvoke;
+import static com.amazon.corretto.crypto.provider.test.TestUtil.sneakyInvoke_boolean;
 import static org.junit.jupiter.api.Assertions.assertArrayEquals;
 import static org.junit.jupiter.api.Assertions.assertEquals;
+import static org.junit.jupiter.api.Assertions.assertTrue;
+import static org.junit.jupiter.api.Assumptions.assumeTrue;
 
 import com.amazon.corretto.crypto.provider.*;
 import java.io.File;
@@ -21,6 +26,7 @@ import java.security.InvalidAlgorithmParameterException;
 import java.security.InvalidKeyException;
 import java.security.Provider.Service;
 import java.security.PublicKey;
+import java.security.spec.AlgorithmParameterSpec;
 import java.security.spec.InvalidKeySpecException;
 import java.security.spec.KeySpec;
 import java.util.ArrayList;
@@ -46,6 +52,7 @@ import org.junit.jupiter.api.parallel.ResourceAccessMode;
 import org.junit.jupiter.api.parallel.ResourceLock;
 import org.junit.jupiter.params.ParameterizedTest;
 import org.junit.jupiter.params.provider.MethodSource;
+import org.junit.jupiter.params.provider.ValueSource;
 
 @ExtendWith(TestResultLogger.class)
 @Execution(ExecutionMode.CONCURRENT)
@@ -340,6 +347,32 @@ public class HmacTest {
     assertArrayEquals(jceMac.doFinal(), nativeMac.doFinal());
   }
 
+  @ParameterizedTest
+  @MethodSource("supportedHmacs")
+  public void directBufferStartsMessage(final String algorithm) throws Exception {
+    // Direct buffers past the input buffer size go straight to native code, so make sure that
+    // the first (keying) update, position and limit, and re-keying are all honored there.
+    final ByteBuffer msg = ByteBuffer.allocateDirect(5000);
+    msg.put(TestUtil.getRandomBytes(msg.capacity()));
+    msg.position(17).limit(4500);
+    final Mac nativeMac = Mac.getInstance(algorithm, NATIVE_PROVIDER);
+    final Mac jceMac = Mac.getInstance(algorithm, "SunJCE");
+    for (int keyNum = 0; keyNum < 2; keyNum++) {
+      final SecretKeySpec key = new SecretKeySpec(TestUtil.getRandomBytes(20 + keyNum), "Generic");
+      nativeMac.init(key);
+      jceMac.init(key);
+      for (int round = 0; round < 2; round++) {
+        final ByteBuffer nativeMsg = msg.duplicate();
+        nativeMac.update(nativeMsg);
+        assertEquals(nativeMsg.limit(), nativeMsg.position());
+        nativeMac.update(msg.duplicate());
+        jceMac.update(msg.duplicate());
+        jceMac.update(msg.duplicate());
+        assertArrayEquals(jceMac.doFinal(), nativeMac.doFinal());
+      }
+    }
+  }
+
   @Test
   public void cavpTestVectors() throws Throwable {
     final Map<String, String> macBySize = new HashMap<>();
@@ -716,4 +749,102 @@ public class HmacTest {
     assertEquals(
         SelfTestStatus.PASSED, ((SelfTestResult) sneakyInvoke(clazz, "runSelfTest")).getStatus());
   }
+
+  private static int keyCacheCapacity() throws Exception {
+    return (Integer)
+        sneakyGetField(Class.forName(NATIVE_PROVIDER_PACKAGE + ".HmacKeyCache"), "CAPACITY");
+  }
+
+  private static byte[] sunMac(final String algorithm, final SecretKey key, final byte[]... parts)
+      throws GeneralSecurityException {
+    final Mac mac = Mac.getInstance(algorithm, "SunJCE");
+    mac.init(key);
+    for (final byte[] part : parts) {
+      mac.update(part);
+    }
+    return mac.doFinal();
+  }
+
+  @ParameterizedTest
+  @MethodSource("supportedHmacs")
+  public void keyCacheContexts(final String algorithm) throws Throwable {
+    final int capacity = keyCacheCapacity();
+    assumeTrue(capacity > 0, "HMAC key cache is disabled");
+    final SecretKey key = new SecretKeySpec(TestUtil.getRandomBytes(32), "Generic");
+    // Larger than the input buffer, so that updates reach the native context
+    final byte[] prefix = TestUtil.getRandomBytes(3000);
+    final byte[] suffix1 = TestUtil.getRandomBytes(2000);
+    final byte[] suffix2 = TestUtil.getRandomBytes(1500);
+    final Mac mac = Mac.getInstance(algorithm, NATIVE_PROVIDER);
+    mac.init(key);
+
+    // Clones have their own context but share the cached key
+    mac.update(prefix);
+    final Mac clone = (Mac) mac.clone();
+    clone.update(suffix1);
+    mac.update(suffix2);
+    assertArraysHexEquals(sunMac(algorithm, key, prefix, suffix1), clone.doFinal());
+    assertArraysHexEquals(sunMac(algorithm, key, prefix, suffix2), mac.doFinal());
+
+    // Both restart from the cached key after doFinal and reset
+    assertArraysHexEquals(sunMac(algorithm, key, suffix1), mac.doFinal(suffix1));
+    clone.update(prefix);
+    clone.reset();
+    assertArraysHexEquals(sunMac(algorithm, key, suffix2), clone.doFinal(suffix2));
+
+    // A Mac keeps using its entry after the cache has evicted it, and a later init with the same
+    // key creates a new one.
+    mac.update(prefix);
+    final Mac other = Mac.getInstance(algorithm, NATIVE_PROVIDER);
+    for (int i = 0; i < 3 * capacity; i++) {
+      final SecretKey evicting = new SecretKeySpec(TestUtil.getRandomBytes(32), "Generic");
+      other.init(evicting);
+      assertArraysHexEquals(sunMac(algorithm, evicting, suffix1), other.doFinal(suffix1));
+    }
+    assertArraysHexEquals(sunMac(algorithm, key, prefix, suffix1), mac.doFinal(suffix1));
+    other.init(new SecretKeySpec(key.getEncoded(), "Generic"));
+    assertArraysHexEquals(sunMac(algorithm, key, prefix), other.doFinal(prefix));
+  }
+
+  @Test
+  public void keyCacheReleasedThroughJanitor() throws Throwable {
+    assumeTrue(keyCacheCapacity() > 0, "HMAC key cache is disabled");
+    final Object[] cells = unreachableKeyCacheCells();
+    for (final Object cell : cells) {
+      for (int i = 0; i < 250 && !sneakyInvoke_boolean(cell, "isReleased"); i++) {
+        System.gc();
+        Thread.sleep(50);
+      }
+      assertTrue(sneakyInvoke_boolean(cell, "isReleased"));
+    }
+  }
+
+  /**
+   * Returns the cells holding the cache entry and native context of a Mac which is no longer
+   * referenced. The cells are what the Janitor releases, and holding them does not keep the Mac
+   * reachable.
+   */
+  private static Object[] unreachableKeyCacheCells() throws Throwable {
+    final Object spi = sneakyConstruct(NATIVE_PROVIDER_PACKAGE + ".EvpHmac$SHA256");
+    final byte[] data = TestUtil.getRandomBytes(2000);
+    sneakyInvoke(
+        spi,
+        "engineInit",
+        new SecretKeySpec(TestUtil.getRandomBytes(32), "Generic"),
+        (AlgorithmParameterSpec) null);
+    sneakyInvoke(spi, "engineUpdate", data, 0, data.length);
+    final Object state = sneakyGetField(spi, "state");
+    return new Object[] {
+      sneakyGetField(sneakyGetField(state, "cacheEntry"), "cell"),
+      sneakyGetField(sneakyGetField(state, "nativeContext"), "cell")
+    };
+  }
+
+  @ParameterizedTest
+  @ValueSource(strings = {"HmacSHA256", "HmacSHA384", "HmacSHA512"})
+  public void specializedSelfTest(final String algorithm) throws Throwable {
+    final Class<?> clazz = Class.forName(NATIVE_PROVIDER_PACKAGE + "." + algorithm + "Spi");
+    assertEquals(
+        SelfTestStatus.PASSED, ((SelfTestResult) sneakyInvoke(clazz, "runSelfTest")).getStatus());
+  }
 }
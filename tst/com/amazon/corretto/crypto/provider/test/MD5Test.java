@@ -87,6 +87,16 @@ public class MD5Test {
     new HashFunctionTester(ALGORITHM).testAPI();
   }
 
+  @Test
+  public void testBatch() throws Throwable {
+    new HashFunctionTester(ALGORITHM).testBatch("MD5Spi");
+  }
+
+  @Test
+  public void testContexts() throws Throwable {
+    new HashFunctionTester(ALGORITHM).testContexts("MD5Spi");
+  }
+
   @Test
   public void cavpVectors() throws Throwable {
     try (final InputStream is = new GZIPInputStream(TestUtil.getTestData("MD5ShortMsg.rsp.gz"))) {
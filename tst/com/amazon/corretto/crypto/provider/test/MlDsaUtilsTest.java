@@ -2,12 +2,20 @@
 // SPDX-License-Identifier: Apache-2.0
 package com.amazon.corretto.crypto.provider.test;
 
+import static com.amazon.corretto.crypto.provider.test.TestUtil.assertThrows;
 import static org.junit.jupiter.api.Assertions.assertArrayEquals;
 import static org.junit.jupiter.api.Assertions.assertEquals;
+import static org.junit.jupiter.api.Assertions.assertFalse;
 import static org.junit.jupiter.api.Assertions.assertTrue;
 
 import com.amazon.corretto.crypto.provider.AmazonCorrettoCryptoProvider;
 import com.amazon.corretto.crypto.utils.MlDsaUtils;
+import java.io.ByteArrayInputStream;
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.file.Files;
+import java.nio.file.Path;
+import java.nio.file.Paths;
 import java.security.KeyFactory;
 import java.security.KeyPair;
 import java.security.KeyPairGenerator;
@@ -58,6 +66,76 @@ public class MlDsaUtilsTest {
     assertArrayEquals(mu, MlDsaUtils.computeMu(bcPub, message));
   }
 
+  @ParameterizedTest
+  @ValueSource(strings = {"ML-DSA-44", "ML-DSA-65", "ML-DSA-87"})
+  @DisabledIf("mlDsaDisabled")
+  public void testStreamedMuSignsLikeMessage(String algorithm) throws Exception {
+    KeyPair keyPair = KeyPairGenerator.getInstance(algorithm, NATIVE_PROVIDER).generateKeyPair();
+    PublicKey pub = keyPair.getPublic();
+    // Spans several stream chunks and does not end on a chunk boundary
+    byte[] message = TestUtil.getRandomBytes(200_003);
+    byte[] mu = MlDsaUtils.computeMu(pub, message);
+
+    assertArrayEquals(mu, MlDsaUtils.computeMu(pub, new ByteArrayInputStream(message)));
+    assertArrayEquals(mu, MlDsaUtils.computeMu(pub, ByteBuffer.wrap(message)));
+    assertArrayEquals(mu, MlDsaUtils.computeMu(pub, ByteBuffer.wrap(message).asReadOnlyBuffer()));
+    ByteBuffer direct = ByteBuffer.allocateDirect(message.length + 5);
+    direct.position(5);
+    direct.put(message);
+    direct.position(5);
+    assertArrayEquals(mu, MlDsaUtils.computeMu(pub, direct));
+    assertEquals(direct.limit(), direct.position());
+
+    Path file = Files.createTempFile("mldsa-mu", ".bin");
+    try {
+      Files.write(file, message);
+      assertArrayEquals(mu, MlDsaUtils.computeMu(pub, file));
+    } finally {
+      Files.delete(file);
+    }
+
+    // Signing only mu produces a signature over the whole message
+    Signature extMu = Signature.getInstance("ML-DSA-ExtMu", NATIVE_PROVIDER);
+    extMu.initSign(keyPair.getPrivate());
+    extMu.update(mu);
+    byte[] signature = extMu.sign();
+    Signature verifier = Signature.getInstance("ML-DSA", NATIVE_PROVIDER);
+    verifier.initVerify(pub);
+    verifier.update(message);
+    assertTrue(verifier.verify(signature));
+  }
+
+  @Test
+  @DisabledIf("mlDsaDisabled")
+  public void testFileMuReleasesMapping() throws Exception {
+    PublicKey pub =
+        KeyPairGenerator.getInstance("ML-DSA-44", NATIVE_PROVIDER).generateKeyPair().getPublic();
+    Path empty = Files.createTempFile("mldsa-mu-empty", ".bin");
+    Path file = Files.createTempFile("mldsa-mu-mapped", ".bin");
+    try {
+      byte[] message = TestUtil.getRandomBytes(100_000);
+      Files.write(file, message);
+      assertArrayEquals(MlDsaUtils.computeMu(pub, message), MlDsaUtils.computeMu(pub, file));
+      assertArrayEquals(MlDsaUtils.computeMu(pub, new byte[0]), MlDsaUtils.computeMu(pub, empty));
+
+      // The file is unmapped before computeMu returns
+      Path maps = Paths.get("/proc/self/maps");
+      if (Files.isReadable(maps)) {
+        for (String line : Files.readAllLines(maps)) {
+          assertFalse(line.contains(file.getFileName().toString()), line);
+        }
+      }
+
+      assertThrows(IOException.class, () -> MlDsaUtils.computeMu(pub, file.getParent()));
+      assertThrows(
+          IOException.class,
+          () -> MlDsaUtils.computeMu(pub, file.resolveSibling(file.getFileName() + ".missing")));
+    } finally {
+      Files.delete(file);
+      Files.delete(empty);
+    }
+  }
+
   @Test
   @DisabledIf("mlDsaDisabled")
   public void testExpandPrivateKey() throws Exception {
@@ -87,6 +87,16 @@ public class SHA1Test {
     new HashFunctionTester(ALGORITHM).testAPI();
   }
 
+  @Test
+  public void testBatch() throws Throwable {
+    new HashFunctionTester(ALGORITHM).testBatch("SHA1Spi");
+  }
+
+  @Test
+  public void testContexts() throws Throwable {
+    new HashFunctionTester(ALGORITHM).testContexts("SHA1Spi");
+  }
+
   @Test
   public void cavpShortVectors() throws Throwable {
     try (final InputStream is = new GZIPInputStream(TestUtil.getTestData("SHA1ShortMsg.rsp.gz"))) {
@@ -114,6 +114,16 @@ public class SHA256Test {
     new HashFunctionTester(SHA_256).testAPI();
   }
 
+  @Test
+  public void testBatch() throws Throwable {
+    new HashFunctionTester(SHA_256).testBatch("SHA256Spi");
+  }
+
+  @Test
+  public void testContexts() throws Throwable {
+    new HashFunctionTester(SHA_256).testContexts("SHA256Spi");
+  }
+
   @Test
   public void cavpShortVectors() throws Throwable {
     try (final InputStream is =
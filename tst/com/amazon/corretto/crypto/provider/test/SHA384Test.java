@@ -104,6 +104,16 @@ public class SHA384Test {
     new HashFunctionTester(SHA_384).testAPI();
   }
 
+  @Test
+  public void testBatch() throws Throwable {
+    new HashFunctionTester(SHA_384).testBatch("SHA384Spi");
+  }
+
+  @Test
+  public void testContexts() throws Throwable {
+    new HashFunctionTester(SHA_384).testContexts("SHA384Spi");
+  }
+
   @Test
   public void cavpShortVectors() throws Throwable {
     try (final InputStream is =
@@ -0,0 +1,113 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider.test;
+
+import static com.amazon.corretto.crypto.provider.test.TestUtil.assertArraysHexEquals;
+import static org.junit.jupiter.api.Assertions.assertEquals;
+
+import java.security.MessageDigest;
+import java.util.Arrays;
+import org.junit.jupiter.api.Test;
+import org.junit.jupiter.api.extension.ExtendWith;
+import org.junit.jupiter.api.parallel.Execution;
+import org.junit.jupiter.api.parallel.ExecutionMode;
+import org.junit.jupiter.api.parallel.ResourceAccessMode;
+import org.junit.jupiter.api.parallel.ResourceLock;
+import org.junit.jupiter.params.ParameterizedTest;
+import org.junit.jupiter.params.provider.ValueSource;
+
+@ExtendWith(TestResultLogger.class)
+@Execution(ExecutionMode.SAME_THREAD)
+@ResourceLock(value = TestUtil.RESOURCE_REFLECTION)
+@ResourceLock(value = TestUtil.RESOURCE_GLOBAL, mode = ResourceAccessMode.READ_WRITE)
+public class SHA3Test {
+  private static MessageDigest getDigest(final String algorithm) throws Exception {
+    return MessageDigest.getInstance(algorithm, TestUtil.NATIVE_PROVIDER);
+  }
+
+  @Test
+  public void testNullDigest() throws Exception {
+    assertArraysHexEquals(
+        TestUtil.decodeHex("6b4e03423667dbb73b6e15454f0eb1abd4597f9a1b078e3f5b5a6bc7"),
+        getDigest("SHA3-224").digest());
+    assertArraysHexEquals(
+        TestUtil.decodeHex("a7ffc6f8bf1ed76651c14756a061d662f580ff4de43b49fa82d80a4b80f8434a"),
+        getDigest("SHA3-256").digest());
+    assertArraysHexEquals(
+        TestUtil.decodeHex(
+            "0c63a75b845e4f7d01107d852e4c2485c51a50aaaa94fc61995e71bbee983a2a"
+                + "c3713831264adb47fb6bd1e058d5f004"),
+        getDigest("SHA3-384").digest());
+    assertArraysHexEquals(
+        TestUtil.decodeHex(
+            "a69f73cca23a9ac5c8b567dc185a756e97c982164fe25859e0d1dcc1475c80a6"
+                + "15b2123af1f5f94c11e3e9402c3ac558f500199d95b6d3e301758586281dcd26"),
+        getDigest("SHA3-512").digest());
+    assertArraysHexEquals(
+        TestUtil.decodeHex("7f9c2ba4e88f827d616045507605853ed73b8093f6efbc88eb1a6eacfa66ef26"),
+        getDigest("SHAKE128").digest());
+    assertArraysHexEquals(
+        TestUtil.decodeHex(
+            "46b9dd2b0ba88d13233b3feb743eeb243fcd52ea62b81b82b50c27646ed5762f"
+                + "d75dc4ddd8c0f200cb05019d67b592f6fc821c49479ab48640292eacb3b7c4be"),
+        getDigest("SHAKE256").digest());
+  }
+
+  @ParameterizedTest
+  @ValueSource(strings = {"SHA3-224", "SHA3-256", "SHA3-384", "SHA3-512"})
+  public void testRandomly(final String algorithm) throws Exception {
+    new HashFunctionTester(algorithm).testRandomly(1000);
+  }
+
+  @ParameterizedTest
+  @ValueSource(strings = {"SHA3-224", "SHA3-256", "SHA3-384", "SHA3-512"})
+  public void testAPI(final String algorithm) throws Exception {
+    new HashFunctionTester(algorithm).testAPI();
+  }
+
+  @ParameterizedTest
+  @ValueSource(strings = {"SHAKE128", "SHAKE256"})
+  public void shakeHasVariableLengthOutput(final String algorithm) throws Exception {
+    // Cover both the single-pass path and the native context, which starts past 1 KiB of input
+    for (final int inputLength : new int[] {0, 17, 1024, 5000}) {
+      final byte[] input = TestUtil.getRandomBytes(inputLength);
+      final MessageDigest md = getDigest(algorithm);
+      final byte[] defaultOutput = md.digest(input);
+      assertEquals(md.getDigestLength(), defaultOutput.length);
+
+      for (final int outputLength : new int[] {1, 16, md.getDigestLength(), 200, 1000}) {
+        final byte[] output = new byte[outputLength + 3];
+        md.update(input);
+        assertEquals(outputLength, md.digest(output, 3, outputLength));
+        final byte[] result = Arrays.copyOfRange(output, 3, output.length);
+
+        // Every output is a prefix of every longer output
+        final int common = Math.min(outputLength, defaultOutput.length);
+        assertArraysHexEquals(
+            Arrays.copyOf(defaultOutput, common), Arrays.copyOf(result, common));
+        // Nothing leaks from one output length to the next
+        assertArraysHexEquals(defaultOutput, md.digest(input));
+      }
+    }
+  }
+
+  @Test
+  public void shakeAliases() throws Exception {
+    final byte[] input = TestUtil.getRandomBytes(100);
+    assertArraysHexEquals(
+        getDigest("SHAKE128").digest(input), getDigest("SHAKE128-256").digest(input));
+    assertArraysHexEquals(
+        getDigest("SHAKE256").digest(input), getDigest("SHAKE256-512").digest(input));
+  }
+
+  @Test
+  public void cloneKeepsOwnOutputLength() throws Exception {
+    final byte[] input = TestUtil.getRandomBytes(3000);
+    final MessageDigest md = getDigest("SHAKE256");
+    md.update(input);
+    final MessageDigest clone = (MessageDigest) md.clone();
+    final byte[] longOutput = new byte[300];
+    md.digest(longOutput, 0, longOutput.length);
+    assertArraysHexEquals(Arrays.copyOf(longOutput, 64), clone.digest());
+  }
+}
@@ -104,6 +104,16 @@ public class SHA512Test {
     new HashFunctionTester(SHA_512).testAPI();
   }
 
+  @Test
+  public void testBatch() throws Throwable {
+    new HashFunctionTester(SHA_512).testBatch("SHA512Spi");
+  }
+
+  @Test
+  public void testContexts() throws Throwable {
+    new HashFunctionTester(SHA_512).testContexts("SHA512Spi");
+  }
+
   @Test
   public void cavpShortVectors() throws Throwable {
     try (final InputStream is =
@@ -0,0 +1,206 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider.test;
+
+import static com.amazon.corretto.crypto.provider.test.TestUtil.assertThrows;
+import static org.junit.jupiter.api.Assertions.assertEquals;
+import static org.junit.jupiter.api.Assertions.assertTrue;
+
+import com.amazon.corretto.crypto.utils.SignatureBatchUtils;
+import java.io.ByteArrayOutputStream;
+import java.security.KeyPair;
+import java.security.KeyPairGenerator;
+import java.security.PublicKey;
+import java.security.Signature;
+import java.util.Arrays;
+import java.util.BitSet;
+import org.junit.jupiter.api.Test;
+import org.junit.jupiter.api.extension.ExtendWith;
+import org.junit.jupiter.api.parallel.Execution;
+import org.junit.jupiter.api.parallel.ExecutionMode;
+import org.junit.jupiter.api.parallel.ResourceAccessMode;
+import org.junit.jupiter.api.parallel.ResourceLock;
+import org.junit.jupiter.params.ParameterizedTest;
+import org.junit.jupiter.params.provider.ValueSource;
+
+@Execution(ExecutionMode.CONCURRENT)
+@ExtendWith(TestResultLogger.class)
+@ResourceLock(value = TestUtil.RESOURCE_GLOBAL, mode = ResourceAccessMode.READ)
+public class SignatureBatchUtilsTest {
+  // More than 64 messages, so the result bitmap spans several words
+  private static final int MESSAGES = 150;
+
+  private static final class Batch {
+    final PublicKey[] keys = new PublicKey[MESSAGES];
+    final int[] offsets = new int[MESSAGES];
+    final int[] lengths = new int[MESSAGES];
+    final int[] sigOffsets = new int[MESSAGES];
+    final int[] sigLengths = new int[MESSAGES];
+    final byte[] input;
+    final byte[] signatures;
+
+    Batch(final String algorithm) throws Exception {
+      final String keyAlgorithm;
+      if (algorithm.endsWith("withRSA")) {
+        keyAlgorithm = "RSA";
+      } else if (algorithm.endsWith("withECDSA")) {
+        keyAlgorithm = "EC";
+      } else {
+        keyAlgorithm = algorithm;
+      }
+      final KeyPairGenerator kpg =
+          KeyPairGenerator.getInstance(keyAlgorithm, TestUtil.NATIVE_PROVIDER);
+      final KeyPair[] pairs = new KeyPair[3];
+      for (int i = 0; i < pairs.length; i++) {
+        pairs[i] = kpg.generateKeyPair();
+      }
+
+      final Signature signer = Signature.getInstance(algorithm, TestUtil.NATIVE_PROVIDER);
+      final ByteArrayOutputStream sigs = new ByteArrayOutputStream();
+      int total = 0;
+      for (int i = 0; i < MESSAGES; i++) {
+        keys[i] = pairs[i % pairs.length].getPublic();
+        // Leave a gap between messages to make sure offsets are honored
+        offsets[i] = total + 2;
+        lengths[i] = (i * 37) % 300;
+        total = offsets[i] + lengths[i];
+      }
+      input = TestUtil.getRandomBytes(total);
+      for (int i = 0; i < MESSAGES; i++) {
+        signer.initSign(pairs[i % pairs.length].getPrivate());
+        signer.update(input, offsets[i], lengths[i]);
+        final byte[] signature = signer.sign();
+        sigs.write(0);
+        sigOffsets[i] = sigs.size();
+        sigLengths[i] = signature.length;
+        sigs.write(signature, 0, signature.length);
+      }
+      signatures = sigs.toByteArray();
+    }
+
+    BitSet verify(final String algorithm, final int threads) {
+      return SignatureBatchUtils.verify(
+          algorithm,
+          keys,
+          input,
+          offsets,
+          lengths,
+          signatures,
+          sigOffsets,
+          sigLengths,
+          threads);
+    }
+  }
+
+  @ParameterizedTest
+  @ValueSource(
+      strings = {
+        "SHA256withECDSA",
+        "SHA384withECDSA",
+        "SHA1withRSA",
+        "SHA256withRSA",
+        "SHA512withRSA",
+        "Ed25519"
+      })
+  public void verifyReportsEachSignature(final String algorithm) throws Exception {
+    final Batch batch = new Batch(algorithm);
+
+    assertEquals(MESSAGES, batch.verify(algorithm, 1).cardinality());
+    assertEquals(MESSAGES, batch.verify(algorithm, 8).cardinality());
+
+    // Corrupt some signatures, truncate some others, and alter some messages
+    final BitSet bad = new BitSet();
+    for (int i = 0; i < MESSAGES; i += 7) {
+      switch (i % 3) {
+        case 0:
+          batch.signatures[batch.sigOffsets[i] + batch.sigLengths[i] - 1] ^= 1;
+          break;
+        case 1:
+          batch.sigLengths[i]--;
+          break;
+        default:
+          if (batch.lengths[i] == 0) {
+            batch.lengths[i]++;
+          } else {
+            batch.input[batch.offsets[i]] ^= 1;
+          }
+      }
+      bad.set(i);
+    }
+    for (final int threads : new int[] {1, 3, 64}) {
+      final BitSet verified = batch.verify(algorithm, threads);
+      for (int i = 0; i < MESSAGES; i++) {
+        assertEquals(!bad.get(i), verified.get(i), "Message " + i + " with " + threads);
+      }
+    }
+  }
+
+  @Test
+  public void emptyBatch() {
+    final int[] none = new int[0];
+    assertTrue(
+        SignatureBatchUtils.verify(
+                "SHA256withECDSA",
+                new PublicKey[0],
+                new byte[0],
+                none,
+                none,
+                new byte[0],
+                none,
+                none)
+            .isEmpty());
+  }
+
+  @Test
+  public void badArguments() throws Exception {
+    final Batch batch = new Batch("SHA256withECDSA");
+
+    assertThrows(IllegalArgumentException.class, () -> batch.verify("SHA3-256withECDSA", 1));
+    assertThrows(IllegalArgumentException.class, () -> batch.verify("RSASSA-PSS", 1));
+    assertThrows(IllegalArgumentException.class, () -> batch.verify("SHA256withECDSA", 0));
+    // The keys are not RSA keys
+    assertThrows(IllegalArgumentException.class, () -> batch.verify("SHA256withRSA", 1));
+    assertThrows(
+        IllegalArgumentException.class,
+        () ->
+            SignatureBatchUtils.verify(
+                "SHA256withECDSA",
+                batch.keys,
+                batch.input,
+                batch.offsets,
+                batch.lengths,
+                batch.signatures,
+                Arrays.copyOf(batch.sigOffsets, 3),
+                batch.sigLengths));
+
+    final PublicKey[] withNull = batch.keys.clone();
+    withNull[5] = null;
+    assertThrows(
+        IllegalArgumentException.class,
+        () ->
+            SignatureBatchUtils.verify(
+                "SHA256withECDSA",
+                withNull,
+                batch.input,
+                batch.offsets,
+                batch.lengths,
+                batch.signatures,
+                batch.sigOffsets,
+                batch.sigLengths));
+
+    final int[] badSigOffsets = batch.sigOffsets.clone();
+    badSigOffsets[MESSAGES - 1] = batch.signatures.length;
+    assertThrows(
+        ArrayIndexOutOfBoundsException.class,
+        () ->
+            SignatureBatchUtils.verify(
+                "SHA256withECDSA",
+                batch.keys,
+                batch.input,
+                batch.offsets,
+                batch.lengths,
+                batch.signatures,
+                badSigOffsets,
+                batch.sigLengths));
+  }
+}
@@ -0,0 +1,135 @@
+// Copyright Amazon.com Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+package com.amazon.corretto.crypto.provider.test;
+
+import static com.amazon.corretto.crypto.provider.test.TestUtil.assertArraysHexEquals;
+import static com.amazon.corretto.crypto.provider.test.TestUtil.sneakyInvoke;
+import static org.junit.jupiter.api.Assertions.assertEquals;
+
+import java.security.MessageDigest;
+import java.util.Arrays;
+import java.util.Random;
+import org.junit.jupiter.api.Test;
+import org.junit.jupiter.api.condition.DisabledIf;
+import org.junit.jupiter.api.extension.ExtendWith;
+import org.junit.jupiter.api.parallel.Execution;
+import org.junit.jupiter.api.parallel.ExecutionMode;
+import org.junit.jupiter.api.parallel.ResourceAccessMode;
+import org.junit.jupiter.api.parallel.ResourceLock;
+import org.junit.jupiter.params.ParameterizedTest;
+import org.junit.jupiter.params.provider.ValueSource;
+
+@DisabledIf("com.amazon.corretto.crypto.provider.test.TreeHashTest#isDisabled")
+@Execution(ExecutionMode.CONCURRENT)
+@ExtendWith(TestResultLogger.class)
+@ResourceLock(value = TestUtil.RESOURCE_GLOBAL, mode = ResourceAccessMode.READ)
+public class TreeHashTest {
+  private static final int CHUNK = 1024 * 1024;
+
+  public static boolean isDisabled() {
+    return TestUtil.NATIVE_PROVIDER.isFips() && !TestUtil.NATIVE_PROVIDER.isExperimentalFips();
+  }
+
+  /** Straightforward recursive RFC 6962 Merkle tree hash over CHUNK sized leaves. */
+  private static byte[] referenceTreeHash(
+      final String hash, final byte[] data, final int from, final int to) throws Exception {
+    final MessageDigest md = MessageDigest.getInstance(hash, "SUN");
+    final long chunks = to == from ? 1 : (to - from - 1) / CHUNK + 1;
+    if (chunks == 1) {
+      md.update((byte) 0);
+      md.update(data, from, to - from);
+      return md.digest();
+    }
+    long split = 1;
+    while (split * 2 < chunks) {
+      split *= 2;
+    }
+    final int middle = from + (int) split * CHUNK;
+    md.update((byte) 1);
+    md.update(referenceTreeHash(hash, data, from, middle));
+    md.update(referenceTreeHash(hash, data, middle, to));
+    return md.digest();
+  }
+
+  @Test
+  public void emptyInputIsEmptyLeaf() throws Exception {
+    // RFC 6962 leaf hash of the empty string
+    assertArraysHexEquals(
+        TestUtil.decodeHex("6e340b9cffb37a989ca544e6bb780a2c78901d3fb33738768511a30617afa01d"),
+        MessageDigest.getInstance("SHA-256-TREE", TestUtil.NATIVE_PROVIDER).digest());
+  }
+
+  @ParameterizedTest
+  @ValueSource(
+      ints = {1, CHUNK - 1, CHUNK, CHUNK + 1, 2 * CHUNK, 3 * CHUNK, 4 * CHUNK + 1, 5 * CHUNK + 17})
+  public void matchesReference(final int length) throws Exception {
+    final byte[] data = TestUtil.getRandomBytes(length);
+    for (final String hash : new String[] {"SHA-256", "SHA-512"}) {
+      final MessageDigest md =
+          MessageDigest.getInstance(hash + "-TREE", TestUtil.NATIVE_PROVIDER);
+      final byte[] expected = referenceTreeHash(hash, data, 0, data.length);
+      assertEquals(expected.length, md.getDigestLength());
+      assertArraysHexEquals(expected, md.digest(data));
+      // The digest is reset afterwards
+      assertArraysHexEquals(expected, md.digest(data));
+    }
+  }
+
+  @Test
+  public void independentOfUpdatePattern() throws Exception {
+    final Random rnd = new Random();
+    final byte[] data = TestUtil.getRandomBytes(6 * CHUNK + 12345);
+    final byte[] expected = referenceTreeHash("SHA-256", data, 0, data.length);
+    final MessageDigest md = MessageDigest.getInstance("SHA-256-TREE", TestUtil.NATIVE_PROVIDER);
+
+    for (int trial = 0; trial < 4; trial++) {
+      MessageDigest clone = null;
+      int offset = 0;
+      while (offset < data.length) {
+        final int step;
+        switch (rnd.nextInt(4)) {
+          case 0:
+            md.update(data[offset]);
+            step = 1;
+            break;
+          case 1:
+            step = Math.min(data.length - offset, rnd.nextInt(64 * 1024));
+            md.update(data, offset, step);
+            break;
+          default:
+            step = Math.min(data.length - offset, rnd.nextInt(3 * CHUNK));
+            md.update(data, offset, step);
+            break;
+        }
+        offset += step;
+        if (clone == null && offset > data.length / 2) {
+          clone = (MessageDigest) md.clone();
+          clone.update(data, offset, data.length - offset);
+        }
+      }
+      assertArraysHexEquals(expected, md.digest());
+      assertArraysHexEquals(expected, clone.digest());
+    }
+  }
+
+  @ParameterizedTest
+  @ValueSource(ints = {1, 3})
+  public void leavesSpanningSeveralWindowsMatchReference(final int threads) throws Throwable {
+    // The native code borrows at most four chunks per thread at a time, so these leaves are
+    // digested in several windows.
+    final Class<?> spi = Class.forName("com.amazon.corretto.crypto.provider.TreeHashSpi");
+    final byte[] data = TestUtil.getRandomBytes(13 * CHUNK + 5);
+    final int offset = 3;
+    final int leafCount = (data.length - offset - 1) / CHUNK + 1;
+    final byte[] leaves = new byte[leafCount * 32];
+    sneakyInvoke(spi, "hashLeaves", 32, data, offset, data.length - offset, CHUNK, leaves, threads);
+
+    final MessageDigest md = MessageDigest.getInstance("SHA-256", "SUN");
+    for (int i = 0; i < leafCount; i++) {
+      final int from = offset + i * CHUNK;
+      md.update((byte) 0);
+      md.update(data, from, Math.min(CHUNK, data.length - from));
+      assertArraysHexEquals(md.digest(), Arrays.copyOfRange(leaves, i * 32, (i + 1) * 32));
+    }
+  }
+}